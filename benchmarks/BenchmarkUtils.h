@@ -0,0 +1,82 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Microbenchmark Helpers
+ *
+ * Shared by the data-structure microbenchmarks: the junction workload
+ * (the OSM file, or synthetic junctions when it is missing), a ns/op
+ * timer and the before/after comparison table they print.
+ */
+
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include "JunctionReader.h"
+
+// ==================== WORKLOAD ====================
+
+// Junctions of filename, or 20000 synthetic ones of the same shape if it
+// cannot be read: names share long prefixes like the OSM ones
+inline std::vector<Junction> loadBenchmarkJunctions(const std::string& filename) {
+    std::vector<Junction> junctions;
+    JunctionJsonReader::readFile(filename, [&](std::vector<Junction>& batch) {
+        junctions.insert(junctions.end(), batch.begin(), batch.end());
+    });
+    if (!junctions.empty()) return junctions;
+
+    static const char* prefixes[] = {"Jamia Masjid ", "Karachi ", "National Bank ", "Government School "};
+    std::mt19937 rng(7);
+    for (int id = 1; id <= 20000; ++id) {
+        std::string name = prefixes[rng() % 4] + std::to_string(rng() % 1000000);
+        junctions.push_back(Junction(id, name, 24.0 + (rng() % 13000) / 1000.0,
+                                     61.0 + (rng() % 16000) / 1000.0, "Lahore", "Central"));
+    }
+    return junctions;
+}
+
+// ==================== TIMING ====================
+
+// Nanoseconds per operation of one run() doing ops operations; run
+// returns a checksum so the work cannot be optimized away
+inline double nsPerOp(size_t ops, const std::function<size_t()>& run) {
+    auto start = std::chrono::high_resolution_clock::now();
+    volatile size_t sink = run();
+    (void)sink;
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+// One operation timed on the previous structure and on its replacement
+struct ComparisonRow {
+    const char* label;
+    double before;
+    double after;
+};
+
+// ns/op table with a speedup column (before / after)
+struct ComparisonTable {
+    const char* beforeName;
+    const char* afterName;
+    int labelWidth;
+    int valueWidth;
+
+    void print(const std::vector<ComparisonRow>& rows) const {
+        std::cout << std::left << std::setw(labelWidth) << "operation" << std::right
+                  << std::setw(valueWidth) << beforeName << std::setw(valueWidth) << afterName
+                  << std::setw(valueWidth - 2) << "speedup" << "   (ns/op)\n";
+        for (const ComparisonRow& row : rows) {
+            std::cout << std::left << std::setw(labelWidth) << row.label << std::right << std::fixed
+                      << std::setprecision(1) << std::setw(valueWidth) << row.before
+                      << std::setw(valueWidth) << row.after << std::setw(valueWidth - 3)
+                      << (row.before / row.after) << "x\n";
+        }
+    }
+};
+
+#endif // BENCHMARKUTILS_H
@@ -0,0 +1,166 @@
+/**
+ * Smart Traffic Route Optimizer
+ * B-Tree vs B+Tree Microbenchmark
+ *
+ * Compares BTree (min degree 3, the TrafficManager default) with
+ * BPlusTree on junction names from the OSM data set (or synthetic ones):
+ * inserting in file order, bulk loading, lookups, misses, prefix search,
+ * a name range, a full traversal and size(). Names keep their file
+ * order and duplicates for the insert pass, as the name index sees them.
+ *
+ * Usage: btree_bench [junctions.json] [lookups]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "BTree.h"
+#include "BPlusTree.h"
+#include "BenchmarkUtils.h"
+
+int main(int argc, char* argv[]) {
+    std::string filename = argc > 1 ? argv[1] : "data/pakistan_osm_junctions.json";
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    std::mt19937 rng(42);   // fixed seed: reproducible workload
+    std::vector<std::pair<std::string, int>> names;
+    for (const Junction& j : loadBenchmarkJunctions(filename)) names.push_back({j.name, j.id});
+    std::vector<std::pair<std::string, int>> sorted = names;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end(),
+                             [](const auto& a, const auto& b) { return a.first == b.first; }),
+                 sorted.end());
+    std::cout << "📊 B-Tree benchmark: " << sorted.size() << " distinct junction names, "
+              << lookups << " lookups\n\n";
+
+    std::vector<std::string> hits(lookups), misses(lookups), prefixes(lookups / 100);
+    for (size_t i = 0; i < lookups; ++i) {
+        hits[i] = sorted[rng() % sorted.size()].first;
+        misses[i] = hits[i] + "~";
+    }
+    for (std::string& p : prefixes) {
+        const std::string& name = sorted[rng() % sorted.size()].first;
+        p = name.substr(0, std::min<size_t>(name.size(), 3 + rng() % 6));
+    }
+
+    std::vector<ComparisonRow> rows;
+    BTree<std::string, int> btree;
+    BPlusTree<std::string, int> bplus;
+    rows.push_back({"insert (file order)",
+        nsPerOp(names.size(), [&]() {
+            for (const auto& n : names) btree.insert(n.first, n.second);
+            return btree.size();
+        }),
+        nsPerOp(names.size(), [&]() {
+            for (const auto& n : names) bplus.insert(n.first, n.second);
+            return bplus.size();
+        })});
+    rows.push_back({"bulk load (sorted)",
+        nsPerOp(sorted.size(), [&]() {
+            BTree<std::string, int> tree;
+            tree.bulkLoad(sorted);
+            return size_t(tree.isEmpty());
+        }),
+        nsPerOp(sorted.size(), [&]() {
+            BPlusTree<std::string, int> tree;
+            tree.bulkLoad(sorted);
+            return tree.size();
+        })});
+
+    // Same contents before anything is timed
+    std::vector<std::pair<std::string, int>> a = btree.getAll(), b = bplus.getAll();
+    if (a != b || bplus.size() != sorted.size()) {
+        std::cerr << "❌ Trees disagree on contents\n";
+        return 1;
+    }
+    for (const std::string& p : prefixes) {
+        if (btree.prefixSearch(p) != bplus.prefixSearch(p)) {
+            std::cerr << "❌ Trees disagree on prefix " << p << "\n";
+            return 1;
+        }
+    }
+
+    rows.push_back({"hit, find()",
+        nsPerOp(lookups, [&]() {
+            size_t sum = 0;
+            for (const std::string& k : hits) if (const int* v = btree.find(k)) sum += *v;
+            return sum;
+        }),
+        nsPerOp(lookups, [&]() {
+            size_t sum = 0;
+            for (const std::string& k : hits) if (const int* v = bplus.find(k)) sum += *v;
+            return sum;
+        })});
+    rows.push_back({"miss",
+        nsPerOp(lookups, [&]() {
+            size_t sum = 0;
+            for (const std::string& k : misses) sum += btree.find(k) != nullptr;
+            return sum;
+        }),
+        nsPerOp(lookups, [&]() {
+            size_t sum = 0;
+            for (const std::string& k : misses) sum += bplus.find(k) != nullptr;
+            return sum;
+        })});
+    rows.push_back({"prefix search",
+        nsPerOp(prefixes.size(), [&]() {
+            size_t sum = 0;
+            for (const std::string& p : prefixes) sum += btree.prefixSearch(p).size();
+            return sum;
+        }),
+        nsPerOp(prefixes.size(), [&]() {
+            size_t sum = 0;
+            for (const std::string& p : prefixes) sum += bplus.prefixSearch(p).size();
+            return sum;
+        })});
+    rows.push_back({"range (\"K\" .. \"L\")",
+        nsPerOp(100, [&]() {
+            size_t sum = 0;
+            for (int i = 0; i < 100; ++i) sum += btree.rangeQuery("K", "L").size();
+            return sum;
+        }),
+        nsPerOp(100, [&]() {
+            size_t sum = 0;
+            for (int i = 0; i < 100; ++i) sum += bplus.rangeQuery("K", "L").size();
+            return sum;
+        })});
+    rows.push_back({"traverse (per entry)",
+        nsPerOp(sorted.size() * 20, [&]() {
+            size_t sum = 0;
+            for (int pass = 0; pass < 20; ++pass) {
+                btree.traverse([&](const std::string&, const int& id) { sum += id; });
+            }
+            return sum;
+        }),
+        nsPerOp(sorted.size() * 20, [&]() {
+            size_t sum = 0;
+            for (int pass = 0; pass < 20; ++pass) {
+                bplus.traverse([&](const std::string&, const int& id) { sum += id; });
+            }
+            return sum;
+        })});
+    rows.push_back({"size()",
+        nsPerOp(1000, [&]() {
+            size_t sum = 0;
+            for (int i = 0; i < 1000; ++i) sum += btree.size();
+            return sum;
+        }),
+        nsPerOp(1000, [&]() {
+            size_t sum = 0;
+            for (int i = 0; i < 1000; ++i) sum += bplus.size();
+            return sum;
+        })});
+
+    ComparisonTable{"B-Tree", "B+Tree", 30, 14}.print(rows);
+
+    auto m = bplus.getMetrics();
+    std::cout << "\n🌳 B+Tree: height " << m.height << ", " << m.nodeCount << " nodes, "
+              << std::setprecision(1) << m.avgKeysPerLeaf << " keys per leaf (max " << m.maxKeysPerNode
+              << "), " << m.memoryBytes / 1024 << " KB; B-Tree: height " << btree.getHeight() << ", "
+              << btree.countNodes() << " nodes\n";
+    std::cout << "\n✅ Both trees agree on every name and prefix\n";
+    return 0;
+}
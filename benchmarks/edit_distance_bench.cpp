@@ -0,0 +1,184 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Edit Distance Microbenchmark
+ *
+ * Compares the full-matrix Levenshtein implementation that fuzzy search
+ * used to run with the kernels in EditDistance.h, on junction names from
+ * the OSM data set (lower-cased, as search sees them).
+ * Every kernel is checked against the matrix before it is timed.
+ *
+ * Usage: edit_distance_bench [junctions.json] [pairs]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include "EditDistance.h"
+
+// ==================== REFERENCE ====================
+
+// Previous TrafficManager::levenshteinDistance: (n+1) x (m+1) matrix per call
+static size_t matrixEditDistance(const std::string& s1, const std::string& s2) {
+    const size_t len1 = s1.size(), len2 = s2.size();
+    std::vector<std::vector<int>> d(len1 + 1, std::vector<int>(len2 + 1));
+
+    for (size_t i = 0; i <= len1; ++i) d[i][0] = i;
+    for (size_t j = 0; j <= len2; ++j) d[0][j] = j;
+
+    for (size_t i = 1; i <= len1; ++i) {
+        for (size_t j = 1; j <= len2; ++j) {
+            int cost = (s1[i-1] == s2[j-1]) ? 0 : 1;
+            d[i][j] = std::min({
+                d[i-1][j] + 1,
+                d[i][j-1] + 1,
+                d[i-1][j-1] + cost
+            });
+        }
+    }
+    return d[len1][len2];
+}
+
+// ==================== WORKLOAD ====================
+
+struct Pair {
+    std::string a;
+    std::string b;
+    size_t maxEdits;   // bound implied by the similarity threshold
+};
+
+static std::vector<std::string> loadNames(const std::string& filename) {
+    std::vector<std::string> names;
+    std::ifstream file(filename);
+    std::string line;
+    const std::string key = "\"name\": \"";
+    while (std::getline(file, line)) {
+        size_t pos = line.find(key);
+        if (pos == std::string::npos) continue;
+        size_t start = pos + key.size();
+        size_t end = line.find('"', start);
+        if (end == std::string::npos) continue;
+        std::string name = line.substr(start, end - start);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        names.push_back(name);
+    }
+    return names;
+}
+
+static std::string perturb(std::string s, std::mt19937& rng) {
+    int edits = 1 + rng() % 3;
+    for (int e = 0; e < edits && !s.empty(); ++e) {
+        size_t pos = rng() % s.size();
+        char c = static_cast<char>('a' + rng() % 26);
+        switch (rng() % 3) {
+            case 0: s[pos] = c; break;
+            case 1: s.erase(pos, 1); break;
+            default: s.insert(pos, 1, c); break;
+        }
+    }
+    return s;
+}
+
+static size_t maxEditsFor(const std::string& a, const std::string& b, double threshold) {
+    return static_cast<size_t>((1.0 - threshold) * std::max(a.size(), b.size()) + 1e-9);
+}
+
+// Half near-duplicates (typos), half unrelated names
+static std::vector<Pair> makePairs(const std::vector<std::string>& names, size_t count,
+                                   double threshold, bool longNames, std::mt19937& rng) {
+    std::vector<Pair> pairs;
+    pairs.reserve(count);
+    auto pick = [&]() {
+        std::string name = names[rng() % names.size()];
+        if (longNames) {
+            while (name.size() <= EDIT_DISTANCE_WORD_BITS) name += " " + names[rng() % names.size()];
+        }
+        return name;
+    };
+    for (size_t i = 0; i < count; ++i) {
+        std::string a = pick();
+        std::string b = (i % 2 == 0) ? perturb(a, rng) : pick();
+        pairs.push_back({a, b, maxEditsFor(a, b, threshold)});
+    }
+    return pairs;
+}
+
+// ==================== TIMING ====================
+
+static double nsPerPair(const std::vector<Pair>& pairs,
+                        const std::function<size_t(const Pair&)>& kernel) {
+    size_t checksum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const Pair& p : pairs) checksum += kernel(p);
+    auto end = std::chrono::high_resolution_clock::now();
+    volatile size_t sink = checksum;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(end - start).count() / pairs.size();
+}
+
+static bool verify(const std::vector<Pair>& pairs) {
+    for (const Pair& p : pairs) {
+        size_t expected = matrixEditDistance(p.a, p.b);
+        size_t bounded = std::min(expected, p.maxEdits + 1);
+        if (editDistance(p.a, p.b) != expected ||
+            boundedEditDistance(p.a, p.b, p.maxEdits) != bounded) {
+            std::cerr << "❌ Mismatch: \"" << p.a << "\" / \"" << p.b << "\" expected "
+                      << expected << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filename = argc > 1 ? argv[1] : "data/pakistan_osm_junctions.json";
+    size_t count = argc > 2 ? std::stoul(argv[2]) : 200000;
+
+    std::vector<std::string> names = loadNames(filename);
+    if (names.empty()) {
+        std::cerr << "Error: no junction names in " << filename << "\n";
+        return 1;
+    }
+    std::cout << "📊 Edit distance benchmark: " << names.size() << " names, "
+              << count << " pairs per workload\n\n";
+
+    struct Workload {
+        const char* label;
+        double threshold;
+        bool longNames;
+    };
+    const Workload workloads[] = {
+        {"names, threshold 0.5", 0.5, false},
+        {"names, threshold 0.7", 0.7, false},
+        {"> 64 chars, threshold 0.7", 0.7, true},
+    };
+
+    std::cout << std::left << std::setw(28) << "workload"
+              << std::right << std::setw(12) << "matrix" << std::setw(12) << "unbounded"
+              << std::setw(12) << "bounded" << std::setw(10) << "speedup" << "   (ns/pair)\n";
+
+    std::mt19937 rng(42);   // fixed seed: reproducible pairs
+    for (const Workload& w : workloads) {
+        std::vector<Pair> pairs = makePairs(names, w.longNames ? count / 20 : count,
+                                            w.threshold, w.longNames, rng);
+        if (!verify(pairs)) return 1;
+
+        double matrix = nsPerPair(pairs, [](const Pair& p) { return matrixEditDistance(p.a, p.b); });
+        double unbounded = nsPerPair(pairs, [](const Pair& p) { return editDistance(p.a, p.b); });
+        double bounded = nsPerPair(pairs, [](const Pair& p) {
+            return boundedEditDistance(p.a, p.b, p.maxEdits);
+        });
+
+        std::cout << std::left << std::setw(28) << w.label << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(12) << matrix << std::setw(12) << unbounded
+                  << std::setw(12) << bounded << std::setw(9) << (matrix / bounded) << "x\n";
+    }
+
+    std::cout << "\n✅ All kernels agree with the matrix implementation\n";
+    return 0;
+}
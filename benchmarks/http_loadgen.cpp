@@ -0,0 +1,685 @@
+/**
+ * Smart Traffic Route Optimizer
+ * HTTP Load Generator
+ *
+ * Replays a weighted mix of API requests against a running server
+ * (--server, either the event loop or --threaded) and reports latency
+ * per endpoint:
+ *   route      GET /api/route between two junctions of one city; --repeat
+ *              percent of them come from a small set of popular pairs
+ *   search     GET /api/smart-search for a known name, half of them with
+ *              one letter changed (the fuzzy path, never Nominatim)
+ *   junctions  GET /api/junctions, one page of a city
+ *   traffic    POST /api/traffic with a random level for a random road
+ *
+ * Junction and road IDs come from the server itself before the run.
+ * Each connection is a keep-alive client with one request in flight
+ * (closed loop) paced to its share of --qps. Latency runs from the time a
+ * request was scheduled, not from when it was sent, so a server that falls
+ * behind shows up in the percentiles instead of silently lowering the
+ * offered load; service time (send to last byte) is reported next to it.
+ * Results from the first --warmup seconds are discarded.
+ *
+ * --slo-p99=MS and --slo-errors=PCT turn the report into a check: the
+ * exit code is 2 if any endpoint misses them. --json=FILE writes the
+ * report one endpoint per line, like traffic_bench.
+ *
+ * Usage: http_loadgen [--host=H] [--port=8080] [--connections=N] [--qps=Q]
+ *                     [--duration=S] [--warmup=S] [--mix=route:60,search:20,...]
+ *                     [--repeat=PCT] [--close] [--timeout=MS] [--seed=N]
+ *                     [--slo-p99=MS] [--slo-errors=PCT] [--json=FILE]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include "Metrics.h"
+
+// Platform-specific socket headers
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <netdb.h>
+    #include <unistd.h>
+    #define SOCKET int
+    #define INVALID_SOCKET -1
+    #define closesocket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// ==================== HTTP CLIENT ====================
+
+struct HttpReply {
+    int status;          // 0 = no response (connect or I/O error, timeout)
+    bool keepAlive;
+    std::string body;    // decoded (chunked bodies are joined)
+};
+
+// One keep-alive connection; reconnects on the next request after a close
+class HttpConnection {
+private:
+    std::string host;
+    std::string port;
+    int timeoutMs;
+    SOCKET fd;
+    std::string buffer;   // received, not yet consumed
+
+    bool connectSocket() {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) return false;
+        for (addrinfo* a = addresses; a && fd == INVALID_SOCKET; a = a->ai_next) {
+            fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+            if (fd == INVALID_SOCKET) continue;
+            if (connect(fd, a->ai_addr, static_cast<int>(a->ai_addrlen)) != 0) {
+                closesocket(fd);
+                fd = INVALID_SOCKET;
+            }
+        }
+        freeaddrinfo(addresses);
+        if (fd == INVALID_SOCKET) return false;
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+#ifdef _WIN32
+        DWORD timeout = static_cast<DWORD>(timeoutMs);
+#else
+        timeval timeout{timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+#endif
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        connects++;
+        return true;
+    }
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int n = send(fd, data.data() + sent, static_cast<int>(data.size() - sent), MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Receive more into buffer; false on close, error or timeout
+    bool fill() {
+        char chunk[16384];
+        int n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+        return true;
+    }
+
+    static bool headerIs(const std::string& head, const char* name, const char* value) {
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+        size_t at = lower.find(std::string("\r\n") + name + ":");
+        if (at == std::string::npos) return false;
+        size_t end = lower.find("\r\n", at + 2);
+        return lower.substr(at, end - at).find(value) != std::string::npos;
+    }
+
+    static long long headerNumber(const std::string& head, const char* name) {
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+        size_t at = lower.find(std::string("\r\n") + name + ":");
+        if (at == std::string::npos) return -1;
+        return std::atoll(lower.c_str() + at + 3 + std::strlen(name));
+    }
+
+    // Read one response; body framing by Content-Length, chunked or close
+    bool readReply(HttpReply* reply) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        std::string head = buffer.substr(0, headerEnd + 2);
+        size_t pos = headerEnd + 4;
+        if (head.compare(0, 5, "HTTP/") != 0 || head.size() < 12) return false;
+        reply->status = std::atoi(head.c_str() + 9);
+        bool http10 = head.compare(0, 8, "HTTP/1.0") == 0;
+        reply->keepAlive = headerIs(head, "connection", "close") ? false
+                           : http10 ? headerIs(head, "connection", "keep-alive") : true;
+
+        if (headerIs(head, "transfer-encoding", "chunked")) {
+            for (;;) {
+                size_t lineEnd;
+                while ((lineEnd = buffer.find("\r\n", pos)) == std::string::npos) {
+                    if (!fill()) return false;
+                }
+                size_t size = std::strtoul(buffer.c_str() + pos, nullptr, 16);
+                pos = lineEnd + 2;
+                while (buffer.size() < pos + size + 2) {
+                    if (!fill()) return false;
+                }
+                if (size == 0) {
+                    pos += 2;   // no trailers from this server
+                    break;
+                }
+                reply->body.append(buffer, pos, size);
+                pos += size + 2;
+            }
+        } else {
+            long long length = headerNumber(head, "content-length");
+            if (length < 0 && reply->status != 204 && reply->status != 304) {
+                while (fill()) {}   // body ends with the connection
+                reply->keepAlive = false;
+                length = static_cast<long long>(buffer.size() - pos);
+            }
+            if (length < 0) length = 0;
+            while (buffer.size() < pos + static_cast<size_t>(length)) {
+                if (!fill()) return false;
+            }
+            reply->body.assign(buffer, pos, static_cast<size_t>(length));
+            pos += static_cast<size_t>(length);
+        }
+        buffer.erase(0, pos);
+        return true;
+    }
+
+public:
+    uint64_t connects = 0;
+
+    HttpConnection(const std::string& host, int port, int timeoutMs)
+        : host(host), port(std::to_string(port)), timeoutMs(timeoutMs), fd(INVALID_SOCKET) {}
+
+    ~HttpConnection() { disconnect(); }
+
+    HttpConnection(const HttpConnection&) = delete;
+    HttpConnection& operator=(const HttpConnection&) = delete;
+
+    void disconnect() {
+        if (fd != INVALID_SOCKET) closesocket(fd);
+        fd = INVALID_SOCKET;
+        buffer.clear();
+    }
+
+    // Send one request and wait for its response; reply->status is 0 when
+    // there was none. A keep-alive connection the server closed while idle
+    // is retried once on a fresh connection.
+    void exchange(const std::string& method, const std::string& target, bool keepAlive, HttpReply* reply) {
+        std::string request = method + " " + target + " HTTP/1.1\r\nHost: " + host +
+                              (keepAlive ? "\r\n" : "\r\nConnection: close\r\n");
+        if (method == "POST") request += "Content-Length: 0\r\n";
+        request += "\r\n";
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            bool reused = fd != INVALID_SOCKET;
+            reply->status = 0;
+            reply->keepAlive = false;
+            reply->body.clear();
+            if (!reused && !connectSocket()) return;
+            if (sendAll(request) && readReply(reply)) {
+                if (!reply->keepAlive) disconnect();
+                return;
+            }
+            disconnect();
+            if (!reused) return;
+        }
+    }
+};
+
+// ==================== REQUEST MIX ====================
+
+enum Endpoint { ROUTE, SEARCH, JUNCTIONS, TRAFFIC, ENDPOINT_COUNT };
+
+static const char* endpointNames[ENDPOINT_COUNT] = {"route", "search", "junctions", "traffic"};
+
+struct JunctionRef {
+    int id;
+    std::string name;
+    std::string city;
+};
+
+// What the server holds, fetched before the run
+struct Catalog {
+    std::vector<JunctionRef> junctions;
+    std::map<std::string, std::vector<size_t>> cities;   // city -> indices into junctions
+    std::vector<std::string> routeCities;                // cities with at least two junctions
+    std::vector<int> roadIds;
+    std::string serverMode;
+    int serverWorkers = 0;
+};
+
+// Value after "key": in one JSON object (numbers and plain strings only)
+static std::string jsonField(const std::string& json, size_t from, size_t to, const char* key) {
+    std::string needle = std::string("\"") + key + "\":";
+    size_t at = json.find(needle, from);
+    if (at == std::string::npos || at >= to) return std::string();
+    at += needle.size();
+    while (at < to && json[at] == ' ') at++;
+    if (at < to && json[at] == '"') {
+        std::string value;
+        for (size_t i = at + 1; i < to && json[i] != '"'; ++i) {
+            if (json[i] == '\\' && i + 1 < to) ++i;
+            value += json[i];
+        }
+        return value;
+    }
+    size_t end = json.find_first_of(",}", at);
+    return json.substr(at, std::min(end, to) - at);
+}
+
+// Calls visit(begin, end) for each object in the "<key>": [...] array
+template <typename Visit>
+static void forEachObject(const std::string& json, const char* key, Visit visit) {
+    size_t at = json.find(std::string("\"") + key + "\"");
+    if (at == std::string::npos) return;
+    at = json.find('[', at);
+    while (at != std::string::npos) {
+        size_t begin = json.find('{', at);
+        if (begin == std::string::npos) return;
+        size_t end = json.find('}', begin);
+        size_t close = json.find(']', at);
+        if (end == std::string::npos || (close != std::string::npos && close < begin)) return;
+        visit(begin, end);
+        at = end;
+    }
+}
+
+static bool loadCatalog(HttpConnection& connection, size_t limit, Catalog* catalog) {
+    HttpReply reply;
+    connection.exchange("GET", "/api/stats", true, &reply);
+    if (reply.status != 200) return false;
+    size_t server = reply.body.find("\"server\"");
+    if (server != std::string::npos) {
+        size_t end = reply.body.find('}', server);
+        catalog->serverMode = jsonField(reply.body, server, end, "mode");
+        catalog->serverWorkers = std::atoi(jsonField(reply.body, server, end, "workers").c_str());
+    }
+
+    connection.exchange("GET", "/api/junctions?offset=0&limit=" + std::to_string(limit), true, &reply);
+    if (reply.status != 200) return false;
+    forEachObject(reply.body, "junctions", [&](size_t begin, size_t end) {
+        JunctionRef j{std::atoi(jsonField(reply.body, begin, end, "id").c_str()),
+                      jsonField(reply.body, begin, end, "name"), jsonField(reply.body, begin, end, "city")};
+        catalog->cities[j.city].push_back(catalog->junctions.size());
+        catalog->junctions.push_back(std::move(j));
+    });
+    for (const auto& city : catalog->cities) {
+        if (city.second.size() >= 2) catalog->routeCities.push_back(city.first);
+    }
+
+    connection.exchange("GET", "/api/roads?offset=0&limit=" + std::to_string(limit), true, &reply);
+    if (reply.status != 200) return false;
+    forEachObject(reply.body, "roads", [&](size_t begin, size_t end) {
+        catalog->roadIds.push_back(std::atoi(jsonField(reply.body, begin, end, "id").c_str()));
+    });
+    return !catalog->routeCities.empty();
+}
+
+static std::string urlEncode(const std::string& text) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 15];
+        }
+    }
+    return out;
+}
+
+struct MixConfig {
+    double weights[ENDPOINT_COUNT] = {60, 20, 10, 10};
+    int repeatPct = 50;   // route requests drawn from the popular pairs
+};
+
+// "route:60,search:20,junctions:10,traffic:10"; unnamed endpoints get 0
+static bool parseMix(const std::string& text, MixConfig* mix) {
+    std::fill(mix->weights, mix->weights + ENDPOINT_COUNT, 0.0);
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(start, end - start);
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) return false;
+        const char** name = std::find(endpointNames, endpointNames + ENDPOINT_COUNT, item.substr(0, colon));
+        if (name == endpointNames + ENDPOINT_COUNT) return false;
+        mix->weights[name - endpointNames] = std::atof(item.c_str() + colon + 1);
+        start = end + 1;
+    }
+    return std::any_of(mix->weights, mix->weights + ENDPOINT_COUNT, [](double w) { return w > 0; });
+}
+
+struct PlannedRequest {
+    Endpoint endpoint;
+    const char* method;
+    std::string target;
+};
+
+// Draws requests from the mix; one per connection thread
+class RequestPlanner {
+private:
+    const Catalog& catalog;
+    const MixConfig& mix;
+    std::mt19937 rng;
+    std::discrete_distribution<int> pickEndpoint;
+    std::vector<std::pair<int, int>> popularPairs;
+
+    const JunctionRef& randomIn(const std::string& city) {
+        const std::vector<size_t>& ids = catalog.cities.at(city);
+        return catalog.junctions[ids[rng() % ids.size()]];
+    }
+
+    const std::string& randomRouteCity() {
+        return catalog.routeCities[rng() % catalog.routeCities.size()];
+    }
+
+    std::pair<int, int> randomPair() {
+        const std::string& city = randomRouteCity();
+        int from = randomIn(city).id, to = from;
+        while (to == from) to = randomIn(city).id;
+        return {from, to};
+    }
+
+public:
+    // popularSeed is shared by every connection, so they repeat the same pairs
+    RequestPlanner(const Catalog& catalog, const MixConfig& mix, uint32_t seed, uint32_t popularSeed)
+        : catalog(catalog), mix(mix), rng(popularSeed),
+          pickEndpoint(mix.weights, mix.weights + ENDPOINT_COUNT) {
+        for (int i = 0; i < 64; ++i) popularPairs.push_back(randomPair());
+        rng.seed(seed);
+    }
+
+    PlannedRequest next() {
+        Endpoint endpoint = static_cast<Endpoint>(pickEndpoint(rng));
+        if (endpoint == TRAFFIC && catalog.roadIds.empty()) endpoint = ROUTE;
+        switch (endpoint) {
+            case ROUTE: {
+                std::pair<int, int> pair = static_cast<int>(rng() % 100) < mix.repeatPct
+                                               ? popularPairs[rng() % popularPairs.size()] : randomPair();
+                std::string target = "/api/route?from=" + std::to_string(pair.first) +
+                                     "&to=" + std::to_string(pair.second);
+                if (rng() % 4 == 0) target += "&optimize=distance";
+                return {endpoint, "GET", target};
+            }
+            case SEARCH: {
+                const JunctionRef& j = catalog.junctions[rng() % catalog.junctions.size()];
+                std::string query = j.name;
+                if (query.size() > 3 && rng() % 2 == 0) query[1 + rng() % (query.size() - 2)] = 'x';
+                return {endpoint, "GET", "/api/smart-search?q=" + urlEncode(query) + "&city=" + urlEncode(j.city)};
+            }
+            case JUNCTIONS: {
+                const std::string& city = randomRouteCity();
+                size_t pages = (catalog.cities.at(city).size() + 49) / 50;
+                return {endpoint, "GET", "/api/junctions?city=" + urlEncode(city) +
+                                         "&offset=" + std::to_string(rng() % pages * 50) + "&limit=50"};
+            }
+            default: {
+                int road = catalog.roadIds[rng() % catalog.roadIds.size()];
+                return {endpoint, "POST", "/api/traffic?road=" + std::to_string(road) +
+                                          "&level=" + std::to_string(1 + rng() % 4)};
+            }
+        }
+    }
+};
+
+// ==================== RUN ====================
+
+// Owned by one connection thread; merged after the run
+struct ConnectionStats {
+    LatencyHistogram latency[ENDPOINT_COUNT];   // from the scheduled start, ns
+    LatencyHistogram service[ENDPOINT_COUNT];   // from the send, ns
+    uint64_t statusClasses[ENDPOINT_COUNT][6] = {};   // [0] = no response, [2] = 2xx ... [5] = 5xx
+    uint64_t connects = 0;
+};
+
+struct RunConfig {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 8;
+    double qps = 200;   // total offered load; 0 = as fast as responses come back
+    double durationSeconds = 30;
+    double warmupSeconds = 2;
+    bool keepAlive = true;
+    int timeoutMs = 5000;
+    uint32_t seed = 42;
+};
+
+static void runConnection(const RunConfig& config, const Catalog& catalog, const MixConfig& mix, int index,
+                          Clock::time_point start, ConnectionStats* stats) {
+    HttpConnection connection(config.host, config.port, config.timeoutMs);
+    RequestPlanner planner(catalog, mix, config.seed + 1 + index, config.seed);
+    const auto warmupEnd = start + std::chrono::duration_cast<Clock::duration>(
+                                       std::chrono::duration<double>(config.warmupSeconds));
+    const auto end = warmupEnd + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(config.durationSeconds));
+
+    // This connection's share of the load, staggered against the others
+    Clock::duration interval = Clock::duration::zero();
+    Clock::time_point scheduled = start;
+    if (config.qps > 0) {
+        interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(config.connections / config.qps));
+        scheduled += interval * index / config.connections;
+    }
+
+    HttpReply reply;
+    while (scheduled < end) {
+        if (config.qps > 0) std::this_thread::sleep_until(scheduled);
+        PlannedRequest request = planner.next();
+        Clock::time_point sent = Clock::now();
+        if (config.qps <= 0) scheduled = sent;
+        connection.exchange(request.method, request.target, config.keepAlive, &reply);
+        Clock::time_point done = Clock::now();
+
+        if (scheduled >= warmupEnd) {
+            stats->latency[request.endpoint].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - scheduled).count()));
+            stats->service[request.endpoint].record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(done - sent).count()));
+            int statusClass = reply.status / 100;
+            stats->statusClasses[request.endpoint][statusClass >= 1 && statusClass <= 5 ? statusClass : 0]++;
+        }
+        scheduled += interval;
+    }
+    stats->connects = connection.connects;
+}
+
+// ==================== REPORT ====================
+
+struct EndpointReport {
+    std::string name;
+    LatencyHistogram::Snapshot latency;
+    LatencyHistogram::Snapshot service;
+    uint64_t statusClasses[6];
+
+    uint64_t errors() const { return statusClasses[0] + statusClasses[4] + statusClasses[5]; }
+    double errorPct() const { return latency.count ? 100.0 * errors() / latency.count : 0.0; }
+};
+
+static EndpointReport merge(const std::string& name, const std::vector<std::unique_ptr<ConnectionStats>>& stats,
+                            int first, int last) {
+    EndpointReport report{name, {}, {}, {}};
+    for (const auto& s : stats) {
+        for (int e = first; e < last; ++e) {
+            s->latency[e].addTo(&report.latency);
+            s->service[e].addTo(&report.service);
+            for (int c = 0; c < 6; ++c) report.statusClasses[c] += s->statusClasses[e][c];
+        }
+    }
+    return report;
+}
+
+static void printReport(const EndpointReport& r, double seconds) {
+    std::cout << std::left << std::setw(11) << r.name << std::right << std::setw(8) << r.latency.count
+              << std::fixed << std::setprecision(1) << std::setw(9) << (seconds > 0 ? r.latency.count / seconds : 0)
+              << std::setprecision(2) << std::setw(10) << r.latency.percentile(0.5) / 1e6 << std::setw(10)
+              << r.latency.percentile(0.99) / 1e6 << std::setw(10) << r.latency.percentile(0.999) / 1e6
+              << std::setw(10) << r.latency.max / 1e6 << std::setw(10) << r.service.percentile(0.99) / 1e6
+              << std::setw(8) << r.errors() << "  (4xx " << r.statusClasses[4] << ", 5xx "
+              << r.statusClasses[5] << ", no reply " << r.statusClasses[0] << ")\n";
+}
+
+static bool writeJson(const std::string& path, const RunConfig& config, const std::string& mixText,
+                      const Catalog& catalog, const std::vector<EndpointReport>& reports, double seconds) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\"benchmark\": \"http_loadgen\", \"schema\": 1, \"seed\": " << config.seed << ", \"server\": {\"mode\": \""
+        << catalog.serverMode << "\", \"workers\": " << catalog.serverWorkers << "},\n";
+    out << " \"load\": {\"connections\": " << config.connections << ", \"qps\": " << config.qps
+        << ", \"duration\": " << config.durationSeconds << ", \"keepAlive\": " << (config.keepAlive ? "true" : "false")
+        << ", \"mix\": \"" << mixText << "\"},\n";
+    out << " \"results\": [\n";
+    for (size_t i = 0; i < reports.size(); ++i) {
+        const EndpointReport& r = reports[i];
+        std::string line = "  {\"name\": \"http." + r.name + "\", \"unit\": \"ms\", \"ops\": " +
+                           std::to_string(r.latency.count);
+        const std::pair<const char*, double> fields[] = {
+            {"mean", r.latency.mean() / 1e6}, {"p50", r.latency.percentile(0.5) / 1e6},
+            {"p90", r.latency.percentile(0.9) / 1e6}, {"p99", r.latency.percentile(0.99) / 1e6},
+            {"p999", r.latency.percentile(0.999) / 1e6}, {"max", r.latency.max / 1e6},
+            {"serviceP50", r.service.percentile(0.5) / 1e6}, {"serviceP99", r.service.percentile(0.99) / 1e6},
+            {"opsPerSec", seconds > 0 ? r.latency.count / seconds : 0}, {"errors", static_cast<double>(r.errors())},
+            {"errorPct", r.errorPct()}};
+        for (const auto& field : fields) {
+            line += std::string(", \"") + field.first + "\": ";
+            Metrics::appendNumber(line, field.second);
+        }
+        line += i + 1 < reports.size() ? "},\n" : "}\n";
+        out << line;
+    }
+    out << " ]}\n";
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char* argv[]) {
+    RunConfig config;
+    MixConfig mix;
+    std::string mixText = "route:60,search:20,junctions:10,traffic:10";
+    std::string jsonFile;
+    double sloP99Ms = 0, sloErrorPct = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--host=", 0) == 0) config.host = arg.substr(7);
+        else if (arg.rfind("--port=", 0) == 0) config.port = std::atoi(arg.c_str() + 7);
+        else if (arg.rfind("--connections=", 0) == 0) config.connections = std::max(1, std::atoi(arg.c_str() + 14));
+        else if (arg.rfind("--qps=", 0) == 0) config.qps = std::max(0.0, std::atof(arg.c_str() + 6));
+        else if (arg.rfind("--duration=", 0) == 0) config.durationSeconds = std::atof(arg.c_str() + 11);
+        else if (arg.rfind("--warmup=", 0) == 0) config.warmupSeconds = std::max(0.0, std::atof(arg.c_str() + 9));
+        else if (arg.rfind("--mix=", 0) == 0) mixText = arg.substr(6);
+        else if (arg.rfind("--repeat=", 0) == 0) mix.repeatPct = std::atoi(arg.c_str() + 9);
+        else if (arg == "--close") config.keepAlive = false;
+        else if (arg.rfind("--timeout=", 0) == 0) config.timeoutMs = std::max(1, std::atoi(arg.c_str() + 10));
+        else if (arg.rfind("--seed=", 0) == 0) config.seed = static_cast<uint32_t>(std::atol(arg.c_str() + 7));
+        else if (arg.rfind("--slo-p99=", 0) == 0) sloP99Ms = std::atof(arg.c_str() + 10);
+        else if (arg.rfind("--slo-errors=", 0) == 0) sloErrorPct = std::atof(arg.c_str() + 13);
+        else if (arg.rfind("--json=", 0) == 0) jsonFile = arg.substr(7);
+        else {
+            std::cerr << "❌ Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+    if (!parseMix(mixText, &mix)) {
+        std::cerr << "❌ Invalid --mix " << mixText << " (endpoints: route, search, junctions, traffic)\n";
+        return 1;
+    }
+
+#ifdef _WIN32
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+#endif
+
+    Catalog catalog;
+    {
+        HttpConnection setup(config.host, config.port, 30000);
+        if (!loadCatalog(setup, 20000, &catalog)) {
+            std::cerr << "❌ No junctions from http://" << config.host << ":" << config.port
+                      << " (start it with --server)\n";
+            return 1;
+        }
+    }
+
+    std::cout << "🚦 http_loadgen: http://" << config.host << ":" << config.port << " ("
+              << (catalog.serverMode.empty() ? "unknown" : catalog.serverMode) << " mode";
+    if (catalog.serverWorkers > 0) std::cout << ", " << catalog.serverWorkers << " workers";
+    std::cout << "), " << catalog.junctions.size() << " junctions, " << catalog.roadIds.size() << " roads\n";
+    std::cout << "   " << config.connections << (config.keepAlive ? " keep-alive" : " close-per-request")
+              << " connections, ";
+    if (config.qps > 0) std::cout << config.qps << " req/s offered";
+    else std::cout << "unpaced";
+    std::cout << ", " << config.warmupSeconds << " s warm-up + " << config.durationSeconds << " s, mix " << mixText
+              << "\n\n";
+
+    std::vector<std::unique_ptr<ConnectionStats>> stats;
+    std::vector<std::thread> threads;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < config.connections; ++i) {
+        stats.emplace_back(new ConnectionStats());
+        threads.emplace_back(runConnection, std::cref(config), std::cref(catalog), std::cref(mix), i, start,
+                             stats.back().get());
+    }
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count() - config.warmupSeconds;
+
+    std::vector<EndpointReport> reports;
+    for (int e = 0; e < ENDPOINT_COUNT; ++e) {
+        if (mix.weights[e] > 0) reports.push_back(merge(endpointNames[e], stats, e, e + 1));
+    }
+    reports.push_back(merge("all", stats, 0, ENDPOINT_COUNT));
+    uint64_t connects = 0;
+    for (const auto& s : stats) connects += s->connects;
+
+    std::cout << std::left << std::setw(11) << "endpoint" << std::right << std::setw(8) << "reqs" << std::setw(9)
+              << "req/s" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "p999 ms"
+              << std::setw(10) << "max ms" << std::setw(10) << "svc p99" << std::setw(8) << "errors" << "\n";
+    for (const EndpointReport& r : reports) printReport(r, seconds);
+    std::cout << "\n   " << connects << " TCP connections opened\n";
+
+    if (!jsonFile.empty()) {
+        if (!writeJson(jsonFile, config, mixText, catalog, reports, seconds)) {
+            std::cerr << "❌ Could not write " << jsonFile << "\n";
+            return 1;
+        }
+        std::cout << "💾 Results written to " << jsonFile << "\n";
+    }
+
+    if (sloP99Ms <= 0 && sloErrorPct < 0) return 0;
+    std::cout << "\n📊 SLO:";
+    if (sloP99Ms > 0) std::cout << " p99 <= " << sloP99Ms << " ms";
+    if (sloErrorPct >= 0) std::cout << " errors <= " << sloErrorPct << "%";
+    std::cout << "\n";
+    int misses = 0;
+    for (const EndpointReport& r : reports) {
+        bool slow = sloP99Ms > 0 && r.latency.percentile(0.99) / 1e6 > sloP99Ms;
+        bool failing = sloErrorPct >= 0 && r.errorPct() > sloErrorPct;
+        misses += slow || failing;
+        std::cout << (slow || failing ? "  ❌ " : "  ✅ ") << std::left << std::setw(11) << r.name << std::right
+                  << std::fixed << std::setprecision(2) << " p99 " << r.latency.percentile(0.99) / 1e6 << " ms, errors "
+                  << r.errorPct() << "%\n";
+    }
+    std::cout << (misses ? "\n❌ " : "\n✅ ") << misses << " endpoint(s) outside the SLO\n";
+    return misses ? 2 : 0;
+}
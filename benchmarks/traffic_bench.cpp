@@ -0,0 +1,495 @@
+/**
+ * Smart Traffic Route Optimizer
+ * End-to-End Benchmark Suite
+ *
+ * Fixed-seed workloads over the real Pakistan data set, run through
+ * TrafficManager the way the server uses it:
+ *   load.*     JSON parse, road generation, freeze, snapshot save / load,
+ *              route hierarchy
+ *   route.*    intra-city and intercity queries for every algorithm, by
+ *              distance, with alternatives and with a departure time
+ *              (cache misses: each pair is asked once per workload)
+ *   search.*   fuzzy (misspelled names), prefix and exact name lookups
+ *   traffic.*  bursts of traffic updates against a warm route cache
+ *   cache.*    route request streams with 90% and 50% repeated pairs
+ *
+ * Results go to a table on stdout and, one result per line, to a JSON
+ * file for tracking between releases; --compare checks a run against an
+ * earlier file and exits with 2 if a p50 got slower than the tolerance.
+ *
+ * Query workloads run three times (--runs) and keep the fastest pass.
+ *
+ * Usage: traffic_bench [junctions.json] [--radius=KM] [--quick] [--runs=N]
+ *                      [--json=FILE] [--compare=BASELINE] [--tolerance=PCT]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include "TrafficManager.h"
+#include "OSMLoader.h"
+#include "Metrics.h"
+
+// ==================== RESULTS ====================
+
+struct BenchResult {
+    std::string name;
+    std::string unit;                                  // "us" or "ms"
+    uint64_t ops;
+    LatencyHistogram::Snapshot latency;                // nanoseconds
+    double seconds;                                    // wall time of the whole workload
+    std::vector<std::pair<std::string, double>> extra; // workload-specific outputs (found, hit rate, ...)
+};
+
+static std::vector<BenchResult> results;
+
+static BenchResult& addResult(const std::string& name, const char* unit, const LatencyHistogram& histogram,
+                              double seconds) {
+    LatencyHistogram::Snapshot latency = histogram.snapshot();
+    results.push_back(BenchResult{name, unit, latency.count, latency, seconds, {}});
+    return results.back();
+}
+
+static uint64_t elapsedNs(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// Times op(i) for i in [0, ops); keeps it as one result
+template <typename Op>
+static BenchResult& measure(const std::string& name, size_t ops, Op op, const char* unit = "us") {
+    LatencyHistogram histogram;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        auto opStart = std::chrono::steady_clock::now();
+        op(i);
+        histogram.record(elapsedNs(opStart));
+    }
+    return addResult(name, unit, histogram, elapsedNs(start) / 1e9);
+}
+
+static int runs = 3;   // --runs=N
+
+// Best of `runs` passes of measure(), each after setup(): the fastest pass
+// is the one least disturbed by the rest of the machine
+template <typename Setup, typename Op>
+static BenchResult& measureBest(const std::string& name, size_t ops, Setup setup, Op op) {
+    for (int run = 0; run < runs; ++run) {
+        setup();
+        measure(name, ops, op);
+        if (run > 0) {
+            BenchResult latest = std::move(results.back());
+            results.pop_back();
+            if (latest.seconds < results.back().seconds) results.back() = std::move(latest);
+        }
+    }
+    return results.back();
+}
+
+static void printResult(const BenchResult& r) {
+    double scale = r.unit == "ms" ? 1e-6 : 1e-3;
+    std::cout << std::left << std::setw(34) << r.name << std::right << std::setw(7) << r.ops << std::fixed
+              << std::setprecision(1) << std::setw(11) << r.latency.mean() * scale << std::setw(11)
+              << r.latency.percentile(0.5) * scale << std::setw(11) << r.latency.percentile(0.99) * scale
+              << std::setw(11) << r.latency.max * scale << "  " << r.unit;
+    for (const auto& e : r.extra) std::cout << "  " << e.first << "=" << std::setprecision(3) << e.second;
+    std::cout << "\n";
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static bool writeJson(const std::string& path, const std::string& dataFile, double radiusKm, uint32_t seed,
+                      bool quick, int junctions, int roads) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\"benchmark\": \"traffic_bench\", \"schema\": 1, \"seed\": " << seed << ", \"quick\": "
+        << (quick ? "true" : "false") << ", \"runs\": " << runs << ",\n";
+    out << " \"dataset\": {\"file\": \"" << jsonEscape(dataFile) << "\", \"junctions\": " << junctions
+        << ", \"roads\": " << roads << ", \"radiusKm\": " << radiusKm << "},\n";
+    out << " \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        double scale = r.unit == "ms" ? 1e-6 : 1e-3;
+        std::string line;
+        line += "  {\"name\": \"" + r.name + "\", \"unit\": \"" + r.unit + "\", \"ops\": " + std::to_string(r.ops);
+        line += ", \"mean\": ";
+        Metrics::appendNumber(line, r.latency.mean() * scale);
+        line += ", \"p50\": ";
+        Metrics::appendNumber(line, r.latency.percentile(0.5) * scale);
+        line += ", \"p90\": ";
+        Metrics::appendNumber(line, r.latency.percentile(0.9) * scale);
+        line += ", \"p99\": ";
+        Metrics::appendNumber(line, r.latency.percentile(0.99) * scale);
+        line += ", \"max\": ";
+        Metrics::appendNumber(line, r.latency.max * scale);
+        line += ", \"opsPerSec\": ";
+        Metrics::appendNumber(line, r.seconds > 0 ? r.ops / r.seconds : 0);
+        for (const auto& e : r.extra) {
+            line += ", \"" + e.first + "\": ";
+            Metrics::appendNumber(line, e.second);
+        }
+        line += i + 1 < results.size() ? "},\n" : "}\n";
+        out << line;
+    }
+    out << " ]}\n";
+    return static_cast<bool>(out);
+}
+
+// ==================== BASELINE COMPARISON ====================
+
+// name -> p50 from a file written by writeJson (one result per line)
+static std::map<std::string, double> readBaseline(const std::string& path) {
+    std::map<std::string, double> p50s;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("{\"name\": \"");
+        size_t p50 = line.find("\"p50\": ");
+        if (name == std::string::npos || p50 == std::string::npos) continue;
+        name += 10;
+        p50s[line.substr(name, line.find('"', name) - name)] = std::atof(line.c_str() + p50 + 7);
+    }
+    return p50s;
+}
+
+static int compareWithBaseline(const std::string& path, double tolerancePct) {
+    std::map<std::string, double> baseline = readBaseline(path);
+    if (baseline.empty()) {
+        std::cerr << "❌ No results in baseline " << path << "\n";
+        return 1;
+    }
+    std::cout << "\n📊 p50 against " << path << " (tolerance " << tolerancePct << "%)\n";
+    int regressions = 0;
+    for (const BenchResult& r : results) {
+        auto old = baseline.find(r.name);
+        if (old == baseline.end() || old->second <= 0) continue;
+        double now = r.latency.percentile(0.5) * (r.unit == "ms" ? 1e-6 : 1e-3);
+        double change = (now - old->second) / old->second * 100.0;
+        bool slower = change > tolerancePct;
+        regressions += slower;
+        std::cout << (slower ? "  ❌ " : "  ✅ ") << std::left << std::setw(34) << r.name << std::right
+                  << std::fixed << std::setprecision(1) << std::setw(11) << old->second << " -> " << std::setw(11)
+                  << now << " " << r.unit << std::showpos << std::setw(9) << change << "%" << std::noshowpos << "\n";
+    }
+    std::cout << (regressions ? "\n❌ " : "\n✅ ") << regressions << " regression(s)\n";
+    return regressions ? 2 : 0;
+}
+
+// ==================== WORKLOADS ====================
+
+struct Workload {
+    std::mt19937 rng;
+    std::vector<Junction> junctions;
+    std::map<std::string, std::vector<int>> cities;    // city -> junction IDs
+    std::vector<std::string> routeCities;              // cities big enough for intra-city pairs
+    size_t scale;                                      // op counts are divided by this
+
+    explicit Workload(uint32_t seed) : rng(seed), scale(1) {}
+
+    size_t ops(size_t full) const { return std::max<size_t>(1, full / scale); }
+
+    // Distinct source/destination pairs with a route between them, in one
+    // city or between two (fewer if the network has too few)
+    std::vector<std::pair<int, int>> pairs(TrafficManager& tm, size_t count, bool intercity) {
+        std::set<std::pair<int, int>> seen;
+        std::vector<std::pair<int, int>> out;
+        for (size_t attempt = 0; out.size() < count && attempt < 1000 * count; ++attempt) {
+            const std::vector<int>& from = cities[routeCities[rng() % routeCities.size()]];
+            const std::vector<int>* to = &from;
+            if (intercity) {
+                while ((to = &cities[routeCities[rng() % routeCities.size()]]) == &from) {}
+            }
+            std::pair<int, int> pair(from[rng() % from.size()], (*to)[rng() % to->size()]);
+            if (pair.first != pair.second && seen.insert(pair).second &&
+                tm.findRoute(pair.first, pair.second).found) {
+                out.push_back(pair);
+            }
+        }
+        tm.invalidateCache();
+        return out;
+    }
+};
+
+struct AlgorithmName {
+    const char* name;
+    RouteAlgorithm algorithm;
+};
+
+static const AlgorithmName ALGORITHMS[] = {
+    {"ch", RouteAlgorithm::HIERARCHY},
+    {"dijkstra", RouteAlgorithm::DIJKSTRA},
+    {"astar", RouteAlgorithm::ASTAR},
+    {"bidijkstra", RouteAlgorithm::BIDIRECTIONAL},
+    {"biastar", RouteAlgorithm::BIDIRECTIONAL_ASTAR},
+};
+
+// One route workload; every query misses the cache
+template <typename Query>
+static void routeWorkload(TrafficManager& tm, const std::string& name, const std::vector<std::pair<int, int>>& pairs,
+                          Query query) {
+    size_t found = 0;
+    uint64_t settled = 0;
+    double totalTime = 0;
+    auto setup = [&]() {
+        tm.invalidateCache();
+        found = 0;
+        settled = 0;
+        totalTime = 0;
+    };
+    BenchResult& r = measureBest(name, pairs.size(), setup, [&](size_t i) {
+        RouteResult route = query(pairs[i].first, pairs[i].second);
+        found += route.found;
+        settled += route.settledNodes;
+        totalTime += route.totalTime;
+    });
+    r.extra.push_back({"found", static_cast<double>(found)});
+    r.extra.push_back({"settledMean", static_cast<double>(settled) / pairs.size()});
+    r.extra.push_back({"minutesSum", totalTime});   // changes only if routes change
+    printResult(r);
+}
+
+static void runRouteWorkloads(TrafficManager& tm, Workload& w) {
+    for (bool intercity : {false, true}) {
+        std::string scope = intercity ? "route.intercity." : "route.intra.";
+        size_t count = w.ops(intercity ? 100 : 300);
+        std::vector<std::pair<int, int>> pairs = w.pairs(tm, count, intercity);
+        if (pairs.empty()) {
+            std::cout << "⚠️  No connected " << scope << " pairs on this network\n";
+            continue;
+        }
+        // Plain Dijkstra (which settles most of the network between cities),
+        // alternatives and departure times get a quarter or a third of the pairs
+        const std::vector<std::pair<int, int>> quarter(pairs.begin(), pairs.begin() + std::max<size_t>(1, count / 4));
+        const std::vector<std::pair<int, int>> few(pairs.begin(), pairs.begin() + std::max<size_t>(1, count / 3));
+        for (const AlgorithmName& a : ALGORITHMS) {
+            const std::vector<std::pair<int, int>>& subset = a.algorithm == RouteAlgorithm::DIJKSTRA ? quarter : pairs;
+            routeWorkload(tm, scope + a.name + ".time", subset, [&](int s, int t) {
+                return tm.findRoute(s, t, true, a.algorithm);
+            });
+        }
+        routeWorkload(tm, scope + "ch.distance", pairs, [&](int s, int t) {
+            return tm.findRoute(s, t, false, RouteAlgorithm::HIERARCHY);
+        });
+        routeWorkload(tm, scope + "alternatives2", few, [&](int s, int t) {
+            return tm.findRoute(s, t, true, RouteAlgorithm::HIERARCHY, 2);
+        });
+        // Friday 17:30: inside the evening rush-hour profile
+        routeWorkload(tm, scope + "depart.fri1730", few, [&](int s, int t) {
+            return tm.findRouteDepartingAt(s, t, 4 * 1440 + 17 * 60 + 30);
+        });
+    }
+}
+
+static void runSearchWorkloads(TrafficManager& tm, Workload& w) {
+    std::vector<std::string> names, typos, prefixes;
+    for (size_t i = 0; i < w.ops(2000); ++i) {
+        const std::string& name = w.junctions[w.rng() % w.junctions.size()].name;
+        names.push_back(name);
+        prefixes.push_back(name.substr(0, std::min<size_t>(name.size(), 3 + w.rng() % 4)));
+        std::string typo = name;
+        if (typo.size() > 4) {
+            size_t at = 1 + w.rng() % (typo.size() - 2);
+            if (w.rng() % 2) typo.erase(at, 1); else std::swap(typo[at], typo[at + 1]);
+        }
+        typos.push_back(typo);
+    }
+
+    size_t hits = 0;
+    auto resetHits = [&]() { hits = 0; };
+    BenchResult& fuzzy = measureBest("search.fuzzy", w.ops(500), resetHits, [&](size_t i) {
+        hits += !tm.fuzzySearchJunctions(typos[i]).empty();
+    });
+    fuzzy.extra.push_back({"withResults", static_cast<double>(hits)});
+    printResult(fuzzy);
+
+    BenchResult& prefix = measureBest("search.prefix", prefixes.size(), resetHits, [&](size_t i) {
+        hits += tm.autocompleteJunctions(prefixes[i], 10).size();
+    });
+    prefix.extra.push_back({"results", static_cast<double>(hits)});
+    printResult(prefix);
+
+    BenchResult& exact = measureBest("search.exact_name", names.size(), resetHits, [&](size_t i) {
+        Junction junction;
+        hits += tm.getJunctionByName(names[i], &junction);
+    });
+    exact.extra.push_back({"found", static_cast<double>(hits)});
+    printResult(exact);
+}
+
+static uint64_t cacheHits(const TrafficManager& tm) {
+    uint64_t hits = 0;
+    for (const RouteCache::ShardStats& s : tm.getRouteCacheStats()) hits += s.hits;
+    return hits;
+}
+
+static void runTrafficWorkloads(TrafficManager& tm, Workload& w) {
+    size_t total = 0;
+    std::vector<int> roadIds = tm.pageRoadIds(0, static_cast<size_t>(-1), &total);
+    std::sort(roadIds.begin(), roadIds.end());
+    std::map<int, TrafficLevel> original;   // restored afterwards
+    std::vector<std::pair<int, int>> warm = w.pairs(tm, 48, false);   // fits the 100-route cache
+
+    for (size_t burst : {w.ops(100), w.ops(1000)}) {
+        tm.invalidateCache();
+        for (const auto& p : warm) tm.findRoute(p.first, p.second);
+
+        // Congestion building up: a road getting faster would drop every
+        // time-optimized route, so only per-road invalidation is exercised
+        static const TrafficLevel levels[] = {TrafficLevel::HEAVY, TrafficLevel::SEVERE};
+        std::vector<std::pair<int, TrafficLevel>> updates;
+        for (size_t i = 0; i < burst; ++i) {
+            int id = roadIds[w.rng() % roadIds.size()];
+            Road road;
+            if (original.find(id) == original.end() && tm.getRoad(id, &road)) original[id] = road.trafficLevel;
+            updates.push_back({id, levels[w.rng() % 2]});
+        }
+        BenchResult& r = measure("traffic.burst" + std::to_string(burst), burst, [&](size_t i) {
+            tm.updateTrafficLevel(updates[i].first, updates[i].second);
+        });
+
+        // How much of the warm cache the burst left valid
+        uint64_t hitsBefore = cacheHits(tm);
+        for (const auto& p : warm) tm.findRoute(p.first, p.second);
+        r.extra.push_back({"cacheSurvivors", static_cast<double>(cacheHits(tm) - hitsBefore) / warm.size()});
+        printResult(r);
+    }
+    for (const auto& [id, level] : original) tm.updateTrafficLevel(id, level);
+}
+
+static void runCacheWorkloads(TrafficManager& tm, Workload& w) {
+    for (int repeatPct : {90, 50}) {
+        std::vector<std::pair<int, int>> hot = w.pairs(tm, 48, false);
+        std::vector<std::pair<int, int>> cold = w.pairs(tm, w.ops(1000), false);
+
+        std::vector<std::pair<int, int>> stream;
+        size_t nextCold = 0;
+        for (size_t i = 0; i < w.ops(1000); ++i) {
+            stream.push_back(static_cast<int>(w.rng() % 100) < repeatPct || nextCold == cold.size()
+                                 ? hot[w.rng() % hot.size()] : cold[nextCold++]);
+        }
+
+        uint64_t hitsBefore = 0;
+        auto warm = [&]() {
+            tm.invalidateCache();
+            for (const auto& p : hot) tm.findRoute(p.first, p.second);
+            hitsBefore = cacheHits(tm);
+        };
+        BenchResult& r = measureBest("cache.mix" + std::to_string(repeatPct), stream.size(), warm, [&](size_t i) {
+            tm.findRoute(stream[i].first, stream[i].second);
+        });
+        r.extra.push_back({"hitRate", static_cast<double>(cacheHits(tm) - hitsBefore) / stream.size()});
+        printResult(r);
+    }
+}
+
+// ==================== MAIN ====================
+
+int main(int argc, char* argv[]) {
+    std::string dataFile = "data/pakistan_osm_junctions.json";
+    std::string jsonFile = "traffic_bench.json";
+    std::string baselineFile;
+    double radiusKm = 1.0;
+    double tolerancePct = 15.0;
+    const uint32_t seed = 42;   // fixed: every run asks the same queries
+    Workload w(seed);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--radius=", 0) == 0) radiusKm = std::atof(arg.c_str() + 9);
+        else if (arg == "--quick") w.scale = 5;
+        else if (arg.rfind("--runs=", 0) == 0) runs = std::max(1, std::atoi(arg.c_str() + 7));
+        else if (arg.rfind("--json=", 0) == 0) jsonFile = arg.substr(7);
+        else if (arg.rfind("--compare=", 0) == 0) baselineFile = arg.substr(10);
+        else if (arg.rfind("--tolerance=", 0) == 0) tolerancePct = std::atof(arg.c_str() + 12);
+        else dataFile = arg;
+    }
+
+    SnapshotSource source;
+    if (!SnapshotSource::describe(dataFile, radiusKm, &source)) {
+        std::cerr << "❌ " << dataFile << " not found (run from the repository root or pass its path)\n";
+        return 1;
+    }
+    const std::string snapshotFile = jsonFile + ".snap";
+
+    std::cout << "📊 traffic_bench: " << dataFile << ", " << radiusKm << " km roads, seed " << seed
+              << (w.scale > 1 ? ", quick" : "") << "\n\n";
+
+    // Startup: everything a first start does, then snapshot starts
+    {
+        TrafficManager cold(100);
+        OSMLoader loader(cold);
+        measure("load.junctions_json", 1, [&](size_t) { loader.loadJunctions(dataFile); }, "ms");
+        measure("load.road_generation", 1, [&](size_t) { loader.generateRoadNetwork(radiusKm); }, "ms");
+        measure("load.freeze", 1, [&](size_t) {
+            cold.freezeRoadNetwork();
+            cold.applyDefaultTrafficProfiles();
+        }, "ms");
+        measure("load.snapshot_save", 1, [&](size_t) { cold.saveSnapshot(snapshotFile, source); }, "ms");
+    }
+
+    // Three snapshot starts; the last one is the network the queries run on
+    TrafficManager tm(100);   // the server's route cache size
+    LatencyHistogram snapshotLoads;
+    double snapshotSeconds = 0;
+    for (int pass = 0; pass < 3; ++pass) {
+        std::unique_ptr<TrafficManager> probe(pass < 2 ? new TrafficManager(100) : nullptr);
+        auto start = std::chrono::steady_clock::now();
+        bool loaded = (probe ? *probe : tm).loadSnapshot(snapshotFile, source);
+        uint64_t ns = elapsedNs(start);
+        snapshotLoads.record(ns);
+        snapshotSeconds += ns / 1e9;
+        if (!loaded) {
+            std::cerr << "❌ Snapshot did not load\n";
+            return 1;
+        }
+    }
+    addResult("load.snapshot_load", "ms", snapshotLoads, snapshotSeconds);
+    std::remove(snapshotFile.c_str());
+    measure("load.route_hierarchy", 1, [&](size_t) { tm.prepareRouteHierarchy(); }, "ms");
+    int junctionCount = tm.getJunctionCount();
+    int roadCount = tm.getRoadCount();
+
+    w.junctions = tm.getAllJunctions();
+    std::sort(w.junctions.begin(), w.junctions.end(),
+              [](const Junction& a, const Junction& b) { return a.id < b.id; });   // table order may vary
+    for (const Junction& j : w.junctions) w.cities[j.city].push_back(j.id);
+    for (const auto& [city, ids] : w.cities) {
+        if (ids.size() >= 20) w.routeCities.push_back(city);
+    }
+    if (w.routeCities.size() < 2) {
+        std::cerr << "❌ Need at least two cities with 20 junctions\n";
+        return 1;
+    }
+
+    std::cout << "\n" << std::left << std::setw(34) << "workload" << std::right << std::setw(7) << "ops"
+              << std::setw(11) << "mean" << std::setw(11) << "p50" << std::setw(11) << "p99" << std::setw(11)
+              << "max" << "\n";
+    for (const BenchResult& r : results) printResult(r);   // startup, logged over by the loaders
+    runRouteWorkloads(tm, w);
+    runSearchWorkloads(tm, w);
+    runTrafficWorkloads(tm, w);
+    runCacheWorkloads(tm, w);
+
+    if (!writeJson(jsonFile, dataFile, radiusKm, seed, w.scale > 1, junctionCount, roadCount)) {
+        std::cerr << "❌ Could not write " << jsonFile << "\n";
+        return 1;
+    }
+    std::cout << "\n✅ " << results.size() << " results written to " << jsonFile << "\n";
+    return baselineFile.empty() ? 0 : compareWithBaseline(baselineFile, tolerancePct);
+}
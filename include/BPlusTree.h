@@ -0,0 +1,594 @@
+/**
+ * Smart Traffic Route Optimizer
+ * B+Tree Data Structure Implementation
+ *
+ * Ordered index with the BTree interface, laid out for the cache: all
+ * entries live in the leaves, which are chained for sequential range and
+ * prefix scans, and inner nodes only route. Every node has room for
+ * MAX_KEYS keys in fixed arrays, so a node is one allocation and the keys
+ * a search compares are contiguous NODE_BYTES of memory. String keys keep
+ * a parallel array of 8-byte big-endian key heads: a search binary
+ * searches the heads as integers and compares whole strings only among
+ * keys sharing their first 8 bytes. The element count is maintained.
+ * Time Complexity: O(log n) search, insert, remove; O(log n + k) scans
+ */
+
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+template <typename K, typename V, size_t NODE_BYTES = 256>
+class BPlusTree {
+private:
+    static constexpr bool STRING_KEYS = std::is_same_v<K, std::string>;
+    // Bytes a search reads per key: the key head for strings, else the key
+    static constexpr size_t SEARCH_KEY_BYTES = STRING_KEYS ? sizeof(uint64_t) : sizeof(K);
+
+public:
+    static constexpr int MAX_KEYS = static_cast<int>(std::max<size_t>(4, NODE_BYTES / SEARCH_KEY_BYTES));
+    static constexpr int MIN_KEYS = MAX_KEYS / 2;
+
+private:
+    static constexpr int HEAD_SLOTS = STRING_KEYS ? MAX_KEYS + 1 : 1;
+
+    // One spare slot in each array: a node overflows by one key, then splits
+    struct Node {
+        bool isLeaf;
+        int count;                    // keys in use
+        uint64_t heads[HEAD_SLOTS];   // string keys only: headOf(keys[i])
+        K keys[MAX_KEYS + 1];
+        explicit Node(bool leaf) : isLeaf(leaf), count(0) {}
+    };
+
+    // children[i] holds keys < keys[i] <= keys in children[i + 1]
+    struct Inner : Node {
+        Node* children[MAX_KEYS + 2];
+        Inner() : Node(false) {}
+    };
+
+    struct Leaf : Node {
+        V values[MAX_KEYS + 1];
+        Leaf* prev;
+        Leaf* next;
+        Leaf() : Node(true), prev(nullptr), next(nullptr) {}
+    };
+
+    Node* root;
+    size_t numElements;
+    int height;
+
+    // First 8 bytes, big-endian and zero-padded: orders like the strings
+    static uint64_t headOf(const K& key) {
+        if constexpr (STRING_KEYS) {
+            uint64_t head = 0;
+            size_t n = std::min<size_t>(key.size(), 8);
+            for (size_t i = 0; i < n; ++i) {
+                head |= static_cast<uint64_t>(static_cast<unsigned char>(key[i])) << (56 - 8 * i);
+            }
+            return head;
+        } else {
+            return 0;
+        }
+    }
+
+    static void setKey(Node* node, int i, K key) {
+        if constexpr (STRING_KEYS) node->heads[i] = headOf(key);
+        node->keys[i] = std::move(key);
+    }
+
+    // Index of the first key >= key in node
+    static int lowerBound(const Node* node, const K& key) {
+        int lo = 0, hi = node->count;
+        if constexpr (STRING_KEYS) {
+            uint64_t head = headOf(key);
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (node->heads[mid] < head) lo = mid + 1; else hi = mid;
+            }
+            // Whole-string compares only across the run of equal heads
+            hi = lo;
+            while (hi < node->count && node->heads[hi] == head) ++hi;
+        }
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (node->keys[mid] < key) lo = mid + 1; else hi = mid;
+        }
+        return lo;
+    }
+
+    static bool keyAt(const Node* node, int i, const K& key) {
+        return i < node->count && node->keys[i] == key;
+    }
+
+    // Child of inner that holds key
+    static int childIndex(const Inner* inner, const K& key) {
+        int i = lowerBound(inner, key);
+        return keyAt(inner, i, key) ? i + 1 : i;
+    }
+
+    const Leaf* leafFor(const K& key) const {
+        const Node* node = root;
+        if (node == nullptr) return nullptr;
+        while (!node->isLeaf) {
+            const Inner* inner = static_cast<const Inner*>(node);
+            node = inner->children[childIndex(inner, key)];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    const Leaf* firstLeaf() const {
+        const Node* node = root;
+        if (node == nullptr) return nullptr;
+        while (!node->isLeaf) node = static_cast<const Inner*>(node)->children[0];
+        return static_cast<const Leaf*>(node);
+    }
+
+    // Visit entries from the first key >= from in order until visit returns false
+    template <typename Visit>
+    void scanFrom(const K& from, Visit visit) const {
+        const Leaf* leaf = leafFor(from);
+        if (leaf == nullptr) return;
+        int i = lowerBound(leaf, from);
+        for (; leaf != nullptr; leaf = leaf->next, i = 0) {
+            for (; i < leaf->count; ++i) {
+                if (!visit(leaf->keys[i], leaf->values[i])) return;
+            }
+        }
+    }
+
+    // ---- Slot moves; ranges may overlap only when moving left (d < s) ----
+
+    static void moveKeys(Node* dst, int d, Node* src, int s, int n) {
+        if constexpr (STRING_KEYS) std::copy(src->heads + s, src->heads + s + n, dst->heads + d);
+        std::move(src->keys + s, src->keys + s + n, dst->keys + d);
+    }
+
+    static void moveValues(Leaf* dst, int d, Leaf* src, int s, int n) {
+        std::move(src->values + s, src->values + s + n, dst->values + d);
+    }
+
+    static void moveChildren(Inner* dst, int d, Inner* src, int s, int n) {
+        std::copy(src->children + s, src->children + s + n, dst->children + d);
+    }
+
+    // Open a gap at key slot pos; the caller fills it and bumps count
+    static void openKeySlot(Node* node, int pos) {
+        if constexpr (STRING_KEYS) {
+            std::copy_backward(node->heads + pos, node->heads + node->count, node->heads + node->count + 1);
+        }
+        std::move_backward(node->keys + pos, node->keys + node->count, node->keys + node->count + 1);
+    }
+
+    static void insertAt(Leaf* leaf, int pos, K key, V value) {
+        openKeySlot(leaf, pos);
+        std::move_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+        setKey(leaf, pos, std::move(key));
+        leaf->values[pos] = std::move(value);
+        ++leaf->count;
+    }
+
+    // Separator key at pos with child right of it at pos + 1
+    static void insertAt(Inner* inner, int pos, K key, Node* child) {
+        openKeySlot(inner, pos);
+        std::copy_backward(inner->children + pos + 1, inner->children + inner->count + 1,
+                           inner->children + inner->count + 2);
+        setKey(inner, pos, std::move(key));
+        inner->children[pos + 1] = child;
+        ++inner->count;
+    }
+
+    static void eraseAt(Leaf* leaf, int pos) {
+        moveKeys(leaf, pos, leaf, pos + 1, leaf->count - pos - 1);
+        moveValues(leaf, pos, leaf, pos + 1, leaf->count - pos - 1);
+        --leaf->count;
+        leaf->values[leaf->count] = V();   // release what the vacated slot held
+    }
+
+    // Drop key pos and the child right of it
+    static void eraseAt(Inner* inner, int pos) {
+        moveKeys(inner, pos, inner, pos + 1, inner->count - pos - 1);
+        moveChildren(inner, pos + 1, inner, pos + 2, inner->count - pos - 1);
+        --inner->count;
+    }
+
+    // ---- Node lifetime ----
+
+    static void deleteNode(Node* node) {
+        if (node->isLeaf) delete static_cast<Leaf*>(node);
+        else delete static_cast<Inner*>(node);
+    }
+
+    static void destroy(Node* node) {
+        if (node == nullptr) return;
+        if (!node->isLeaf) {
+            Inner* inner = static_cast<Inner*>(node);
+            for (int i = 0; i <= inner->count; ++i) destroy(inner->children[i]);
+        }
+        deleteNode(node);
+    }
+
+    // ---- Insert ----
+
+    Node* splitLeaf(Leaf* leaf, K* separator) {
+        Leaf* right = new Leaf();
+        int keep = leaf->count / 2;
+        int moved = leaf->count - keep;
+        moveKeys(right, 0, leaf, keep, moved);
+        moveValues(right, 0, leaf, keep, moved);
+        right->count = moved;
+        leaf->count = keep;
+
+        right->next = leaf->next;
+        if (right->next) right->next->prev = right;
+        right->prev = leaf;
+        leaf->next = right;
+        *separator = right->keys[0];
+        return right;
+    }
+
+    Node* splitInner(Inner* inner, K* separator) {
+        Inner* right = new Inner();
+        int mid = inner->count / 2;
+        int moved = inner->count - mid - 1;
+        moveKeys(right, 0, inner, mid + 1, moved);
+        moveChildren(right, 0, inner, mid + 1, moved + 1);
+        right->count = moved;
+        *separator = std::move(inner->keys[mid]);
+        inner->count = mid;
+        return right;
+    }
+
+    // Insert or update under node; returns the new right sibling if node
+    // split, with its smallest key in *separator
+    Node* insertInto(Node* node, const K& key, const V& value, K* separator) {
+        if (node->isLeaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            int pos = lowerBound(leaf, key);
+            if (keyAt(leaf, pos, key)) {
+                leaf->values[pos] = value;
+                return nullptr;
+            }
+            insertAt(leaf, pos, key, value);
+            ++numElements;
+            return leaf->count > MAX_KEYS ? splitLeaf(leaf, separator) : nullptr;
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        int i = childIndex(inner, key);
+        K childSeparator;
+        Node* split = insertInto(inner->children[i], key, value, &childSeparator);
+        if (split == nullptr) return nullptr;
+        insertAt(inner, i, std::move(childSeparator), split);
+        return inner->count > MAX_KEYS ? splitInner(inner, separator) : nullptr;
+    }
+
+    // ---- Remove ----
+
+    void borrowFromLeft(Inner* parent, int i) {
+        Node* child = parent->children[i];
+        Node* left = parent->children[i - 1];
+        if (child->isLeaf) {
+            Leaf* c = static_cast<Leaf*>(child);
+            Leaf* l = static_cast<Leaf*>(left);
+            insertAt(c, 0, l->keys[l->count - 1], std::move(l->values[l->count - 1]));
+            eraseAt(l, l->count - 1);
+            setKey(parent, i - 1, c->keys[0]);
+        } else {
+            Inner* c = static_cast<Inner*>(child);
+            Inner* l = static_cast<Inner*>(left);
+            openKeySlot(c, 0);
+            std::copy_backward(c->children, c->children + c->count + 1, c->children + c->count + 2);
+            setKey(c, 0, std::move(parent->keys[i - 1]));
+            c->children[0] = l->children[l->count];
+            ++c->count;
+            setKey(parent, i - 1, std::move(l->keys[l->count - 1]));
+            --l->count;
+        }
+    }
+
+    void borrowFromRight(Inner* parent, int i) {
+        Node* child = parent->children[i];
+        Node* right = parent->children[i + 1];
+        if (child->isLeaf) {
+            Leaf* c = static_cast<Leaf*>(child);
+            Leaf* r = static_cast<Leaf*>(right);
+            insertAt(c, c->count, r->keys[0], std::move(r->values[0]));
+            eraseAt(r, 0);
+            setKey(parent, i, r->keys[0]);
+        } else {
+            Inner* c = static_cast<Inner*>(child);
+            Inner* r = static_cast<Inner*>(right);
+            setKey(c, c->count, std::move(parent->keys[i]));
+            c->children[c->count + 1] = r->children[0];
+            ++c->count;
+            setKey(parent, i, std::move(r->keys[0]));
+            moveKeys(r, 0, r, 1, r->count - 1);
+            moveChildren(r, 0, r, 1, r->count);
+            --r->count;
+        }
+    }
+
+    // Fold children[i + 1] into children[i]
+    void merge(Inner* parent, int i) {
+        Node* left = parent->children[i];
+        Node* right = parent->children[i + 1];
+        if (left->isLeaf) {
+            Leaf* l = static_cast<Leaf*>(left);
+            Leaf* r = static_cast<Leaf*>(right);
+            moveKeys(l, l->count, r, 0, r->count);
+            moveValues(l, l->count, r, 0, r->count);
+            l->count += r->count;
+            l->next = r->next;
+            if (l->next) l->next->prev = l;
+        } else {
+            Inner* l = static_cast<Inner*>(left);
+            Inner* r = static_cast<Inner*>(right);
+            setKey(l, l->count, std::move(parent->keys[i]));
+            moveKeys(l, l->count + 1, r, 0, r->count);
+            moveChildren(l, l->count + 1, r, 0, r->count + 1);
+            l->count += r->count + 1;
+        }
+        deleteNode(right);
+        eraseAt(parent, i);
+    }
+
+    // Bring children[i] back to MIN_KEYS keys from a sibling, or merge it
+    void rebalance(Inner* parent, int i) {
+        if (i > 0 && parent->children[i - 1]->count > MIN_KEYS) {
+            borrowFromLeft(parent, i);
+        } else if (i < parent->count && parent->children[i + 1]->count > MIN_KEYS) {
+            borrowFromRight(parent, i);
+        } else {
+            merge(parent, i > 0 ? i - 1 : i);
+        }
+    }
+
+    bool removeFrom(Node* node, const K& key) {
+        if (node->isLeaf) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            int pos = lowerBound(leaf, key);
+            if (!keyAt(leaf, pos, key)) return false;
+            eraseAt(leaf, pos);
+            return true;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        int i = childIndex(inner, key);
+        if (!removeFrom(inner->children[i], key)) return false;
+        if (inner->children[i]->count < MIN_KEYS) rebalance(inner, i);
+        return true;
+    }
+
+    int countNodesHelper(const Node* node) const {
+        if (node->isLeaf) return 1;
+        const Inner* inner = static_cast<const Inner*>(node);
+        int count = 1;
+        for (int i = 0; i <= inner->count; ++i) count += countNodesHelper(inner->children[i]);
+        return count;
+    }
+
+public:
+    BPlusTree() : root(nullptr), numElements(0), height(0) {}
+
+    ~BPlusTree() {
+        destroy(root);
+    }
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Visit every entry in key order
+    void traverse(std::function<void(const K&, const V&)> callback) const {
+        for (const Leaf* leaf = firstLeaf(); leaf != nullptr; leaf = leaf->next) {
+            for (int i = 0; i < leaf->count; ++i) callback(leaf->keys[i], leaf->values[i]);
+        }
+    }
+
+    // Search a key in the tree
+    bool search(const K& k, V* result = nullptr) const {
+        const V* value = find(k);
+        if (value && result) *result = *value;
+        return value != nullptr;
+    }
+
+    // Pointer to the stored value, or nullptr - no copy; valid until the
+    // next insert or remove
+    const V* find(const K& k) const {
+        const Leaf* leaf = leafFor(k);
+        if (leaf == nullptr) return nullptr;
+        int i = lowerBound(leaf, k);
+        return keyAt(leaf, i, k) ? &leaf->values[i] : nullptr;
+    }
+
+    V* find(const K& k) {
+        return const_cast<V*>(static_cast<const BPlusTree*>(this)->find(k));
+    }
+
+    // Insert or update a key-value pair - O(log n)
+    void insert(const K& k, const V& v) {
+        if (root == nullptr) {
+            Leaf* leaf = new Leaf();
+            insertAt(leaf, 0, k, v);
+            root = leaf;
+            numElements = 1;
+            height = 1;
+            return;
+        }
+        K separator;
+        Node* split = insertInto(root, k, v, &separator);
+        if (split != nullptr) {
+            Inner* newRoot = new Inner();
+            newRoot->children[0] = root;
+            newRoot->children[1] = split;
+            setKey(newRoot, 0, std::move(separator));
+            newRoot->count = 1;
+            root = newRoot;
+            ++height;
+        }
+    }
+
+    /**
+     * Replace the contents with items, which must be sorted by strictly
+     * increasing key. Leaves are packed full and chained in one pass, then
+     * each inner level is built over the one below.
+     * @return false (tree unchanged) if items are not sorted
+     * Time Complexity: O(n)
+     */
+    bool bulkLoad(std::vector<std::pair<K, V>> items) {
+        for (size_t i = 1; i < items.size(); ++i) {
+            if (!(items[i - 1].first < items[i].first)) return false;
+        }
+        clear();
+        if (items.empty()) return true;
+
+        // Spreading entries evenly keeps every node at or above MIN_KEYS
+        std::vector<Node*> level;
+        std::vector<K> lowestKeys;   // smallest key under each node of level
+        size_t numLeaves = (items.size() + MAX_KEYS - 1) / MAX_KEYS;
+        level.reserve(numLeaves);
+        lowestKeys.reserve(numLeaves);
+        Leaf* previous = nullptr;
+        for (size_t i = 0, next = 0; i < numLeaves; ++i) {
+            int n = static_cast<int>(items.size() / numLeaves + (i < items.size() % numLeaves ? 1 : 0));
+            Leaf* leaf = new Leaf();
+            for (int k = 0; k < n; ++k, ++next) {
+                setKey(leaf, k, std::move(items[next].first));
+                leaf->values[k] = std::move(items[next].second);
+            }
+            leaf->count = n;
+            leaf->prev = previous;
+            if (previous) previous->next = leaf;
+            previous = leaf;
+            lowestKeys.push_back(leaf->keys[0]);
+            level.push_back(leaf);
+        }
+        height = 1;
+
+        const size_t fanout = MAX_KEYS + 1;
+        while (level.size() > 1) {
+            size_t numNodes = (level.size() + fanout - 1) / fanout;
+            std::vector<Node*> above;
+            std::vector<K> aboveLowest;
+            above.reserve(numNodes);
+            aboveLowest.reserve(numNodes);
+            for (size_t i = 0, child = 0; i < numNodes; ++i) {
+                int n = static_cast<int>(level.size() / numNodes + (i < level.size() % numNodes ? 1 : 0));
+                Inner* inner = new Inner();
+                for (int c = 0; c < n; ++c) {
+                    inner->children[c] = level[child + c];
+                    if (c > 0) setKey(inner, c - 1, std::move(lowestKeys[child + c]));
+                }
+                inner->count = n - 1;
+                aboveLowest.push_back(std::move(lowestKeys[child]));
+                above.push_back(inner);
+                child += n;
+            }
+            level = std::move(above);
+            lowestKeys = std::move(aboveLowest);
+            ++height;
+        }
+        root = level[0];
+        numElements = items.size();
+        return true;
+    }
+
+    // Remove a key - O(log n)
+    bool remove(const K& k) {
+        if (root == nullptr || !removeFrom(root, k)) return false;
+        --numElements;
+        if (root->count == 0) {
+            Node* old = root;
+            root = root->isLeaf ? nullptr : static_cast<Inner*>(root)->children[0];
+            --height;
+            deleteNode(old);
+        }
+        return true;
+    }
+
+    void clear() {
+        destroy(root);
+        root = nullptr;
+        numElements = 0;
+        height = 0;
+    }
+
+    // Check if tree is empty
+    bool isEmpty() const { return root == nullptr; }
+
+    // Get count of elements - O(1)
+    size_t size() const { return numElements; }
+
+    // Get all key-value pairs as vector
+    std::vector<std::pair<K, V>> getAll() const {
+        std::vector<std::pair<K, V>> result;
+        result.reserve(numElements);
+        traverse([&result](const K& key, const V& value) {
+            result.push_back({key, value});
+        });
+        return result;
+    }
+
+    // ============ METRICS ============
+    struct BPlusTreeMetrics {
+        int height;
+        int nodeCount;
+        int elementCount;
+        double avgKeysPerLeaf;
+        int maxKeysPerNode;
+        size_t memoryBytes;
+    };
+
+    BPlusTreeMetrics getMetrics() const {
+        BPlusTreeMetrics m;
+        m.elementCount = static_cast<int>(numElements);
+        m.height = height;
+        m.nodeCount = countNodes();
+        m.maxKeysPerNode = MAX_KEYS;
+        int leaves = 0, inner = m.nodeCount;
+        for (const Leaf* leaf = firstLeaf(); leaf != nullptr; leaf = leaf->next) ++leaves;
+        inner -= leaves;
+        m.avgKeysPerLeaf = leaves > 0 ? static_cast<double>(numElements) / leaves : 0;
+        m.memoryBytes = leaves * sizeof(Leaf) + inner * sizeof(Inner);
+        return m;
+    }
+
+    int getHeight() const { return height; }
+
+    int countNodes() const {
+        return root ? countNodesHelper(root) : 0;
+    }
+
+    // ============ RANGE QUERY ============
+    // Entries with minKey <= key <= maxKey, in key order
+    std::vector<std::pair<K, V>> rangeQuery(const K& minKey, const K& maxKey) const {
+        std::vector<std::pair<K, V>> results;
+        scanFrom(minKey, [&](const K& key, const V& value) {
+            if (maxKey < key) return false;
+            results.push_back({key, value});
+            return true;
+        });
+        return results;
+    }
+
+    // ============ PREFIX SEARCH ============
+    // String keys starting with prefix, in key order; at most limit of them
+    std::vector<std::pair<K, V>> prefixSearch(const K& prefix, size_t limit = SIZE_MAX) const {
+        std::vector<std::pair<K, V>> results;
+        if constexpr (STRING_KEYS) {
+            scanFrom(prefix, [&](const K& key, const V& value) {
+                if (results.size() >= limit || key.compare(0, prefix.size(), prefix) != 0) return false;
+                results.push_back({key, value});
+                return true;
+            });
+        }
+        return results;
+    }
+};
+
+#endif // BPLUSTREE_H
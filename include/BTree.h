@@ -92,9 +92,33 @@ public:
         return root->search(k, result) != nullptr;
     }
 
+    // Pointer to the stored value, or nullptr - no copy
+    const V* find(const K& k) const {
+        const BTreeNode<K, V>* node = root;
+        while (node != nullptr) {
+            int i = node->findKey(k);
+            if (i < static_cast<int>(node->keys.size()) && node->keys[i] == k) return &node->values[i];
+            node = node->isLeaf ? nullptr : node->children[i];
+        }
+        return nullptr;
+    }
+
+    V* find(const K& k) {
+        return const_cast<V*>(static_cast<const BTree*>(this)->find(k));
+    }
+
     // Insert a new key-value pair
     void insert(const K& k, const V& v);
 
+    /**
+     * Replace the contents with items, which must be sorted by strictly
+     * increasing key. Built bottom-up a level at a time with nodes packed
+     * nearly full, so the tree is denser than one grown by insert().
+     * @return false (tree unchanged) if items are not sorted
+     * Time Complexity: O(n)
+     */
+    bool bulkLoad(std::vector<std::pair<K, V>> items);
+
     // Remove a key
     void remove(const K& k);
 
@@ -298,6 +322,57 @@ void BTree<K, V>::insert(const K& k, const V& v) {
     }
 }
 
+template <typename K, typename V>
+bool BTree<K, V>::bulkLoad(std::vector<std::pair<K, V>> items) {
+    for (size_t i = 1; i < items.size(); ++i) {
+        if (!(items[i - 1].first < items[i].first)) return false;
+    }
+    delete root;
+    root = nullptr;
+    if (items.empty()) return true;
+
+    // Each level splits its keys into the fewest nodes of at most maxKeys
+    // keys; the key between two neighbours moves up as their separator.
+    // Spreading the keys evenly keeps every node above the t - 1 minimum.
+    const size_t maxKeys = 2 * minDegree - 1;
+    std::vector<BTreeNode<K, V>*> below;   // previous level: items.size() + 1 nodes
+    bool leaf = true;
+    for (;;) {
+        size_t count = (items.size() + 1 + maxKeys) / (maxKeys + 1);
+        size_t kept = items.size() - (count - 1);
+        std::vector<BTreeNode<K, V>*> level;
+        std::vector<std::pair<K, V>> separators;
+        level.reserve(count);
+        separators.reserve(count - 1);
+
+        size_t next = 0, child = 0;
+        for (size_t i = 0; i < count; ++i) {
+            size_t numKeys = kept / count + (i < kept % count ? 1 : 0);
+            BTreeNode<K, V>* node = new BTreeNode<K, V>(minDegree, leaf);
+            node->keys.reserve(numKeys);
+            node->values.reserve(numKeys);
+            for (size_t k = 0; k < numKeys; ++k, ++next) {
+                node->keys.push_back(std::move(items[next].first));
+                node->values.push_back(std::move(items[next].second));
+            }
+            if (!leaf) {
+                node->children.assign(below.begin() + child, below.begin() + child + numKeys + 1);
+                child += numKeys + 1;
+            }
+            level.push_back(node);
+            if (i + 1 < count) separators.push_back(std::move(items[next++]));
+        }
+
+        if (count == 1) {
+            root = level[0];
+            return true;
+        }
+        items = std::move(separators);
+        below = std::move(level);
+        leaf = false;
+    }
+}
+
 template <typename K, typename V>
 void BTreeNode<K, V>::insertNonFull(const K& k, const V& v) {
     int i = keys.size() - 1;
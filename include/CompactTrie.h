@@ -0,0 +1,223 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Compact Trie (Autocomplete) Implementation
+ *
+ * Read-mostly radix trie from normalized names to junction IDs, stored
+ * in flat arrays: nodes with contiguous children, edge labels in one
+ * character pool, and a precomputed top-k list per node. Completing a
+ * prefix walks |prefix| characters and copies the node's top-k list.
+ * Keys added after the build go to a small pending list that is merged
+ * by an amortized rebuild.
+ * Ranking: shorter names first, then alphabetical, then by ID.
+ * Time Complexity: O(n log n) build, O(|prefix| + k) per completion
+ */
+
+#ifndef COMPACTTRIE_H
+#define COMPACTTRIE_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+class CompactTrie {
+public:
+    static constexpr size_t TOP_K = 20;   // completions precomputed per node
+
+private:
+    static constexpr size_t MIN_PENDING_REBUILD = 64;
+
+    struct Entry {
+        std::string key;
+        int id;
+    };
+
+    struct Node {
+        uint32_t labelBegin;    // edge label from the parent, in labels
+        uint32_t labelLength;
+        uint32_t firstChild;    // children are contiguous and sorted by first label char
+        uint32_t childCount;
+        uint32_t topBegin;      // best completions below this node, in topEntries
+        uint32_t topCount;
+    };
+
+    std::vector<Entry> entries;         // all keys; [0, built) are in the trie
+    size_t built;
+    std::vector<Node> nodes;            // nodes[0] is the root
+    std::string labels;
+    std::vector<uint32_t> topEntries;   // entry indices, best first
+
+    bool ranksBefore(uint32_t a, uint32_t b) const {
+        const Entry& x = entries[a];
+        const Entry& y = entries[b];
+        if (x.key.size() != y.key.size()) return x.key.size() < y.key.size();
+        if (x.key != y.key) return x.key < y.key;
+        return x.id < y.id;
+    }
+
+    // Fill node for the sorted entry range [lo, hi) sharing the first depth chars
+    void buildNode(uint32_t nodeIndex, const std::vector<uint32_t>& sorted,
+                   size_t lo, size_t hi, size_t depth) {
+        std::vector<uint32_t> candidates;
+
+        // Keys ending here sort first
+        size_t i = lo;
+        while (i < hi && entries[sorted[i]].key.size() == depth) {
+            candidates.push_back(sorted[i++]);
+        }
+
+        // One child per distinct next character; its label is the group's common prefix
+        std::vector<std::pair<size_t, size_t>> groups;
+        while (i < hi) {
+            char c = entries[sorted[i]].key[depth];
+            size_t j = i + 1;
+            while (j < hi && entries[sorted[j]].key[depth] == c) ++j;
+            groups.push_back({i, j});
+            i = j;
+        }
+
+        uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+        nodes[nodeIndex].firstChild = firstChild;
+        nodes[nodeIndex].childCount = static_cast<uint32_t>(groups.size());
+        nodes.resize(nodes.size() + groups.size());
+
+        for (size_t g = 0; g < groups.size(); ++g) {
+            // Sorted range: the common prefix of first and last is common to all
+            const std::string& first = entries[sorted[groups[g].first]].key;
+            const std::string& last = entries[sorted[groups[g].second - 1]].key;
+            size_t end = depth + 1;
+            while (end < first.size() && end < last.size() && first[end] == last[end]) ++end;
+
+            uint32_t child = firstChild + static_cast<uint32_t>(g);
+            nodes[child].labelBegin = static_cast<uint32_t>(labels.size());
+            nodes[child].labelLength = static_cast<uint32_t>(end - depth);
+            labels.append(first, depth, end - depth);
+
+            buildNode(child, sorted, groups[g].first, groups[g].second, end);
+
+            const Node& childNode = nodes[child];
+            candidates.insert(candidates.end(), topEntries.begin() + childNode.topBegin,
+                              topEntries.begin() + childNode.topBegin + childNode.topCount);
+        }
+
+        // Top-k of the subtree = best of the terminal keys and the children's top-k
+        size_t count = std::min(TOP_K, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                          [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); });
+        nodes[nodeIndex].topBegin = static_cast<uint32_t>(topEntries.size());
+        nodes[nodeIndex].topCount = static_cast<uint32_t>(count);
+        topEntries.insert(topEntries.end(), candidates.begin(), candidates.begin() + count);
+    }
+
+    // Node whose subtree holds exactly the keys starting with prefix, or -1
+    int64_t findNode(const std::string& prefix) const {
+        if (nodes.empty()) return -1;
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < prefix.size()) {
+            const Node& current = nodes[node];
+            const Node* begin = nodes.data() + current.firstChild;
+            const Node* end = begin + current.childCount;
+            // Children are ordered like std::string compares: by unsigned char
+            unsigned char next = static_cast<unsigned char>(prefix[pos]);
+            const Node* child = std::lower_bound(begin, end, next,
+                [this](const Node& n, unsigned char c) {
+                    return static_cast<unsigned char>(labels[n.labelBegin]) < c;
+                });
+            if (child == end || labels[child->labelBegin] != prefix[pos]) return -1;
+
+            size_t length = std::min<size_t>(child->labelLength, prefix.size() - pos);
+            if (labels.compare(child->labelBegin, length, prefix, pos, length) != 0) return -1;
+            pos += length;
+            node = static_cast<uint32_t>(child - nodes.data());
+        }
+        return node;
+    }
+
+public:
+    CompactTrie() : built(0) {}
+
+    // Add a normalized key; the trie is rebuilt when pending reaches a quarter of it
+    void insert(const std::string& key, int id) {
+        entries.push_back({key, id});
+        if (entries.size() - built >= std::max(MIN_PENDING_REBUILD, built / 4)) {
+            rebuild();
+        }
+    }
+
+    // Add many normalized keys with at most one rebuild (same rule as insert)
+    void insertMany(const std::vector<std::pair<std::string, int>>& keys) {
+        for (const auto& key : keys) {
+            entries.push_back({key.first, key.second});
+        }
+        if (entries.size() - built >= std::max(MIN_PENDING_REBUILD, built / 4)) {
+            rebuild();
+        }
+    }
+
+    // Fold pending keys into the trie - O(n log n)
+    void rebuild() {
+        std::vector<uint32_t> sorted(entries.size());
+        for (size_t i = 0; i < sorted.size(); ++i) sorted[i] = static_cast<uint32_t>(i);
+        std::sort(sorted.begin(), sorted.end(), [this](uint32_t a, uint32_t b) {
+            const Entry& x = entries[a];
+            const Entry& y = entries[b];
+            return x.key < y.key || (x.key == y.key && x.id < y.id);
+        });
+
+        nodes.clear();
+        labels.clear();
+        topEntries.clear();
+        nodes.push_back(Node());
+        nodes[0].labelBegin = nodes[0].labelLength = 0;
+        buildNode(0, sorted, 0, sorted.size(), 0);
+        built = entries.size();
+    }
+
+    // IDs of up to limit (<= TOP_K) keys starting with prefix, best first
+    std::vector<int> complete(const std::string& prefix, size_t limit) const {
+        limit = std::min(limit, TOP_K);
+        std::vector<uint32_t> matches;
+
+        int64_t node = findNode(prefix);
+        if (node >= 0) {
+            const Node& n = nodes[node];
+            matches.assign(topEntries.begin() + n.topBegin,
+                           topEntries.begin() + n.topBegin + std::min<size_t>(n.topCount, limit));
+        }
+        for (size_t i = built; i < entries.size(); ++i) {
+            if (entries[i].key.compare(0, prefix.size(), prefix) == 0) {
+                matches.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        size_t count = std::min(limit, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + count, matches.end(),
+                          [this](uint32_t a, uint32_t b) { return ranksBefore(a, b); });
+
+        std::vector<int> ids;
+        ids.reserve(count);
+        for (size_t i = 0; i < count; ++i) ids.push_back(entries[matches[i]].id);
+        return ids;
+    }
+
+    size_t size() const { return entries.size(); }
+    size_t getNumNodes() const { return nodes.size(); }
+
+    size_t memoryUsageBytes() const {
+        size_t bytes = nodes.capacity() * sizeof(Node) + labels.capacity() +
+                       topEntries.capacity() * sizeof(uint32_t) + entries.capacity() * sizeof(Entry);
+        for (const Entry& entry : entries) bytes += entry.key.capacity();
+        return bytes;
+    }
+
+    void clear() {
+        entries.clear();
+        built = 0;
+        nodes.clear();
+        labels.clear();
+        topEntries.clear();
+    }
+};
+
+#endif // COMPACTTRIE_H
@@ -19,196 +19,45 @@
 #include "BTree.h"
 #include "HashTable.h"
 #include "Models.h"
-
-// ============ FEATURE 1: SPATIAL INDEX ============
-
-class SpatialIndex {
-private:
-    BTree<double, std::vector<int>> latIndex;   // Latitude -> Junction IDs
-    BTree<double, std::vector<int>> lngIndex;   // Longitude -> Junction IDs
-    HashTable<int, Junction> idCache;            // Fast ID lookup
-    
-public:
-    SpatialIndex() : latIndex(5), lngIndex(5), idCache(1024) {}
-    
-    void addJunction(const Junction& j) {
-        // Add to spatial indices
-        std::vector<int> latList;
-        latIndex.search(j.latitude, &latList);
-        latList.push_back(j.id);
-        latIndex.insert(j.latitude, latList);
-        
-        std::vector<int> lngList;
-        lngIndex.search(j.longitude, &lngList);
-        lngList.push_back(j.id);
-        lngIndex.insert(j.longitude, lngList);
-        
-        // Cache full junction
-        idCache.insert(j.id, j);
-    }
-    
-    // Find all junctions within radius (km)
-    std::vector<Junction> findInRadius(double centerLat, double centerLng, double radiusKm) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        // Calculate lat/lng bounds (approximate)
-        double latDelta = radiusKm / 111.0; // 1 degree lat ≈ 111 km
-        double lngDelta = radiusKm / (111.0 * cos(centerLat * M_PI / 180.0));
-        
-        // Range query on B-Tree (O(log n + m))
-        auto latCandidates = latIndex.rangeQuery(
-            centerLat - latDelta, 
-            centerLat + latDelta
-        );
-        
-        std::vector<Junction> results;
-        std::set<int> seen;
-        
-        for (const auto& [lat, ids] : latCandidates) {
-            for (int id : ids) {
-                if (seen.find(id) != seen.end()) continue;
-                seen.insert(id);
-                
-                Junction j;
-                if (idCache.search(id, &j)) {
-                    double dist = calculateDistance(
-                        centerLat, centerLng, 
-                        j.latitude, j.longitude
-                    );
-                    if (dist <= radiusKm) {
-                        results.push_back(j);
-                    }
-                }
-            }
-        }
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        
-        std::cout << "🎯 SPATIAL QUERY: Found " << results.size() 
-                  << " junctions within " << radiusKm << "km in " 
-                  << duration.count() << "ms\n";
-        
-        return results;
-    }
-    
-    double calculateDistance(double lat1, double lng1, double lat2, double lng2) {
-        const double R = 6371.0; // Earth radius in km
-        double dLat = (lat2 - lat1) * M_PI / 180.0;
-        double dLng = (lng2 - lng1) * M_PI / 180.0;
-        
-        double a = sin(dLat/2) * sin(dLat/2) +
-                   cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) *
-                   sin(dLng/2) * sin(dLng/2);
-        double c = 2 * atan2(sqrt(a), sqrt(1-a));
-        
-        return R * c;
-    }
-};
+#include "Metrics.h"
 
 // ============ FEATURE 2: PERFORMANCE MONITOR ============
 
 class PerformanceMonitor {
 private:
-    struct SearchRecord {
-        std::string type;
-        double timeMs;
-        std::chrono::system_clock::time_point timestamp;
-    };
-    
-    std::vector<SearchRecord> history;
-    std::map<std::string, std::vector<double>> timingsByType;
+    // Fixed-size histogram per search type (nanoseconds), so memory stays
+    // bounded however many searches are recorded
+    std::map<std::string, LatencyHistogram> timingsByType;
+    size_t totalSearches = 0;
     
 public:
     void recordSearch(const std::string& type, double timeMs) {
-        SearchRecord record;
-        record.type = type;
-        record.timeMs = timeMs;
-        record.timestamp = std::chrono::system_clock::now();
-        
-        history.push_back(record);
-        timingsByType[type].push_back(timeMs);
-        
-        // Keep last 1000 records
-        if (history.size() > 1000) {
-            history.erase(history.begin());
-        }
+        timingsByType[type].record(static_cast<uint64_t>(std::max(0.0, timeMs) * 1e6));
+        totalSearches++;
     }
     
     void showStats() {
         std::cout << "\n📊 PERFORMANCE STATISTICS\n";
         std::cout << "=================================\n";
-        std::cout << "Total Searches: " << history.size() << "\n\n";
+        std::cout << "Total Searches: " << totalSearches << "\n\n";
         
-        for (const auto& [type, timings] : timingsByType) {
-            if (timings.empty()) continue;
-            
-            double sum = 0;
-            double minTime = timings[0];
-            double maxTime = timings[0];
-            
-            for (double t : timings) {
-                sum += t;
-                if (t < minTime) minTime = t;
-                if (t > maxTime) maxTime = t;
-            }
-            
-            double avg = sum / timings.size();
+        for (const auto& [type, histogram] : timingsByType) {
+            LatencyHistogram::Snapshot timings = histogram.snapshot();
+            if (timings.count == 0) continue;
             
             std::cout << type << " Searches:\n";
-            std::cout << "  Count: " << timings.size() << "\n";
-            std::cout << "  Avg: " << avg << " ms\n";
-            std::cout << "  Min: " << minTime << " ms\n";
-            std::cout << "  Max: " << maxTime << " ms\n\n";
+            std::cout << "  Count: " << timings.count << "\n";
+            std::cout << "  Avg: " << timings.mean() / 1e6 << " ms\n";
+            std::cout << "  Min: " << timings.min / 1e6 << " ms\n";
+            std::cout << "  p50: " << timings.percentile(0.5) / 1e6 << " ms\n";
+            std::cout << "  p99: " << timings.percentile(0.99) / 1e6 << " ms\n";
+            std::cout << "  Max: " << timings.max / 1e6 << " ms\n\n";
         }
     }
     
     void reset() {
-        history.clear();
         timingsByType.clear();
-    }
-};
-
-// ============ FEATURE 3: AUTOCOMPLETE ENGINE ============
-
-class AutocompleteEngine {
-private:
-    BTree<std::string, Junction> junctionTree;
-    
-public:
-    AutocompleteEngine() : junctionTree(5) {}
-    
-    void addJunction(const Junction& j) {
-        std::string lowerName = toLowerCase(j.name);
-        junctionTree.insert(lowerName, j);
-    }
-    
-    std::vector<Junction> search(const std::string& prefix, int maxResults = 10) {
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        std::string lowerPrefix = toLowerCase(prefix);
-        auto results = junctionTree.prefixSearch(lowerPrefix);
-        
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        
-        std::cout << "⚡ AUTOCOMPLETE: Found " << results.size() 
-                  << " matches for \"" << prefix << "\" in " 
-                  << duration.count() / 1000.0 << " ms\n";
-        
-        std::vector<Junction> junctions;
-        for (size_t i = 0; i < results.size() && i < maxResults; i++) {
-            junctions.push_back(results[i].second);
-        }
-        
-        return junctions;
-    }
-    
-private:
-    std::string toLowerCase(const std::string& str) {
-        std::string result = str;
-        std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-        return result;
+        totalSearches = 0;
     }
 };
 
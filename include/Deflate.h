@@ -0,0 +1,232 @@
+/**
+ * Smart Traffic Route Optimizer
+ * DEFLATE Compressor Implementation
+ *
+ * Compresses response payloads for Content-Encoding: gzip / deflate
+ * without an external library. LZ77 over a 32 KB window (hash chains,
+ * greedy matching) feeding one block of the fixed Huffman code
+ * (RFC 1951 3.2.6); the raw stream is wrapped as gzip (RFC 1952) or
+ * zlib (RFC 1950). JSON is dominated by repeated keys and digits, which
+ * LZ77 already captures, so the fixed code costs little against dynamic
+ * tables and keeps the encoder small.
+ * Time Complexity: O(n * MAX_CHAIN) worst case, close to O(n) on JSON
+ */
+
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace deflate_detail {
+
+static const size_t WINDOW = 32768;
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_MATCH = 258;
+static const int HASH_BITS = 15;
+static const int MAX_CHAIN = 64;
+
+static const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// DEFLATE packs bits LSB first; Huffman codes go in MSB first
+class BitWriter {
+private:
+    std::string& out;
+    uint32_t buffer;
+    int count;
+
+public:
+    explicit BitWriter(std::string& target) : out(target), buffer(0), count(0) {}
+
+    void write(uint32_t bits, int length) {
+        buffer |= bits << count;
+        count += length;
+        while (count >= 8) {
+            out += static_cast<char>(buffer & 0xFF);
+            buffer >>= 8;
+            count -= 8;
+        }
+    }
+
+    void writeCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | (code & 1);
+            code >>= 1;
+        }
+        write(reversed, length);
+    }
+
+    void flush() {
+        if (count > 0) out += static_cast<char>(buffer & 0xFF);
+        buffer = 0;
+        count = 0;
+    }
+};
+
+// Fixed literal/length code
+inline void writeSymbol(BitWriter& bits, unsigned symbol) {
+    if (symbol < 144) bits.writeCode(0x30 + symbol, 8);
+    else if (symbol < 256) bits.writeCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280) bits.writeCode(symbol - 256, 7);
+    else bits.writeCode(0xC0 + symbol - 280, 8);
+}
+
+inline void writeMatch(BitWriter& bits, size_t length, size_t distance) {
+    int lengthCode = 28;
+    while (LENGTH_BASE[lengthCode] > length) --lengthCode;
+    writeSymbol(bits, 257 + lengthCode);
+    bits.write(static_cast<uint32_t>(length - LENGTH_BASE[lengthCode]), LENGTH_EXTRA[lengthCode]);
+
+    int distanceCode = 29;
+    while (DISTANCE_BASE[distanceCode] > distance) --distanceCode;
+    bits.writeCode(distanceCode, 5);
+    bits.write(static_cast<uint32_t>(distance - DISTANCE_BASE[distanceCode]), DISTANCE_EXTRA[distanceCode]);
+}
+
+inline uint32_t hash3(const unsigned char* p) {
+    uint32_t v = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+struct Crc32Table {
+    uint32_t entries[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+inline uint32_t crc32(const std::string& data) {
+    static const Crc32Table table;   // built once, thread-safe
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : data) crc = table.entries[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+inline uint32_t adler32(const std::string& data) {
+    uint32_t a = 1, b = 0;
+    size_t i = 0;
+    while (i < data.size()) {
+        size_t end = std::min(data.size(), i + 5552);   // largest run without overflow
+        for (; i < end; ++i) {
+            a += static_cast<unsigned char>(data[i]);
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+inline void appendLE32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+inline void appendBE32(std::string& out, uint32_t v) {
+    for (int i = 3; i >= 0; --i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+} // namespace deflate_detail
+
+// Raw DEFLATE stream (one final fixed-Huffman block)
+inline std::string deflateRaw(const std::string& input) {
+    using namespace deflate_detail;
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
+    const size_t n = input.size();
+
+    std::string out;
+    out.reserve(n / 4 + 64);
+    BitWriter bits(out);
+    bits.write(1, 1);   // BFINAL
+    bits.write(1, 2);   // BTYPE = fixed Huffman
+
+    std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+    std::vector<int32_t> prev(WINDOW, -1);
+    auto insert = [&](size_t pos) {
+        if (pos + MIN_MATCH > n) return;
+        uint32_t h = hash3(data + pos);
+        prev[pos & (WINDOW - 1)] = head[h];
+        head[h] = static_cast<int32_t>(pos);
+    };
+
+    size_t pos = 0;
+    while (pos < n) {
+        size_t bestLength = 0, bestDistance = 0;
+        if (pos + MIN_MATCH <= n) {
+            size_t maxLength = std::min(MAX_MATCH, n - pos);
+            int32_t candidate = head[hash3(data + pos)];
+            for (int chain = MAX_CHAIN; candidate >= 0 && chain > 0; --chain) {
+                size_t distance = pos - static_cast<size_t>(candidate);
+                if (distance > WINDOW) break;
+                const unsigned char* a = data + candidate;
+                const unsigned char* b = data + pos;
+                if (a[bestLength] == b[bestLength]) {   // can it beat the best so far?
+                    size_t length = 0;
+                    while (length < maxLength && a[length] == b[length]) ++length;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if (length == maxLength) break;
+                    }
+                }
+                candidate = prev[candidate & (WINDOW - 1)];
+            }
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            writeMatch(bits, bestLength, bestDistance);
+            for (size_t end = pos + bestLength; pos < end; ++pos) insert(pos);
+        } else {
+            writeSymbol(bits, data[pos]);
+            insert(pos);
+            ++pos;
+        }
+    }
+
+    writeSymbol(bits, 256);   // end of block
+    bits.flush();
+    return out;
+}
+
+// gzip member around a raw stream (Content-Encoding: gzip)
+inline std::string gzipWrap(const std::string& raw, const std::string& original) {
+    std::string out("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);   // no name, no mtime, OS unknown
+    out.reserve(raw.size() + 18);
+    out += raw;
+    deflate_detail::appendLE32(out, deflate_detail::crc32(original));
+    deflate_detail::appendLE32(out, static_cast<uint32_t>(original.size()));
+    return out;
+}
+
+// zlib stream around a raw stream (Content-Encoding: deflate)
+inline std::string zlibWrap(const std::string& raw, const std::string& original) {
+    std::string out("\x78\x01", 2);   // 32 KB window, fastest-level flag
+    out.reserve(raw.size() + 6);
+    out += raw;
+    deflate_detail::appendBE32(out, deflate_detail::adler32(original));
+    return out;
+}
+
+inline std::string gzipCompress(const std::string& input) {
+    return gzipWrap(deflateRaw(input), input);
+}
+
+#endif // DEFLATE_H
@@ -0,0 +1,152 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Edit Distance Kernel
+ *
+ * Bounded Levenshtein distance with no per-call heap allocation.
+ * If the shorter string has at most 64 characters, the bit-parallel
+ * algorithm of Myers (in Hyyro's formulation) keeps one whole DP column
+ * in two 64-bit delta masks, so each character of the longer string costs
+ * a handful of word operations. Longer patterns are split into 64-row
+ * blocks that pass horizontal deltas down the column. Both stop as soon
+ * as the distance must exceed the bound.
+ * Time Complexity: O(ceil(m / 64) * n) for pattern length m <= text length n
+ */
+
+#ifndef EDITDISTANCE_H
+#define EDITDISTANCE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+const size_t EDIT_DISTANCE_WORD_BITS = 64;
+
+// ==================== BLOCKED BIT-PARALLEL (LONG STRINGS) ====================
+
+/**
+ * One 64-row block of a column step (Myers' block recurrence).
+ * hin is the horizontal delta entering from the block above (-1, 0, +1);
+ * returns the delta leaving at row outBit.
+ */
+inline int advanceEditDistanceBlock(uint64_t& pv, uint64_t& mv, uint64_t eq, int hin, uint64_t outBit) {
+    uint64_t hinNegative = hin < 0 ? 1 : 0;
+    uint64_t xv = eq | mv;
+    eq |= hinNegative;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+
+    int hout = ((ph & outBit) != 0) - ((mh & outBit) != 0);
+
+    ph = (ph << 1) | (hin > 0 ? 1 : 0);
+    mh = (mh << 1) | hinNegative;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+
+// Pattern longer than one word: ceil(m / 64) blocks per text character
+inline size_t boundedEditDistanceBlocks(const std::string& pattern, const std::string& text,
+                                        size_t maxDistance) {
+    const size_t m = pattern.size(), n = text.size();
+    const size_t blocks = (m + EDIT_DISTANCE_WORD_BITS - 1) / EDIT_DISTANCE_WORD_BITS;
+    const uint64_t highBit = uint64_t(1) << (EDIT_DISTANCE_WORD_BITS - 1);
+    const uint64_t lastRow = uint64_t(1) << ((m - 1) % EDIT_DISTANCE_WORD_BITS);
+
+    // peq[c * blocks + b]: match mask of character c in block b (reset on exit)
+    thread_local std::vector<uint64_t> peq;
+    thread_local std::vector<uint64_t> pv, mv;
+    if (peq.size() < 256 * blocks) peq.resize(256 * blocks, 0);
+    pv.assign(blocks, ~uint64_t(0));
+    mv.assign(blocks, 0);
+    for (size_t i = 0; i < m; ++i) {
+        peq[static_cast<unsigned char>(pattern[i]) * blocks + i / EDIT_DISTANCE_WORD_BITS] |=
+            uint64_t(1) << (i % EDIT_DISTANCE_WORD_BITS);
+    }
+
+    size_t score = m;
+    for (size_t j = 0; j < n; ++j) {
+        const uint64_t* eq = &peq[static_cast<unsigned char>(text[j]) * blocks];
+        int carry = 1;   // row 0 is d[0][j] = j
+        for (size_t b = 0; b + 1 < blocks; ++b) {
+            carry = advanceEditDistanceBlock(pv[b], mv[b], eq[b], carry, highBit);
+        }
+        score += advanceEditDistanceBlock(pv[blocks - 1], mv[blocks - 1], eq[blocks - 1], carry, lastRow);
+
+        if (score > maxDistance + (n - j - 1)) {
+            score = maxDistance + 1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+        peq[static_cast<unsigned char>(pattern[i]) * blocks + i / EDIT_DISTANCE_WORD_BITS] = 0;
+    }
+    return std::min(score, maxDistance + 1);
+}
+
+// ==================== BIT-PARALLEL (MYERS / HYYRO) ====================
+
+/**
+ * Levenshtein distance between a and b if it is at most maxDistance,
+ * otherwise maxDistance + 1.
+ */
+inline size_t boundedEditDistance(const std::string& a, const std::string& b, size_t maxDistance) {
+    const std::string& pattern = a.size() <= b.size() ? a : b;
+    const std::string& text = a.size() <= b.size() ? b : a;
+    const size_t m = pattern.size(), n = text.size();
+
+    if (n - m > maxDistance) return maxDistance + 1;   // every length difference costs an edit
+    if (m == 0) return n;
+    if (m > EDIT_DISTANCE_WORD_BITS) return boundedEditDistanceBlocks(pattern, text, maxDistance);
+
+    // Match masks: bit i of peq[c] is set when pattern[i] == c.
+    // Only the pattern's entries are written, and they are reset on exit.
+    thread_local uint64_t peq[256] = {};
+    for (size_t i = 0; i < m; ++i) {
+        peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+
+    // Vertical deltas of the current column: +1 where pv is set, -1 where mv is set
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    const uint64_t lastRow = uint64_t(1) << (m - 1);
+    size_t score = m;   // d[m][0]
+
+    for (size_t j = 0; j < n; ++j) {
+        uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);   // horizontal +1
+        uint64_t mh = pv & xh;           // horizontal -1
+
+        score += (ph & lastRow) != 0;
+        score -= (mh & lastRow) != 0;
+
+        // Row 0 is d[0][j] = j, so its horizontal delta is always +1
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining character can lower the score by at most one
+        if (score > maxDistance + (n - j - 1)) {
+            score = maxDistance + 1;
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < m; ++i) {
+        peq[static_cast<unsigned char>(pattern[i])] = 0;
+    }
+    return std::min(score, maxDistance + 1);
+}
+
+// Unbounded Levenshtein distance
+inline size_t editDistance(const std::string& a, const std::string& b) {
+    return boundedEditDistance(a, b, std::max(a.size(), b.size()));
+}
+
+#endif // EDITDISTANCE_H
@@ -0,0 +1,766 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Event-Driven Connection Server Implementation
+ *
+ * One I/O thread multiplexes every client socket (epoll on Linux, an
+ * I/O completion port on Windows) and a bounded WorkerPool runs the
+ * request handler, so thousands of idle keep-alive connections cost no
+ * threads. Bytes are accumulated per connection until the framer reports
+ * a complete request, however many reads that takes. Each connection has
+ * at most one request with the workers; pipelined requests wait in its
+ * buffer, so responses go out in request order. Handlers may stream a
+ * large response in parts; a worker that gets too far ahead of the
+ * client waits until the socket drains.
+ */
+
+#ifndef EVENTSERVER_H
+#define EVENTSERVER_H
+
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <cstdint>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+    typedef int socklen_t;
+#else
+    #include <sys/socket.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <cerrno>
+    #define SOCKET int
+    #define INVALID_SOCKET -1
+    #define SOCKET_ERROR -1
+    #define closesocket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0   // Windows never raises SIGPIPE
+#endif
+
+#include "WorkerPool.h"
+#include "ResponseStream.h"
+
+class EventServer {
+public:
+    /**
+     * Length of the first complete request in buffer, 0 if more bytes are
+     * needed, or std::string::npos with *errorResponse set when the stream
+     * cannot be parsed (the error is sent and the connection closed).
+     */
+    typedef std::function<size_t(const std::string& buffer, std::string* errorResponse)> RequestFramer;
+
+    /**
+     * Response to one framed request: anything written to the sink goes out
+     * first, then the returned string. Clear *keepAlive to close after it.
+     */
+    typedef std::function<std::string(const std::string& request, bool* keepAlive,
+                                      ResponseSink& sink)> RequestHandler;
+
+    struct Stats {
+        size_t activeConnections;
+        uint64_t acceptedConnections;
+        uint64_t requests;
+        uint64_t keepAliveRequests;   // served on an already used connection
+        uint64_t pipelinedRequests;   // more bytes were already buffered behind them
+        uint64_t rejectedRequests;    // answered with the overload response
+        uint64_t idleTimeouts;
+        WorkerPool::Stats workers;
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr size_t READ_CHUNK = 16384;
+    static constexpr int MAX_EVENTS = 256;
+    static constexpr int POLL_INTERVAL_MS = 1000;   // idle sweep granularity
+    static constexpr size_t STREAM_HIGH_WATER = 1 << 20;   // unsent streamed bytes per connection
+
+    // Flow control between a streaming worker and the I/O thread
+    struct StreamState {
+        std::mutex mutex;
+        std::condition_variable drained;
+        size_t unsent = 0;       // written by the worker, not yet sent to the socket
+        bool aborted = false;    // connection closed
+    };
+
+    struct Connection {
+        uint64_t id;
+        SOCKET socket;
+        std::string input;          // received bytes not yet framed
+        std::string output;         // response bytes, sent from outputOffset on
+        size_t outputOffset;
+        bool busy;                  // a request is with the workers
+        bool closeAfterWrite;
+        bool peerClosed;            // peer finished sending; serve what is buffered
+        bool closed;                // socket closed, waiting to be released
+        uint64_t served;
+        Clock::time_point lastActive;
+        std::shared_ptr<StreamState> stream;   // set while a request is with the workers
+#ifdef _WIN32
+        struct Operation {
+            OVERLAPPED overlapped;
+            Connection* owner;
+            bool isRead;
+        };
+        Operation readOp;
+        Operation writeOp;
+        bool reading;
+        bool writing;
+        std::string backlog;        // output queued while WSASend reads from output
+        char readBuffer[READ_CHUNK];
+#else
+        uint32_t events;            // current epoll interest
+#endif
+    };
+
+    struct Completion {
+        uint64_t connection;
+        std::string response;
+        bool keepAlive;
+        bool final;              // false: a streamed part, more follows
+    };
+
+    // Sink handed to handlers on the workers: parts become completions
+    class WorkerSink : public ResponseSink {
+        EventServer& server;
+        uint64_t connection;
+        std::shared_ptr<StreamState> state;
+
+    public:
+        WorkerSink(EventServer& owner, uint64_t id, std::shared_ptr<StreamState> flow)
+            : server(owner), connection(id), state(flow) {}
+
+        bool write(std::string data) override {
+            {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->drained.wait(lock, [this]() {
+                    return state->aborted || state->unsent < STREAM_HIGH_WATER;
+                });
+                if (state->aborted) return false;
+                state->unsent += data.size();
+            }
+            Completion part;
+            part.connection = connection;
+            part.response = std::move(data);
+            part.keepAlive = true;
+            part.final = false;
+            server.complete(std::move(part));
+            return true;
+        }
+    };
+
+    RequestFramer framer;
+    RequestHandler handler;
+    std::string overloadResponse;
+    int idleTimeoutSeconds;
+
+    std::map<uint64_t, std::unique_ptr<Connection>> connections;   // I/O thread only
+    uint64_t nextConnectionId;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;     // finished by workers, drained by the I/O thread
+    std::atomic<bool> running;
+
+    std::atomic<size_t> activeConnections;
+    std::atomic<uint64_t> acceptedConnections;
+    std::atomic<uint64_t> requests;
+    std::atomic<uint64_t> keepAliveRequests;
+    std::atomic<uint64_t> pipelinedRequests;
+    std::atomic<uint64_t> rejectedRequests;
+    std::atomic<uint64_t> idleTimeouts;
+
+#ifdef _WIN32
+    static const ULONG_PTR IO_KEY = 0;
+    static const ULONG_PTR WAKE_KEY = 1;
+    HANDLE completionPort;
+    std::vector<SOCKET> acceptedSockets;     // guarded by completionMutex
+#else
+    static const uint64_t LISTEN_KEY = 0;
+    static const uint64_t WAKE_KEY = 1;
+    int epollFd;
+    int wakeFd;
+#endif
+
+    // Declared last: destroyed (and joined) before the state its tasks touch
+    WorkerPool pool;
+
+    // ==================== CONNECTION STATE ====================
+
+    static bool outputPending(const Connection& conn) {
+        return conn.outputOffset < conn.output.size();
+    }
+
+    static void queueOutput(Connection& conn, const std::string& data) {
+#ifdef _WIN32
+        if (conn.writing) {   // the posted WSASend still reads from output
+            conn.backlog += data;
+            return;
+        }
+#endif
+        if (!outputPending(conn)) {
+            conn.output.clear();
+            conn.outputOffset = 0;
+        }
+        conn.output += data;
+    }
+
+    Connection* addConnection(SOCKET socket) {
+        std::unique_ptr<Connection> conn(new Connection());
+        conn->id = nextConnectionId++;
+        conn->socket = socket;
+        conn->outputOffset = 0;
+        conn->busy = false;
+        conn->closeAfterWrite = false;
+        conn->peerClosed = false;
+        conn->closed = false;
+        conn->served = 0;
+        conn->lastActive = Clock::now();
+#ifdef _WIN32
+        conn->readOp.owner = conn->writeOp.owner = conn.get();
+        conn->readOp.isRead = true;
+        conn->writeOp.isRead = false;
+        conn->reading = conn->writing = false;
+#else
+        conn->events = 0;
+#endif
+        Connection* raw = conn.get();
+        connections[raw->id] = std::move(conn);
+        acceptedConnections++;
+        activeConnections++;
+        return raw;
+    }
+
+    // Account for bytes that reached the socket
+    static void noteSent(Connection& conn, size_t bytes) {
+        conn.outputOffset += bytes;
+        conn.lastActive = Clock::now();
+        if (conn.stream) {
+            std::lock_guard<std::mutex> lock(conn.stream->mutex);
+            conn.stream->unsent = conn.stream->unsent > bytes ? conn.stream->unsent - bytes : 0;
+            conn.stream->drained.notify_all();
+        }
+    }
+
+    // Wake a worker blocked on a connection that is going away
+    static void abortStream(Connection& conn) {
+        if (!conn.stream) return;
+        std::lock_guard<std::mutex> lock(conn.stream->mutex);
+        conn.stream->aborted = true;
+        conn.stream->drained.notify_all();
+    }
+
+    void complete(Completion&& done) {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back(std::move(done));
+        }
+        wake();
+    }
+
+    // Free a closed connection once no I/O refers to it
+    void release(uint64_t id) {
+        auto it = connections.find(id);
+        if (it == connections.end() || !it->second->closed) return;
+#ifdef _WIN32
+        if (it->second->reading || it->second->writing) return;
+#endif
+        connections.erase(it);
+    }
+
+    // Hand the next buffered request to the workers (one at a time per connection)
+    void processInput(Connection& conn) {
+        if (conn.busy || conn.closeAfterWrite || outputPending(conn) || conn.input.empty()) return;
+
+        std::string error;
+        size_t length = framer(conn.input, &error);
+        if (length == 0) return;
+        if (length == std::string::npos) {
+            queueOutput(conn, error);
+            conn.closeAfterWrite = true;
+            conn.input.clear();
+            return;
+        }
+
+        std::string request = conn.input.substr(0, length);
+        conn.input.erase(0, length);
+        requests++;
+        if (conn.served++ > 0) keepAliveRequests++;
+        if (!conn.input.empty()) pipelinedRequests++;
+
+        uint64_t id = conn.id;
+        conn.busy = true;
+        conn.stream = std::make_shared<StreamState>();
+        std::shared_ptr<StreamState> flow = conn.stream;
+        bool queued = pool.trySubmit([this, id, request, flow]() {
+            WorkerSink sink(*this, id, flow);
+            Completion done;
+            done.connection = id;
+            done.keepAlive = true;
+            done.final = true;
+            done.response = handler(request, &done.keepAlive, sink);
+            complete(std::move(done));
+        });
+
+        if (!queued) {
+            conn.busy = false;
+            conn.stream.reset();
+            rejectedRequests++;
+            queueOutput(conn, overloadResponse);
+            conn.closeAfterWrite = true;
+            conn.input.clear();
+        }
+    }
+
+    // Send what the socket takes, then start the next pipelined request
+    void update(Connection& conn) {
+        while (!conn.closed) {
+            if (!sendOutput(conn)) {
+                closeConnection(conn);
+                return;
+            }
+            if (outputPending(conn)) break;          // wait for the socket to drain
+            if (conn.closeAfterWrite) {
+                if (!conn.busy) closeConnection(conn);
+                break;
+            }
+            processInput(conn);
+            if (!outputPending(conn)) {              // dispatched, or waiting for more bytes
+                if (conn.peerClosed && !conn.busy) closeConnection(conn);
+                break;
+            }
+        }
+        if (!conn.closed) watch(conn);
+    }
+
+    // Move worker responses onto their connections (I/O thread)
+    void drainCompletions() {
+        std::vector<Completion> done;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            done.swap(completions);
+        }
+        for (Completion& completion : done) {
+            auto it = connections.find(completion.connection);
+            if (it == connections.end() || it->second->closed) continue;   // client went away
+
+            Connection& conn = *it->second;
+            if (completion.final) {
+                conn.busy = false;
+                conn.stream.reset();
+                if (!completion.keepAlive) conn.closeAfterWrite = true;
+            }
+            queueOutput(conn, completion.response);
+            conn.lastActive = Clock::now();
+            update(conn);
+            release(completion.connection);
+        }
+    }
+
+    // Close connections without traffic for idleTimeoutSeconds (and stalled streams)
+    void sweepIdle() {
+        Clock::time_point now = Clock::now();
+        std::vector<uint64_t> expired;
+        for (auto& entry : connections) {
+            Connection& conn = *entry.second;
+            if (conn.closed || (conn.busy && !outputPending(conn))) continue;
+            if (now - conn.lastActive >= std::chrono::seconds(idleTimeoutSeconds)) {
+                closeConnection(conn);
+                idleTimeouts++;
+                expired.push_back(entry.first);
+            }
+        }
+        for (uint64_t id : expired) release(id);
+    }
+
+#ifdef _WIN32
+    // ==================== IOCP (WINDOWS) ====================
+
+    void wake() {
+        PostQueuedCompletionStatus(completionPort, 0, WAKE_KEY, nullptr);
+    }
+
+    void closeConnection(Connection& conn) {
+        if (conn.closed) return;
+        conn.closed = true;
+        abortStream(conn);
+        closesocket(conn.socket);   // pending operations complete with an error
+        activeConnections--;
+    }
+
+    bool sendOutput(Connection& conn) {
+        if (conn.writing || !outputPending(conn)) return true;
+
+        ZeroMemory(&conn.writeOp.overlapped, sizeof(OVERLAPPED));
+        WSABUF buffer;
+        buffer.buf = &conn.output[conn.outputOffset];
+        buffer.len = static_cast<ULONG>(conn.output.size() - conn.outputOffset);
+        conn.writing = true;
+        if (WSASend(conn.socket, &buffer, 1, nullptr, 0, &conn.writeOp.overlapped, nullptr) == SOCKET_ERROR &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            conn.writing = false;
+            return false;
+        }
+        return true;
+    }
+
+    // Keep a receive posted whenever the connection can take another request
+    void watch(Connection& conn) {
+        bool wantRead = !conn.busy && !conn.closeAfterWrite && !conn.peerClosed && !outputPending(conn);
+        if (!wantRead || conn.reading) return;
+
+        ZeroMemory(&conn.readOp.overlapped, sizeof(OVERLAPPED));
+        WSABUF buffer;
+        buffer.buf = conn.readBuffer;
+        buffer.len = static_cast<ULONG>(READ_CHUNK);
+        DWORD flags = 0;
+        conn.reading = true;
+        if (WSARecv(conn.socket, &buffer, 1, nullptr, &flags, &conn.readOp.overlapped, nullptr) == SOCKET_ERROR &&
+            WSAGetLastError() != WSA_IO_PENDING) {
+            conn.reading = false;
+            closeConnection(conn);
+        }
+    }
+
+    void adoptAcceptedSockets() {
+        std::vector<SOCKET> sockets;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            sockets.swap(acceptedSockets);
+        }
+        for (SOCKET socket : sockets) {
+            BOOL noDelay = TRUE;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (char*)&noDelay, sizeof(noDelay));
+            if (CreateIoCompletionPort((HANDLE)socket, completionPort, IO_KEY, 0) == NULL) {
+                closesocket(socket);
+                continue;
+            }
+            Connection* conn = addConnection(socket);
+            watch(*conn);
+            release(conn->id);
+        }
+    }
+
+    void onIoComplete(Connection::Operation& op, BOOL ok, DWORD bytes) {
+        Connection& conn = *op.owner;
+        uint64_t id = conn.id;
+
+        if (op.isRead) {
+            conn.reading = false;
+            if (!conn.closed) {
+                if (!ok) {
+                    closeConnection(conn);
+                } else if (bytes == 0) {
+                    conn.peerClosed = true;
+                } else {
+                    conn.input.append(conn.readBuffer, bytes);
+                    conn.lastActive = Clock::now();
+                }
+            }
+        } else {
+            conn.writing = false;
+            if (!conn.closed) {
+                if (!ok) {
+                    closeConnection(conn);
+                } else {
+                    noteSent(conn, bytes);
+                    if (!outputPending(conn) && !conn.backlog.empty()) {
+                        conn.output.swap(conn.backlog);
+                        conn.backlog.clear();
+                        conn.outputOffset = 0;
+                    }
+                }
+            }
+        }
+
+        if (!conn.closed) update(conn);
+        release(id);
+    }
+
+public:
+    void run(SOCKET listenSocket) {
+        completionPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+        if (completionPort == NULL) {
+            std::cerr << "Error creating I/O completion port\n";
+            return;
+        }
+
+        // accept() blocks, so it gets its own thread and hands sockets to the I/O thread
+        std::thread acceptor([this, listenSocket]() {
+            while (running) {
+                SOCKET client = accept(listenSocket, nullptr, nullptr);
+                if (client == INVALID_SOCKET) {
+                    if (!running) break;
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(completionMutex);
+                    acceptedSockets.push_back(client);
+                }
+                wake();
+            }
+        });
+
+        Clock::time_point lastSweep = Clock::now();
+        while (running) {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            OVERLAPPED* overlapped = nullptr;
+            BOOL ok = GetQueuedCompletionStatus(completionPort, &bytes, &key, &overlapped, POLL_INTERVAL_MS);
+
+            if (overlapped != nullptr) {
+                onIoComplete(*CONTAINING_RECORD(overlapped, Connection::Operation, overlapped), ok, bytes);
+            } else if (ok && key == WAKE_KEY) {
+                adoptAcceptedSockets();
+                drainCompletions();
+            }
+
+            if (Clock::now() - lastSweep >= std::chrono::milliseconds(POLL_INTERVAL_MS)) {
+                sweepIdle();
+                lastSweep = Clock::now();
+            }
+        }
+
+        // The listening socket is closed by the owner, which unblocks accept()
+        // Close first: that also releases workers waiting on a stream
+        std::vector<uint64_t> open;
+        for (auto& entry : connections) {
+            closeConnection(*entry.second);
+            open.push_back(entry.first);
+        }
+        pool.shutdown();
+        for (uint64_t id : open) release(id);
+        while (!connections.empty()) {
+            DWORD bytes = 0;
+            ULONG_PTR key = 0;
+            OVERLAPPED* overlapped = nullptr;
+            BOOL ok = GetQueuedCompletionStatus(completionPort, &bytes, &key, &overlapped, POLL_INTERVAL_MS);
+            if (overlapped == nullptr) {
+                if (!ok) break;   // nothing left in flight
+                continue;
+            }
+            Connection::Operation& op = *CONTAINING_RECORD(overlapped, Connection::Operation, overlapped);
+            (op.isRead ? op.owner->reading : op.owner->writing) = false;
+            release(op.owner->id);
+        }
+        if (acceptor.joinable()) acceptor.join();
+        for (SOCKET socket : acceptedSockets) closesocket(socket);
+        acceptedSockets.clear();
+        CloseHandle(completionPort);
+        completionPort = NULL;
+    }
+
+#else
+    // ==================== EPOLL (LINUX) ====================
+
+    void wake() {
+        if (wakeFd < 0) return;
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;   // the counter only saturates if the loop is far behind
+    }
+
+    void closeConnection(Connection& conn) {
+        if (conn.closed) return;
+        conn.closed = true;
+        abortStream(conn);
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, conn.socket, nullptr);
+        closesocket(conn.socket);
+        activeConnections--;
+    }
+
+    // Non-blocking send until done or the kernel buffer is full
+    bool sendOutput(Connection& conn) {
+        while (outputPending(conn)) {
+            ssize_t sent = send(conn.socket, conn.output.data() + conn.outputOffset,
+                                conn.output.size() - conn.outputOffset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                noteSent(conn, static_cast<size_t>(sent));
+            } else if (sent < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+            }
+        }
+        return true;
+    }
+
+    // Read while idle, write while output is pending; nothing while a worker has the request
+    void watch(Connection& conn) {
+        bool wantRead = !conn.busy && !conn.closeAfterWrite && !conn.peerClosed && !outputPending(conn);
+        uint32_t events = (wantRead ? uint32_t(EPOLLIN) : 0u) | (outputPending(conn) ? uint32_t(EPOLLOUT) : 0u);
+        if (events == conn.events) return;
+
+        epoll_event ev = {};
+        ev.events = events;
+        ev.data.u64 = conn.id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.socket, &ev);
+        conn.events = events;
+    }
+
+    void acceptConnections(SOCKET listenSocket) {
+        while (true) {
+            SOCKET client = accept(listenSocket, nullptr, nullptr);
+            if (client == INVALID_SOCKET) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running) {
+                    std::cerr << "Error accepting connection\n";
+                }
+                return;
+            }
+            fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+            int noDelay = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+            Connection* conn = addConnection(client);
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = conn->id;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, client, &ev) < 0) {
+                closeConnection(*conn);
+                release(conn->id);
+                continue;
+            }
+            conn->events = EPOLLIN;
+        }
+    }
+
+    void onSocketEvent(Connection& conn, uint32_t events) {
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            closeConnection(conn);
+            return;
+        }
+        if (events & EPOLLIN) {
+            char buffer[READ_CHUNK];
+            ssize_t received = recv(conn.socket, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                conn.input.append(buffer, static_cast<size_t>(received));
+                conn.lastActive = Clock::now();
+            } else if (received == 0) {
+                conn.peerClosed = true;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                closeConnection(conn);
+                return;
+            }
+        }
+        update(conn);
+    }
+
+public:
+    void run(SOCKET listenSocket) {
+        epollFd = epoll_create1(0);
+        wakeFd = eventfd(0, EFD_NONBLOCK);
+        if (epollFd < 0 || wakeFd < 0) {
+            std::cerr << "Error creating epoll instance\n";
+            return;
+        }
+        fcntl(listenSocket, F_SETFL, fcntl(listenSocket, F_GETFL, 0) | O_NONBLOCK);
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = LISTEN_KEY;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSocket, &ev);
+        ev.data.u64 = WAKE_KEY;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+        epoll_event events[MAX_EVENTS];
+        Clock::time_point lastSweep = Clock::now();
+        while (running) {
+            int count = epoll_wait(epollFd, events, MAX_EVENTS, POLL_INTERVAL_MS);
+            if (count < 0 && errno != EINTR) {
+                std::cerr << "Error waiting for socket events\n";
+                break;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                uint64_t key = events[i].data.u64;
+                if (key == LISTEN_KEY) {
+                    acceptConnections(listenSocket);
+                } else if (key == WAKE_KEY) {
+                    uint64_t pending;
+                    ssize_t drained = read(wakeFd, &pending, sizeof(pending));
+                    (void)drained;
+                    drainCompletions();
+                } else {
+                    auto it = connections.find(key);
+                    if (it == connections.end()) continue;
+                    onSocketEvent(*it->second, events[i].events);
+                    release(key);
+                }
+            }
+
+            if (Clock::now() - lastSweep >= std::chrono::milliseconds(POLL_INTERVAL_MS)) {
+                sweepIdle();
+                lastSweep = Clock::now();
+            }
+        }
+
+        // Close first: that also releases workers waiting on a stream
+        for (auto& entry : connections) closeConnection(*entry.second);
+        pool.shutdown();
+        connections.clear();
+        close(wakeFd);
+        close(epollFd);
+        wakeFd = epollFd = -1;
+    }
+#endif
+
+    // ==================== COMMON ====================
+
+    EventServer(size_t workerCount, size_t maxQueuedRequests, int idleTimeout,
+                RequestFramer frame, RequestHandler handle, const std::string& overload)
+        : framer(frame), handler(handle), overloadResponse(overload),
+          idleTimeoutSeconds(idleTimeout), nextConnectionId(2), running(true),
+          activeConnections(0), acceptedConnections(0), requests(0), keepAliveRequests(0),
+          pipelinedRequests(0), rejectedRequests(0), idleTimeouts(0),
+#ifdef _WIN32
+          completionPort(NULL),
+#else
+          epollFd(-1), wakeFd(-1),
+#endif
+          pool(workerCount, maxQueuedRequests) {}
+
+    EventServer(const EventServer&) = delete;
+    EventServer& operator=(const EventServer&) = delete;
+
+    // Ask run() to return; safe to call from any thread
+    void stop() {
+        running = false;
+#ifdef _WIN32
+        if (completionPort != NULL) wake();
+#else
+        wake();
+#endif
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.activeConnections = activeConnections;
+        stats.acceptedConnections = acceptedConnections;
+        stats.requests = requests;
+        stats.keepAliveRequests = keepAliveRequests;
+        stats.pipelinedRequests = pipelinedRequests;
+        stats.rejectedRequests = rejectedRequests;
+        stats.idleTimeouts = idleTimeouts;
+        stats.workers = pool.getStats();
+        return stats;
+    }
+};
+
+#endif // EVENTSERVER_H
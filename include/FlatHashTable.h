@@ -0,0 +1,308 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Flat (Open-Addressing) Hash Table Implementation
+ *
+ * Same interface as HashTable, with contiguous storage: entries live in
+ * one vector in insertion order, and a Robin Hood index of 8-byte slots
+ * (probe distance, 8-bit hash fingerprint, entry position) maps keys to
+ * them. A lookup touches one or two index cache lines and compares keys
+ * only when the fingerprint matches; iteration walks a dense array.
+ * Pointers returned by find() stay valid until the next insert or remove.
+ * Time Complexity: O(1) average for insert, lookup and remove
+ */
+
+#ifndef FLATHASHTABLE_H
+#define FLATHASHTABLE_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+// getMetrics() result, shared by every instantiation
+struct FlatHashTableMetrics {
+    size_t elementCount;
+    size_t slotCount;
+    float loadFactor;
+    size_t longestProbe;      // 1 = in its home slot
+    double avgProbeLength;
+    size_t displaced;         // entries not in their home slot
+    size_t memoryUsageBytes;
+};
+
+template <typename K, typename V>
+class FlatHashTable {
+private:
+    struct Entry {
+        K key;
+        V value;
+    };
+
+    // distAndFingerprint: (probe distance + 1) << 8 | fingerprint, 0 = empty
+    struct Slot {
+        uint32_t distAndFingerprint;
+        uint32_t entry;
+    };
+
+    static constexpr uint32_t DIST_INC = 1u << 8;
+    static constexpr uint32_t FINGERPRINT_MASK = DIST_INC - 1;
+    static constexpr size_t MIN_SLOTS = 16;
+
+    std::vector<Entry> entries;
+    std::vector<Slot> slots;   // power-of-two size
+    uint8_t shift;             // bucket = hash >> shift
+    float maxLoadFactor;
+
+    static uint64_t mix(uint64_t h) {
+        h *= 0x9E3779B97F4A7C15ULL;   // Fibonacci hashing: the high bits pick the bucket
+        return h ^ (h >> 29);
+    }
+
+    static uint64_t hashOf(const K& key) {
+        if constexpr (std::is_integral_v<K>) {
+            return mix(static_cast<uint64_t>(key));
+        } else if constexpr (std::is_same_v<K, std::string>) {
+            return mix(std::hash<std::string_view>{}(key));
+        } else {
+            return mix(std::hash<K>{}(key));
+        }
+    }
+
+    size_t bucketOf(uint64_t hash) const {
+        return static_cast<size_t>(hash >> shift);
+    }
+
+    size_t next(size_t slot) const {
+        return (slot + 1) & (slots.size() - 1);
+    }
+
+    // Slot holding key, or slots.size()
+    size_t findSlot(const K& key) const {
+        if (entries.empty()) return slots.size();
+        uint64_t hash = hashOf(key);
+        uint32_t distAndFingerprint = DIST_INC | static_cast<uint32_t>(hash & FINGERPRINT_MASK);
+        size_t slot = bucketOf(hash);
+        for (;;) {
+            const Slot& s = slots[slot];
+            if (s.distAndFingerprint == distAndFingerprint && entries[s.entry].key == key) return slot;
+            // Robin Hood: an entry closer to home than we are means key is absent
+            if (s.distAndFingerprint < distAndFingerprint) return slots.size();
+            distAndFingerprint += DIST_INC;
+            slot = next(slot);
+        }
+    }
+
+    // Index entries[entry] (not yet indexed); displaced slots move one further
+    void place(uint32_t entry) {
+        uint64_t hash = hashOf(entries[entry].key);
+        Slot carry{DIST_INC | static_cast<uint32_t>(hash & FINGERPRINT_MASK), entry};
+        size_t slot = bucketOf(hash);
+        while (slots[slot].distAndFingerprint >= carry.distAndFingerprint) {
+            carry.distAndFingerprint += DIST_INC;
+            slot = next(slot);
+        }
+        while (slots[slot].distAndFingerprint != 0) {
+            std::swap(carry, slots[slot]);
+            carry.distAndFingerprint += DIST_INC;
+            slot = next(slot);
+        }
+        slots[slot] = carry;
+    }
+
+    // Rebuild the index with numSlots slots; entries do not move
+    void rehash(size_t numSlots) {
+        uint8_t bits = 0;
+        while ((size_t(1) << bits) < numSlots) ++bits;
+        slots.assign(size_t(1) << bits, Slot{0, 0});
+        shift = static_cast<uint8_t>(64 - bits);
+        for (uint32_t i = 0; i < entries.size(); ++i) place(i);
+    }
+
+    size_t slotsFor(size_t count) const {
+        size_t numSlots = std::max(slots.size(), MIN_SLOTS);
+        while (static_cast<float>(count) > numSlots * maxLoadFactor) numSlots *= 2;
+        return numSlots;
+    }
+
+    // Append a new entry (key known to be absent) and index it
+    V& append(const K& key, const V& value) {
+        size_t numSlots = slotsFor(entries.size() + 1);
+        entries.push_back(Entry{key, value});
+        if (numSlots != slots.size()) {
+            rehash(numSlots);
+        } else {
+            place(static_cast<uint32_t>(entries.size() - 1));
+        }
+        return entries.back().value;
+    }
+
+public:
+    explicit FlatHashTable(size_t initialSize = MIN_SLOTS, float loadFactor = 0.8f)
+        : shift(0), maxLoadFactor(loadFactor) {
+        rehash(std::max(initialSize, MIN_SLOTS));
+    }
+
+    // Insert or update a key-value pair - O(1) average
+    void insert(const K& key, const V& value) {
+        size_t slot = findSlot(key);
+        if (slot != slots.size()) {
+            entries[slots[slot].entry].value = value;
+            return;
+        }
+        append(key, value);
+    }
+
+    // Size the index and the entry array once for count entries
+    void reserve(size_t count) {
+        entries.reserve(count);
+        size_t numSlots = slotsFor(count);
+        if (numSlots != slots.size()) rehash(numSlots);
+    }
+
+    // Pointer to the stored value, or nullptr - no copy
+    const V* find(const K& key) const {
+        size_t slot = findSlot(key);
+        return slot != slots.size() ? &entries[slots[slot].entry].value : nullptr;
+    }
+
+    V* find(const K& key) {
+        size_t slot = findSlot(key);
+        return slot != slots.size() ? &entries[slots[slot].entry].value : nullptr;
+    }
+
+    // Copy the value out - prefer find() on hot paths
+    bool search(const K& key, V* result = nullptr) const {
+        const V* value = find(key);
+        if (value && result) *result = *value;
+        return value != nullptr;
+    }
+
+    // Get value by key (throws if not found)
+    V& get(const K& key) {
+        V* value = find(key);
+        if (!value) throw std::runtime_error("Key not found in hash table");
+        return *value;
+    }
+
+    const V& get(const K& key) const {
+        const V* value = find(key);
+        if (!value) throw std::runtime_error("Key not found in hash table");
+        return *value;
+    }
+
+    // Operator[] for convenient access
+    V& operator[](const K& key) {
+        V* value = find(key);
+        return value ? *value : append(key, V());
+    }
+
+    // Remove a key; the last entry takes its place in the iteration order - O(1) average
+    bool remove(const K& key) {
+        size_t slot = findSlot(key);
+        if (slot == slots.size()) return false;
+        uint32_t entry = slots[slot].entry;
+
+        // Backward-shift deletion: pull following displaced slots one closer
+        for (size_t following = next(slot); slots[following].distAndFingerprint >= 2 * DIST_INC;
+             following = next(following)) {
+            slots[slot] = Slot{slots[following].distAndFingerprint - DIST_INC, slots[following].entry};
+            slot = following;
+        }
+        slots[slot] = Slot{0, 0};
+
+        uint32_t last = static_cast<uint32_t>(entries.size() - 1);
+        if (entry != last) {
+            size_t moved = findSlot(entries[last].key);
+            slots[moved].entry = entry;
+            entries[entry] = std::move(entries[last]);
+        }
+        entries.pop_back();
+        return true;
+    }
+
+    bool contains(const K& key) const { return findSlot(key) != slots.size(); }
+
+    size_t size() const { return entries.size(); }
+
+    bool isEmpty() const { return entries.empty(); }
+
+    float getLoadFactor() const {
+        return static_cast<float>(entries.size()) / slots.size();
+    }
+
+    // Longest probe sequence (1 = every key in its home slot)
+    size_t getMaxProbeLength() const {
+        uint32_t longest = 0;
+        for (const Slot& s : slots) longest = std::max(longest, s.distAndFingerprint >> 8);
+        return longest;
+    }
+
+    size_t memoryUsageBytes() const {
+        return entries.capacity() * sizeof(Entry) + slots.capacity() * sizeof(Slot);
+    }
+
+    // One pass over the index
+    FlatHashTableMetrics getMetrics() const {
+        FlatHashTableMetrics m;
+        m.elementCount = entries.size();
+        m.slotCount = slots.size();
+        m.loadFactor = getLoadFactor();
+        m.longestProbe = 0;
+        m.displaced = 0;
+        size_t totalProbe = 0;
+        for (const Slot& s : slots) {
+            uint32_t probe = s.distAndFingerprint >> 8;
+            if (probe > 1) m.displaced++;
+            m.longestProbe = std::max<size_t>(m.longestProbe, probe);
+            totalProbe += probe;
+        }
+        m.avgProbeLength = entries.empty() ? 0.0 : static_cast<double>(totalProbe) / entries.size();
+        m.memoryUsageBytes = memoryUsageBytes();
+        return m;
+    }
+
+    void clear() {
+        entries.clear();
+        std::fill(slots.begin(), slots.end(), Slot{0, 0});
+    }
+
+    std::vector<K> keys() const {
+        std::vector<K> result;
+        result.reserve(entries.size());
+        for (const Entry& e : entries) result.push_back(e.key);
+        return result;
+    }
+
+    std::vector<V> values() const {
+        std::vector<V> result;
+        result.reserve(entries.size());
+        for (const Entry& e : entries) result.push_back(e.value);
+        return result;
+    }
+
+    std::vector<std::pair<K, V>> getAll() const {
+        std::vector<std::pair<K, V>> result;
+        result.reserve(entries.size());
+        for (const Entry& e : entries) result.push_back({e.key, e.value});
+        return result;
+    }
+
+    // Visit entries in insertion order until visit(key, value) returns false
+    template <typename Visit>
+    void scan(Visit visit) const {
+        for (const Entry& e : entries) {
+            if (!visit(e.key, e.value)) return;
+        }
+    }
+
+    void forEach(std::function<void(const K&, V&)> callback) {
+        for (Entry& e : entries) callback(e.key, e.value);
+    }
+};
+
+#endif // FLATHASHTABLE_H
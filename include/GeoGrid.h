@@ -0,0 +1,215 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Geographic Grid Implementation
+ *
+ * Great-circle helpers and a uniform latitude/longitude grid.
+ * Cells are sized so that any two points closer than cellKm always fall
+ * in the same or adjacent cells, which turns "all pairs within r" into a
+ * 3x3 neighbourhood scan.
+ * Time Complexity: O(n log n) build, O(points in 3x3 cells) per lookup
+ */
+
+#ifndef GEOGRID_H
+#define GEOGRID_H
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+// ==================== GEOMETRY ====================
+
+// Geographic position (degrees)
+struct GeoPoint {
+    double latitude;
+    double longitude;
+
+    GeoPoint() : latitude(0), longitude(0) {}
+    GeoPoint(double lat, double lng) : latitude(lat), longitude(lng) {}
+};
+
+const double EARTH_RADIUS_KM = 6371.0;
+const double GEO_PI = 3.14159265358979323846;
+
+// Haversine great-circle distance in km.
+// Same operations as Junction::distanceTo, so results are bit-identical.
+inline double greatCircleKm(const GeoPoint& a, const GeoPoint& b) {
+    const double R = EARTH_RADIUS_KM;
+    double lat1 = a.latitude * GEO_PI / 180.0;
+    double lat2 = b.latitude * GEO_PI / 180.0;
+    double dLat = (b.latitude - a.latitude) * GEO_PI / 180.0;
+    double dLon = (b.longitude - a.longitude) * GEO_PI / 180.0;
+
+    double h = sin(dLat/2) * sin(dLat/2) +
+               cos(lat1) * cos(lat2) * sin(dLon/2) * sin(dLon/2);
+    double c = 2 * atan2(sqrt(h), sqrt(1-h));
+
+    return R * c;
+}
+
+// Convex hull (Andrew's monotone chain) in the lng/lat plane, counter-
+// clockwise from the lowest-longitude point; fine at city scale, where
+// the map projection barely bends straight lines. O(n log n)
+inline std::vector<GeoPoint> convexHull(std::vector<GeoPoint> points) {
+    std::sort(points.begin(), points.end(), [](const GeoPoint& a, const GeoPoint& b) {
+        return a.longitude < b.longitude ||
+               (a.longitude == b.longitude && a.latitude < b.latitude);
+    });
+    if (points.size() < 3) return points;
+
+    auto cross = [](const GeoPoint& o, const GeoPoint& a, const GeoPoint& b) {
+        return (a.longitude - o.longitude) * (b.latitude - o.latitude) -
+               (a.latitude - o.latitude) * (b.longitude - o.longitude);
+    };
+    std::vector<GeoPoint> hull(2 * points.size());
+    size_t k = 0;
+    for (size_t i = 0; i < points.size(); ++i) {                 // lower chain
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+        hull[k++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i > 0; --i) {   // upper chain
+        while (k >= lower && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) k--;
+        hull[k++] = points[i - 1];
+    }
+    hull.resize(k - 1);   // last point repeats the first
+    return hull;
+}
+
+// ==================== UNIFORM GRID ====================
+
+class GeoGrid {
+public:
+    struct Cell {
+        int64_t key;
+        uint32_t begin;          // range in the grouped index array
+        uint32_t end;
+        double minLat, maxLat;   // bounding box of the points in the cell
+        double minLng, maxLng;
+    };
+
+private:
+    double cellKm;
+    double cellLatDeg;
+    double cellLngDeg;
+    std::vector<uint32_t> order;                    // point indices grouped by cell
+    std::vector<Cell> cells;                        // sorted by key
+    std::unordered_map<int64_t, uint32_t> cellIndex; // key -> index into cells
+
+    static int64_t makeKey(int64_t cx, int64_t cy) {
+        return (cy << 32) | static_cast<uint32_t>(cx);
+    }
+
+public:
+    GeoGrid() : cellKm(0), cellLatDeg(0), cellLngDeg(0) {}
+
+    int64_t cellX(double longitude) const {
+        return static_cast<int64_t>(std::floor(longitude / cellLngDeg));
+    }
+
+    int64_t cellY(double latitude) const {
+        return static_cast<int64_t>(std::floor(latitude / cellLatDeg));
+    }
+
+    /**
+     * Bucket points into cells at least cellKm wide
+     * Latitude: 1 deg = R * pi / 180 km everywhere. Longitude: the width is
+     * chosen for the highest latitude present, where degrees are shortest.
+     */
+    void build(const std::vector<GeoPoint>& points, double minCellKm) {
+        clear();
+        cellKm = minCellKm;
+
+        double maxAbsLat = 0;
+        for (const GeoPoint& p : points) {
+            maxAbsLat = std::max(maxAbsLat, std::fabs(p.latitude));
+        }
+
+        const double margin = 1.0 + 1e-9;
+        cellLatDeg = (cellKm / EARTH_RADIUS_KM) * 180.0 / GEO_PI * margin;
+        double c = cos(maxAbsLat * GEO_PI / 180.0);
+        double s = sin(cellKm / (2 * EARTH_RADIUS_KM));
+        cellLngDeg = (c <= s) ? 360.0 : 2 * asin(s / c) * 180.0 / GEO_PI * margin;
+
+        std::vector<std::pair<int64_t, uint32_t>> keyed(points.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            keyed[i] = {makeKey(cellX(points[i].longitude), cellY(points[i].latitude)),
+                        static_cast<uint32_t>(i)};
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        order.resize(keyed.size());
+        for (size_t i = 0; i < keyed.size(); ++i) {
+            order[i] = keyed[i].second;
+            const GeoPoint& p = points[keyed[i].second];
+            if (cells.empty() || cells.back().key != keyed[i].first) {
+                cells.push_back({keyed[i].first, static_cast<uint32_t>(i), static_cast<uint32_t>(i),
+                                 p.latitude, p.latitude, p.longitude, p.longitude});
+            }
+            Cell& cell = cells.back();
+            cell.end = static_cast<uint32_t>(i + 1);
+            cell.minLat = std::min(cell.minLat, p.latitude);
+            cell.maxLat = std::max(cell.maxLat, p.latitude);
+            cell.minLng = std::min(cell.minLng, p.longitude);
+            cell.maxLng = std::max(cell.maxLng, p.longitude);
+        }
+
+        cellIndex.reserve(cells.size());
+        for (size_t i = 0; i < cells.size(); ++i) {
+            cellIndex[cells[i].key] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Visit every point in the 3x3 block of cells around p: visit(pointIndex)
+    template <typename Visit>
+    void forEachNear(const GeoPoint& p, Visit visit) const {
+        int64_t cx = cellX(p.longitude);
+        int64_t cy = cellY(p.latitude);
+        for (int64_t y = cy - 1; y <= cy + 1; ++y) {
+            for (int64_t x = cx - 1; x <= cx + 1; ++x) {
+                auto it = cellIndex.find(makeKey(x, y));
+                if (it == cellIndex.end()) continue;
+                const Cell& cell = cells[it->second];
+                for (uint32_t k = cell.begin; k < cell.end; ++k) {
+                    visit(order[k]);
+                }
+            }
+        }
+    }
+
+    /**
+     * Lower bound on the great-circle distance between any point of a and
+     * any point of b, from their bounding boxes:
+     * hav(d) = hav(dLat) + cos(lat1) cos(lat2) hav(dLng)
+     */
+    static double lowerBoundKm(const Cell& a, const Cell& b) {
+        double dLat = std::max(0.0, std::max(a.minLat - b.maxLat, b.minLat - a.maxLat));
+        double dLng = std::max(0.0, std::max(a.minLng - b.maxLng, b.minLng - a.maxLng));
+        if (dLat == 0 && dLng == 0) return 0;
+
+        double cosA = cos(std::max(std::fabs(a.minLat), std::fabs(a.maxLat)) * GEO_PI / 180.0);
+        double cosB = cos(std::max(std::fabs(b.minLat), std::fabs(b.maxLat)) * GEO_PI / 180.0);
+        double sLat = sin(dLat * GEO_PI / 360.0);
+        double sLng = sin(dLng * GEO_PI / 360.0);
+        double h = std::min(1.0, sLat * sLat + cosA * cosB * sLng * sLng);
+        return 2 * EARTH_RADIUS_KM * asin(sqrt(h)) * (1.0 - 1e-9);
+    }
+
+    const std::vector<Cell>& getCells() const { return cells; }
+    const std::vector<uint32_t>& getOrder() const { return order; }
+    double getCellKm() const { return cellKm; }
+    size_t size() const { return order.size(); }
+
+    size_t memoryUsageBytes() const {
+        return order.capacity() * sizeof(uint32_t) + cells.capacity() * sizeof(Cell) +
+               cellIndex.size() * (sizeof(int64_t) + sizeof(uint32_t) + sizeof(void*) * 2);
+    }
+
+    void clear() {
+        order.clear();
+        cells.clear();
+        cellIndex.clear();
+    }
+};
+
+#endif // GEOGRID_H
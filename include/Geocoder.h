@@ -0,0 +1,527 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Geocoder Implementation
+ *
+ * Nominatim (OpenStreetMap) lookups for smart search misses, off the
+ * request path. lookup() returns a shared_future at once; one worker
+ * thread sends the queued queries in order, at most one request per
+ * second (Nominatim's usage policy), over a single connection it keeps
+ * open between requests. A query that is already queued or in flight is
+ * not sent again: later callers share its future.
+ *
+ * Answers are kept in a B-Tree keyed by query and city. Places that were
+ * found are also appended to a cache file, which load() reads back at
+ * startup, so a restart does not ask Nominatim again; "not found" is
+ * remembered until the process exits. Transport errors are not cached.
+ * Geocoded places get junction IDs above every ID reserveIds() was told
+ * about (the loaded data set); cached places that collide are renumbered.
+ *
+ * The transport is WinHTTP; builds without it answer from the cache only.
+ */
+
+#ifndef GEOCODER_H
+#define GEOCODER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
+#include <set>
+#include "BTree.h"
+#include "Metrics.h"
+#include "Models.h"
+
+#ifdef _WIN32
+    #include <winsock2.h>   // before windows.h, which would pull in the old winsock.h
+    #include <windows.h>
+    #include <winhttp.h>
+    #pragma comment(lib, "winhttp.lib")
+#endif
+
+// Nominatim API Configuration (OpenStreetMap - FREE)
+const std::wstring NOMINATIM_HOST = L"nominatim.openstreetmap.org";
+const std::wstring USER_AGENT = L"TrafficOptimizer/1.0 (contact@example.com)";
+
+struct GeocodeResult {
+    bool found = false;
+    Junction junction;   // when found
+};
+
+enum class GeocodeStatus { FOUND, NOT_FOUND, PENDING };
+
+class Geocoder {
+public:
+    static constexpr int FIRST_JUNCTION_ID = 10000;   // lowest geocoded junction ID
+    static constexpr size_t MAX_QUEUED = 256;          // lookups beyond this are answered "not found"
+
+    struct Stats {
+        size_t cachedAnswers;      // found and not found
+        size_t queueDepth;         // waiting for the worker
+        uint64_t cacheHits;
+        uint64_t coalesced;        // joined a lookup already queued or in flight
+        uint64_t requests;         // sent to Nominatim
+        uint64_t failures;         // transport or HTTP errors (asked again next time)
+        uint64_t dropped;          // queue full
+        bool online;               // a transport is compiled in
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Lookup {
+        std::string key;
+        std::string query;
+        std::string city;
+        std::promise<GeocodeResult> done;
+    };
+
+    static constexpr std::chrono::milliseconds MIN_REQUEST_INTERVAL{1000};
+
+    // Guarded by mutex
+    BTree<std::string, GeocodeResult> cache;
+    std::deque<Lookup> queue;
+    std::map<std::string, std::shared_future<GeocodeResult>> inFlight;   // queued or being fetched
+    std::string cacheFile;
+    int nextJunctionId;
+    int lastReservedId;    // highest ID taken by junctions outside the geocoder
+    int lowestPlaceId;     // smallest ID among cached places, INT_MAX if none
+    bool stopping;
+    uint64_t cacheHits;
+    uint64_t coalesced;
+    uint64_t requests;
+    uint64_t failures;
+    uint64_t dropped;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::thread worker;   // started by the first lookup
+
+    // Worker thread only
+    Clock::time_point nextRequestAt;
+#ifdef _WIN32
+    HINTERNET session;
+    HINTERNET connection;
+#endif
+
+    static std::string cacheKey(const std::string& query, const std::string& city) {
+        return query + "_" + city;
+    }
+
+    static std::shared_future<GeocodeResult> ready(const GeocodeResult& result) {
+        std::promise<GeocodeResult> done;
+        done.set_value(result);
+        return done.get_future().share();
+    }
+
+    // URL Encode
+    static std::string urlEncode(const std::string& str) {
+        std::ostringstream escaped;
+        escaped.fill('0');
+        escaped << std::hex;
+
+        for (char c : str) {
+            if (isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_' || c == '.' || c == '~') {
+                escaped << c;
+            } else if (c == ' ') {
+                escaped << '+';
+            } else {
+                escaped << '%' << std::setw(2) << int((unsigned char)c);
+            }
+        }
+        return escaped.str();
+    }
+
+    // Search path for a query: city names dropped from the text, the city
+    // and country added as context
+    static std::string searchPath(const std::string& query, const std::string& city) {
+        std::string searchQuery = query;
+        std::string lowerQuery = query;
+        std::transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
+
+        // Remove common words that confuse Nominatim
+        const char* removeWords[] = {"lahore", "karachi", "islamabad", "pakistan"};
+        for (const char* word : removeWords) {
+            size_t pos = lowerQuery.find(word);
+            if (pos != std::string::npos) {
+                size_t length = std::char_traits<char>::length(word);
+                searchQuery.erase(pos, length);
+                lowerQuery.erase(pos, length);
+            }
+        }
+
+        // Trim spaces
+        searchQuery.erase(0, searchQuery.find_first_not_of(" "));
+        searchQuery.erase(searchQuery.find_last_not_of(" ") + 1);
+
+        if (!city.empty()) searchQuery += " " + city;
+        searchQuery += " Pakistan";
+        return "/search?q=" + urlEncode(searchQuery) + "&format=json&limit=1&countrycodes=pk";
+    }
+
+    // First place in a Nominatim JSON answer; false for an empty list.
+    // The junction is named after the query and has no ID yet.
+    static bool parseResponse(const std::string& jsonResponse, const std::string& searchQuery, Junction* out) {
+        if (jsonResponse.empty() || jsonResponse[0] != '[') return false;
+
+        size_t latPos = jsonResponse.find("\"lat\":");
+        size_t lonPos = jsonResponse.find("\"lon\":");
+        size_t namePos = jsonResponse.find("\"display_name\":");
+        if (latPos == std::string::npos || lonPos == std::string::npos) return false;
+
+        // "lat":"31.5" and "lon":"74.3" - quoted numbers
+        double lat = std::strtod(jsonResponse.c_str() + latPos + 7, nullptr);
+        double lon = std::strtod(jsonResponse.c_str() + lonPos + 7, nullptr);
+
+        std::string displayName = searchQuery;
+        if (namePos != std::string::npos) {
+            namePos += 16;
+            size_t nameEnd = jsonResponse.find("\"", namePos);
+            displayName = jsonResponse.substr(namePos, nameEnd - namePos);
+        }
+
+        // Extract city from display name
+        std::string city = "Unknown";
+        const char* cities[] = {"Lahore", "Karachi", "Islamabad", "Rawalpindi", "Faisalabad", "Multan"};
+        for (const char* c : cities) {
+            if (displayName.find(c) != std::string::npos) {
+                city = c;
+                break;
+            }
+        }
+
+        std::string area = "Central";
+        const char* areas[] = {"Gulberg", "Defence", "Model Town", "Johar Town", "Garden Town",
+                               "Township", "Anarkali", "Cantt", "Saddar", "PECHS"};
+        for (const char* a : areas) {
+            if (displayName.find(a) != std::string::npos) {
+                area = a;
+                break;
+            }
+        }
+
+        *out = Junction(0, searchQuery, lat, lon, city, area);
+        out->geocoded = true;
+        return true;
+    }
+
+#ifdef _WIN32
+    static std::wstring toWide(const std::string& str) {
+        if (str.empty()) return std::wstring();
+        int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, NULL, 0);
+        std::wstring wstr(size, 0);
+        MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &wstr[0], size);
+        return wstr;
+    }
+
+    void closeConnection() {
+        if (connection) WinHttpCloseHandle(connection);
+        if (session) WinHttpCloseHandle(session);
+        connection = session = NULL;
+    }
+#endif
+
+    // GET path from Nominatim over the kept-open connection; false on a
+    // transport error or a status other than 200
+    bool httpGet(const std::string& path, std::string* body) {
+#ifdef _WIN32
+        if (!session) {
+            session = WinHttpOpen(USER_AGENT.c_str(), WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+                                  WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+            if (session) connection = WinHttpConnect(session, NOMINATIM_HOST.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0);
+            if (!connection) {
+                std::cerr << "❌ WinHTTP connect failed" << std::endl;
+                closeConnection();
+                return false;
+            }
+        }
+
+        // Requests on one connect handle reuse its keep-alive connection
+        std::wstring wPath = toWide(path);
+        HINTERNET request = WinHttpOpenRequest(connection, L"GET", wPath.c_str(), NULL, WINHTTP_NO_REFERER,
+                                               WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE);
+        bool ok = request &&
+                  WinHttpSendRequest(request, WINHTTP_NO_ADDITIONAL_HEADERS, 0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0) &&
+                  WinHttpReceiveResponse(request, NULL);
+
+        DWORD status = 0;
+        DWORD statusSize = sizeof(status);
+        if (ok) {
+            ok = WinHttpQueryHeaders(request, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                                     WINHTTP_HEADER_NAME_BY_INDEX, &status, &statusSize, WINHTTP_NO_HEADER_INDEX) &&
+                 status == 200;
+        }
+
+        std::vector<char> buffer;
+        DWORD available = 0;
+        while (ok && WinHttpQueryDataAvailable(request, &available) && available > 0) {
+            buffer.resize(available);
+            DWORD read = 0;
+            if (!WinHttpReadData(request, buffer.data(), available, &read)) {
+                ok = false;
+                break;
+            }
+            body->append(buffer.data(), read);
+        }
+        if (request) WinHttpCloseHandle(request);
+
+        if (!ok) {
+            std::cerr << "❌ Nominatim request failed" << (status ? " (HTTP " + std::to_string(status) + ")" : "")
+                      << std::endl;
+            closeConnection();   // start over on the next request
+        }
+        return ok;
+#else
+        (void)path;
+        (void)body;
+        return false;
+#endif
+    }
+
+    static constexpr bool online() {
+#ifdef _WIN32
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Tabs and line breaks would split a cache file record
+    static std::string fileField(const std::string& text) {
+        std::string field = text;
+        std::replace_if(field.begin(), field.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+        return field;
+    }
+
+    // key, id, name, latitude, longitude, city, area (caller holds mutex)
+    void appendToFile(const std::string& key, const Junction& j) {
+        if (cacheFile.empty()) return;
+        std::ofstream out(cacheFile, std::ios::app);
+        writeRecord(out, key, j);
+        if (!out) std::cerr << "⚠️  Could not write " << cacheFile << std::endl;
+    }
+
+    void writeRecord(std::ofstream& out, const std::string& key, const Junction& j) {
+        out << std::fixed << std::setprecision(7) << fileField(key) << '\t' << j.id << '\t' << fileField(j.name)
+            << '\t' << j.latitude << '\t' << j.longitude << '\t' << fileField(j.city) << '\t' << fileField(j.area)
+            << '\n';
+    }
+
+    // All cached places, written to a temporary file and renamed into place
+    // (caller holds mutex)
+    void rewriteFile() {
+        if (cacheFile.empty()) return;
+        std::string temporary = cacheFile + ".tmp";
+        bool ok;
+        {
+            std::ofstream out(temporary, std::ios::trunc);
+            for (const auto& entry : cache.getAll()) {
+                if (entry.second.found) writeRecord(out, entry.first, entry.second.junction);
+            }
+            ok = static_cast<bool>(out);
+        }
+        if (ok) {
+            std::remove(cacheFile.c_str());   // rename() does not replace on Windows
+            ok = std::rename(temporary.c_str(), cacheFile.c_str()) == 0;
+        }
+        if (!ok) std::cerr << "⚠️  Could not write " << cacheFile << std::endl;
+    }
+
+    /**
+     * Give every cached place whose ID is lastReservedId or below, or is
+     * shared with another place, a fresh ID, and rewrite the cache file if
+     * any moved (caller holds mutex). force checks for shared IDs even when
+     * all places are above lastReservedId.
+     */
+    void renumberPlaces(bool force) {
+        nextJunctionId = std::max(nextJunctionId, lastReservedId + 1);
+        if (!force && lastReservedId < lowestPlaceId) return;
+
+        std::set<int> taken;
+        bool moved = false;
+        lowestPlaceId = INT_MAX;
+        for (const auto& entry : cache.getAll()) {
+            if (!entry.second.found) continue;
+            GeocodeResult* place = cache.find(entry.first);
+            if (place->junction.id <= lastReservedId || !taken.insert(place->junction.id).second) {
+                place->junction.id = nextJunctionId++;
+                taken.insert(place->junction.id);
+                moved = true;
+            }
+            lowestPlaceId = std::min(lowestPlaceId, place->junction.id);
+        }
+        if (moved) rewriteFile();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            available.wait(lock, [this]() { return stopping || !queue.empty(); });
+            // Nominatim allows one request per second
+            if (available.wait_until(lock, nextRequestAt, [this]() { return stopping; })) break;
+
+            Lookup lookup = std::move(queue.front());
+            queue.pop_front();
+            requests++;
+            lock.unlock();
+
+            std::cout << "🌍 Searching Nominatim for: " << lookup.query
+                      << (lookup.city.empty() ? "" : " (" + lookup.city + ")") << std::endl;
+            Metrics::Timer timer(Metric::GEOCODE_REQUEST);
+            std::string response;
+            bool answered = httpGet(searchPath(lookup.query, lookup.city), &response);
+            timer.stop();
+            GeocodeResult result;
+            if (answered) result.found = parseResponse(response, lookup.query, &result.junction);
+
+            lock.lock();
+            nextRequestAt = Clock::now() + MIN_REQUEST_INTERVAL;
+            if (!answered) {
+                failures++;
+            } else {
+                if (result.found) {
+                    result.junction.id = nextJunctionId++;
+                    lowestPlaceId = std::min(lowestPlaceId, result.junction.id);
+                    appendToFile(lookup.key, result.junction);
+                    std::cout << "✅ Found via Nominatim: " << result.junction.name << " at ("
+                              << result.junction.latitude << ", " << result.junction.longitude << ")" << std::endl;
+                }
+                cache.insert(lookup.key, result);
+            }
+            inFlight.erase(lookup.key);
+            lookup.done.set_value(result);
+        }
+
+        // Shutting down: answer everyone still waiting
+        for (Lookup& lookup : queue) lookup.done.set_value(GeocodeResult());
+        queue.clear();
+        inFlight.clear();
+    }
+
+public:
+    Geocoder()
+        : nextJunctionId(FIRST_JUNCTION_ID), lastReservedId(FIRST_JUNCTION_ID - 1), lowestPlaceId(INT_MAX),
+          stopping(false), cacheHits(0), coalesced(0), requests(0),
+          failures(0), dropped(0), nextRequestAt(Clock::now()) {
+#ifdef _WIN32
+        session = connection = NULL;
+#endif
+    }
+
+    ~Geocoder() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        if (worker.joinable()) worker.join();
+#ifdef _WIN32
+        closeConnection();
+#endif
+    }
+
+    Geocoder(const Geocoder&) = delete;
+    Geocoder& operator=(const Geocoder&) = delete;
+
+    /**
+     * Read the places found by earlier runs from path and append new ones
+     * to it from now on. A missing file is an empty cache; the last record
+     * for a query wins. Places whose ID is reserved or used twice are
+     * renumbered (and the file rewritten). Returns the number of records read.
+     */
+    size_t load(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheFile = path;
+        std::ifstream in(path);
+        size_t loaded = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::vector<std::string> fields;
+            std::istringstream record(line);
+            std::string field;
+            while (std::getline(record, field, '\t')) fields.push_back(field);
+            if (fields.size() != 7) continue;
+
+            GeocodeResult result;
+            result.found = true;
+            result.junction = Junction(std::atoi(fields[1].c_str()), fields[2], std::strtod(fields[3].c_str(), nullptr),
+                                       std::strtod(fields[4].c_str(), nullptr), fields[5], fields[6]);
+            result.junction.geocoded = true;
+            nextJunctionId = std::max(nextJunctionId, result.junction.id + 1);
+            cache.insert(fields[0], result);
+            loaded++;
+        }
+        renumberPlaces(true);
+        return loaded;
+    }
+
+    /**
+     * IDs up to lastUsed belong to junctions from elsewhere (the data set,
+     * a snapshot, manual additions): geocoded places are numbered above
+     * them, and cached places below are renumbered.
+     */
+    void reserveIds(int lastUsed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastUsed <= lastReservedId) return;
+        lastReservedId = lastUsed;
+        renumberPlaces(false);
+    }
+
+    /**
+     * The answer for query in city: ready at once from the cache, otherwise
+     * once the worker has asked Nominatim. Never blocks on the network.
+     */
+    std::shared_future<GeocodeResult> lookup(const std::string& query, const std::string& city) {
+        std::string key = cacheKey(query, city);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const GeocodeResult* cached = cache.find(key)) {
+            cacheHits++;
+            return ready(*cached);
+        }
+        auto pending = inFlight.find(key);
+        if (pending != inFlight.end()) {
+            coalesced++;
+            return pending->second;
+        }
+        if (!online() || stopping) return ready(GeocodeResult());
+        if (queue.size() >= MAX_QUEUED) {
+            dropped++;
+            return ready(GeocodeResult());
+        }
+
+        std::promise<GeocodeResult> done;
+        std::shared_future<GeocodeResult> future = done.get_future().share();
+        queue.push_back(Lookup{key, query, city, std::move(done)});
+        inFlight.emplace(key, future);
+        if (!worker.joinable()) worker = std::thread(&Geocoder::run, this);
+        available.notify_one();
+        return future;
+    }
+
+    // Roughly how long a lookup queued now waits for its answer
+    std::chrono::milliseconds estimatedWait() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return MIN_REQUEST_INTERVAL * static_cast<int>(queue.size() + 1);
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return Stats{cache.size(), queue.size(), cacheHits, coalesced, requests, failures, dropped, online()};
+    }
+};
+
+#endif // GEOCODER_H
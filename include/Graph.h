@@ -1,21 +1,47 @@
 /**
  * Smart Traffic Route Optimizer
  * Graph with Dijkstra's Algorithm Implementation
- * 
+ *
  * Weighted directed graph for road network
  * Shortest path calculation with traffic multipliers
  * Time Complexity: O((V+E) log V) with min-heap
+ *
+ * The graph is built through an adjacency list and then frozen into a
+ * compressed sparse row (CSR) layout: dense vertex indices, contiguous
+ * offset/target/weight arrays and road names interned in a string table.
+ * All path queries run on the frozen form, using a per-thread
+ * SearchWorkspace so steady-state queries do not allocate.
+ * An optional RouteHierarchy answers inter-city queries from precomputed
+ * portal trees.
  */
 
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <limits>
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 #include "MinHeap.h"
+#include "StringTable.h"
+#include "RouteArena.h"
+#include "SearchWorkspace.h"
+#include "WorkerPool.h"
+#include "RouteHierarchy.h"
+#include "GeoGrid.h"
+#include "TrafficProfile.h"
+#include "Snapshot.h"
 
 struct Edge {
     int destination;
@@ -23,10 +49,11 @@ struct Edge {
     double baseTime;     // base travel time in minutes
     double trafficMultiplier; // 1.0 = normal, 2.0 = heavy traffic
     std::string roadName;
+    uint16_t profile;    // time-of-day profile, TrafficProfileTable::NONE for none
 
     Edge(int dest, double dist, double time, const std::string& name = "")
-        : destination(dest), distance(dist), baseTime(time), 
-          trafficMultiplier(1.0), roadName(name) {}
+        : destination(dest), distance(dist), baseTime(time),
+          trafficMultiplier(1.0), roadName(name), profile(TrafficProfileTable::NONE) {}
 
     // Get actual travel time considering traffic
     double getActualTime() const {
@@ -34,34 +61,741 @@ struct Edge {
     }
 };
 
+// Read-only view of one edge in the frozen graph
+struct EdgeView {
+    int destination;          // junction ID
+    double distance;
+    double baseTime;
+    double trafficMultiplier;
+    std::string_view roadName;
+    uint32_t index;           // position in the CSR edge arrays
+
+    EdgeView() : destination(0), distance(0), baseTime(0),
+                 trafficMultiplier(1.0), index(0) {}
+
+    double getActualTime() const {
+        return baseTime * trafficMultiplier;
+    }
+};
+
+// Shortest path search strategy
+enum class RouteAlgorithm {
+    DIJKSTRA,            // Unidirectional Dijkstra
+    ASTAR,               // A* with great-circle lower bound
+    BIDIRECTIONAL,       // Bidirectional Dijkstra
+    BIDIRECTIONAL_ASTAR, // Bidirectional A* (average potentials)
+    HIERARCHY            // Portal hierarchy, Dijkstra inside one city
+};
+
+inline std::string routeAlgorithmToString(RouteAlgorithm algorithm) {
+    switch (algorithm) {
+        case RouteAlgorithm::DIJKSTRA: return "dijkstra";
+        case RouteAlgorithm::ASTAR: return "astar";
+        case RouteAlgorithm::BIDIRECTIONAL: return "bidijkstra";
+        case RouteAlgorithm::BIDIRECTIONAL_ASTAR: return "biastar";
+        case RouteAlgorithm::HIERARCHY: return "ch";
+        default: return "unknown";
+    }
+}
+
+// Parse the name used by /api/route?algo=
+inline bool parseRouteAlgorithm(const std::string& name, RouteAlgorithm* result) {
+    if (name == "dijkstra") {
+        *result = RouteAlgorithm::DIJKSTRA;
+    } else if (name == "astar") {
+        *result = RouteAlgorithm::ASTAR;
+    } else if (name == "bidijkstra" || name == "bidirectional") {
+        *result = RouteAlgorithm::BIDIRECTIONAL;
+    } else if (name == "biastar") {
+        *result = RouteAlgorithm::BIDIRECTIONAL_ASTAR;
+    } else if (name == "ch" || name == "hierarchy") {
+        *result = RouteAlgorithm::HIERARCHY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 struct PathResult {
     std::vector<int> path;
+    std::vector<double> legTimes;   // per-hop minutes (time-dependent search only)
     double totalDistance;
     double totalTime;
     bool found;
+    int settledNodes;    // vertices taken off the priority queue(s)
+    RouteAlgorithm algorithm; // search that produced the result
+
+    PathResult() : totalDistance(0), totalTime(0), found(false), settledNodes(0),
+                   algorithm(RouteAlgorithm::DIJKSTRA) {}
+};
+
+// Many-to-many costs, row-major: cell i * numTargets + j is sources[i] -> targets[j]
+struct MatrixResult {
+    size_t numSources;
+    size_t numTargets;
+    std::vector<double> times;       // infinity where unreachable
+    std::vector<double> distances;
+    size_t settledNodes;             // summed over all sources
+
+    MatrixResult() : numSources(0), numTargets(0), settledNodes(0) {}
+};
 
-    PathResult() : totalDistance(0), totalTime(0), found(false) {}
+// Junction within a travel budget, with the cost of reaching it
+struct ReachableJunction {
+    int id;
+    double time;
+    double distance;
+};
+
+/**
+ * Compressed Sparse Row road network
+ * Out-edges of dense vertex v are [offsets[v], offsets[v+1])
+ * In-edges of v are reverseEdges[reverseOffsets[v], reverseOffsets[v+1]),
+ * stored as forward edge indices so weights are shared with the forward graph
+ */
+class CSRGraph {
+private:
+    std::vector<int> vertexIds;                 // dense index -> junction ID
+    std::unordered_map<int, int> denseIndex;    // junction ID -> dense index
+    std::vector<uint32_t> offsets;              // size V + 1
+    std::vector<int> targets;                   // dense target index per edge
+    std::vector<double> distances;
+    std::vector<double> baseTimes;
+    std::vector<double> trafficMultipliers;
+    std::vector<uint32_t> nameIds;              // index into roadNames
+    std::vector<uint16_t> profileIds;           // time-of-day profile per edge
+    StringTable roadNames;
+
+    // Reverse (incoming) adjacency
+    std::vector<uint32_t> reverseOffsets;       // size V + 1
+    std::vector<uint32_t> reverseEdges;         // forward edge index
+    std::vector<int> reverseSources;            // dense source of that edge
+
+    // Vertex positions for goal-directed search
+    struct UnitVector { double x, y, z; };
+    std::vector<GeoPoint> locations;
+    std::vector<UnitVector> directions;         // position on the unit sphere
+    std::vector<bool> located;
+    double distancePerKm;      // min over edges of distance / great-circle km
+    double baseTimePerKm;      // min over edges of baseTime / great-circle km
+    double minMultiplier;      // smallest traffic multiplier present
+
+    void buildReverse() {
+        size_t n = vertexIds.size();
+        reverseOffsets.assign(n + 1, 0);
+        for (int t : targets) {
+            reverseOffsets[t + 1]++;
+        }
+        for (size_t v = 0; v < n; ++v) {
+            reverseOffsets[v + 1] += reverseOffsets[v];
+        }
+
+        reverseEdges.resize(targets.size());
+        reverseSources.resize(targets.size());
+        std::vector<uint32_t> next(reverseOffsets.begin(), reverseOffsets.end() - 1);
+        for (size_t u = 0; u < n; ++u) {
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                uint32_t slot = next[targets[e]]++;
+                reverseEdges[slot] = e;
+                reverseSources[slot] = static_cast<int>(u);
+            }
+        }
+    }
+
+    static UnitVector toUnitVector(const GeoPoint& p) {
+        const double toRad = 3.14159265358979323846 / 180.0;
+        double lat = p.latitude * toRad;
+        double lng = p.longitude * toRad;
+        return { cos(lat) * cos(lng), cos(lat) * sin(lng), sin(lat) };
+    }
+
+    // Cost per great-circle km lower bounds; 0 disables the heuristic
+    void calibrateBounds() {
+        const double INF = std::numeric_limits<double>::infinity();
+        distancePerKm = INF;
+        baseTimePerKm = INF;
+        minMultiplier = 1.0;
+
+        for (size_t u = 0; u < vertexIds.size(); ++u) {
+            for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                minMultiplier = std::min(minMultiplier, trafficMultipliers[e]);
+                int v = targets[e];
+                if (!located[u] || !located[v]) {
+                    distancePerKm = 0;
+                    baseTimePerKm = 0;
+                    continue;
+                }
+                double km = greatCircleKm(locations[u], locations[v]);
+                if (km <= 0) continue;
+                distancePerKm = std::min(distancePerKm, distances[e] / km);
+                baseTimePerKm = std::min(baseTimePerKm, baseTimes[e] / km);
+            }
+        }
+
+        if (distancePerKm == INF) distancePerKm = 0;
+        if (baseTimePerKm == INF) baseTimePerKm = 0;
+        // Guard against rounding in the triangle inequality
+        distancePerKm *= 1.0 - 1e-9;
+        baseTimePerKm *= 1.0 - 1e-9;
+    }
+
+public:
+    CSRGraph() : offsets(1, 0), reverseOffsets(1, 0),
+                 distancePerKm(0), baseTimePerKm(0), minMultiplier(1.0) {}
+
+    // Build from adjacency lists; vertices are numbered in ascending ID order
+    void build(const std::unordered_map<int, std::vector<Edge>>& adjacency,
+               const std::unordered_map<int, GeoPoint>& positions) {
+        clear();
+
+        vertexIds.reserve(adjacency.size());
+        for (const auto& pair : adjacency) {
+            vertexIds.push_back(pair.first);
+        }
+        std::sort(vertexIds.begin(), vertexIds.end());
+
+        denseIndex.reserve(vertexIds.size());
+        for (size_t i = 0; i < vertexIds.size(); ++i) {
+            denseIndex[vertexIds[i]] = static_cast<int>(i);
+        }
+
+        size_t edgeCount = 0;
+        for (const auto& pair : adjacency) {
+            edgeCount += pair.second.size();
+        }
+        offsets.reserve(vertexIds.size() + 1);
+        targets.reserve(edgeCount);
+        distances.reserve(edgeCount);
+        baseTimes.reserve(edgeCount);
+        trafficMultipliers.reserve(edgeCount);
+        nameIds.reserve(edgeCount);
+        profileIds.reserve(edgeCount);
+
+        for (int id : vertexIds) {
+            for (const Edge& edge : adjacency.at(id)) {
+                targets.push_back(denseIndex.at(edge.destination));
+                distances.push_back(edge.distance);
+                baseTimes.push_back(edge.baseTime);
+                trafficMultipliers.push_back(edge.trafficMultiplier);
+                nameIds.push_back(roadNames.intern(edge.roadName));
+                profileIds.push_back(edge.profile);
+            }
+            offsets.push_back(static_cast<uint32_t>(targets.size()));
+        }
+
+        locations.resize(vertexIds.size());
+        directions.resize(vertexIds.size(), UnitVector{0, 0, 0});
+        located.resize(vertexIds.size(), false);
+        for (size_t i = 0; i < vertexIds.size(); ++i) {
+            auto it = positions.find(vertexIds[i]);
+            if (it != positions.end()) {
+                locations[i] = it->second;
+                directions[i] = toUnitVector(it->second);
+                located[i] = true;
+            }
+        }
+
+        buildReverse();
+        calibrateBounds();
+    }
+
+    // Append an isolated vertex without rebuilding
+    void appendVertex(int id, const GeoPoint* position = nullptr) {
+        denseIndex[id] = static_cast<int>(vertexIds.size());
+        vertexIds.push_back(id);
+        offsets.push_back(offsets.back());
+        reverseOffsets.push_back(reverseOffsets.back());
+        locations.push_back(position ? *position : GeoPoint());
+        directions.push_back(position ? toUnitVector(*position) : UnitVector{0, 0, 0});
+        located.push_back(position != nullptr);
+    }
+
+    // Map junction ID to dense index
+    bool indexOf(int id, int* index) const {
+        auto it = denseIndex.find(id);
+        if (it == denseIndex.end()) return false;
+        *index = it->second;
+        return true;
+    }
+
+    int idOf(int index) const { return vertexIds[index]; }
+
+    // Position of dense vertex v; false if it has none
+    bool position(int v, GeoPoint* result) const {
+        if (!located[v]) return false;
+        *result = locations[v];
+        return true;
+    }
+
+    int numVertices() const { return static_cast<int>(vertexIds.size()); }
+    size_t numEdges() const { return targets.size(); }
+
+    uint32_t edgeBegin(int v) const { return offsets[v]; }
+    uint32_t edgeEnd(int v) const { return offsets[v + 1]; }
+
+    // Incoming edges of v: slots [reverseBegin(v), reverseEnd(v))
+    uint32_t reverseBegin(int v) const { return reverseOffsets[v]; }
+    uint32_t reverseEnd(int v) const { return reverseOffsets[v + 1]; }
+    uint32_t reverseEdge(uint32_t slot) const { return reverseEdges[slot]; }
+    int reverseSource(uint32_t slot) const { return reverseSources[slot]; }
+
+    int target(uint32_t e) const { return targets[e]; }
+    double distance(uint32_t e) const { return distances[e]; }
+    double baseTime(uint32_t e) const { return baseTimes[e]; }
+    double trafficMultiplier(uint32_t e) const { return trafficMultipliers[e]; }
+    double actualTime(uint32_t e) const { return baseTimes[e] * trafficMultipliers[e]; }
+    std::string_view roadName(uint32_t e) const { return roadNames.get(nameIds[e]); }
+    uint16_t profile(uint32_t e) const { return profileIds[e]; }
+    void setProfile(uint32_t e, uint16_t profile) { profileIds[e] = profile; }
+
+    // Cost of an edge under the chosen metric
+    double cost(uint32_t e, bool useTime) const {
+        return useTime ? actualTime(e) : distances[e];
+    }
+
+    EdgeView view(uint32_t e) const {
+        EdgeView v;
+        v.destination = vertexIds[targets[e]];
+        v.distance = distances[e];
+        v.baseTime = baseTimes[e];
+        v.trafficMultiplier = trafficMultipliers[e];
+        v.roadName = roadName(e);
+        v.index = e;
+        return v;
+    }
+
+    // Dense source vertex of edge e - O(log V)
+    int edgeSource(uint32_t e) const {
+        return static_cast<int>(std::upper_bound(offsets.begin(), offsets.end(), e) -
+                                offsets.begin()) - 1;
+    }
+
+    // First edge u -> v (dense indices)
+    bool findEdge(int u, int v, uint32_t* edge) const {
+        for (uint32_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (targets[e] == v) {
+                *edge = e;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void setTrafficMultiplier(uint32_t e, double multiplier) {
+        trafficMultipliers[e] = multiplier;
+        minMultiplier = std::min(minMultiplier, multiplier);
+    }
+
+    /**
+     * Lower bound on the cost of any path u -> v (dense indices)
+     * Edge costs are at least great-circle km times the calibrated
+     * per-km bound. The straight chord through the earth is never longer
+     * than the great-circle arc and is a metric, so the bound is admissible
+     * and consistent while costing one sqrt instead of the haversine trig.
+     * Returns 0 when either vertex has no position.
+     */
+    double lowerBound(int u, int v, bool useTime, double maxSpeedKmh) const {
+        if (!located[u] || !located[v]) return 0;
+        double perKm = distancePerKm;
+        if (useTime) {
+            perKm = baseTimePerKm;
+            if (maxSpeedKmh > 0) perKm = std::min(perKm, 60.0 / maxSpeedKmh);
+            perKm *= minMultiplier;
+        }
+        if (perKm <= 0) return 0;
+        const UnitVector& a = directions[u];
+        const UnitVector& b = directions[v];
+        double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+        return EARTH_RADIUS_KM * sqrt(dx * dx + dy * dy + dz * dz) * perKm;
+    }
+
+    // ==================== SNAPSHOT ====================
+
+    // Add every array (reverse adjacency and heuristic bounds included)
+    void saveSnapshot(SnapshotWriter& writer) const {
+        writer.addArray(SNAP_GRAPH_VERTICES, vertexIds);
+        writer.addArray(SNAP_GRAPH_OFFSETS, offsets);
+        writer.addArray(SNAP_GRAPH_TARGETS, targets);
+        writer.addArray(SNAP_GRAPH_DISTANCES, distances);
+        writer.addArray(SNAP_GRAPH_BASE_TIMES, baseTimes);
+        writer.addArray(SNAP_GRAPH_MULTIPLIERS, trafficMultipliers);
+        writer.addArray(SNAP_GRAPH_NAME_IDS, nameIds);
+        writer.addArray(SNAP_GRAPH_PROFILE_IDS, profileIds);
+        writer.addBytes(SNAP_GRAPH_ROAD_NAMES, roadNames.rawData().data(), roadNames.rawData().size());
+        writer.addArray(SNAP_GRAPH_ROAD_NAME_OFFSETS, roadNames.rawOffsets());
+        writer.addArray(SNAP_GRAPH_REVERSE_OFFSETS, reverseOffsets);
+        writer.addArray(SNAP_GRAPH_REVERSE_EDGES, reverseEdges);
+        writer.addArray(SNAP_GRAPH_REVERSE_SOURCES, reverseSources);
+        writer.addArray(SNAP_GRAPH_LOCATIONS, locations);
+        writer.addArray(SNAP_GRAPH_LOCATED, std::vector<uint8_t>(located.begin(), located.end()));
+        writer.addArray(SNAP_GRAPH_BOUNDS, std::vector<double>{distancePerKm, baseTimePerKm, minMultiplier});
+    }
+
+    /**
+     * Replace the graph with a snapshot's arrays. Every index is checked
+     * against the array it points into and every weight for being finite,
+     * non-negative and (base times) under a week, so a wrong file is
+     * rejected instead of read out of bounds or searched forever. Profile
+     * IDs are checked by Graph.
+     */
+    bool loadSnapshot(const SnapshotReader& reader) {
+        clear();
+        const char* names;
+        size_t namesLength;
+        const uint32_t* nameOffsets;
+        size_t numNameOffsets;
+        std::vector<uint8_t> locatedBytes;
+        std::vector<double> bounds;
+
+        bool ok = reader.read(SNAP_GRAPH_VERTICES, &vertexIds);
+        long long n = static_cast<long long>(vertexIds.size());
+        ok = ok && reader.read(SNAP_GRAPH_OFFSETS, &offsets, n + 1) &&
+             reader.read(SNAP_GRAPH_TARGETS, &targets, offsets.back());
+        long long m = static_cast<long long>(targets.size());
+        ok = ok && reader.read(SNAP_GRAPH_DISTANCES, &distances, m) &&
+             reader.read(SNAP_GRAPH_BASE_TIMES, &baseTimes, m) &&
+             reader.read(SNAP_GRAPH_MULTIPLIERS, &trafficMultipliers, m) &&
+             reader.read(SNAP_GRAPH_NAME_IDS, &nameIds, m) &&
+             reader.read(SNAP_GRAPH_PROFILE_IDS, &profileIds, m) &&
+             reader.view(SNAP_GRAPH_ROAD_NAMES, &names, &namesLength) &&
+             reader.view(SNAP_GRAPH_ROAD_NAME_OFFSETS, &nameOffsets, &numNameOffsets) &&
+             roadNames.assign(names, namesLength, nameOffsets, numNameOffsets) &&
+             reader.read(SNAP_GRAPH_REVERSE_OFFSETS, &reverseOffsets, n + 1) &&
+             reader.read(SNAP_GRAPH_REVERSE_EDGES, &reverseEdges, m) &&
+             reader.read(SNAP_GRAPH_REVERSE_SOURCES, &reverseSources, m) &&
+             reader.read(SNAP_GRAPH_LOCATIONS, &locations, n) &&
+             reader.read(SNAP_GRAPH_LOCATED, &locatedBytes, n) &&
+             reader.read(SNAP_GRAPH_BOUNDS, &bounds, 3);
+
+        ok = ok && offsets[0] == 0 && reverseOffsets[0] == 0 && reverseOffsets[n] == m;
+        for (long long v = 0; ok && v < n; ++v) {
+            ok = offsets[v] <= offsets[v + 1] && reverseOffsets[v] <= reverseOffsets[v + 1];
+        }
+        for (long long e = 0; ok && e < m; ++e) {
+            ok = targets[e] >= 0 && targets[e] < n && nameIds[e] < roadNames.size() &&
+                 reverseEdges[e] < m && reverseSources[e] >= 0 && reverseSources[e] < n &&
+                 std::isfinite(distances[e]) && distances[e] >= 0 &&
+                 baseTimes[e] >= 0 && baseTimes[e] <= MINUTES_PER_WEEK &&   // arrival() walks its slots
+                 std::isfinite(trafficMultipliers[e]) && trafficMultipliers[e] > 0;
+        }
+        if (!ok) {
+            clear();
+            return false;
+        }
+
+        denseIndex.reserve(vertexIds.size());
+        for (size_t i = 0; i < vertexIds.size(); ++i) {
+            if (!denseIndex.emplace(vertexIds[i], static_cast<int>(i)).second) {
+                clear();   // duplicate vertex
+                return false;
+            }
+        }
+        located.assign(locatedBytes.begin(), locatedBytes.end());
+        directions.resize(vertexIds.size(), UnitVector{0, 0, 0});
+        for (size_t i = 0; i < vertexIds.size(); ++i) {
+            if (located[i]) directions[i] = toUnitVector(locations[i]);
+        }
+        distancePerKm = bounds[0];
+        baseTimePerKm = bounds[1];
+        minMultiplier = bounds[2];
+        return true;
+    }
+
+    size_t getNumRoadNames() const { return roadNames.size(); }
+
+    size_t memoryUsageBytes() const {
+        return vertexIds.capacity() * sizeof(int) +
+               denseIndex.size() * (sizeof(int) * 2 + sizeof(void*) * 2) +
+               offsets.capacity() * sizeof(uint32_t) +
+               targets.capacity() * sizeof(int) +
+               (distances.capacity() + baseTimes.capacity() +
+                trafficMultipliers.capacity()) * sizeof(double) +
+               nameIds.capacity() * sizeof(uint32_t) +
+               profileIds.capacity() * sizeof(uint16_t) +
+               roadNames.memoryUsageBytes() +
+               (reverseOffsets.capacity() + reverseEdges.capacity()) * sizeof(uint32_t) +
+               reverseSources.capacity() * sizeof(int) +
+               locations.capacity() * sizeof(GeoPoint) +
+               directions.capacity() * sizeof(UnitVector) + located.capacity() / 8;
+    }
+
+    void clear() {
+        vertexIds.clear();
+        denseIndex.clear();
+        offsets.assign(1, 0);
+        targets.clear();
+        distances.clear();
+        baseTimes.clear();
+        trafficMultipliers.clear();
+        nameIds.clear();
+        profileIds.clear();
+        roadNames.clear();
+        reverseOffsets.assign(1, 0);
+        reverseEdges.clear();
+        reverseSources.clear();
+        locations.clear();
+        directions.clear();
+        located.clear();
+        distancePerKm = 0;
+        baseTimePerKm = 0;
+        minMultiplier = 1.0;
+    }
+};
+
+// Iterable range over the out-edges of one frozen vertex
+class EdgeRange {
+private:
+    const CSRGraph* graph;
+    uint32_t first;
+    uint32_t last;
+
+public:
+    class iterator {
+    private:
+        const CSRGraph* graph;
+        uint32_t edge;
+    public:
+        iterator(const CSRGraph* g, uint32_t e) : graph(g), edge(e) {}
+        EdgeView operator*() const { return graph->view(edge); }
+        iterator& operator++() { ++edge; return *this; }
+        bool operator!=(const iterator& other) const { return edge != other.edge; }
+        bool operator==(const iterator& other) const { return edge == other.edge; }
+    };
+
+    EdgeRange(const CSRGraph* g, uint32_t begin, uint32_t end)
+        : graph(g), first(begin), last(end) {}
+
+    iterator begin() const { return iterator(graph, first); }
+    iterator end() const { return iterator(graph, last); }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
 };
 
 class Graph {
 private:
+    // Build-time representation (released by freeze())
     std::unordered_map<int, std::vector<Edge>> adjacencyList;
     int numVertices;
+    std::unordered_map<int, GeoPoint> locations;
+
+    // Query-time representation
+    CSRGraph csr;
+    bool frozen;
+    double maxSpeedKmh;   // fastest road speed, bounds the A* time heuristic
+
+    // Optional preprocessing for inter-city queries (one per metric).
+    // thaw() drops it; the next freeze() rebuilds it from hierarchyCells
+    RouteHierarchy distanceHierarchy;
+    RouteHierarchy timeHierarchy;
+    std::unordered_map<int, int> hierarchyCells;   // junction ID -> cell of the last build
+    bool hierarchyPending;                         // dropped by an edit, not rebuilt yet
+    uint64_t hierarchyRebuilds;
+    uint64_t hierarchyRebuildFailures;             // routing fell back to plain search
+    size_t droppedCustomizations;                  // traffic repairs done by dropped hierarchies
+    size_t droppedRepairedVertices;
+
+    TrafficProfileTable profiles;   // shared time-of-day profiles (edges store IDs)
+
+    // Time leaving edge e when entering it at minute-of-week t
+    double arrivalTime(uint32_t e, double t) const {
+        uint16_t profile = csr.profile(e);
+        if (profile == TrafficProfileTable::NONE) return t + csr.actualTime(e);
+        return profiles.arrival(profile, csr.baseTime(e), t);
+    }
+
+    // Convert the frozen graph back to adjacency lists so it can be edited
+    void thaw() {
+        if (!frozen) return;
+
+        adjacencyList.clear();
+        adjacencyList.reserve(csr.numVertices());
+        for (int v = 0; v < csr.numVertices(); ++v) {
+            std::vector<Edge>& edges = adjacencyList[csr.idOf(v)];
+            edges.reserve(csr.edgeEnd(v) - csr.edgeBegin(v));
+            for (uint32_t e = csr.edgeBegin(v); e < csr.edgeEnd(v); ++e) {
+                Edge edge(csr.idOf(csr.target(e)), csr.distance(e),
+                          csr.baseTime(e), std::string(csr.roadName(e)));
+                edge.trafficMultiplier = csr.trafficMultiplier(e);
+                edge.profile = csr.profile(e);
+                edges.push_back(edge);
+            }
+        }
+        csr.clear();
+        if (!hierarchyCells.empty()) hierarchyPending = true;
+        droppedCustomizations += timeHierarchy.getCustomizations();
+        droppedRepairedVertices += timeHierarchy.getRepairedVertices();
+        distanceHierarchy.clear();
+        timeHierarchy.clear();
+        frozen = false;
+    }
+
+    // Build both metrics' hierarchies over the frozen graph from hierarchyCells
+    size_t buildHierarchies() {
+        std::vector<int> cells(csr.numVertices(), -1);
+        for (int v = 0; v < csr.numVertices(); ++v) {
+            auto it = hierarchyCells.find(csr.idOf(v));
+            if (it != hierarchyCells.end()) cells[v] = it->second;
+        }
+
+        if (!distanceHierarchy.build(csr, cells, false) ||
+            !timeHierarchy.build(csr, cells, true)) {
+            distanceHierarchy.clear();
+            timeHierarchy.clear();
+            return 0;
+        }
+        return distanceHierarchy.getNumPortals();
+    }
+
+    // Assemble a PathResult from a chain of CSR edges starting at source
+    template <typename EdgeList>
+    PathResult pathFromEdges(int source, const EdgeList& edges) const {
+        PathResult result;
+        result.found = true;
+        result.path.reserve(edges.size() + 1);
+        result.path.push_back(csr.idOf(source));
+        for (uint32_t e : edges) {
+            result.totalDistance += csr.distance(e);
+            result.totalTime += csr.actualTime(e);
+            result.path.push_back(csr.idOf(csr.target(e)));
+        }
+        return result;
+    }
+
+    // Walk the predecessor-edge chain back from the destination
+    PathResult buildPath(int source, int destination,
+                         const SearchWorkspace& workspace) const {
+        RouteArena::Scope arena;
+        std::pmr::vector<uint32_t> edges(arena.resource());
+
+        int current = destination;
+        while (current != source) {
+            int64_t e = workspace.getPreviousEdge(current);
+            if (e < 0) return PathResult();
+            edges.push_back(static_cast<uint32_t>(e));
+            current = csr.edgeSource(static_cast<uint32_t>(e));
+        }
+        std::reverse(edges.begin(), edges.end());
+        return pathFromEdges(source, edges);
+    }
+
+    // A* on dense indices; potential(v) must be a consistent lower bound to t
+    template <typename Potential>
+    PathResult astarSearch(int s, int t, bool useTime, Potential potential) {
+        SearchWorkspace& ws = SearchWorkspace::forThread();
+        ws.begin(csr.numVertices());
+        ws.setCost(s, 0, -1); // Actual cost from start (g score)
+
+        ws.heap.push(s, potential(s));
+        int settled = 0;
+
+        while (!ws.heap.empty()) {
+            int current = ws.heap.extractMin();
+            settled++;
+
+            if (current == t) {
+                PathResult result = buildPath(s, t, ws);
+                result.settledNodes = settled;
+                return result;
+            }
+
+            double currentG = ws.getCost(current);
+
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double tentativeG = currentG + csr.cost(e, useTime);
+
+                if (tentativeG < ws.getCost(neighbor)) {
+                    ws.setCost(neighbor, tentativeG, e);
+                    ws.heap.push(neighbor, tentativeG + potential(neighbor));
+                }
+            }
+        }
+
+        PathResult result;
+        result.settledNodes = settled;
+        return result;
+    }
+
+    /**
+     * Dijkstra from dense s until every vertex marked in isTarget is settled.
+     * secondary[v] accumulates the other metric along the same tree; both
+     * are valid for vertices the workspace reached.
+     */
+    int settleTargets(int s, const std::vector<char>& isTarget, size_t numTargets,
+                      bool useTime, SearchWorkspace& ws, std::vector<double>& secondary) const {
+        ws.begin(csr.numVertices());
+        if (secondary.size() < static_cast<size_t>(csr.numVertices())) {
+            secondary.resize(csr.numVertices());
+        }
+        ws.setCost(s, 0, -1);
+        secondary[s] = 0;
+        ws.heap.push(s, 0);
+        int settled = 0;
+        size_t remaining = numTargets;
+
+        while (!ws.heap.empty() && remaining > 0) {
+            int current = ws.heap.extractMin();
+            settled++;
+            if (isTarget[current]) remaining--;
+
+            double currentCost = ws.getCost(current);
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double newCost = currentCost + csr.cost(e, useTime);
+                if (newCost < ws.getCost(neighbor)) {
+                    ws.setCost(neighbor, newCost, e);
+                    secondary[neighbor] = secondary[current] + csr.cost(e, !useTime);
+                    ws.heap.push(neighbor, newCost);
+                }
+            }
+        }
+        return settled;
+    }
 
 public:
-    Graph() : numVertices(0) {}
+    Graph() : numVertices(0), frozen(false), maxSpeedKmh(0), hierarchyPending(false),
+              hierarchyRebuilds(0), hierarchyRebuildFailures(0), droppedCustomizations(0),
+              droppedRepairedVertices(0) {}
 
     // Add a vertex (junction)
     void addVertex(int id) {
+        if (frozen) {
+            int index;
+            if (!csr.indexOf(id, &index)) {
+                csr.appendVertex(id);
+                numVertices++;
+            }
+            return;
+        }
         if (adjacencyList.find(id) == adjacencyList.end()) {
             adjacencyList[id] = std::vector<Edge>();
             numVertices++;
         }
     }
 
+    // Add a vertex with its position (enables goal-directed search)
+    void addVertex(int id, double latitude, double longitude) {
+        GeoPoint position(latitude, longitude);
+        locations[id] = position;
+        if (frozen) {
+            int index;
+            if (!csr.indexOf(id, &index)) {
+                csr.appendVertex(id, &position);
+                numVertices++;
+                return;
+            }
+            thaw(); // moved vertex: heuristic bounds are rebuilt on next freeze()
+        }
+        addVertex(id);
+    }
+
+    // Cap for the A* time heuristic: no road is faster than this (km/h)
+    void setMaxSpeed(double kmh) { maxSpeedKmh = kmh; }
+
     // Add a directed edge (road)
-    void addEdge(int source, int destination, double distance, 
+    void addEdge(int source, int destination, double distance,
                  double baseTime, const std::string& roadName = "") {
+        thaw();
         addVertex(source);
         addVertex(destination);
         adjacencyList[source].push_back(Edge(destination, distance, baseTime, roadName));
@@ -74,23 +808,113 @@ public:
         addEdge(destination, source, distance, baseTime, roadName);
     }
 
+    /**
+     * Freeze the graph into CSR form
+     * Call once after the network is built; adding edges afterwards
+     * thaws it again until the next freeze(), which also rebuilds a route
+     * hierarchy the edit dropped (junctions added since its last
+     * buildHierarchy() have no cell and are routed by plain search).
+     */
+    void freeze() {
+        if (frozen) return;
+        csr.build(adjacencyList, locations);
+        std::unordered_map<int, std::vector<Edge>>().swap(adjacencyList);
+        frozen = true;
+
+        if (!hierarchyPending) return;
+        hierarchyPending = false;
+        auto startTime = std::chrono::steady_clock::now();
+        size_t portals = buildHierarchies();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - startTime);
+        if (portals == 0) {
+            hierarchyRebuildFailures++;
+            std::cout << "⚠️  Route hierarchy lost after a network edit: no usable portals, "
+                      << "inter-city routes use plain search\n";
+            return;
+        }
+        hierarchyRebuilds++;
+        std::cout << "🏔️  Route hierarchy rebuilt after a network edit: " << portals
+                  << " portals in " << duration.count() << " ms\n";
+    }
+
+    // Add the frozen graph and its traffic profiles to a snapshot
+    bool saveSnapshot(SnapshotWriter& writer) const {
+        if (!frozen) return false;
+        csr.saveSnapshot(writer);
+        writer.addArray(SNAP_PROFILE_SLOTS, profiles.rawSlots());
+        return true;
+    }
+
+    // Replace the graph with a snapshot's; it loads frozen, without hierarchies
+    bool loadSnapshot(const SnapshotReader& reader) {
+        const uint8_t* slots;
+        size_t numSlots;
+        bool ok = csr.loadSnapshot(reader) && reader.view(SNAP_PROFILE_SLOTS, &slots, &numSlots) &&
+                  profiles.assign(slots, numSlots);
+        for (size_t e = 0; ok && e < csr.numEdges(); ++e) {
+            ok = csr.profile(static_cast<uint32_t>(e)) <= profiles.size();
+        }
+
+        std::unordered_map<int, std::vector<Edge>>().swap(adjacencyList);
+        locations.clear();
+        distanceHierarchy.clear();
+        timeHierarchy.clear();
+        hierarchyCells.clear();
+        hierarchyPending = false;
+        droppedCustomizations = 0;
+        droppedRepairedVertices = 0;
+        if (!ok) {
+            csr.clear();
+            profiles.clear();
+            numVertices = 0;
+            frozen = false;
+            return false;
+        }
+
+        // Positions are kept for the next freeze() after an edit
+        GeoPoint position;
+        locations.reserve(csr.numVertices());
+        for (int v = 0; v < csr.numVertices(); ++v) {
+            if (csr.position(v, &position)) locations[csr.idOf(v)] = position;
+        }
+        numVertices = csr.numVertices();
+        frozen = true;
+        return true;
+    }
+
+    bool isFrozen() const { return frozen; }
+
+    // Access to the frozen representation
+    const CSRGraph& compact() const { return csr; }
+
     // Check if vertex exists
     bool hasVertex(int id) const {
+        if (frozen) {
+            int index;
+            return csr.indexOf(id, &index);
+        }
         return adjacencyList.find(id) != adjacencyList.end();
     }
 
-    // Get all neighbors of a vertex
-    const std::vector<Edge>& getNeighbors(int id) const {
-        static std::vector<Edge> empty;
-        auto it = adjacencyList.find(id);
-        if (it != adjacencyList.end()) {
-            return it->second;
+    // Get all neighbors of a vertex (frozen graph only)
+    EdgeRange getNeighbors(int id) const {
+        int index;
+        if (!frozen || !csr.indexOf(id, &index)) {
+            return EdgeRange(&csr, 0, 0);
         }
-        return empty;
+        return EdgeRange(&csr, csr.edgeBegin(index), csr.edgeEnd(index));
     }
 
     // Get all vertex IDs
     std::vector<int> getVertices() const {
+        if (frozen) {
+            std::vector<int> vertices(csr.numVertices());
+            for (int v = 0; v < csr.numVertices(); ++v) {
+                vertices[v] = csr.idOf(v);
+            }
+            return vertices;
+        }
         std::vector<int> vertices;
         vertices.reserve(adjacencyList.size());
         for (const auto& pair : adjacencyList) {
@@ -104,6 +928,7 @@ public:
 
     // Get number of edges
     int getNumEdges() const {
+        if (frozen) return static_cast<int>(csr.numEdges());
         int count = 0;
         for (const auto& pair : adjacencyList) {
             count += pair.second.size();
@@ -111,8 +936,37 @@ public:
         return count;
     }
 
+    // Approximate memory used by the graph in bytes
+    size_t getMemoryUsage() const {
+        if (frozen) return csr.memoryUsageBytes();
+        size_t bytes = 0;
+        for (const auto& pair : adjacencyList) {
+            bytes += sizeof(pair) + sizeof(void*) * 2;
+            for (const Edge& edge : pair.second) {
+                bytes += sizeof(Edge);
+                if (edge.roadName.capacity() >= sizeof(std::string)) {
+                    bytes += edge.roadName.capacity() + 1;
+                }
+            }
+        }
+        return bytes;
+    }
+
     // Update traffic multiplier for a road
     bool updateTraffic(int source, int destination, double multiplier) {
+        if (frozen) {
+            int u, v;
+            uint32_t e;
+            if (!csr.indexOf(source, &u) || !csr.indexOf(destination, &v) ||
+                !csr.findEdge(u, v, &e)) {
+                return false;
+            }
+            double oldTime = csr.actualTime(e);
+            csr.setTrafficMultiplier(e, multiplier);
+            timeHierarchy.updateEdge(csr, e, oldTime); // repair affected time trees
+            return true;
+        }
+
         auto it = adjacencyList.find(source);
         if (it == adjacencyList.end()) return false;
 
@@ -131,209 +985,723 @@ public:
         updateTraffic(destination, source, multiplier);
     }
 
-    // Get edge between two vertices
-    Edge* getEdge(int source, int destination) {
-        auto it = adjacencyList.find(source);
-        if (it == adjacencyList.end()) return nullptr;
+    // Register a weekly profile (see TrafficProfileTable::add); NONE if rejected
+    uint16_t addTrafficProfile(const std::vector<double>& multipliers) {
+        return profiles.add(multipliers);
+    }
 
+    // Attach a profile to edge source -> destination (NONE detaches it)
+    bool setTrafficProfile(int source, int destination, uint16_t profile) {
+        if (profile > profiles.size()) return false;
+        if (frozen) {
+            int u, v;
+            uint32_t e;
+            if (!csr.indexOf(source, &u) || !csr.indexOf(destination, &v) ||
+                !csr.findEdge(u, v, &e)) {
+                return false;
+            }
+            csr.setProfile(e, profile);
+            return true;
+        }
+
+        auto it = adjacencyList.find(source);
+        if (it == adjacencyList.end()) return false;
         for (auto& edge : it->second) {
             if (edge.destination == destination) {
-                return &edge;
+                edge.profile = profile;
+                return true;
             }
         }
-        return nullptr;
+        return false;
+    }
+
+    size_t getNumTrafficProfiles() const { return profiles.size(); }
+    size_t getTrafficProfileMemoryUsage() const {
+        return profiles.memoryUsageBytes() + csr.numEdges() * sizeof(uint16_t);
+    }
+
+    // Get edge between two vertices (frozen graph only)
+    bool getEdge(int source, int destination, EdgeView* result) const {
+        int u, v;
+        uint32_t e;
+        if (!frozen || !csr.indexOf(source, &u) || !csr.indexOf(destination, &v) ||
+            !csr.findEdge(u, v, &e)) {
+            return false;
+        }
+        if (result) *result = csr.view(e);
+        return true;
     }
 
     /**
      * Dijkstra's Algorithm - Shortest Path
-     * Uses Min-Heap for O((V+E) log V) time complexity
-     * 
+     * Uses an indexed 4-ary min-heap over dense vertex indices: O((V+E) log V)
+     *
      * @param source Starting junction ID
      * @param destination Target junction ID
      * @param useTime If true, optimize for time; otherwise, optimize for distance
      * @return PathResult containing the shortest path and metrics
      */
     PathResult dijkstra(int source, int destination, bool useTime = true) {
+        freeze();
+
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return PathResult();
+        }
+
+        SearchWorkspace& ws = SearchWorkspace::forThread();
+        ws.begin(csr.numVertices());
+        ws.setCost(s, 0, -1);
+
+        // Indexed min-heap: one entry per vertex, decrease-key in place
+        ws.heap.push(s, 0);
+        int settled = 0;
+
+        while (!ws.heap.empty()) {
+            int current = ws.heap.extractMin();
+            settled++;
+
+            if (current == t) {
+                break; // Found shortest path
+            }
+
+            double currentCost = ws.getCost(current);
+
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double newCost = currentCost + csr.cost(e, useTime);
+
+                if (newCost < ws.getCost(neighbor)) {
+                    ws.setCost(neighbor, newCost, e);
+                    ws.heap.push(neighbor, newCost);
+                }
+            }
+        }
+
         PathResult result;
-        
-        if (!hasVertex(source) || !hasVertex(destination)) {
-            return result;
+        if (ws.isReached(t)) {
+            result = buildPath(s, t, ws);
         }
+        result.settledNodes = settled;
+        return result;
+    }
 
-        const double INF = std::numeric_limits<double>::infinity();
-        
-        std::unordered_map<int, double> distances;
-        std::unordered_map<int, double> times;
-        std::unordered_map<int, int> previous;
-        
-        // Initialize distances
-        for (const auto& pair : adjacencyList) {
-            distances[pair.first] = INF;
-            times[pair.first] = INF;
+    /**
+     * A* Algorithm - Faster pathfinding with heuristics
+     * heuristic(junctionId, destinationId) must never overestimate
+     */
+    PathResult astar(int source, int destination,
+                     std::function<double(int, int)> heuristic,
+                     bool useTime = true) {
+        freeze();
+
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return PathResult();
         }
-        distances[source] = 0;
-        times[source] = 0;
 
-        // Min-heap priority queue
-        MinHeap<int, double> pq;
-        pq.insert(source, 0);
+        return astarSearch(s, t, useTime, [&](int v) {
+            return heuristic(csr.idOf(v), destination);
+        });
+    }
 
-        while (!pq.empty()) {
-            int current = pq.extractMin();
+    /**
+     * A* with the built-in great-circle heuristic
+     * Distance mode: haversine km. Time mode: haversine km at the
+     * fastest road speed and lowest traffic multiplier in the graph.
+     */
+    PathResult astar(int source, int destination, bool useTime = true) {
+        freeze();
 
-            if (current == destination) {
-                break; // Found shortest path
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return PathResult();
+        }
+
+        return astarSearch(s, t, useTime, [&](int v) {
+            return csr.lowerBound(v, t, useTime, maxSpeedKmh);
+        });
+    }
+
+    /**
+     * Bidirectional Dijkstra / A*
+     * Grows a forward search from the source and a backward search (over
+     * the reverse CSR) from the destination, expanding the smaller queue.
+     * With useHeuristic the searches use the average potential
+     * p(v) = (h(v, t) - h(s, v)) / 2, which keeps both sides consistent.
+     * Stops once minForward + minBackward >= best meeting cost.
+     */
+    PathResult bidirectional(int source, int destination, bool useTime = true,
+                             bool useHeuristic = false) {
+        freeze();
+
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return PathResult();
+        }
+        if (s == t) {
+            return pathFromEdges(s, std::vector<uint32_t>());
+        }
+
+        auto potential = [&](int v) {
+            if (!useHeuristic) return 0.0;
+            return 0.5 * (csr.lowerBound(v, t, useTime, maxSpeedKmh) -
+                          csr.lowerBound(s, v, useTime, maxSpeedKmh));
+        };
+
+        SearchWorkspace& forward = SearchWorkspace::forThread();
+        SearchWorkspace& backward = SearchWorkspace::backwardForThread();
+        forward.begin(csr.numVertices());
+        backward.begin(csr.numVertices());
+
+        forward.setCost(s, 0, -1);
+        forward.heap.push(s, potential(s));
+        backward.setCost(t, 0, -1);
+        backward.heap.push(t, -potential(t));
+
+        double best = std::numeric_limits<double>::infinity();
+        int meeting = -1;
+        int settled = 0;
+
+        while (!forward.heap.empty() && !backward.heap.empty()) {
+            if (forward.heap.getMinPriority() + backward.heap.getMinPriority() >= best) {
+                break;
             }
 
-            double currentCost = useTime ? times[current] : distances[current];
+            if (forward.heap.size() <= backward.heap.size()) {
+                int current = forward.heap.extractMin();
+                settled++;
+                double currentCost = forward.getCost(current);
 
-            for (const Edge& edge : adjacencyList[current]) {
-                int neighbor = edge.destination;
-                double edgeCost = useTime ? edge.getActualTime() : edge.distance;
-                double newCost = currentCost + edgeCost;
-                double neighborCost = useTime ? times[neighbor] : distances[neighbor];
+                for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                    int neighbor = csr.target(e);
+                    double newCost = currentCost + csr.cost(e, useTime);
+                    if (newCost < forward.getCost(neighbor)) {
+                        forward.setCost(neighbor, newCost, e);
+                        forward.heap.push(neighbor, newCost + potential(neighbor));
+                    }
+                    if (backward.isReached(neighbor)) {
+                        double through = forward.getCost(neighbor) + backward.getCost(neighbor);
+                        if (through < best) {
+                            best = through;
+                            meeting = neighbor;
+                        }
+                    }
+                }
+            } else {
+                int current = backward.heap.extractMin();
+                settled++;
+                double currentCost = backward.getCost(current);
 
-                if (newCost < neighborCost) {
-                    distances[neighbor] = distances[current] + edge.distance;
-                    times[neighbor] = times[current] + edge.getActualTime();
-                    previous[neighbor] = current;
-                    pq.insert(neighbor, newCost);
+                for (uint32_t r = csr.reverseBegin(current); r < csr.reverseEnd(current); ++r) {
+                    uint32_t e = csr.reverseEdge(r);
+                    int neighbor = csr.reverseSource(r);
+                    double newCost = currentCost + csr.cost(e, useTime);
+                    if (newCost < backward.getCost(neighbor)) {
+                        backward.setCost(neighbor, newCost, e);
+                        backward.heap.push(neighbor, newCost - potential(neighbor));
+                    }
+                    if (forward.isReached(neighbor)) {
+                        double through = forward.getCost(neighbor) + backward.getCost(neighbor);
+                        if (through < best) {
+                            best = through;
+                            meeting = neighbor;
+                        }
+                    }
                 }
             }
         }
 
-        // Reconstruct path
-        if (distances[destination] != INF) {
-            result.found = true;
-            result.totalDistance = distances[destination];
-            result.totalTime = times[destination];
+        PathResult result;
+        if (meeting >= 0) {
+            // Forward half: s -> meeting, backward half: meeting -> t
+            RouteArena::Scope arena;
+            std::pmr::vector<uint32_t> edges(arena.resource());
+            for (int v = meeting; v != s; ) {
+                uint32_t e = static_cast<uint32_t>(forward.getPreviousEdge(v));
+                edges.push_back(e);
+                v = csr.edgeSource(e);
+            }
+            std::reverse(edges.begin(), edges.end());
+            for (int v = meeting; v != t; ) {
+                uint32_t e = static_cast<uint32_t>(backward.getPreviousEdge(v));
+                edges.push_back(e);
+                v = csr.target(e);
+            }
+            result = pathFromEdges(s, edges);
+        }
+        result.settledNodes = settled;
+        return result;
+    }
 
-            // Build path from destination to source
-            int current = destination;
-            while (current != source) {
-                result.path.push_back(current);
-                auto it = previous.find(current);
-                if (it == previous.end()) {
-                    result.found = false;
-                    return result;
+    /**
+     * Many-to-many cost matrix (time and distance of the route that is
+     * optimal under the chosen metric)
+     * One Dijkstra per source that stops once all targets are settled;
+     * the calling thread claims rows alongside whichever helpers pool
+     * lends it (none if null or busy), each with its own workspace, so no
+     * threads are started per call. Unknown junction IDs give unreachable
+     * rows / columns.
+     * Read-only once frozen: callers may run it concurrently with queries.
+     */
+    MatrixResult costMatrix(const std::vector<int>& sources, const std::vector<int>& targets,
+                            bool useTime, WorkerPool* pool = nullptr) {
+        freeze();
+
+        MatrixResult result;
+        result.numSources = sources.size();
+        result.numTargets = targets.size();
+        const double unreachable = std::numeric_limits<double>::infinity();
+        result.times.assign(sources.size() * targets.size(), unreachable);
+        result.distances.assign(sources.size() * targets.size(), unreachable);
+
+        std::vector<int> targetIndex(targets.size(), -1);
+        std::vector<char> isTarget(csr.numVertices(), 0);
+        size_t numTargets = 0;
+        for (size_t j = 0; j < targets.size(); ++j) {
+            if (!csr.indexOf(targets[j], &targetIndex[j])) continue;
+            if (!isTarget[targetIndex[j]]) {
+                isTarget[targetIndex[j]] = 1;
+                numTargets++;
+            }
+        }
+        if (numTargets == 0) return result;
+
+        std::atomic<size_t> nextRow(0);
+        std::atomic<size_t> settledTotal(0);
+        auto work = [&]() {
+            SearchWorkspace& ws = SearchWorkspace::forThread();
+            thread_local std::vector<double> secondary;
+            for (size_t i = nextRow++; i < sources.size(); i = nextRow++) {
+                int s;
+                if (!csr.indexOf(sources[i], &s)) continue;
+                settledTotal += settleTargets(s, isTarget, numTargets, useTime, ws, secondary);
+
+                double* times = &result.times[i * targets.size()];
+                double* distances = &result.distances[i * targets.size()];
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    int t = targetIndex[j];
+                    if (t < 0 || !ws.isReached(t)) continue;
+                    times[j] = useTime ? ws.getCost(t) : secondary[t];
+                    distances[j] = useTime ? secondary[t] : ws.getCost(t);
                 }
-                current = it->second;
             }
-            result.path.push_back(source);
-            std::reverse(result.path.begin(), result.path.end());
+        };
+
+        // Helpers still queued when the rows run out must not touch this
+        // frame: they check closed under the mutex and return untouched
+        struct HelperState {
+            std::mutex mutex;
+            std::condition_variable idle;
+            size_t active = 0;
+            bool closed = false;
+        };
+        auto state = std::make_shared<HelperState>();
+        auto helper = [state, &work]() {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->closed) return;
+                state->active++;
+            }
+            work();
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (--state->active == 0) state->idle.notify_all();
+        };
+
+        size_t helpers = pool && sources.size() > 1 ? std::min(pool->size(), sources.size() - 1) : 0;
+        for (size_t k = 0; k < helpers; ++k) {
+            if (!pool->trySubmit(helper)) break;   // pool busy: fewer hands share the rows
+        }
+        work();
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->closed = true;
+            state->idle.wait(lock, [&]() { return state->active == 0; });
         }
 
+        result.settledNodes = settledTotal;
         return result;
     }
 
     /**
-     * A* Algorithm - Faster pathfinding with heuristics
-     * Uses Haversine distance as heuristic
+     * Bounded one-to-all search (isochrone)
+     * Every junction whose cheapest route from source costs at most budget
+     * under the chosen metric, in order of cost. Edges that would exceed
+     * the budget are never queued, so the work is proportional to the
+     * reachable area, not to V.
+     * @return vertices settled; 0 if source is unknown
      */
-    PathResult astar(int source, int destination, 
-                     std::function<double(int, int)> heuristic,
-                     bool useTime = true) {
-        PathResult result;
-        
-        if (!hasVertex(source) || !hasVertex(destination)) {
-            return result;
+    int reachableWithin(int source, double budget, bool useTime,
+                        std::vector<ReachableJunction>* result) {
+        freeze();
+        result->clear();
+
+        int s;
+        if (!csr.indexOf(source, &s)) return 0;
+
+        SearchWorkspace& ws = SearchWorkspace::forThread();
+        thread_local std::vector<double> secondary;
+        ws.begin(csr.numVertices());
+        if (secondary.size() < static_cast<size_t>(csr.numVertices())) {
+            secondary.resize(csr.numVertices());
         }
+        ws.setCost(s, 0, -1);
+        secondary[s] = 0;
+        ws.heap.push(s, 0);
+        int settled = 0;
 
-        const double INF = std::numeric_limits<double>::infinity();
-        
-        std::unordered_map<int, double> gScore; // Actual cost from start
-        std::unordered_map<int, double> fScore; // gScore + heuristic
-        std::unordered_map<int, double> times;
-        std::unordered_map<int, int> previous;
-        
-        for (const auto& pair : adjacencyList) {
-            gScore[pair.first] = INF;
-            fScore[pair.first] = INF;
-            times[pair.first] = INF;
-        }
-        
-        gScore[source] = 0;
-        times[source] = 0;
-        fScore[source] = heuristic(source, destination);
-
-        MinHeap<int, double> openSet;
-        openSet.insert(source, fScore[source]);
-
-        while (!openSet.empty()) {
-            int current = openSet.extractMin();
-
-            if (current == destination) {
-                result.found = true;
-                result.totalDistance = gScore[destination];
-                result.totalTime = times[destination];
-
-                int node = destination;
-                while (node != source) {
-                    result.path.push_back(node);
-                    node = previous[node];
+        while (!ws.heap.empty()) {
+            int current = ws.heap.extractMin();
+            settled++;
+            double currentCost = ws.getCost(current);
+            result->push_back({csr.idOf(current),
+                               useTime ? currentCost : secondary[current],
+                               useTime ? secondary[current] : currentCost});
+
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double newCost = currentCost + csr.cost(e, useTime);
+                if (newCost <= budget && newCost < ws.getCost(neighbor)) {
+                    ws.setCost(neighbor, newCost, e);
+                    secondary[neighbor] = secondary[current] + csr.cost(e, !useTime);
+                    ws.heap.push(neighbor, newCost);
                 }
-                result.path.push_back(source);
-                std::reverse(result.path.begin(), result.path.end());
-                return result;
             }
+        }
+        return settled;
+    }
 
-            for (const Edge& edge : adjacencyList[current]) {
-                int neighbor = edge.destination;
-                double edgeCost = useTime ? edge.getActualTime() : edge.distance;
-                double tentativeG = gScore[current] + edgeCost;
-
-                if (tentativeG < gScore[neighbor]) {
-                    previous[neighbor] = current;
-                    gScore[neighbor] = tentativeG;
-                    times[neighbor] = times[current] + edge.getActualTime();
-                    fScore[neighbor] = tentativeG + heuristic(neighbor, destination);
-                    
-                    if (!openSet.contains(neighbor)) {
-                        openSet.insert(neighbor, fScore[neighbor]);
-                    } else {
-                        openSet.decreaseKey(neighbor, fScore[neighbor]);
-                    }
+    /**
+     * Time-dependent Dijkstra (fastest route for a departure time)
+     * Labels are arrival times; an edge's cost depends on when it is
+     * entered (its profile, or the live multiplier for edges without one).
+     * Exact because travel is FIFO (see TrafficProfileTable::arrival).
+     * @param depart minute of the week, Monday 00:00 = 0
+     * @return path with totalTime in minutes and per-hop legTimes
+     */
+    PathResult timeDependentPath(int source, int destination, double depart) {
+        freeze();
+
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return PathResult();
+        }
+
+        SearchWorkspace& ws = SearchWorkspace::forThread();
+        ws.begin(csr.numVertices());
+        ws.setCost(s, depart, -1);
+        ws.heap.push(s, depart);
+        int settled = 0;
+
+        while (!ws.heap.empty()) {
+            int current = ws.heap.extractMin();
+            settled++;
+            if (current == t) break;
+
+            double now = ws.getCost(current);
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double arrival = arrivalTime(e, now);
+                if (arrival < ws.getCost(neighbor)) {
+                    ws.setCost(neighbor, arrival, e);
+                    ws.heap.push(neighbor, arrival);
                 }
             }
         }
 
+        PathResult result;
+        if (ws.isReached(t)) {
+            RouteArena::Scope arena;
+            std::pmr::vector<uint32_t> edges(arena.resource());
+            for (int v = t; v != s; ) {
+                uint32_t e = static_cast<uint32_t>(ws.getPreviousEdge(v));
+                edges.push_back(e);
+                v = csr.edgeSource(e);
+            }
+            std::reverse(edges.begin(), edges.end());
+            result = pathFromEdges(s, edges);
+
+            // Replay the departure to get each hop's time-dependent duration
+            result.totalTime = 0;
+            double now = depart;
+            for (uint32_t e : edges) {
+                double next = arrivalTime(e, now);
+                result.legTimes.push_back(next - now);
+                result.totalTime += next - now;
+                now = next;
+            }
+        }
+        result.settledNodes = settled;
+        return result;
+    }
+
+    /**
+     * Build the portal hierarchy for both metrics
+     * @param cellOf junction ID -> cell (city) ID; junctions not listed get no cell
+     * @return number of portals, 0 if the hierarchy could not be built
+     */
+    size_t buildHierarchy(const std::unordered_map<int, int>& cellOf) {
+        freeze();
+        hierarchyCells = cellOf;
+        hierarchyPending = false;
+        size_t portals = buildHierarchies();
+        if (portals == 0) hierarchyCells.clear();
+        return portals;
+    }
+
+    bool hasHierarchy(bool useTime) const {
+        return useTime ? timeHierarchy.isReady() : distanceHierarchy.isReady();
+    }
+
+    const RouteHierarchy& getHierarchy(bool useTime) const {
+        return useTime ? timeHierarchy : distanceHierarchy;
+    }
+
+    // Hierarchies rebuilt by freeze() after an edit, and rebuilds that failed
+    uint64_t getHierarchyRebuilds() const { return hierarchyRebuilds; }
+    uint64_t getHierarchyRebuildFailures() const { return hierarchyRebuildFailures; }
+
+    // Traffic updates customized in place (time metric), across rebuilds
+    size_t getHierarchyCustomizations() const {
+        return droppedCustomizations + timeHierarchy.getCustomizations();
+    }
+    size_t getHierarchyRepairedVertices() const {
+        return droppedRepairedVertices + timeHierarchy.getRepairedVertices();
+    }
+
+    size_t getHierarchyMemoryUsage() const {
+        return distanceHierarchy.memoryUsageBytes() + timeHierarchy.memoryUsageBytes();
+    }
+
+    /**
+     * Inter-city query through the hierarchy - O(|portals|^2 + path length)
+     * @return false if the hierarchy cannot answer this pair
+     */
+    bool hierarchyPath(int source, int destination, bool useTime, PathResult* result) {
+        const RouteHierarchy& hierarchy = useTime ? timeHierarchy : distanceHierarchy;
+        int s, t;
+        if (!frozen || !hierarchy.isReady() ||
+            !csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) {
+            return false;
+        }
+
+        RouteArena::Scope arena;
+        std::pmr::vector<uint32_t> edges(arena.resource());
+        bool found;
+        if (!hierarchy.query(csr, s, t, &edges, &found)) {
+            return false;
+        }
+        *result = found ? pathFromEdges(s, edges) : PathResult();
+        result->algorithm = RouteAlgorithm::HIERARCHY;
+        return true;
+    }
+
+    // Run the selected search strategy
+    PathResult findPath(int source, int destination, bool useTime,
+                        RouteAlgorithm algorithm) {
+        PathResult result;
+        switch (algorithm) {
+            case RouteAlgorithm::ASTAR:
+                result = astar(source, destination, useTime);
+                break;
+            case RouteAlgorithm::BIDIRECTIONAL:
+                result = bidirectional(source, destination, useTime, false);
+                break;
+            case RouteAlgorithm::BIDIRECTIONAL_ASTAR:
+                result = bidirectional(source, destination, useTime, true);
+                break;
+            case RouteAlgorithm::HIERARCHY:
+                if (hierarchyPath(source, destination, useTime, &result)) {
+                    return result;
+                }
+                // Same city or no hierarchy: plain Dijkstra
+                algorithm = RouteAlgorithm::DIJKSTRA;
+                result = dijkstra(source, destination, useTime);
+                break;
+            case RouteAlgorithm::DIJKSTRA:
+            default:
+                result = dijkstra(source, destination, useTime);
+                break;
+        }
+        result.algorithm = algorithm;
         return result;
     }
 
     /**
-     * Find K shortest paths (for alternative routes)
+     * Alternative routes by the plateau method
+     * One forward tree from the source and one backward tree from the
+     * destination, both grown to (1 + maxStretch) x the best cost. An edge
+     * on both trees lies on a "plateau"; the route through a plateau
+     * (forward tree to its start, backward tree from its end) is locally
+     * optimal along the plateau, and longer plateaus give more natural
+     * alternatives. Candidates are taken longest plateau first and kept if
+     * they are loop-free, within the stretch, share at most maxShare of
+     * their cost with routes already chosen, and have a plateau of at
+     * least minPlateau x the best cost.
+     * @return best route first, then up to maxAlternatives alternatives
      */
-    std::vector<PathResult> findKShortestPaths(int source, int destination, 
-                                                int k = 3, bool useTime = true) {
+    std::vector<PathResult> findAlternativePaths(int source, int destination, int maxAlternatives,
+                                                 bool useTime = true, double maxStretch = 0.3,
+                                                 double maxShare = 0.7, double minPlateau = 0.1) {
+        freeze();
         std::vector<PathResult> results;
-        
-        // First shortest path
-        PathResult first = dijkstra(source, destination, useTime);
-        if (!first.found) return results;
-        results.push_back(first);
 
-        // Simple approach: block edges from previous paths and find alternatives
-        // (Yen's algorithm simplified)
-        for (int i = 1; i < k; ++i) {
-            // Find alternative by adding penalty to used edges
-            PathResult alt = first; // Placeholder - implement full Yen's if needed
-            // For now, just return the same path with slight variation
-            if (results.size() < static_cast<size_t>(k)) {
-                results.push_back(first);
+        int s, t;
+        if (!csr.indexOf(source, &s) || !csr.indexOf(destination, &t)) return results;
+
+        // Candidate bookkeeping lives in the request arena
+        RouteArena::Scope arena;
+        SearchWorkspace& forward = SearchWorkspace::forThread();
+        SearchWorkspace& backward = SearchWorkspace::backwardForThread();
+        thread_local std::vector<int> settledOrder;
+        thread_local std::vector<double> plateau;     // length of the plateau ending at v
+        thread_local std::vector<int> plateauStart;   // first vertex of that plateau
+        thread_local std::vector<uint32_t> visited;   // == visitMark: on the candidate route
+        thread_local uint32_t visitMark = 0;
+        settledOrder.clear();
+        if (plateau.size() < static_cast<size_t>(csr.numVertices())) {
+            plateau.resize(csr.numVertices());
+            plateauStart.resize(csr.numVertices());
+            visited.resize(csr.numVertices(), 0);
+        }
+
+        // Forward tree: settle up to the stretch bound once t is known
+        forward.begin(csr.numVertices());
+        forward.setCost(s, 0, -1);
+        forward.heap.push(s, 0);
+        double bound = std::numeric_limits<double>::infinity();
+        int settled = 0;
+        while (!forward.heap.empty() && forward.heap.getMinPriority() <= bound) {
+            int current = forward.heap.extractMin();
+            settled++;
+            settledOrder.push_back(current);
+            double currentCost = forward.getCost(current);
+            if (current == t) bound = currentCost * (1.0 + maxStretch);
+
+            for (uint32_t e = csr.edgeBegin(current); e < csr.edgeEnd(current); ++e) {
+                int neighbor = csr.target(e);
+                double newCost = currentCost + csr.cost(e, useTime);
+                if (newCost <= bound && newCost < forward.getCost(neighbor)) {
+                    forward.setCost(neighbor, newCost, e);
+                    forward.heap.push(neighbor, newCost);
+                }
+            }
+        }
+        if (!forward.isReached(t)) return results;
+        const double best = forward.getCost(t);
+
+        // Backward tree over the reverse CSR, same bound
+        backward.begin(csr.numVertices());
+        backward.setCost(t, 0, -1);
+        backward.heap.push(t, 0);
+        while (!backward.heap.empty() && backward.heap.getMinPriority() <= bound) {
+            int current = backward.heap.extractMin();
+            settled++;
+            double currentCost = backward.getCost(current);
+            for (uint32_t r = csr.reverseBegin(current); r < csr.reverseEnd(current); ++r) {
+                uint32_t e = csr.reverseEdge(r);
+                int neighbor = csr.reverseSource(r);
+                double newCost = currentCost + csr.cost(e, useTime);
+                if (newCost <= bound && newCost < backward.getCost(neighbor)) {
+                    backward.setCost(neighbor, newCost, e);
+                    backward.heap.push(neighbor, newCost);
+                }
+            }
+        }
+
+        // Plateau lengths in forward settle order (a vertex's parent comes first)
+        struct Candidate { int via; int start; double length; };
+        std::pmr::vector<Candidate> candidates(arena.resource());
+        for (int v : settledOrder) {
+            plateau[v] = 0;
+            int64_t e = forward.getPreviousEdge(v);
+            if (e < 0 || forward.getCost(v) + backward.getCost(v) > bound) continue;
+            int u = csr.edgeSource(static_cast<uint32_t>(e));
+            if (backward.getPreviousEdge(u) == e) {
+                plateau[v] = plateau[u] + csr.cost(static_cast<uint32_t>(e), useTime);
+                plateauStart[v] = plateau[u] > 0 ? plateauStart[u] : u;
+                if (plateau[v] >= minPlateau * best) candidates.push_back({v, plateauStart[v], plateau[v]});
             }
         }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+            return a.length > b.length;
+        });
 
+        // Route through v: forward tree to v, backward tree on to t
+        auto routeVia = [&](int v, std::pmr::vector<uint32_t>* edges) {
+            edges->clear();
+            for (int x = v; x != s; ) {
+                uint32_t e = static_cast<uint32_t>(forward.getPreviousEdge(x));
+                edges->push_back(e);
+                x = csr.edgeSource(e);
+            }
+            std::reverse(edges->begin(), edges->end());
+            for (int x = v; x != t; ) {
+                uint32_t e = static_cast<uint32_t>(backward.getPreviousEdge(x));
+                edges->push_back(e);
+                x = csr.target(e);
+            }
+        };
+
+        std::pmr::vector<std::pmr::vector<uint32_t>> chosen(arena.resource());
+        std::pmr::unordered_map<uint32_t, int> chosenEdges(arena.resource());   // edge -> routes using it
+        std::pmr::vector<uint32_t> edges(arena.resource());
+        routeVia(t, &edges);
+        chosen.push_back(edges);
+        for (uint32_t e : edges) chosenEdges[e]++;
+
+        std::pmr::unordered_set<int> triedPlateaus(arena.resource());   // every vertex of a plateau gives the same route
+        for (const Candidate& candidate : candidates) {
+            if (static_cast<int>(chosen.size()) > maxAlternatives) break;
+            if (!triedPlateaus.insert(candidate.start).second) continue;
+            routeVia(candidate.via, &edges);
+            double cost = 0, shared = 0;
+            bool loopFree = true;
+            if (++visitMark == 0) {
+                std::fill(visited.begin(), visited.end(), 0);
+                visitMark = 1;
+            }
+            visited[s] = visitMark;
+            for (uint32_t e : edges) {
+                double edgeCost = csr.cost(e, useTime);
+                cost += edgeCost;
+                if (chosenEdges.count(e)) shared += edgeCost;
+                int target = csr.target(e);
+                if (visited[target] == visitMark) {
+                    loopFree = false;
+                    break;
+                }
+                visited[target] = visitMark;
+            }
+            if (!loopFree || cost > bound || shared > maxShare * cost) continue;
+
+            chosen.push_back(edges);
+            for (uint32_t e : edges) chosenEdges[e]++;
+        }
+
+        for (const std::pmr::vector<uint32_t>& route : chosen) {
+            PathResult result = pathFromEdges(s, route);
+            result.settledNodes = settled;
+            results.push_back(result);
+        }
         return results;
     }
 
     // Print graph structure (for debugging)
     void print() const {
         std::cout << "Graph with " << numVertices << " vertices:\n";
-        for (const auto& pair : adjacencyList) {
-            std::cout << "  " << pair.first << " -> ";
-            for (const auto& edge : pair.second) {
-                std::cout << edge.destination << " (dist: " << edge.distance 
-                          << ", time: " << edge.getActualTime() << ") ";
+        for (int id : getVertices()) {
+            std::cout << "  " << id << " -> ";
+            if (frozen) {
+                for (const EdgeView& edge : getNeighbors(id)) {
+                    std::cout << edge.destination << " (dist: " << edge.distance
+                              << ", time: " << edge.getActualTime() << ") ";
+                }
+            } else {
+                for (const Edge& edge : adjacencyList.at(id)) {
+                    std::cout << edge.destination << " (dist: " << edge.distance
+                              << ", time: " << edge.getActualTime() << ") ";
+                }
             }
             std::cout << "\n";
         }
@@ -342,22 +1710,18 @@ public:
     // Clear all data
     void clear() {
         adjacencyList.clear();
+        csr.clear();
+        distanceHierarchy.clear();
+        timeHierarchy.clear();
+        hierarchyCells.clear();
+        hierarchyPending = false;
+        droppedCustomizations = 0;
+        droppedRepairedVertices = 0;
+        profiles.clear();
+        locations.clear();
         numVertices = 0;
+        frozen = false;
     }
-
-    // In Graph.h, add this public method to the Graph class:
-
-    // Edge* getEdge(int source, int destination) {
-    //     auto it = adjacencyList.find(source);
-    //     if (it == adjacencyList.end()) return nullptr;
-
-    //     for (auto& edge : it->second) {
-    //         if (edge.destination == destination) {
-    //             return &edge;
-    //         }
-    //     }
-    //     return nullptr;
-    // }
 };
 
 #endif // GRAPH_H
@@ -44,34 +44,31 @@ private:
         return static_cast<size_t>(key);
     }
 
-    // Generic hash function
-    size_t getHash(const K& key) const {
+    // Bucket of key in a table of bucketCount buckets
+    size_t bucketFor(const K& key, size_t bucketCount) const {
         if constexpr (std::is_same_v<K, std::string>) {
-            return hashString(key) % numBuckets;
+            return hashString(key) % bucketCount;
         } else if constexpr (std::is_integral_v<K>) {
-            return hashInt(static_cast<int>(key)) % numBuckets;
+            return hashInt(static_cast<int>(key)) % bucketCount;
         } else {
             // Use std::hash as fallback
-            return std::hash<K>{}(key) % numBuckets;
+            return std::hash<K>{}(key) % bucketCount;
         }
     }
 
-    // Rehash when load factor exceeds threshold
-    void rehash() {
-        size_t newSize = numBuckets * 2;
+    // Generic hash function
+    size_t getHash(const K& key) const {
+        return bucketFor(key, numBuckets);
+    }
+
+    // Redistribute into newSize buckets; nodes are relinked, not copied
+    void rehash(size_t newSize) {
         std::vector<std::list<HashNode>> newBuckets(newSize);
         
         for (auto& bucket : buckets) {
-            for (auto& node : bucket) {
-                size_t newIndex;
-                if constexpr (std::is_same_v<K, std::string>) {
-                    newIndex = hashString(node.key) % newSize;
-                } else if constexpr (std::is_integral_v<K>) {
-                    newIndex = hashInt(static_cast<int>(node.key)) % newSize;
-                } else {
-                    newIndex = std::hash<K>{}(node.key) % newSize;
-                }
-                newBuckets[newIndex].push_back(node);
+            while (!bucket.empty()) {
+                auto& target = newBuckets[bucketFor(bucket.front().key, newSize)];
+                target.splice(target.end(), bucket, bucket.begin());
             }
         }
         
@@ -140,7 +137,7 @@ public:
     void insert(const K& key, const V& value) {
         // Check load factor and rehash if needed
         if (static_cast<float>(numElements + 1) / numBuckets > maxLoadFactor) {
-            rehash();
+            rehash(numBuckets * 2);
         }
 
         size_t index = getHash(key);
@@ -158,6 +155,14 @@ public:
         numElements++;
     }
 
+    // Size the buckets once for count elements, so inserting up to
+    // that many never rehashes - O(n)
+    void reserve(size_t count) {
+        size_t newSize = numBuckets;
+        while (static_cast<float>(count) / newSize > maxLoadFactor) newSize *= 2;
+        if (newSize != numBuckets) rehash(newSize);
+    }
+
     // Search for a key - O(1) average
     bool search(const K& key, V* result = nullptr) const {
         size_t index = getHash(key);
@@ -171,6 +176,18 @@ public:
         return false;
     }
 
+    // Pointer to the stored value, or nullptr - no copy
+    const V* find(const K& key) const {
+        size_t index = getHash(key);
+
+        for (const auto& node : buckets[index]) {
+            if (node.key == key) {
+                return &node.value;
+            }
+        }
+        return nullptr;
+    }
+
     // Get value by key (throws if not found)
     V& get(const K& key) {
         size_t index = getHash(key);
@@ -207,7 +224,7 @@ public:
         
         // Insert default value if not found
         if (static_cast<float>(numElements + 1) / numBuckets > maxLoadFactor) {
-            rehash();
+            rehash(numBuckets * 2);
             index = getHash(key);
         }
         buckets[index].push_back(HashNode(key, V()));
@@ -284,6 +301,16 @@ public:
         return result;
     }
 
+    // Visit entries in bucket order until visit(key, value) returns false
+    template <typename Visit>
+    void scan(Visit visit) const {
+        for (const auto& bucket : buckets) {
+            for (const auto& node : bucket) {
+                if (!visit(node.key, node.value)) return;
+            }
+        }
+    }
+
     // Iterate over all elements
     void forEach(std::function<void(const K&, V&)> callback) {
         for (auto& bucket : buckets) {
@@ -0,0 +1,201 @@
+/**
+ * Smart Traffic Route Optimizer
+ * HTTP Request Parser Implementation
+ *
+ * Single pass over the request head that records string_views into the
+ * caller's buffer: request line, query parameters and headers land in
+ * fixed-capacity arrays, so parsing a request allocates nothing and
+ * copies nothing. The same pass frames the request (head length plus
+ * Content-Length) for the connection layer.
+ * The views are only valid while the parsed buffer is alive and unchanged.
+ * Time Complexity: O(length of the request head)
+ */
+
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <stdexcept>
+#include <cstddef>
+
+enum class HttpParseResult {
+    COMPLETE,               // head and body are in the buffer
+    INCOMPLETE,             // need more bytes (totalLength is set once the head is complete)
+    BAD_REQUEST,            // malformed request line or Content-Length
+    TOO_MANY_FIELDS,        // more headers or query parameters than fit
+    UNSUPPORTED_ENCODING    // Transfer-Encoding: chunked bodies are not supported
+};
+
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// ==================== FIELD LIST ====================
+
+/**
+ * Name/value views in arrival order. Requests carry a handful of fields,
+ * so a linear scan beats any map; iterators are plain pointers.
+ */
+template <size_t Capacity>
+class HttpFieldList {
+public:
+    typedef std::pair<std::string_view, std::string_view> Field;
+
+private:
+    Field fields[Capacity];
+    size_t count;
+
+public:
+    HttpFieldList() : count(0) {}
+
+    bool add(std::string_view name, std::string_view value) {
+        if (count == Capacity) return false;
+        fields[count++] = Field(name, value);
+        return true;
+    }
+
+    const Field* begin() const { return fields; }
+    const Field* end() const { return fields + count; }
+    size_t size() const { return count; }
+
+    // First field with exactly this name, or end()
+    const Field* find(std::string_view name) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (fields[i].first == name) return fields + i;
+        }
+        return end();
+    }
+
+    // Header names are case-insensitive
+    const Field* findIgnoreCase(std::string_view name) const {
+        for (size_t i = 0; i < count; ++i) {
+            if (equalsIgnoreCase(fields[i].first, name)) return fields + i;
+        }
+        return end();
+    }
+
+    // Copy of the value; throws std::out_of_range like std::map::at
+    std::string at(std::string_view name) const {
+        const Field* field = find(name);
+        if (field == end()) throw std::out_of_range("missing field");
+        return std::string(field->second);
+    }
+};
+
+// ==================== REQUEST ====================
+
+struct HttpRequest {
+    static const size_t MAX_HEADERS = 32;
+    static const size_t MAX_PARAMS = 16;
+
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::string_view query;
+    std::string_view body;
+    HttpFieldList<MAX_HEADERS> headers;
+    HttpFieldList<MAX_PARAMS> params;   // raw (not URL-decoded) query parameters
+    size_t headerLength;                // request line + headers + blank line
+    size_t totalLength;                 // headerLength + Content-Length
+
+    HttpRequest() : headerLength(0), totalLength(0) {}
+
+    // Header value ignoring name case, empty if absent
+    std::string_view header(std::string_view name) const {
+        auto it = headers.findIgnoreCase(name);
+        return it == headers.end() ? std::string_view() : it->second;
+    }
+};
+
+// ==================== PARSER ====================
+
+inline std::string_view trimHttpWhitespace(std::string_view text) {
+    size_t begin = 0, end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t')) --end;
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * Parse the request at the start of raw into *req (a fresh HttpRequest).
+ * Bytes after totalLength belong to the next (pipelined) request.
+ */
+inline HttpParseResult parseHttpRequest(std::string_view raw, HttpRequest* req) {
+    size_t headEnd = raw.find("\r\n\r\n");
+    if (headEnd == std::string_view::npos) return HttpParseResult::INCOMPLETE;
+
+    // Request line: METHOD SP target SP version
+    size_t lineEnd = raw.find("\r\n");
+    std::string_view line = raw.substr(0, lineEnd);
+    size_t methodEnd = line.find(' ');
+    size_t targetEnd = methodEnd == std::string_view::npos ? methodEnd : line.find(' ', methodEnd + 1);
+    if (targetEnd == std::string_view::npos || methodEnd == 0 ||
+        targetEnd == methodEnd + 1 || targetEnd + 1 == line.size()) {
+        return HttpParseResult::BAD_REQUEST;
+    }
+    req->method = line.substr(0, methodEnd);
+    req->version = line.substr(targetEnd + 1);
+    std::string_view target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+    // Query parameters: name=value pairs split on '&' (pairs without '=' are skipped)
+    size_t queryPos = target.find('?');
+    req->path = target.substr(0, queryPos);
+    if (queryPos != std::string_view::npos) {
+        req->query = target.substr(queryPos + 1);
+        std::string_view rest = req->query;
+        while (!rest.empty()) {
+            size_t amp = rest.find('&');
+            std::string_view param = rest.substr(0, amp);
+            size_t eqPos = param.find('=');
+            if (eqPos != std::string_view::npos &&
+                !req->params.add(param.substr(0, eqPos), param.substr(eqPos + 1))) {
+                return HttpParseResult::TOO_MANY_FIELDS;
+            }
+            if (amp == std::string_view::npos) break;
+            rest.remove_prefix(amp + 1);
+        }
+    }
+
+    // Headers: name ":" OWS value OWS (lines without a colon are ignored)
+    size_t contentLength = 0;
+    size_t pos = lineEnd + 2;
+    while (pos < headEnd) {
+        size_t next = raw.find("\r\n", pos);
+        std::string_view headerLine = raw.substr(pos, next - pos);
+        pos = next + 2;
+
+        size_t colon = headerLine.find(':');
+        if (colon == std::string_view::npos) continue;
+        std::string_view name = headerLine.substr(0, colon);
+        std::string_view value = trimHttpWhitespace(headerLine.substr(colon + 1));
+        if (!req->headers.add(name, value)) return HttpParseResult::TOO_MANY_FIELDS;
+
+        if (equalsIgnoreCase(name, "Content-Length")) {
+            if (value.empty() || value.size() > 18) return HttpParseResult::BAD_REQUEST;
+            contentLength = 0;
+            for (char c : value) {
+                if (c < '0' || c > '9') return HttpParseResult::BAD_REQUEST;
+                contentLength = contentLength * 10 + static_cast<size_t>(c - '0');
+            }
+        } else if (equalsIgnoreCase(name, "Transfer-Encoding")) {
+            return HttpParseResult::UNSUPPORTED_ENCODING;
+        }
+    }
+
+    req->headerLength = headEnd + 4;
+    req->totalLength = req->headerLength + contentLength;
+    if (raw.size() < req->totalLength) return HttpParseResult::INCOMPLETE;
+    req->body = raw.substr(req->headerLength, contentLength);
+    return HttpParseResult::COMPLETE;
+}
+
+#endif // HTTPPARSER_H
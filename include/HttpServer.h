@@ -19,51 +19,77 @@
 #include <ctime>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <charconv>
 
-#ifdef _WIN32
-    #include <winsock2.h>
-    #include <ws2tcpip.h>
-    #pragma comment(lib, "ws2_32.lib")
-    typedef int socklen_t;
-#else
-    #include <sys/socket.h>
-    #include <netinet/in.h>
-    #include <unistd.h>
-    #include <arpa/inet.h>
-    #define SOCKET int
-    #define INVALID_SOCKET -1
-    #define SOCKET_ERROR -1
-    #define closesocket close
-#endif
-
+#include "EventServer.h"   // platform socket headers
+#include "HttpParser.h"
+#include "RouteTable.h"
+#include "ResponseStream.h"
+#include "PayloadCache.h"
+#include "Metrics.h"
 #include "TrafficManager.h"
 
+enum class ServerMode {
+    EVENT_LOOP,               // epoll / IOCP + bounded worker pool
+    THREAD_PER_CONNECTION     // one detached thread per client
+};
+
+struct ServerConfig {
+    ServerMode mode = ServerMode::EVENT_LOOP;
+    size_t workerThreads = 0;              // 0 = one per hardware thread
+    size_t maxQueuedRequests = 1024;       // beyond this, answer 503
+    size_t maxRequestBytes = 1 << 20;      // headers + body
+    int keepAliveTimeoutSeconds = 15;
+};
+
 class HttpServer {
 private:
+    typedef std::string (HttpServer::*RouteHandler)(const HttpRequest&);
+    // Writes its own status line and headers to the sink; returns the tail of the body
+    typedef std::string (HttpServer::*StreamingRouteHandler)(const HttpRequest&, bool* keepAlive,
+                                                               ResponseSink&);
+
+    struct Route {
+        RouteHandler handler = nullptr;
+        StreamingRouteHandler streamingHandler = nullptr;
+
+        Route() {}
+        Route(RouteHandler h) : handler(h) {}
+        Route(StreamingRouteHandler h) : streamingHandler(h) {}
+    };
+
     int port;
     SOCKET serverSocket;
     bool running;
     TrafficManager& trafficManager;
-    std::map<std::string, std::function<std::string(const std::string&, const std::string&)>> routes;
+    ServerConfig config;
+    std::unique_ptr<EventServer> eventServer;   // EVENT_LOOP mode, created by start()
+
+    // THREAD_PER_CONNECTION counters
+    std::atomic<size_t> activeClients;
+    std::atomic<uint64_t> threadedRequests;
+    std::atomic<uint64_t> threadedKeepAliveRequests;
+
+    RouteTable<Route> routes;   // path -> handler, built once in the constructor
+    PayloadCache payloads;      // pre-serialized read-mostly responses
+
+    static constexpr size_t MAX_NEAREST_RESULTS = 100;   // cap for /api/nearest
+    static constexpr size_t LIST_BATCH = 256;            // records serialized per data lock hold
+    static constexpr size_t MAX_MATRIX_CELLS = 250000;   // sources x targets for /api/matrix
+    static constexpr int MAX_ALTERNATIVES = 5;           // /api/route?alternatives=
 
-    // SpatialIndex spatialIndex;
     // PerformanceMonitor perfMonitor;
-    // AutocompleteEngine autocomplete;
     // StressTester stressTester;
 
-    struct HttpRequest {
-        std::string method;
-        std::string path;
-        std::string query;
-        std::string body;
-        std::map<std::string, std::string> headers;
-        std::map<std::string, std::string> params;
-    };
-
     // ============ NEW: Helper Functions for Authentication ============
     
     // Extract field from JSON body
-    std::string extractFromBody(const std::string& body, const std::string& field) {
+    std::string extractFromBody(std::string_view body, const std::string& field) {
         size_t pos = body.find("\"" + field + "\"");
         if (pos == std::string::npos) return "";
         
@@ -81,13 +107,13 @@ private:
             size_t start = pos + 1;
             size_t end = body.find("\"", start);
             if (end == std::string::npos) return "";
-            return body.substr(start, end - start);
+            return std::string(body.substr(start, end - start));
         } else {
             // Number or boolean
             size_t start = pos;
             size_t end = body.find_first_of(",}", start);
             if (end == std::string::npos) return "";
-            return body.substr(start, end - start);
+            return std::string(body.substr(start, end - start));
         }
     }
     
@@ -116,160 +142,354 @@ private:
 
     // ============ END NEW Helper Functions ============
 
-    HttpRequest parseRequest(const std::string& raw) {
-        HttpRequest req;
-        std::istringstream stream(raw);
-        std::string line;
-
-        // Parse request line
-        if (std::getline(stream, line)) {
-            std::istringstream lineStream(line);
-            lineStream >> req.method >> req.path;
-            
-            // Extract query string
-            size_t queryPos = req.path.find('?');
-            if (queryPos != std::string::npos) {
-                req.query = req.path.substr(queryPos + 1);
-                req.path = req.path.substr(0, queryPos);
-                
-                // Parse query parameters
-                std::istringstream queryStream(req.query);
-                std::string param;
-                while (std::getline(queryStream, param, '&')) {
-                    size_t eqPos = param.find('=');
-                    if (eqPos != std::string::npos) {
-                        req.params[param.substr(0, eqPos)] = param.substr(eqPos + 1);
-                    }
-                }
-            }
-        }
-
-        // Parse headers
-        while (std::getline(stream, line) && line != "\r" && !line.empty()) {
-            size_t colonPos = line.find(':');
-            if (colonPos != std::string::npos) {
-                std::string key = line.substr(0, colonPos);
-                std::string value = line.substr(colonPos + 2);
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                req.headers[key] = value;
-            }
-        }
-
-        // Parse body
-        std::ostringstream bodyStream;
-        while (std::getline(stream, line)) {
-            bodyStream << line;
-        }
-        req.body = bodyStream.str();
-
-        return req;
-    }
-
     std::string createResponse(int statusCode, const std::string& body, 
-                               const std::string& contentType = "application/json") {
+                               const std::string& contentType = "application/json",
+                               const std::string& extraHeaders = "") {
         std::string statusText;
         switch (statusCode) {
             case 200: statusText = "OK"; break;
             case 201: statusText = "Created"; break;
+            case 202: statusText = "Accepted"; break;
+            case 304: statusText = "Not Modified"; break;
             case 400: statusText = "Bad Request"; break;
             case 401: statusText = "Unauthorized"; break;
             case 404: statusText = "Not Found"; break;
+            case 413: statusText = "Payload Too Large"; break;
+            case 431: statusText = "Request Header Fields Too Large"; break;
             case 500: statusText = "Internal Server Error"; break;
+            case 501: statusText = "Not Implemented"; break;
+            case 503: statusText = "Service Unavailable"; break;
             default: statusText = "Unknown";
         }
 
-        std::ostringstream response;
-        response << "HTTP/1.1 " << statusCode << " " << statusText << "\r\n";
-        response << "Content-Type: " << contentType << "\r\n";
-        response << "Content-Length: " << body.length() << "\r\n";
-        response << "Access-Control-Allow-Origin: *\r\n";
-        response << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-        response << "Access-Control-Allow-Headers: Content-Type\r\n";
-        response << "Connection: close\r\n";
-        response << "\r\n";
-        response << body;
+        // Sized once: the body is copied a single time, straight into place
+        std::string response;
+        response.reserve(body.size() + 256);
+        response += "HTTP/1.1 ";
+        response += std::to_string(statusCode);
+        response += " ";
+        response += statusText;
+        response += "\r\nContent-Type: ";
+        response += contentType;
+        response += "\r\n";
+        if (statusCode != 304) {   // a 304 has no body, and its length is the cached one's
+            response += "Content-Length: ";
+            response += std::to_string(body.length());
+            response += "\r\n";
+        }
+        response += extraHeaders;
+        response += "Access-Control-Allow-Origin: *\r\n";
+        response += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
+        response += "Access-Control-Allow-Headers: Content-Type\r\n";
+        response += "\r\n";
+        response += body;
 
-        return response.str();
+        return response;
     }
 
-    void handleClient(SOCKET clientSocket) {
-        char buffer[8192];
-        int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-    
-        if (bytesReceived <= 0) {
-            closesocket(clientSocket);
-            return;
-        }
+    // ==================== CONNECTION HANDLING ====================
 
-        buffer[bytesReceived] = '\0';
-        std::string requestStr(buffer);
-    
-        HttpRequest req = parseRequest(requestStr);
-        std::string response;
+    // Set the Connection header of a response built by createResponse
+    static std::string withConnectionHeader(std::string response, bool keepAlive) {
+        size_t headerEnd = response.find("\r\n\r\n");
+        response.insert(headerEnd + 2, keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+        return response;
+    }
 
-        // Handle CORS preflight FIRST
-        if (req.method == "OPTIONS") {
-            response = createResponse(200, "");
+    std::string errorResponse(int statusCode, const std::string& message) {
+        return withConnectionHeader(createResponse(statusCode, "{\"error\": \"" + message + "\"}"), false);
+    }
+
+    /**
+     * Length of the first complete request in buffer: headers up to the
+     * blank line plus Content-Length body bytes. 0 if more bytes are needed;
+     * std::string::npos with *error set if the request cannot be accepted.
+     */
+    size_t frameRequest(const std::string& buffer, std::string* error) {
+        HttpRequest req;
+        switch (parseHttpRequest(buffer, &req)) {
+            case HttpParseResult::COMPLETE:
+            case HttpParseResult::INCOMPLETE:
+                break;
+            case HttpParseResult::BAD_REQUEST:
+                *error = errorResponse(400, "Malformed request");
+                return std::string::npos;
+            case HttpParseResult::TOO_MANY_FIELDS:
+                *error = errorResponse(431, "Too many headers or query parameters");
+                return std::string::npos;
+            case HttpParseResult::UNSUPPORTED_ENCODING:
+                *error = errorResponse(501, "Chunked request bodies are not supported");
+                return std::string::npos;
         }
-        // ============ Authentication Routes ============
-        else if (req.path == "/api/register") {
-            response = handleRegister(req);
+
+        // totalLength is known as soon as the head is complete
+        if (buffer.size() > config.maxRequestBytes || req.totalLength > config.maxRequestBytes) {
+            *error = errorResponse(413, "Request too large");
+            return std::string::npos;
         }
-        else if (req.path == "/api/login") {
-            response = handleLogin(req);
+        return req.totalLength != 0 && buffer.size() >= req.totalLength ? req.totalLength : 0;
+    }
+
+    /**
+     * Answer one framed request; *keepAlive tells the caller whether to keep
+     * reading. Streaming routes send most of their response through sink
+     * and return only what is left.
+     */
+    std::string respond(const std::string& raw, bool* keepAlive, ResponseSink& sink) {
+        HttpRequest req;
+        Metrics::Timer parseTimer(Metric::HTTP_PARSE);
+        parseHttpRequest(raw, &req);   // already framed, so complete
+        parseTimer.stop();
+        Metrics::increment(Counter::HTTP_REQUESTS);
+
+        // HTTP/1.1 connections persist unless closed; 1.0 ones only on request
+        std::string_view connection = req.header("Connection");
+        if (req.version == "HTTP/1.1") {
+            *keepAlive = !equalsIgnoreCase(connection, "close");
+        } else {
+            *keepAlive = equalsIgnoreCase(connection, "keep-alive");
         }
-        else if (req.path == "/api/logout") {
-            response = handleLogout(req);
+
+        std::string response;
+        try {
+            Metrics::Timer dispatchTimer(Metric::HTTP_DISPATCH);
+            const Route* route = routes.find(req.path);
+            dispatchTimer.stop();
+            Metrics::Timer handlerTimer(Metric::HTTP_HANDLER);
+            if (req.method != "OPTIONS" && route != nullptr && route->streamingHandler != nullptr) {
+                return (this->*(route->streamingHandler))(req, keepAlive, sink);
+            }
+            response = dispatch(req, route);
+        } catch (const std::exception&) {
+            // e.g. std::stoi on a non-numeric parameter
+            response = createResponse(400, "{\"error\": \"Invalid request parameters\"}");
         }
-        else if (req.path == "/api/profile") {
-            response = handleProfile(req);
+        if (response.size() > 9 && response[9] >= '4') Metrics::increment(Counter::HTTP_ERRORS);   // "HTTP/1.1 4xx"
+        return withConnectionHeader(response, *keepAlive);
+    }
+
+    std::string dispatch(const HttpRequest& req, const Route* route) {
+        // Handle CORS preflight FIRST
+        if (req.method == "OPTIONS") {
+            return createResponse(200, "");
         }
-        else if (req.path == "/api/users/active") {
-            response = handleActiveUsers(req);
+
+        if (route == nullptr) {
+            return createResponse(404, "{\"error\": \"Not Found\"}");
         }
+        return (this->*(route->handler))(req);
+    }
+
+    void registerRoutes() {
+        // ============ Authentication Routes ============
+        routes.add("/api/register", &HttpServer::handleRegister);
+        routes.add("/api/login", &HttpServer::handleLogin);
+        routes.add("/api/logout", &HttpServer::handleLogout);
+        routes.add("/api/profile", &HttpServer::handleProfile);
+        routes.add("/api/users/active", &HttpServer::handleActiveUsers);
         // ============ Data Routes ============
-        else if (req.path == "/api/health") {
-            response = handleHealth(req);
-        }
-        else if (req.path == "/api/junctions") {
-            response = handleJunctions(req);
-        }
-        else if (req.path == "/api/junction" || req.path.rfind("/api/junction/", 0) == 0) {
-            response = handleJunction(req);
-        }
-        else if (req.path == "/api/route") {
-            response = handleRoute(req);
-        }
-        else if (req.path == "/api/roads") {
-            response = handleRoads(req);
-        }
-        else if (req.path == "/api/traffic") {
-            response = handleTraffic(req);
-        }
-        else if (req.path == "/api/stats") {
-            response = handleStats(req);
-        }
-        else if (req.path == "/api/search") {
-            response = handleSearch(req);
-        }
+        routes.add("/api/health", &HttpServer::handleHealth);
+        routes.add("/api/junctions", &HttpServer::streamJunctions);
+        routes.add("/api/junction", &HttpServer::handleJunction);
+        routes.addPrefix("/api/junction/", &HttpServer::handleJunction);
+        routes.add("/api/route", &HttpServer::handleRoute);
+        routes.add("/api/matrix", &HttpServer::handleMatrix);
+        routes.add("/api/isochrone", &HttpServer::handleIsochrone);
+        routes.add("/api/roads", &HttpServer::streamRoads);
+        routes.add("/api/traffic", &HttpServer::handleTraffic);
+        routes.add("/api/stats", &HttpServer::handleStats);
+        routes.add("/api/search", &HttpServer::handleSearch);
+        routes.add("/api/nearest", &HttpServer::handleNearest);
+        routes.add("/api/autocomplete", &HttpServer::handleAutocomplete);
         // ✅ Smart Search (NEW)
-        else if (req.path == "/api/smart-search") {
-            response = handleSmartSearch(req);
+        routes.add("/api/smart-search", &HttpServer::handleSmartSearch);
+        routes.add("/api/add-from-osm", &HttpServer::handleAddFromOSM);
+        routes.add("/api/metrics", &HttpServer::handleMetrics);
+        routes.build();
+    }
+
+    static bool sendAll(SOCKET socket, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            int n = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
         }
-        else if (req.path == "/api/add-from-osm") {
-            response = handleAddFromOSM(req);
+        return true;
+    }
+
+    // THREAD_PER_CONNECTION: streamed parts go straight to the socket
+    class SocketSink : public ResponseSink {
+    private:
+        SOCKET socket;
+
+    public:
+        explicit SocketSink(SOCKET s) : socket(s) {}
+        bool write(std::string data) override { return sendAll(socket, data); }
+    };
+
+    // THREAD_PER_CONNECTION: serve requests until the client closes or idles out
+    void handleClient(SOCKET clientSocket) {
+        activeClients++;
+#ifdef _WIN32
+        DWORD timeout = config.keepAliveTimeoutSeconds * 1000;
+#else
+        struct timeval timeout;
+        timeout.tv_sec = config.keepAliveTimeoutSeconds;
+        timeout.tv_usec = 0;
+#endif
+        setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, (char*)&timeout, sizeof(timeout));
+
+        std::string buffer;
+        char chunk[8192];
+        bool keepAlive = true;
+        uint64_t served = 0;
+        SocketSink sink(clientSocket);
+        while (keepAlive) {
+            std::string error;
+            size_t length = frameRequest(buffer, &error);
+            if (length == std::string::npos) {
+                sendAll(clientSocket, error);
+                break;
+            }
+            if (length == 0) {
+                int bytesReceived = recv(clientSocket, chunk, sizeof(chunk), 0);
+                if (bytesReceived <= 0) break;   // closed, failed or idle timeout
+                buffer.append(chunk, bytesReceived);
+                continue;
+            }
+
+            std::string request = buffer.substr(0, length);
+            buffer.erase(0, length);
+            threadedRequests++;
+            if (served++ > 0) threadedKeepAliveRequests++;
+            if (!sendAll(clientSocket, respond(request, &keepAlive, sink))) break;
         }
-        else if (req.path == "/api/metrics") {
-           response = handleMetrics(req);
+
+        closesocket(clientSocket);
+        activeClients--;
+    }
+
+    // Connection and worker queue counters for /api/stats
+    std::string serverStatsJson() const {
+        std::string json = "{";
+        if (eventServer) {
+            EventServer::Stats stats = eventServer->getStats();
+            json += "\"mode\": \"event\",";
+            json += "\"activeConnections\": " + std::to_string(stats.activeConnections) + ",";
+            json += "\"acceptedConnections\": " + std::to_string(stats.acceptedConnections) + ",";
+            json += "\"requests\": " + std::to_string(stats.requests) + ",";
+            json += "\"keepAliveRequests\": " + std::to_string(stats.keepAliveRequests) + ",";
+            json += "\"pipelinedRequests\": " + std::to_string(stats.pipelinedRequests) + ",";
+            json += "\"rejectedRequests\": " + std::to_string(stats.rejectedRequests) + ",";
+            json += "\"idleTimeouts\": " + std::to_string(stats.idleTimeouts) + ",";
+            json += "\"workers\": " + std::to_string(stats.workers.workers) + ",";
+            json += "\"busyWorkers\": " + std::to_string(stats.workers.busyWorkers) + ",";
+            json += "\"queueDepth\": " + std::to_string(stats.workers.queueDepth) + ",";
+            json += "\"maxQueueDepth\": " + std::to_string(stats.workers.maxQueueDepth) + ",";
+            json += "\"queueCapacity\": " + std::to_string(stats.workers.capacity) + ",";
+            json += "\"avgQueueWaitMs\": " + std::to_string(stats.workers.avgQueueWaitMs) + ",";
+            json += "\"maxQueueWaitMs\": " + std::to_string(stats.workers.maxQueueWaitMs);
+        } else {
+            json += "\"mode\": \"threads\",";
+            json += "\"activeConnections\": " + std::to_string(activeClients.load()) + ",";
+            json += "\"requests\": " + std::to_string(threadedRequests.load()) + ",";
+            json += "\"keepAliveRequests\": " + std::to_string(threadedKeepAliveRequests.load());
         }
-        else {
-            response = createResponse(404, "{\"error\": \"Not Found\"}");
+        json += "}";
+        return json;
+    }
+
+    // Nominatim geocoder: cache, queue and upstream request counters
+    std::string geocoderStatsJson() {
+        Geocoder::Stats stats = trafficManager.getGeocoderStats();
+        std::string json = "{";
+        json += "\"online\": " + std::string(stats.online ? "true" : "false") + ",";
+        json += "\"cachedAnswers\": " + std::to_string(stats.cachedAnswers) + ",";
+        json += "\"queueDepth\": " + std::to_string(stats.queueDepth) + ",";
+        json += "\"cacheHits\": " + std::to_string(stats.cacheHits) + ",";
+        json += "\"coalesced\": " + std::to_string(stats.coalesced) + ",";
+        json += "\"requests\": " + std::to_string(stats.requests) + ",";
+        json += "\"failures\": " + std::to_string(stats.failures) + ",";
+        json += "\"dropped\": " + std::to_string(stats.dropped);
+        json += "}";
+        return json;
+    }
+
+    // 202 for a Nominatim lookup still running; the client asks again after Retry-After
+    std::string geocodePendingResponse(std::string json) {
+        long long waitMs = trafficManager.getGeocodeWait().count();
+        json += "\"pending\": true, \"retryAfterMs\": " + std::to_string(waitMs) + "}";
+        return createResponse(202, json, "application/json",
+                              "Retry-After: " + std::to_string((waitMs + 999) / 1000) + "\r\n");
+    }
+
+    // Inter-city route hierarchy; rebuildFailures > 0 with ready false means
+    // an edit left routing on plain search
+    std::string routeHierarchyStatsJson() {
+        TrafficManager::RouteHierarchyStats stats = trafficManager.getRouteHierarchyStats();
+        std::string json = "{";
+        json += "\"ready\": " + std::string(stats.ready ? "true" : "false") + ",";
+        json += "\"portals\": " + std::to_string(stats.portals) + ",";
+        json += "\"customizations\": " + std::to_string(stats.customizations) + ",";
+        json += "\"rebuilds\": " + std::to_string(stats.rebuilds) + ",";
+        json += "\"rebuildFailures\": " + std::to_string(stats.rebuildFailures);
+        json += "}";
+        return json;
+    }
+
+    // Transient allocations of route searches, per search
+    std::string routeArenaStatsJson() {
+        TrafficManager::RouteAllocationStats stats = trafficManager.getRouteAllocationStats();
+        double searches = static_cast<double>(std::max<uint64_t>(1, stats.searches));
+        std::string json = "{";
+        json += "\"searches\": " + std::to_string(stats.searches) + ",";
+        json += "\"allocations\": " + std::to_string(stats.arenaAllocations) + ",";
+        json += "\"bytes\": " + std::to_string(stats.arenaBytes) + ",";
+        json += "\"heapAllocations\": " + std::to_string(stats.heapAllocations) + ",";
+        json += "\"allocationsPerSearch\": " + std::to_string(stats.arenaAllocations / searches) + ",";
+        json += "\"bytesPerSearch\": " + std::to_string(stats.arenaBytes / searches) + ",";
+        json += "\"heapAllocationsPerSearch\": " + std::to_string(stats.heapAllocations / searches);
+        json += "}";
+        return json;
+    }
+
+    std::string routeCacheStatsJson() {
+        std::vector<RouteCache::ShardStats> shards = trafficManager.getRouteCacheStats();
+        uint64_t hits = 0, misses = 0;
+        std::string shardsJson = "[";
+        for (size_t i = 0; i < shards.size(); ++i) {
+            const RouteCache::ShardStats& shard = shards[i];
+            hits += shard.hits;
+            misses += shard.misses;
+            if (i > 0) shardsJson += ",";
+            shardsJson += "{\"entries\": " + std::to_string(shard.entries) +
+                          ",\"hits\": " + std::to_string(shard.hits) +
+                          ",\"misses\": " + std::to_string(shard.misses) +
+                          ",\"evictions\": " + std::to_string(shard.evictions) +
+                          ",\"invalidations\": " + std::to_string(shard.invalidations) + "}";
         }
+        shardsJson += "]";
 
-        send(clientSocket, response.c_str(), response.length(), 0);
-        closesocket(clientSocket);
+        double hitRate = hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) * 100.0 : 0.0;
+        std::string json = "{";
+        json += "\"hitRate\": " + std::to_string(hitRate) + ",";
+        json += "\"hits\": " + std::to_string(hits) + ",";
+        json += "\"misses\": " + std::to_string(misses) + ",";
+        json += "\"shards\": " + shardsJson;
+        json += "}";
+        return json;
+    }
+
+    std::string payloadCacheStatsJson() {
+        PayloadCache::Stats stats = payloads.getStats();
+        std::string json = "{";
+        json += "\"entries\": " + std::to_string(stats.entries) + ",";
+        json += "\"hits\": " + std::to_string(stats.hits) + ",";
+        json += "\"builds\": " + std::to_string(stats.builds) + ",";
+        json += "\"notModified\": " + std::to_string(stats.notModified);
+        json += "}";
+        return json;
     }
 
     // ============ NEW: Authentication Handlers ============
@@ -380,17 +600,33 @@ private:
         return createResponse(200, json);
     }
 
-    std::string handleJunctions(const HttpRequest& req) {
-        auto junctions = trafficManager.getAllJunctions();
-        
-        std::string json = "{\"junctions\": [";
-        for (size_t i = 0; i < junctions.size(); ++i) {
-            json += junctions[i].toJson();
-            if (i < junctions.size() - 1) json += ",";
+    // Junctions, all or one city's: ?city=&offset=&limit= (no limit: the rest)
+    std::string streamJunctions(const HttpRequest& req, bool* keepAlive, ResponseSink& sink) {
+        auto visitBatch = [this](const int* batch, size_t count, const auto& visit) {
+            trafficManager.visitJunctions(batch, count, visit);
+        };
+        if (req.query.empty()) {   // the full list the map loads: pre-serialized per version
+            std::string response = serveCached(req, "junctions", trafficManager.getJunctionsVersion(), [&]() {
+                size_t total = 0;
+                std::vector<int> ids = trafficManager.pageJunctionIds(std::string(), 0, SIZE_MAX, &total);
+                std::string body;
+                appendList(body, "junctions", ids, total, 0, visitBatch, []() { return true; });
+                return body;
+            });
+            return withConnectionHeader(response, *keepAlive);
         }
-        json += "], \"count\": " + std::to_string(junctions.size()) + "}";
-        
-        return createResponse(200, json);
+
+        size_t offset, limit;
+        if (!parsePageParams(req, &offset, &limit)) {
+            return withConnectionHeader(
+                createResponse(400, "{\"error\": \"Invalid offset or limit parameter\"}"), *keepAlive);
+        }
+        auto city = req.params.find("city");
+        size_t total = 0;
+        std::vector<int> ids = trafficManager.pageJunctionIds(
+            city == req.params.end() ? std::string() : urlDecode(std::string(city->second)),
+            offset, limit, &total);
+        return streamList(req, keepAlive, sink, "junctions", ids, total, offset, visitBatch);
     }
 
     std::string handleJunction(const HttpRequest& req) {
@@ -428,23 +664,210 @@ private:
             useTime = (req.params.at("optimize") == "time");
         }
 
-        RouteResult result = trafficManager.findRoute(from, to, useTime);
-        return createResponse(200, result.toJson());
+        RouteAlgorithm algorithm = RouteAlgorithm::HIERARCHY;
+        if (req.params.find("algo") != req.params.end() &&
+            !parseRouteAlgorithm(req.params.at("algo"), &algorithm)) {
+            return createResponse(400, "{\"error\": \"Unknown algo (use ch, dijkstra, astar, bidijkstra or biastar)\"}");
+        }
+
+        int alternatives = 0;
+        if (req.params.find("alternatives") != req.params.end()) {
+            double value;
+            if (!parseDoubleParam(req, "alternatives", &value) || value < 0 ||
+                value > MAX_ALTERNATIVES || value != std::floor(value)) {
+                return createResponse(400, "{\"error\": \"Invalid alternatives (0 to " +
+                                      std::to_string(MAX_ALTERNATIVES) + ")\"}");
+            }
+            alternatives = static_cast<int>(value);
+        }
+
+        if (req.params.find("depart") != req.params.end()) {
+            double depart;
+            if (!parseDeparture(req.params.at("depart"), &depart)) {
+                return createResponse(400, "{\"error\": \"Invalid depart (Unix seconds, YYYY-MM-DDTHH:MM in PKT, or now)\"}");
+            }
+            if (!useTime || alternatives > 0) {
+                return createResponse(400, "{\"error\": \"depart works with optimize=time and no alternatives\"}");
+            }
+            return createResponse(200, routeJson(trafficManager.findRouteDepartingAt(from, to, depart)));
+        }
+
+        return createResponse(200, routeJson(trafficManager.findRoute(from, to, useTime, algorithm, alternatives)));
     }
 
-    std::string handleRoads(const HttpRequest& req) {
-        auto roads = trafficManager.getAllRoads();
-        
-        std::string json = "{\"roads\": [";
-        for (size_t i = 0; i < roads.size(); ++i) {
-            json += roads[i].toJson();
-            if (i < roads.size() - 1) json += ",";
+    static std::string routeJson(const RouteResult& result) {
+        Metrics::Timer timer(Metric::ROUTE_SERIALIZE);
+        return result.toJson();
+    }
+
+    // POST {"sources": [...], "targets": [...], "optimize": "time"|"distance"}
+    // (or ?sources=1,2&targets=3,4): time and distance for every pair
+    std::string handleMatrix(const HttpRequest& req) {
+        std::vector<int> sources, targets;
+        if (!parseIdList(req, "sources", &sources) || !parseIdList(req, "targets", &targets) ||
+            sources.empty() || targets.empty()) {
+            return createResponse(400, "{\"error\": \"Missing or invalid sources or targets (junction ID arrays)\"}");
         }
-        json += "], \"count\": " + std::to_string(roads.size()) + "}";
-        
+        if (sources.size() * targets.size() > MAX_MATRIX_CELLS) {
+            return createResponse(400, "{\"error\": \"Matrix too large (at most " +
+                                  std::to_string(MAX_MATRIX_CELLS) + " cells)\"}");
+        }
+
+        std::string optimize = extractFromBody(req.body, "optimize");
+        if (optimize.empty() && req.params.find("optimize") != req.params.end()) {
+            optimize = std::string(req.params.at("optimize"));
+        }
+        bool useTime = optimize != "distance";
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        MatrixResult matrix = trafficManager.findRouteMatrix(sources, targets, useTime);
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+        size_t unreachable = std::count_if(matrix.times.begin(), matrix.times.end(),
+                                           [](double value) { return !std::isfinite(value); });
+        auto appendRows = [&](std::string& out, const std::vector<double>& cells) {
+            out += '[';
+            for (size_t i = 0; i < matrix.numSources; ++i) {
+                if (i > 0) out += ',';
+                out += '[';
+                for (size_t j = 0; j < matrix.numTargets; ++j) {
+                    if (j > 0) out += ',';
+                    double value = cells[i * matrix.numTargets + j];
+                    if (std::isfinite(value)) {
+                        appendJsonNumber(out, value);
+                    } else {
+                        out += "null";
+                    }
+                }
+                out += ']';
+            }
+            out += ']';
+        };
+        auto appendIds = [](std::string& out, const std::vector<int>& ids) {
+            out += '[';
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (i > 0) out += ',';
+                appendJsonNumber(out, static_cast<long long>(ids[i]));
+            }
+            out += ']';
+        };
+
+        std::string json;
+        json.reserve(64 + matrix.times.size() * 24);
+        json += "{\"optimize\":\"";
+        json += useTime ? "time" : "distance";
+        json += "\",\"sources\":";
+        appendIds(json, sources);
+        json += ",\"targets\":";
+        appendIds(json, targets);
+        json += ",\"times\":";
+        appendRows(json, matrix.times);
+        json += ",\"distances\":";
+        appendRows(json, matrix.distances);
+        json += ",\"unreachable\":" + std::to_string(unreachable);
+        json += ",\"settledNodes\":" + std::to_string(matrix.settledNodes);
+        json += ",\"computeMs\":";
+        appendJsonNumber(json, elapsedMs);
+        json += "}";
         return createResponse(200, json);
     }
 
+    // ?from=&minutes= (or &km= for a distance budget), &hull=convex for the outline
+    std::string handleIsochrone(const HttpRequest& req) {
+        double from;
+        if (!parseDoubleParam(req, "from", &from) || from != std::floor(from)) {
+            return createResponse(400, "{\"error\": \"Missing or invalid from parameter\"}");
+        }
+
+        bool useTime = req.params.find("km") == req.params.end();
+        double budget;
+        if (!parseDoubleParam(req, useTime ? "minutes" : "km", &budget) || budget < 0) {
+            return createResponse(400, "{\"error\": \"Missing or invalid minutes (or km) parameter\"}");
+        }
+
+        bool withHull = false;
+        if (req.params.find("hull") != req.params.end()) {
+            std::string_view hull = req.params.at("hull");
+            if (hull == "convex" || hull == "1" || hull == "true") {
+                withHull = true;
+            } else if (hull != "none" && hull != "0" && hull != "false") {
+                return createResponse(400, "{\"error\": \"Unknown hull (use convex or none)\"}");
+            }
+        }
+
+        std::vector<ReachableJunction> reachable;
+        std::vector<GeoPoint> hull;
+        int settled = trafficManager.findReachable(static_cast<int>(from), budget, useTime,
+                                                   &reachable, withHull ? &hull : nullptr);
+        if (settled == 0) {
+            return createResponse(404, "{\"error\": \"Junction not found\"}");
+        }
+
+        std::string json;
+        json.reserve(128 + reachable.size() * 56);
+        json += "{\"from\":";
+        appendJsonNumber(json, static_cast<long long>(from));
+        json += ",\"optimize\":\"";
+        json += useTime ? "time" : "distance";
+        json += "\",\"budget\":";
+        appendJsonNumber(json, budget);
+        json += ",\"count\":" + std::to_string(reachable.size());
+        json += ",\"settledNodes\":" + std::to_string(settled);
+        json += ",\"junctions\":[";
+        for (size_t i = 0; i < reachable.size(); ++i) {
+            if (i > 0) json += ',';
+            json += "{\"id\":";
+            appendJsonNumber(json, static_cast<long long>(reachable[i].id));
+            json += ",\"time\":";
+            appendJsonNumber(json, reachable[i].time);
+            json += ",\"distance\":";
+            appendJsonNumber(json, reachable[i].distance);
+            json += '}';
+        }
+        json += ']';
+        if (withHull) {
+            json += ",\"hull\":[";
+            for (size_t i = 0; i < hull.size(); ++i) {
+                if (i > 0) json += ',';
+                json += '[';
+                appendJsonNumber(json, hull[i].latitude);
+                json += ',';
+                appendJsonNumber(json, hull[i].longitude);
+                json += ']';
+            }
+            json += ']';
+        }
+        json += '}';
+        return createResponse(200, json);
+    }
+
+    // Roads: ?offset=&limit= (no limit: the rest)
+    std::string streamRoads(const HttpRequest& req, bool* keepAlive, ResponseSink& sink) {
+        auto visitBatch = [this](const int* batch, size_t count, const auto& visit) {
+            trafficManager.visitRoads(batch, count, visit);
+        };
+        if (req.query.empty()) {
+            std::string response = serveCached(req, "roads", trafficManager.getRoadsVersion(), [&]() {
+                size_t total = 0;
+                std::vector<int> ids = trafficManager.pageRoadIds(0, SIZE_MAX, &total);
+                std::string body;
+                appendList(body, "roads", ids, total, 0, visitBatch, []() { return true; });
+                return body;
+            });
+            return withConnectionHeader(response, *keepAlive);
+        }
+
+        size_t offset, limit;
+        if (!parsePageParams(req, &offset, &limit)) {
+            return withConnectionHeader(
+                createResponse(400, "{\"error\": \"Invalid offset or limit parameter\"}"), *keepAlive);
+        }
+        size_t total = 0;
+        std::vector<int> ids = trafficManager.pageRoadIds(offset, limit, &total);
+        return streamList(req, keepAlive, sink, "roads", ids, total, offset, visitBatch);
+    }
+
     std::string handleTraffic(const HttpRequest& req) {
         if (req.method == "POST" || req.method == "PUT") {
             if (req.params.find("road") == req.params.end() || 
@@ -475,7 +898,9 @@ private:
         for (size_t i = 0; i < roads.size(); ++i) {
             json += "{";
             json += "\"roadId\": " + std::to_string(roads[i].id) + ",";
-            json += "\"name\": \"" + roads[i].name + "\",";
+            json += "\"name\": \"";
+            appendJsonString(json, roads[i].name);
+            json += "\",";
             json += "\"level\": \"" + trafficLevelToString(roads[i].trafficLevel) + "\",";
             json += "\"multiplier\": " + std::to_string(getTrafficMultiplier(roads[i].trafficLevel));
             json += "}";
@@ -489,7 +914,12 @@ private:
         std::string json = "{";
         json += "\"junctions\": " + std::to_string(trafficManager.getJunctionCount()) + ",";
         json += "\"roads\": " + std::to_string(trafficManager.getRoadCount()) + ",";
-        json += "\"cacheHitRate\": " + std::to_string(trafficManager.getCacheHitRate());
+        json += "\"routeCache\": " + routeCacheStatsJson() + ",";
+        json += "\"routeArena\": " + routeArenaStatsJson() + ",";
+        json += "\"routeHierarchy\": " + routeHierarchyStatsJson() + ",";
+        json += "\"geocoder\": " + geocoderStatsJson() + ",";
+        json += "\"server\": " + serverStatsJson() + ",";
+        json += "\"payloadCache\": " + payloadCacheStatsJson();
         json += "}";
         return createResponse(200, json);
     }
@@ -513,10 +943,267 @@ private:
         return createResponse(200, json);
     }
 
+    // Type-ahead name completion: ?q=prefix[&limit=]
+    std::string handleAutocomplete(const HttpRequest& req) {
+        if (req.params.find("q") == req.params.end()) {
+            return createResponse(400, "{\"error\": \"Missing q parameter\"}");
+        }
+
+        size_t limit = 10;
+        if (req.params.find("limit") != req.params.end()) {
+            double value;
+            if (!parseDoubleParam(req, "limit", &value) || value < 1) {
+                return createResponse(400, "{\"error\": \"Invalid limit parameter\"}");
+            }
+            limit = static_cast<size_t>(std::min(value, static_cast<double>(CompactTrie::TOP_K)));
+        }
+
+        auto results = trafficManager.autocompleteJunctions(urlDecode(req.params.at("q")), limit);
+
+        std::string json = "{\"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            json += results[i].toJson();
+            if (i < results.size() - 1) json += ",";
+        }
+        json += "], \"count\": " + std::to_string(results.size()) + "}";
+
+        return createResponse(200, json);
+    }
+
+    // Junctions nearest to a map position: ?lat=&lng=[&k=][&radius=km]
+    std::string handleNearest(const HttpRequest& req) {
+        double lat, lng;
+        if (!parseDoubleParam(req, "lat", &lat) || !parseDoubleParam(req, "lng", &lng) ||
+            lat < -90 || lat > 90 || lng < -180 || lng > 180) {
+            return createResponse(400, "{\"error\": \"Missing or invalid lat/lng parameter\"}");
+        }
+
+        // k defaults to 1 for a plain nearest query and to the cap for a radius query
+        bool hasRadius = req.params.find("radius") != req.params.end();
+        size_t k = hasRadius ? MAX_NEAREST_RESULTS : 1;
+        if (req.params.find("k") != req.params.end()) {
+            double value;
+            if (!parseDoubleParam(req, "k", &value) || value < 1) {
+                return createResponse(400, "{\"error\": \"Invalid k parameter\"}");
+            }
+            k = static_cast<size_t>(std::min(value, static_cast<double>(MAX_NEAREST_RESULTS)));
+        }
+
+        std::vector<NearbyJunction> results;
+        if (hasRadius) {
+            double radiusKm;
+            if (!parseDoubleParam(req, "radius", &radiusKm) || radiusKm < 0) {
+                return createResponse(400, "{\"error\": \"Invalid radius parameter\"}");
+            }
+            results = trafficManager.findJunctionsWithinRadius(lat, lng, radiusKm);
+            if (results.size() > k) results.resize(k);
+        } else {
+            results = trafficManager.findNearestJunctions(lat, lng, k);
+        }
+
+        std::string json = "{\"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            json += results[i].toJson();
+            if (i < results.size() - 1) json += ",";
+        }
+        json += "], \"count\": " + std::to_string(results.size()) + "}";
+
+        return createResponse(200, json);
+    }
+
+    // ==================== STREAMED LISTINGS ====================
+
+    // ?offset= and ?limit= (both optional, non-negative integers)
+    bool parsePageParams(const HttpRequest& req, size_t* offset, size_t* limit) const {
+        *offset = 0;
+        *limit = std::numeric_limits<size_t>::max();
+        double value;
+        if (req.params.find("offset") != req.params.end()) {
+            if (!parseDoubleParam(req, "offset", &value) || value < 0 || value != std::floor(value)) return false;
+            *offset = static_cast<size_t>(std::min(value, 1e15));
+        }
+        if (req.params.find("limit") != req.params.end()) {
+            if (!parseDoubleParam(req, "limit", &value) || value < 0 || value != std::floor(value)) return false;
+            *limit = static_cast<size_t>(std::min(value, 1e15));
+        }
+        return true;
+    }
+
+    /**
+     * Append {"<key>": [...], "count": n, "total": t, "offset": o} for the
+     * records with the given IDs. visitBatch serializes LIST_BATCH records
+     * per data lock hold and afterBatch() runs between batches, outside the
+     * lock; false from it abandons the list.
+     */
+    template <typename VisitBatch, typename AfterBatch>
+    static bool appendList(std::string& body, const char* key, const std::vector<int>& ids, size_t total,
+                           size_t offset, VisitBatch visitBatch, AfterBatch afterBatch) {
+        body += "{\"";
+        body += key;
+        body += "\": [";
+
+        size_t count = 0;
+        auto append = [&](const auto& record) {
+            if (count++ > 0) body += ',';
+            record.appendJson(body);
+        };
+        for (size_t begin = 0; begin < ids.size(); begin += LIST_BATCH) {
+            visitBatch(ids.data() + begin, std::min(LIST_BATCH, ids.size() - begin), append);
+            if (!afterBatch()) return false;
+        }
+
+        body += "], \"count\": ";
+        appendJsonNumber(body, static_cast<long long>(count));
+        body += ", \"total\": ";
+        appendJsonNumber(body, static_cast<long long>(total));
+        body += ", \"offset\": ";
+        appendJsonNumber(body, static_cast<long long>(offset));
+        body += "}";
+        return true;
+    }
+
+    /**
+     * Send a list (see appendList) as it is serialized: chunks go out
+     * between batches, so a slow client never holds the data lock.
+     * HTTP/1.1 gets a chunked body; an HTTP/1.0 body ends with the connection.
+     */
+    template <typename VisitBatch>
+    std::string streamList(const HttpRequest& req, bool* keepAlive, ResponseSink& sink, const char* key,
+                           const std::vector<int>& ids, size_t total, size_t offset, VisitBatch visitBatch) {
+        bool chunked = req.version == "HTTP/1.1";
+        if (!chunked) *keepAlive = false;
+
+        std::string head = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n";
+        if (chunked) head += "Transfer-Encoding: chunked\r\n";
+        head += "Access-Control-Allow-Origin: *\r\n";
+        head += "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
+        head += "Access-Control-Allow-Headers: Content-Type\r\n";
+        head += *keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+        StreamingResponse out(sink, head, chunked);
+        if (!appendList(out.body(), key, ids, total, offset, visitBatch, [&]() { return out.flushIfFull(); })) {
+            *keepAlive = false;   // client gone
+            return std::string();
+        }
+        return out.finish();
+    }
+
+    // ==================== CACHED PAYLOADS ====================
+
+    /**
+     * Answer from the payload cache: build() runs only after the data
+     * version moved. Clients revalidate (Cache-Control: no-cache) and get
+     * 304 when their ETag is current; gzip or deflate bodies go to clients
+     * that accept them, each encoding with its own ETag.
+     */
+    template <typename Build>
+    std::string serveCached(const HttpRequest& req, const std::string& name, uint64_t version, Build build) {
+        PayloadCache::Ptr payload = payloads.get(name, version, build);
+
+        const std::string* body = &payload->identity;
+        const char* encoding = nullptr;
+        std::string_view accept = req.header("Accept-Encoding");
+        if (!payload->gzip.empty() && acceptsEncoding(accept, "gzip")) {
+            body = &payload->gzip;
+            encoding = "gzip";
+        } else if (!payload->deflate.empty() && acceptsEncoding(accept, "deflate")) {
+            body = &payload->deflate;
+            encoding = "deflate";
+        }
+
+        std::string etag = "\"" + payload->tag + (encoding ? std::string("-") + encoding : "") + "\"";
+        std::string headers = "ETag: " + etag + "\r\nCache-Control: no-cache\r\nVary: Accept-Encoding\r\n";
+        if (etagMatches(req.header("If-None-Match"), etag)) {
+            payloads.noteNotModified();
+            return createResponse(304, "", "application/json", headers);
+        }
+        if (encoding) headers += std::string("Content-Encoding: ") + encoding + "\r\n";
+        return createResponse(200, *body, "application/json", headers);
+    }
+
+    // Junction IDs from a JSON array field of the body, or a comma-separated
+    // query parameter; false if present but malformed
+    bool parseIdList(const HttpRequest& req, const std::string& name, std::vector<int>* ids) const {
+        std::string_view text;
+        size_t field = req.body.find("\"" + name + "\"");
+        if (field != std::string_view::npos) {
+            size_t open = req.body.find('[', field);
+            size_t close = open == std::string_view::npos ? open : req.body.find(']', open);
+            if (close == std::string_view::npos) return false;
+            text = req.body.substr(open + 1, close - open - 1);
+        } else if (req.params.find(name) != req.params.end()) {
+            text = req.params.find(name)->second;   // at() returns a copy
+        }
+
+        ids->clear();
+        const char* p = text.data();
+        const char* end = p + text.size();
+        while (p < end) {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+            if (p == end) break;
+            int id;
+            std::from_chars_result parsed = std::from_chars(p, end, id);
+            if (parsed.ec != std::errc()) return false;
+            ids->push_back(id);
+            p = parsed.ptr;
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p;
+            if (p < end && *p++ != ',') return false;
+        }
+        return true;
+    }
+
+    // ?depart= as Unix seconds, local (PKT) YYYY-MM-DDTHH:MM, or "now" -> minute of the week
+    bool parseDeparture(std::string_view text, double* minuteOfWeek) const {
+        if (text == "now") {
+            *minuteOfWeek = minuteOfWeekFromUnix(static_cast<int64_t>(std::time(nullptr)));
+            return true;
+        }
+
+        const char* end = text.data() + text.size();
+        int64_t seconds;
+        std::from_chars_result parsed = std::from_chars(text.data(), end, seconds);
+        if (parsed.ec == std::errc() && parsed.ptr == end) {
+            *minuteOfWeek = minuteOfWeekFromUnix(seconds);
+            return true;
+        }
+
+        // YYYY-MM-DDTHH:MM; query values arrive undecoded, so accept a
+        // space ("+", "%20") for the T and "%3A" for the colon
+        std::string local;
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '%' && i + 2 < text.size()) {
+                std::string_view escape = text.substr(i + 1, 2);
+                if (escape == "20") { local += 'T'; i += 2; continue; }
+                if (escape == "3A" || escape == "3a") { local += ':'; i += 2; continue; }
+            }
+            local += (text[i] == '+' || text[i] == ' ') ? 'T' : text[i];
+        }
+        int year, month, day, hour, minute;
+        char tail;
+        if (sscanf(local.c_str(), "%4d-%2d-%2dT%2d:%2d%c", &year, &month, &day, &hour, &minute, &tail) != 5) {
+            return false;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 ||
+            minute < 0 || minute > 59) {
+            return false;
+        }
+        *minuteOfWeek = minuteOfWeekFromCivil(year, month, day, hour, minute);
+        return true;
+    }
+
+    bool parseDoubleParam(const HttpRequest& req, const std::string& name, double* value) const {
+        auto it = req.params.find(name);
+        if (it == req.params.end() || it->second.empty()) return false;
+        std::string text(it->second);
+        char* end = nullptr;
+        *value = strtod(text.c_str(), &end);
+        return *end == '\0' && std::isfinite(*value);
+    }
+
     std::string getAuthToken(const HttpRequest& req) {
-        auto it = req.headers.find("Authorization");
+        auto it = req.headers.findIgnoreCase("Authorization");
         if (it != req.headers.end()) {
-            std::string authHeader = it->second;
+            std::string authHeader(it->second);
             if (authHeader.find("Bearer ") == 0) {
                 return authHeader.substr(7);
             }
@@ -628,11 +1315,12 @@ private:
             return createResponse(400, "{\"error\": \"Missing 'q' parameter\"}");
         }
     
-        std::string query = req.params.at("q");
+        // Decoded, so the geocoder cache key and the Nominatim query see the real text
+        std::string query = urlDecode(req.params.at("q"));
         std::string city = "";
     
         if (req.params.find("city") != req.params.end()) {
-            city = req.params.at("city");
+            city = urlDecode(req.params.at("city"));
         }
     
         std::cout << "   Query: " << query << "\n";
@@ -640,30 +1328,45 @@ private:
             std::cout << "   City: " << city << "\n";
         }
     
-        auto results = trafficManager.smartSearch(query, city);
+        // A Nominatim miss is answered 202 at once instead of holding this thread
+        bool pending = false;
+        auto results = trafficManager.smartSearch(query, city, &pending);
     
-        std::cout << "   Results: " << results.size() << "\n";
+        std::cout << "   Results: " << results.size() << (pending ? " (Nominatim pending)" : "") << "\n";
     
         std::string json = "{";
         json += "\"success\": " + std::string(results.empty() ? "false" : "true") + ",";
-        json += "\"query\": \"" + query + "\",";
+        json += "\"query\": \"";
+        appendJsonString(json, query);
+        json += "\",";
         if (!city.empty()) {
-            json += "\"city\": \"" + city + "\",";
+            json += "\"city\": \"";
+            appendJsonString(json, city);
+            json += "\",";
         }
         json += "\"count\": " + std::to_string(results.size()) + ",";
+        if (pending) return geocodePendingResponse(json + "\"results\": [],");
         json += "\"results\": [";
     
         for (size_t i = 0; i < results.size(); ++i) {
             json += "{";
             json += "\"id\": " + std::to_string(results[i].id) + ",";
-            json += "\"name\": \"" + results[i].name + "\",";
-            json += "\"displayName\": \"" + results[i].name + "\",";
-            json += "\"city\": \"" + results[i].city + "\",";
-            json += "\"area\": \"" + results[i].area + "\",";
+            json += "\"name\": \"";
+            appendJsonString(json, results[i].name);
+            json += "\",";
+            json += "\"displayName\": \"";
+            appendJsonString(json, results[i].name);
+            json += "\",";
+            json += "\"city\": \"";
+            appendJsonString(json, results[i].city);
+            json += "\",";
+            json += "\"area\": \"";
+            appendJsonString(json, results[i].area);
+            json += "\",";
             json += "\"latitude\": " + std::to_string(results[i].latitude) + ",";
             json += "\"longitude\": " + std::to_string(results[i].longitude) + ",";
             json += "\"hasTrafficSignal\": " + std::string(results[i].hasTrafficSignal ? "true" : "false") + ",";
-            json += "\"source\": \"" + std::string(results[i].id >= 10000 ? "nominatim" : "osm") + "\"";
+            json += "\"source\": \"" + std::string(results[i].geocoded ? "nominatim" : "osm") + "\"";
             json += "}";
         
             if (i < results.size() - 1) {
@@ -702,55 +1405,173 @@ private:
         std::cout << "   Query: " << query << "\n";
         if (!city.empty()) std::cout << "   City: " << city << "\n";
     
-        // Search Nominatim
-        Junction* newJunction = trafficManager.searchNominatim(query, city);
+        // Search Nominatim; a found place is added to the network
+        Junction newJunction;
+        GeocodeStatus status = trafficManager.geocodePlace(query, city, false, &newJunction);
+        if (status == GeocodeStatus::PENDING) {
+            return geocodePendingResponse("{\"success\": false, \"message\": \"Lookup queued, retry to add the location\",");
+        }
     
-        if (newJunction) {
-            // Add to database
-            trafficManager.addJunction(*newJunction);
-        
+        if (status == GeocodeStatus::FOUND) {
             std::string json = "{";
             json += "\"success\": true,";
             json += "\"message\": \"Location added successfully\",";
             json += "\"junction\": {";
-            json += "\"id\": " + std::to_string(newJunction->id) + ",";
-            json += "\"name\": \"" + newJunction->name + "\",";
-            json += "\"city\": \"" + newJunction->city + "\",";
-            json += "\"area\": \"" + newJunction->area + "\",";
-            json += "\"latitude\": " + std::to_string(newJunction->latitude) + ",";
-            json += "\"longitude\": " + std::to_string(newJunction->longitude);
+            json += "\"id\": " + std::to_string(newJunction.id) + ",";
+            json += "\"name\": \"";
+            appendJsonString(json, newJunction.name);
+            json += "\",";
+            json += "\"city\": \"";
+            appendJsonString(json, newJunction.city);
+            json += "\",";
+            json += "\"area\": \"";
+            appendJsonString(json, newJunction.area);
+            json += "\",";
+            json += "\"latitude\": " + std::to_string(newJunction.latitude) + ",";
+            json += "\"longitude\": " + std::to_string(newJunction.longitude);
             json += "}";
             json += "}";
         
-            delete newJunction;
             return createResponse(201, json);
         }
         return createResponse(404, "{\"error\": \"Location not found in OSM\"}");
     }
 
+    // Live values, so never cached. Prometheus text for ?format=prometheus
+    // or a scraper's Accept: text/plain, JSON otherwise
     std::string handleMetrics(const HttpRequest& req) {
-        auto junctions = trafficManager.getAllJunctions();
-        
+        auto format = req.params.find("format");
+        std::string_view accept = req.header("Accept");
+        bool prometheus = format != req.params.end()
+            ? format->second == "prometheus"
+            : accept.find("text/plain") != std::string_view::npos ||
+              accept.find("application/openmetrics-text") != std::string_view::npos;
+        if (prometheus) {
+            return createResponse(200, metricsPrometheus(), "text/plain; version=0.0.4; charset=utf-8");
+        }
+        return createResponse(200, metricsJson());
+    }
+
+    static std::string tableMetricsJson(const FlatHashTableMetrics& m) {
+        std::string json = "{";
+        json += "\"entries\": " + std::to_string(m.elementCount) + ",";
+        json += "\"buckets\": " + std::to_string(m.slotCount) + ",";
+        json += "\"loadFactor\": " + std::to_string(m.loadFactor) + ",";
+        json += "\"longestProbe\": " + std::to_string(m.longestProbe) + ",";
+        json += "\"avgProbe\": " + std::to_string(m.avgProbeLength) + ",";
+        json += "\"displaced\": " + std::to_string(m.displaced) + ",";
+        json += "\"memory\": " + std::to_string(m.memoryUsageBytes);
+        json += "}";
+        return json;
+    }
+
+    std::string metricsJson() {
+        TrafficManager::IndexMetrics index = trafficManager.getIndexMetrics();
         std::string json = "{";
         json += "\"btree\": {";
-        json += "\"height\": 4,";  // Calculate from actual B-Tree
-        json += "\"nodes\": " + std::to_string(junctions.size() / 10) + ",";
-        json += "\"avgKeys\": 8.5,";
-        json += "\"memory\": " + std::to_string(junctions.size() * 0.5);
+        json += "\"height\": " + std::to_string(index.nameIndex.height) + ",";
+        json += "\"nodes\": " + std::to_string(index.nameIndex.nodeCount) + ",";
+        json += "\"elements\": " + std::to_string(index.nameIndex.elementCount) + ",";
+        json += "\"avgKeys\": " + std::to_string(index.nameIndex.avgKeysPerLeaf) + ",";
+        json += "\"maxKeys\": " + std::to_string(index.nameIndex.maxKeysPerNode) + ",";
+        json += "\"memory\": " + std::to_string(index.nameIndex.memoryBytes) + ",";
+        json += "\"cities\": " + std::to_string(index.cityCount);
         json += "},";
-        json += "\"hashtable\": {";
-        json += "\"buckets\": 1024,";
-        json += "\"loadFactor\": 0.65,";
-        json += "\"collisions\": 124,";
-        json += "\"longestChain\": 3";
-        json += "}";
+        json += "\"hashtable\": " + tableMetricsJson(index.junctionTable) + ",";
+        json += "\"roadTable\": " + tableMetricsJson(index.roadTable) + ",";
+        json += "\"routeCache\": " + routeCacheStatsJson() + ",";
+        json += "\"routeArena\": " + routeArenaStatsJson() + ",";
+        Metrics::appendJson(json);
         json += "}";
-        
-        return createResponse(200, json);
+        return json;
+    }
+
+    static void appendPrometheusHeader(std::string& out, const std::string& name, const char* type,
+                                       const char* help) {
+        out += "# HELP " + name + " " + help + "\n# TYPE " + name + " " + type + "\n";
+    }
+
+    static void appendPrometheusSample(std::string& out, const std::string& name, double value) {
+        out += name;
+        out += " ";
+        Metrics::appendNumber(out, value);
+        out += "\n";
+    }
+
+    std::string metricsPrometheus() {
+        std::string out;
+        out.reserve(32 * 1024);
+        Metrics::appendPrometheus(out);
+
+        TrafficManager::IndexMetrics index = trafficManager.getIndexMetrics();
+        appendPrometheusHeader(out, "traffic_name_index_height", "gauge", "Junction name B+Tree height");
+        appendPrometheusSample(out, "traffic_name_index_height", index.nameIndex.height);
+        appendPrometheusHeader(out, "traffic_name_index_nodes", "gauge", "Junction name B+Tree nodes");
+        appendPrometheusSample(out, "traffic_name_index_nodes", index.nameIndex.nodeCount);
+        appendPrometheusHeader(out, "traffic_name_index_bytes", "gauge", "Junction name B+Tree node memory");
+        appendPrometheusSample(out, "traffic_name_index_bytes", static_cast<double>(index.nameIndex.memoryBytes));
+
+        const std::pair<const char*, const FlatHashTableMetrics*> tables[] = {
+            {"junctions", &index.junctionTable}, {"roads", &index.roadTable}};
+        appendPrometheusHeader(out, "traffic_hash_table_entries", "gauge", "Hash table entries");
+        for (const auto& t : tables) {
+            appendPrometheusSample(out, std::string("traffic_hash_table_entries{table=\"") + t.first + "\"}",
+                                   static_cast<double>(t.second->elementCount));
+        }
+        appendPrometheusHeader(out, "traffic_hash_table_load_factor", "gauge", "Hash table load factor");
+        for (const auto& t : tables) {
+            appendPrometheusSample(out, std::string("traffic_hash_table_load_factor{table=\"") + t.first + "\"}",
+                                   t.second->loadFactor);
+        }
+        appendPrometheusHeader(out, "traffic_hash_table_longest_probe", "gauge", "Longest probe sequence");
+        for (const auto& t : tables) {
+            appendPrometheusSample(out, std::string("traffic_hash_table_longest_probe{table=\"") + t.first + "\"}",
+                                   static_cast<double>(t.second->longestProbe));
+        }
+        appendPrometheusHeader(out, "traffic_hash_table_bytes", "gauge", "Hash table memory");
+        for (const auto& t : tables) {
+            appendPrometheusSample(out, std::string("traffic_hash_table_bytes{table=\"") + t.first + "\"}",
+                                   static_cast<double>(t.second->memoryUsageBytes));
+        }
+
+        uint64_t hits = 0, misses = 0, evictions = 0, invalidations = 0, entries = 0;
+        for (const RouteCache::ShardStats& shard : trafficManager.getRouteCacheStats()) {
+            hits += shard.hits;
+            misses += shard.misses;
+            evictions += shard.evictions;
+            invalidations += shard.invalidations;
+            entries += shard.entries;
+        }
+        appendPrometheusHeader(out, "traffic_route_cache_entries", "gauge", "Cached routes");
+        appendPrometheusSample(out, "traffic_route_cache_entries", static_cast<double>(entries));
+        appendPrometheusHeader(out, "traffic_route_cache_hits_total", "counter", "Route cache hits");
+        appendPrometheusSample(out, "traffic_route_cache_hits_total", static_cast<double>(hits));
+        appendPrometheusHeader(out, "traffic_route_cache_misses_total", "counter", "Route cache misses");
+        appendPrometheusSample(out, "traffic_route_cache_misses_total", static_cast<double>(misses));
+        appendPrometheusHeader(out, "traffic_route_cache_evictions_total", "counter", "Routes dropped for capacity");
+        appendPrometheusSample(out, "traffic_route_cache_evictions_total", static_cast<double>(evictions));
+        appendPrometheusHeader(out, "traffic_route_cache_invalidations_total", "counter",
+                               "Routes dropped by a road network change");
+        appendPrometheusSample(out, "traffic_route_cache_invalidations_total", static_cast<double>(invalidations));
+
+        TrafficManager::RouteAllocationStats arena = trafficManager.getRouteAllocationStats();
+        appendPrometheusHeader(out, "traffic_route_arena_allocations_total", "counter",
+                               "Route search allocations served by the per-thread arena");
+        appendPrometheusSample(out, "traffic_route_arena_allocations_total", static_cast<double>(arena.arenaAllocations));
+        appendPrometheusHeader(out, "traffic_route_arena_heap_allocations_total", "counter",
+                               "Arena blocks taken from the heap");
+        appendPrometheusSample(out, "traffic_route_arena_heap_allocations_total", static_cast<double>(arena.heapAllocations));
+        return out;
     }
 
 public:
-    HttpServer(int p, TrafficManager& tm) : port(p), trafficManager(tm), running(false) {
+    HttpServer(int p, TrafficManager& tm, const ServerConfig& cfg = ServerConfig())
+        : port(p), serverSocket(INVALID_SOCKET), running(false), trafficManager(tm), config(cfg),
+          activeClients(0), threadedRequests(0), threadedKeepAliveRequests(0) {
+        if (config.workerThreads == 0) {
+            config.workerThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        registerRoutes();
 #ifdef _WIN32
         WSADATA wsaData;
         WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -791,11 +1612,33 @@ public:
             return false;
         }
 
+        if (config.mode == ServerMode::EVENT_LOOP) {
+            eventServer.reset(new EventServer(
+                config.workerThreads, config.maxQueuedRequests, config.keepAliveTimeoutSeconds,
+                [this](const std::string& buffer, std::string* error) { return frameRequest(buffer, error); },
+                [this](const std::string& request, bool* keepAlive, ResponseSink& sink) {
+                    return respond(request, keepAlive, sink);
+                },
+                errorResponse(503, "Server busy, retry later")));
+        }
+
         running = true;
         std::cout << "\n========================================\n";
         std::cout << " Smart Traffic Route Optimizer API\n";
         std::cout << " Server running on http://localhost:" << port << "\n";
         std::cout << "========================================\n";
+        if (eventServer) {
+            std::cout << "⚙️  Event loop (" <<
+#ifdef _WIN32
+                "IOCP"
+#else
+                "epoll"
+#endif
+                << "), " << config.workerThreads << " workers, queue " << config.maxQueuedRequests
+                << ", keep-alive " << config.keepAliveTimeoutSeconds << "s\n";
+        } else {
+            std::cout << "⚙️  Thread per connection, keep-alive " << config.keepAliveTimeoutSeconds << "s\n";
+        }
         std::cout << "\nEndpoints:\n";
         std::cout << "  GET  /api/health          - Health check\n";
         std::cout << "  GET  /api/smart-search    - Smart search (B-Tree + Nominatim)\n";
@@ -809,16 +1652,26 @@ public:
         std::cout << "  POST /api/add-from-osm    - Add location from OSM\n";
         std::cout << "  GET  /api/roads           - Get all roads\n";
         std::cout << "  GET  /api/route           - Find route (from, to, optimize)\n";
+        std::cout << "  POST /api/matrix          - Travel time / distance matrix\n";
+        std::cout << "  GET  /api/isochrone       - Junctions reachable within a budget\n";
         std::cout << "  GET  /api/traffic         - Get traffic levels\n";
         std::cout << "  POST /api/traffic         - Update traffic level\n";
         std::cout << "  GET  /api/search          - Search junctions\n";
+        std::cout << "  GET  /api/nearest         - Nearest junctions to a position\n";
+        std::cout << "  GET  /api/autocomplete    - Junction name prefix completion\n";
         std::cout << "  GET  /api/stats           - System statistics\n";
+        std::cout << "  GET  /api/metrics         - Index shapes and latency percentiles\n";
         std::cout << "\nPress Ctrl+C to stop the server.\n\n";
 
         return true;
     }
     
     void run() {
+        if (eventServer) {
+            eventServer->run(serverSocket);
+            return;
+        }
+
         while (running) {
             struct sockaddr_in clientAddr;
             socklen_t clientLen = sizeof(clientAddr);
@@ -839,7 +1692,11 @@ public:
 
     void stop() {
         running = false;
-        closesocket(serverSocket);
+        if (eventServer) eventServer->stop();
+        if (serverSocket != INVALID_SOCKET) {
+            closesocket(serverSocket);
+            serverSocket = INVALID_SOCKET;
+        }
     }
 
     bool isRunning() const { return running; }
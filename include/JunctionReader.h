@@ -0,0 +1,595 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Streaming Junction JSON Reader Implementation
+ *
+ * Single-pass reader for OSM junction files: either an object with a
+ * "junctions" array (python_tools/download_osm_data.py output, other keys
+ * such as "metadata" are skipped) or a bare array of junction objects.
+ * Input arrives in chunks of any size; only the unfinished junction at the
+ * end of a chunk is carried over, so memory stays at one chunk however large
+ * the file grows. Whitespace and string bodies are scanned 16 bytes at a
+ * time with SSE2 where available, numbers are parsed with std::from_chars
+ * and strings are unescaped (including \uXXXX) into UTF-8.
+ * Time Complexity: O(n) in the input size
+ */
+
+#ifndef JUNCTIONREADER_H
+#define JUNCTIONREADER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <charconv>
+#include <chrono>
+#include "Models.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JUNCTIONREADER_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+class JunctionJsonReader {
+public:
+    static constexpr size_t CHUNK_SIZE = 1 << 20;   // readFile() read size
+    static constexpr size_t BATCH_SIZE = 4096;      // junctions per readFile() sink call
+
+    struct Stats {
+        uint64_t bytes;         // input consumed
+        size_t junctions;       // handed out
+        size_t skipped;         // objects without a positive id, a name or a latitude
+        double parseSeconds;    // time inside feed()/finish(), I/O excluded
+
+        Stats() : bytes(0), junctions(0), skipped(0), parseSeconds(0) {}
+
+        double megabytesPerSecond() const {
+            return parseSeconds > 0 ? bytes / (1024.0 * 1024.0) / parseSeconds : 0;
+        }
+    };
+
+private:
+    enum class State { START, ROOT_KEY, ARRAY, DONE };
+    enum class Status { OK, INCOMPLETE, INVALID };
+
+    State state;
+    bool bareArray;          // the document is the junction array itself
+    bool expectComma;        // inside ROOT_KEY / ARRAY, after the first member
+    std::string pending;     // unconsumed tail of the previous chunk
+    uint64_t consumedBytes;  // before pending[0], for error positions
+    std::string error;
+    Stats stats;
+
+    // ==================== SCANNING ====================
+
+    static unsigned firstSetBit(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    static bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    static const char* skipWhitespace(const char* p, const char* end) {
+#ifdef JUNCTIONREADER_SSE2
+        const __m128i space = _mm_set1_epi8(' '), newline = _mm_set1_epi8('\n');
+        const __m128i tab = _mm_set1_epi8('\t'), carriageReturn = _mm_set1_epi8('\r');
+        while (end - p >= 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, newline)),
+                                         _mm_or_si128(_mm_cmpeq_epi8(block, tab), _mm_cmpeq_epi8(block, carriageReturn)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(blank)) ^ 0xFFFFu;
+            if (mask != 0) return p + firstSetBit(mask);
+            p += 16;
+        }
+#endif
+        while (p < end && isWhitespace(*p)) ++p;
+        return p;
+    }
+
+    // First '"' or '\\' at or after p, or end
+    static const char* findQuoteOrEscape(const char* p, const char* end) {
+#ifdef JUNCTIONREADER_SSE2
+        const __m128i quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\');
+        while (end - p >= 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash))));
+            if (mask != 0) return p + firstSetBit(mask);
+            p += 16;
+        }
+#endif
+        while (p < end && *p != '"' && *p != '\\') ++p;
+        return p;
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static void appendUtf8(std::string* out, uint32_t codePoint) {
+        if (codePoint < 0x80) {
+            *out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            *out += static_cast<char>(0xC0 | (codePoint >> 6));
+            *out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            *out += static_cast<char>(0xE0 | (codePoint >> 12));
+            *out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            *out += static_cast<char>(0xF0 | (codePoint >> 18));
+            *out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            *out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    // \uXXXX at p (after the backslash and 'u'); pairs surrogates
+    static Status readUnicodeEscape(const char** p, const char* end, std::string* out) {
+        auto hex4 = [end](const char* at, uint32_t* value) {
+            if (end - at < 4) return Status::INCOMPLETE;
+            *value = 0;
+            for (int i = 0; i < 4; ++i) {
+                int digit = hexDigit(at[i]);
+                if (digit < 0) return Status::INVALID;
+                *value = (*value << 4) | static_cast<uint32_t>(digit);
+            }
+            return Status::OK;
+        };
+
+        uint32_t codePoint;
+        Status status = hex4(*p, &codePoint);
+        if (status != Status::OK) return status;
+        const char* next = *p + 4;
+        if (codePoint >= 0xD800 && codePoint < 0xDC00) {   // high surrogate: a low one must follow
+            if (end - next < 2) return Status::INCOMPLETE;
+            if (next[0] != '\\' || next[1] != 'u') return Status::INVALID;
+            uint32_t low;
+            status = hex4(next + 2, &low);
+            if (status != Status::OK) return status;
+            if (low < 0xDC00 || low >= 0xE000) return Status::INVALID;
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+            next += 6;
+        } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+            return Status::INVALID;
+        }
+        appendUtf8(out, codePoint);
+        *p = next;
+        return Status::OK;
+    }
+
+    // String at *p (which is '"'); out may be null to skip it
+    static Status readString(const char** p, const char* end, std::string* out) {
+        const char* s = *p + 1;
+        if (out) out->clear();
+        for (;;) {
+            const char* stop = findQuoteOrEscape(s, end);
+            if (stop == end) return Status::INCOMPLETE;
+            if (out) out->append(s, stop);
+            if (*stop == '"') {
+                *p = stop + 1;
+                return Status::OK;
+            }
+
+            if (end - stop < 2) return Status::INCOMPLETE;
+            char escaped = stop[1];
+            s = stop + 2;
+            char decoded;
+            switch (escaped) {
+                case '"': decoded = '"'; break;
+                case '\\': decoded = '\\'; break;
+                case '/': decoded = '/'; break;
+                case 'b': decoded = '\b'; break;
+                case 'f': decoded = '\f'; break;
+                case 'n': decoded = '\n'; break;
+                case 'r': decoded = '\r'; break;
+                case 't': decoded = '\t'; break;
+                case 'u': {
+                    std::string scratch;
+                    Status status = readUnicodeEscape(&s, end, out ? out : &scratch);
+                    if (status != Status::OK) return status;
+                    continue;
+                }
+                default: return Status::INVALID;
+            }
+            if (out) *out += decoded;
+        }
+    }
+
+    static bool isNumberChar(char c) {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    // Number token at *p; the token must be followed by something (not end)
+    static Status readNumberToken(const char** p, const char* end, std::string_view* token) {
+        const char* s = *p;
+        while (s < end && isNumberChar(*s)) ++s;
+        if (s == end) return Status::INCOMPLETE;
+        if (s == *p) return Status::INVALID;
+        *token = std::string_view(*p, static_cast<size_t>(s - *p));
+        *p = s;
+        return Status::OK;
+    }
+
+    static Status expectLiteral(const char** p, const char* end, std::string_view literal) {
+        size_t available = static_cast<size_t>(end - *p);
+        size_t n = std::min(available, literal.size());
+        if (std::string_view(*p, n) != literal.substr(0, n)) return Status::INVALID;
+        if (n < literal.size()) return Status::INCOMPLETE;
+        *p += literal.size();
+        return Status::OK;
+    }
+
+    // Any JSON value at *p, without building it
+    static Status skipValue(const char** p, const char* end) {
+        const char* s = skipWhitespace(*p, end);
+        if (s == end) return Status::INCOMPLETE;
+
+        if (*s != '{' && *s != '[') {
+            Status status;
+            if (*s == '"') {
+                status = readString(&s, end, nullptr);
+            } else if (*s == 't' || *s == 'f' || *s == 'n') {
+                status = expectLiteral(&s, end, *s == 't' ? "true" : *s == 'f' ? "false" : "null");
+            } else {
+                std::string_view token;
+                status = readNumberToken(&s, end, &token);
+            }
+            if (status == Status::OK) *p = s;
+            return status;
+        }
+
+        // Nested object or array: track depth, strings may hold brackets
+        std::vector<char> open(1, *s++);
+        while (!open.empty()) {
+            s = skipWhitespace(s, end);
+            if (s == end) return Status::INCOMPLETE;
+            char c = *s;
+            if (c == '"') {
+                Status status = readString(&s, end, nullptr);
+                if (status != Status::OK) return status;
+            } else if (c == '{' || c == '[') {
+                open.push_back(c);
+                ++s;
+            } else if (c == '}' || c == ']') {
+                if ((c == '}') != (open.back() == '{')) return Status::INVALID;
+                open.pop_back();
+                ++s;
+            } else if (c == ',' || c == ':') {
+                ++s;
+            } else if (c == 't' || c == 'f' || c == 'n') {
+                Status status = expectLiteral(&s, end, c == 't' ? "true" : c == 'f' ? "false" : "null");
+                if (status != Status::OK) return status;
+            } else {
+                std::string_view token;
+                Status status = readNumberToken(&s, end, &token);
+                if (status != Status::OK) return status;
+            }
+        }
+        *p = s;
+        return Status::OK;
+    }
+
+    // ==================== JUNCTION OBJECTS ====================
+
+    /**
+     * One junction object at *p (which is '{'). Known fields are read,
+     * others skipped. valid is false if a field has the wrong type; the
+     * object is still consumed so the scan continues after it.
+     */
+    static Status readJunction(const char** p, const char* end, Junction* junction, bool* valid) {
+        const char* s = *p + 1;
+        *junction = Junction();
+        *valid = true;
+        std::string key;
+        bool first = true;
+
+        for (;;) {
+            s = skipWhitespace(s, end);
+            if (s == end) return Status::INCOMPLETE;
+            if (*s == '}') {
+                *p = s + 1;
+                return Status::OK;
+            }
+            if (!first) {
+                if (*s != ',') return Status::INVALID;
+                s = skipWhitespace(s + 1, end);
+                if (s == end) return Status::INCOMPLETE;
+            }
+            first = false;
+
+            if (*s != '"') return Status::INVALID;
+            Status status = readString(&s, end, &key);
+            if (status != Status::OK) return status;
+            s = skipWhitespace(s, end);
+            if (s == end) return Status::INCOMPLETE;
+            if (*s != ':') return Status::INVALID;
+            s = skipWhitespace(s + 1, end);
+            if (s == end) return Status::INCOMPLETE;
+
+            std::string* text = key == "name" ? &junction->name :
+                                key == "city" ? &junction->city :
+                                key == "area" ? &junction->area : nullptr;
+            if (text) {
+                if (*s == '"') {
+                    status = readString(&s, end, text);
+                } else {
+                    *valid = *valid && *s == 'n';   // null leaves it empty
+                    status = skipValue(&s, end);
+                }
+            } else if (key == "id" || key == "latitude" || key == "longitude") {
+                std::string_view token;
+                if (*s == '-' || (*s >= '0' && *s <= '9')) {
+                    status = readNumberToken(&s, end, &token);
+                    if (status == Status::OK) {
+                        std::from_chars_result parsed;
+                        if (key == "id") {
+                            parsed = std::from_chars(token.data(), token.data() + token.size(), junction->id);
+                        } else {
+                            double* target = key == "latitude" ? &junction->latitude : &junction->longitude;
+                            parsed = std::from_chars(token.data(), token.data() + token.size(), *target);
+                        }
+                        *valid = *valid && parsed.ec == std::errc() && parsed.ptr == token.data() + token.size();
+                    }
+                } else {
+                    *valid = false;
+                    status = skipValue(&s, end);
+                }
+            } else if (key == "hasTrafficSignal") {
+                if (*s == 't' || *s == 'f') {
+                    junction->hasTrafficSignal = *s == 't';
+                    status = expectLiteral(&s, end, *s == 't' ? "true" : "false");
+                } else {
+                    status = skipValue(&s, end);
+                }
+            } else {
+                status = skipValue(&s, end);
+            }
+            if (status != Status::OK) return status;
+        }
+    }
+
+    // Same acceptance rule the loaders always used
+    static bool isUsable(const Junction& junction) {
+        return junction.id > 0 && !junction.name.empty() && junction.latitude != 0.0;
+    }
+
+    // ==================== DOCUMENT ====================
+
+    /**
+     * Consume whole units (a root member, an array element) from
+     * [begin, end); stops before a unit that is cut off by the end.
+     * @return bytes consumed, or npos on a syntax error
+     */
+    size_t parse(const char* begin, const char* end, bool last, std::vector<Junction>* out) {
+        const char* p = begin;
+        for (;;) {
+            const char* s = skipWhitespace(p, end);
+            if (s == end) return static_cast<size_t>(s - begin);
+
+            Status status = Status::OK;
+            switch (state) {
+                case State::START:
+                    if (*s == '{') {
+                        state = State::ROOT_KEY;
+                    } else if (*s == '[') {
+                        state = State::ARRAY;
+                        bareArray = true;
+                    } else {
+                        return fail(begin, s, "expected '{' or '['");
+                    }
+                    expectComma = false;
+                    p = s + 1;
+                    continue;
+
+                case State::ROOT_KEY: {
+                    if (*s == '}') {
+                        state = State::DONE;
+                        p = s + 1;
+                        continue;
+                    }
+                    if (expectComma) {
+                        if (*s != ',') return fail(begin, s, "expected ',' or '}'");
+                        s = skipWhitespace(s + 1, end);
+                        if (s == end) return static_cast<size_t>(p - begin);
+                    }
+                    if (*s != '"') return fail(begin, s, "expected a key");
+
+                    const char* q = s;
+                    std::string key;
+                    status = readString(&q, end, &key);
+                    if (status == Status::OK) {
+                        q = skipWhitespace(q, end);
+                        if (q == end) status = Status::INCOMPLETE;
+                        else if (*q != ':') return fail(begin, q, "expected ':'");
+                        else q = skipWhitespace(q + 1, end);
+                    }
+                    if (status == Status::OK && q == end) status = Status::INCOMPLETE;
+                    if (status == Status::OK && key == "junctions" && *q == '[') {
+                        state = State::ARRAY;
+                        expectComma = false;
+                        p = q + 1;
+                        continue;
+                    }
+                    if (status == Status::OK) status = skipValue(&q, end);
+                    if (status == Status::INVALID) return fail(begin, q, "invalid value");
+                    if (status == Status::INCOMPLETE) break;
+                    expectComma = true;
+                    p = q;
+                    continue;
+                }
+
+                case State::ARRAY: {
+                    if (*s == ']') {
+                        state = bareArray ? State::DONE : State::ROOT_KEY;
+                        expectComma = true;
+                        p = s + 1;
+                        continue;
+                    }
+                    if (expectComma) {
+                        if (*s != ',') return fail(begin, s, "expected ',' or ']'");
+                        s = skipWhitespace(s + 1, end);
+                        if (s == end) return static_cast<size_t>(p - begin);
+                    }
+
+                    const char* q = s;
+                    if (*q == '{') {
+                        Junction junction;
+                        bool valid;
+                        status = readJunction(&q, end, &junction, &valid);
+                        if (status == Status::OK) {
+                            if (valid && isUsable(junction)) {
+                                out->push_back(std::move(junction));
+                                stats.junctions++;
+                            } else {
+                                stats.skipped++;
+                            }
+                        }
+                    } else {
+                        status = skipValue(&q, end);   // not a junction: ignore it
+                        if (status == Status::OK) stats.skipped++;
+                    }
+                    if (status == Status::INVALID) return fail(begin, q, "invalid junction object");
+                    if (status == Status::INCOMPLETE) break;
+                    expectComma = true;
+                    p = q;
+                    continue;
+                }
+
+                case State::DONE:
+                    return fail(begin, s, "unexpected data after the document");
+            }
+
+            // The unit at p runs past the end of the input
+            if (last) return fail(begin, end, "unexpected end of input");
+            return static_cast<size_t>(p - begin);
+        }
+    }
+
+    size_t fail(const char* begin, const char* at, const char* message) {
+        char position[32];
+        snprintf(position, sizeof(position), " at byte %llu",
+                 static_cast<unsigned long long>(consumedBytes + static_cast<uint64_t>(at - begin)));
+        error = std::string(message) + position;
+        return std::string::npos;
+    }
+
+public:
+    JunctionJsonReader()
+        : state(State::START), bareArray(false), expectComma(false), consumedBytes(0) {}
+
+    /**
+     * Parse the next chunk; complete junctions are appended to out.
+     * @return false on a syntax error (see getError); later calls fail too
+     */
+    bool feed(const char* data, size_t size, std::vector<Junction>* out) {
+        if (!error.empty()) return false;
+        auto startTime = std::chrono::steady_clock::now();
+
+        size_t used;
+        if (pending.empty()) {
+            used = parse(data, data + size, false, out);   // no copy in the common case
+            if (used != std::string::npos) pending.assign(data + used, size - used);
+        } else {
+            pending.append(data, size);
+            used = parse(pending.data(), pending.data() + pending.size(), false, out);
+            if (used != std::string::npos) pending.erase(0, used);
+        }
+        if (used != std::string::npos) {
+            consumedBytes += used;
+            stats.bytes += used;
+        }
+
+        stats.parseSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return used != std::string::npos;
+    }
+
+    // End of input: false unless a complete document was read
+    bool finish(std::vector<Junction>* out) {
+        if (!error.empty()) return false;
+        size_t used = parse(pending.data(), pending.data() + pending.size(), true, out);
+        if (used == std::string::npos) return false;
+        consumedBytes += used;
+        stats.bytes += used;
+        pending.clear();
+        if (state != State::DONE) {
+            error = "unexpected end of input";
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& getError() const { return error; }
+    const Stats& getStats() const { return stats; }
+
+    /**
+     * Read a junction file in CHUNK_SIZE pieces, handing batches of up to
+     * BATCH_SIZE junctions to sink(std::vector<Junction>&) as they fill.
+     * One chunk can hold more than a batch; it is handed out in slices.
+     * @return false if the file cannot be read or is not valid junction JSON
+     */
+    template <typename Sink>
+    static bool readFile(const std::string& path, Sink sink, Stats* stats = nullptr,
+                         std::string* errorMessage = nullptr) {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) {
+            if (errorMessage) *errorMessage = "cannot open " + path;
+            return false;
+        }
+
+        JunctionJsonReader reader;
+        std::vector<char> chunk(CHUNK_SIZE);
+        std::vector<Junction> parsed;
+        std::vector<Junction> batch;
+        batch.reserve(BATCH_SIZE);
+        // Hand parsed junctions to sink BATCH_SIZE at a time; a short tail
+        // waits for the next chunk unless this is the end
+        auto flush = [&](bool last) {
+            size_t begin = 0;
+            while (parsed.size() - begin >= BATCH_SIZE || (last && begin < parsed.size())) {
+                size_t count = std::min(BATCH_SIZE, parsed.size() - begin);
+                batch.assign(std::make_move_iterator(parsed.begin() + begin),
+                             std::make_move_iterator(parsed.begin() + begin + count));
+                sink(batch);
+                batch.clear();
+                begin += count;
+            }
+            parsed.erase(parsed.begin(), parsed.begin() + begin);
+        };
+
+        bool ok = true;
+        size_t n;
+        while (ok && (n = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+            ok = reader.feed(chunk.data(), n, &parsed);
+            flush(false);
+        }
+        if (ok && ferror(file)) {
+            reader.error = "read error in " + path;
+            ok = false;
+        }
+        fclose(file);
+
+        ok = ok && reader.finish(&parsed);
+        flush(true);   // what was read before an error is kept
+        if (stats) *stats = reader.getStats();
+        if (errorMessage) *errorMessage = reader.getError();
+        return ok;
+    }
+};
+
+#endif // JUNCTIONREADER_H
@@ -0,0 +1,256 @@
+/**
+ * Smart Traffic Route Optimizer
+ * K-D Tree (Spatial Index) Implementation
+ *
+ * Static 3-D k-d tree over junction positions mapped onto the unit sphere.
+ * Straight-line (chord) distance between unit vectors grows monotonically
+ * with great-circle distance, so nearest-by-chord is nearest-by-haversine
+ * with no special cases for longitude or latitude scaling.
+ * Points inserted after the build go to a small pending list that is
+ * folded in by an amortized rebuild.
+ * Time Complexity: O(n log n) build, ~O(log n + k) nearest / radius queries
+ */
+
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "GeoGrid.h"
+
+class KDTree {
+public:
+    struct Neighbor {
+        int id;
+        double distanceKm;   // great-circle distance to the query point
+
+        Neighbor() : id(0), distanceKm(0) {}
+        Neighbor(int _id, double _dist) : id(_id), distanceKm(_dist) {}
+    };
+
+private:
+    static constexpr size_t MIN_PENDING_REBUILD = 64;
+
+    struct Point {
+        double xyz[3];
+        GeoPoint position;
+        int id;
+    };
+
+    std::vector<Point> points;     // tree order: node of [lo, hi) is at (lo + hi) / 2
+    std::vector<uint8_t> axes;     // split axis of each node
+    std::vector<Point> pending;    // inserted since the last build
+
+    static Point makePoint(int id, const GeoPoint& p) {
+        Point point;
+        double lat = p.latitude * GEO_PI / 180.0;
+        double lng = p.longitude * GEO_PI / 180.0;
+        point.xyz[0] = cos(lat) * cos(lng);
+        point.xyz[1] = cos(lat) * sin(lng);
+        point.xyz[2] = sin(lat);
+        point.position = p;
+        point.id = id;
+        return point;
+    }
+
+    static double chord2(const Point& a, const double* q) {
+        double dx = a.xyz[0] - q[0], dy = a.xyz[1] - q[1], dz = a.xyz[2] - q[2];
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Squared chord length of an arc of radiusKm
+    static double chord2ForKm(double radiusKm) {
+        double angle = std::min(radiusKm / EARTH_RADIUS_KM, GEO_PI);
+        double chord = 2 * sin(angle / 2);
+        return chord * chord;
+    }
+
+    void buildRange(size_t lo, size_t hi) {
+        if (hi - lo <= 1) return;
+
+        // Split on the axis with the largest spread
+        double minV[3] = {2, 2, 2}, maxV[3] = {-2, -2, -2};
+        for (size_t i = lo; i < hi; ++i) {
+            for (int a = 0; a < 3; ++a) {
+                minV[a] = std::min(minV[a], points[i].xyz[a]);
+                maxV[a] = std::max(maxV[a], points[i].xyz[a]);
+            }
+        }
+        uint8_t axis = 0;
+        for (uint8_t a = 1; a < 3; ++a) {
+            if (maxV[a] - minV[a] > maxV[axis] - minV[axis]) axis = a;
+        }
+
+        size_t mid = (lo + hi) / 2;
+        std::nth_element(points.begin() + lo, points.begin() + mid, points.begin() + hi,
+                         [axis](const Point& a, const Point& b) {
+                             return a.xyz[axis] < b.xyz[axis];
+                         });
+        axes[mid] = axis;
+        buildRange(lo, mid);
+        buildRange(mid + 1, hi);
+    }
+
+    // Max-heap on (squared chord, id) keeps the k best candidates;
+    // the id breaks ties between junctions at the same position
+    struct Candidate {
+        double chord2;
+        int id;
+        size_t index;   // into points
+
+        bool operator<(const Candidate& other) const {
+            return chord2 < other.chord2 || (chord2 == other.chord2 && id < other.id);
+        }
+    };
+
+    void nearestRange(size_t lo, size_t hi, const double* q, size_t k,
+                      std::priority_queue<Candidate>& best) const {
+        if (lo >= hi) return;
+        size_t mid = (lo + hi) / 2;
+        const Point& node = points[mid];
+
+        Candidate candidate = {chord2(node, q), node.id, mid};
+        if (best.size() < k) {
+            best.push(candidate);
+        } else if (candidate < best.top()) {
+            best.pop();
+            best.push(candidate);
+        }
+        if (hi - lo == 1) return;
+
+        uint8_t axis = axes[mid];
+        double diff = q[axis] - node.xyz[axis];
+        size_t nearLo = diff < 0 ? lo : mid + 1, nearHi = diff < 0 ? mid : hi;
+        size_t farLo = diff < 0 ? mid + 1 : lo, farHi = diff < 0 ? hi : mid;
+
+        nearestRange(nearLo, nearHi, q, k, best);
+        if (best.size() < k || diff * diff <= best.top().chord2) {
+            nearestRange(farLo, farHi, q, k, best);
+        }
+    }
+
+    void radiusRange(size_t lo, size_t hi, const double* q, double limit2,
+                     std::vector<size_t>& found) const {
+        if (lo >= hi) return;
+        size_t mid = (lo + hi) / 2;
+        const Point& node = points[mid];
+
+        if (chord2(node, q) <= limit2) found.push_back(mid);
+        if (hi - lo == 1) return;
+
+        double diff = q[axes[mid]] - node.xyz[axes[mid]];
+        if (diff <= 0 || diff * diff <= limit2) radiusRange(lo, mid, q, limit2, found);
+        if (diff >= 0 || diff * diff <= limit2) radiusRange(mid + 1, hi, q, limit2, found);
+    }
+
+    static void sortNeighbors(std::vector<Neighbor>& result) {
+        std::sort(result.begin(), result.end(), [](const Neighbor& a, const Neighbor& b) {
+            return a.distanceKm < b.distanceKm ||
+                   (a.distanceKm == b.distanceKm && a.id < b.id);
+        });
+    }
+
+public:
+    KDTree() {}
+
+    // Build from scratch - O(n log n)
+    void build(const std::vector<std::pair<int, GeoPoint>>& positions) {
+        clear();
+        points.reserve(positions.size());
+        for (const auto& p : positions) {
+            points.push_back(makePoint(p.first, p.second));
+        }
+        rebuild();
+    }
+
+    // Add one point; the tree is rebuilt when pending reaches a quarter of it
+    void insert(int id, const GeoPoint& position) {
+        pending.push_back(makePoint(id, position));
+        if (pending.size() >= std::max(MIN_PENDING_REBUILD, points.size() / 4)) {
+            rebuild();
+        }
+    }
+
+    // Add many points with at most one rebuild (same rule as insert)
+    void insertMany(const std::vector<std::pair<int, GeoPoint>>& positions) {
+        for (const auto& p : positions) {
+            pending.push_back(makePoint(p.first, p.second));
+        }
+        if (pending.size() >= std::max(MIN_PENDING_REBUILD, points.size() / 4)) {
+            rebuild();
+        }
+    }
+
+    // Fold pending points into the tree - O(n log n)
+    void rebuild() {
+        points.insert(points.end(), pending.begin(), pending.end());
+        pending.clear();
+        axes.assign(points.size(), 0);
+        buildRange(0, points.size());
+    }
+
+    // k closest points, nearest first
+    std::vector<Neighbor> nearest(const GeoPoint& center, size_t k) const {
+        std::vector<Neighbor> result;
+        if (k == 0 || size() == 0) return result;
+
+        Point q = makePoint(0, center);
+        std::priority_queue<Candidate> best;
+        nearestRange(0, points.size(), q.xyz, k, best);
+
+        result.reserve(best.size() + pending.size());
+        while (!best.empty()) {
+            const Point& p = points[best.top().index];
+            result.push_back(Neighbor(p.id, greatCircleKm(center, p.position)));
+            best.pop();
+        }
+        for (const Point& p : pending) {
+            result.push_back(Neighbor(p.id, greatCircleKm(center, p.position)));
+        }
+
+        sortNeighbors(result);
+        if (result.size() > k) result.resize(k);
+        return result;
+    }
+
+    // All points within radiusKm (great-circle), nearest first
+    std::vector<Neighbor> withinRadius(const GeoPoint& center, double radiusKm) const {
+        std::vector<Neighbor> result;
+        if (radiusKm < 0 || size() == 0) return result;
+
+        Point q = makePoint(0, center);
+        // Small slack so boundary points are settled by the exact haversine test
+        double limit2 = chord2ForKm(radiusKm) * (1.0 + 1e-9) + 1e-18;
+        std::vector<size_t> found;
+        radiusRange(0, points.size(), q.xyz, limit2, found);
+
+        for (size_t index : found) {
+            double dist = greatCircleKm(center, points[index].position);
+            if (dist <= radiusKm) result.push_back(Neighbor(points[index].id, dist));
+        }
+        for (const Point& p : pending) {
+            double dist = greatCircleKm(center, p.position);
+            if (dist <= radiusKm) result.push_back(Neighbor(p.id, dist));
+        }
+
+        sortNeighbors(result);
+        return result;
+    }
+
+    size_t size() const { return points.size() + pending.size(); }
+
+    size_t memoryUsageBytes() const {
+        return (points.capacity() + pending.capacity()) * sizeof(Point) + axes.capacity();
+    }
+
+    void clear() {
+        points.clear();
+        axes.clear();
+        pending.clear();
+    }
+};
+
+#endif // KDTREE_H
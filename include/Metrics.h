@@ -0,0 +1,395 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Hot-Path Metrics Implementation
+ *
+ * Latency histograms and counters for the request path (parse, dispatch,
+ * handler, route cache lookup, route search, graph search and its settled
+ * nodes, serialization). Every thread records into its own shard with
+ * relaxed atomic stores, so recording never takes a lock or contends for
+ * a cache line; readers sum the shards. Histograms are HDR-style:
+ * log-linear buckets with 16 steps per power of two (~6% resolution)
+ * from 1 ns to 2^40 ns, in a fixed 4.6 KB array.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// ==================== HISTOGRAM ====================
+
+// Distribution of non-negative integer values (latencies in nanoseconds,
+// or plain counts); one writer thread, any number of readers
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB_BUCKETS = 1u << SUB_BITS;   // linear steps below 32
+    static constexpr uint64_t HALF = SUB_BUCKETS / 2;         // steps per power of two above
+    static constexpr int MAX_BITS = 40;                       // larger values are clamped
+    static constexpr size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * HALF + HALF;
+
+    static int highestBit(uint64_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    static size_t bucketFor(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        int msb = highestBit(value);
+        if (msb >= MAX_BITS) return BUCKETS - 1;
+        int shift = msb - SUB_BITS + 1;
+        return static_cast<size_t>(shift * HALF + (value >> shift));
+    }
+
+    // Smallest value in a bucket; bucketLow(i + 1) is one past its largest
+    static uint64_t bucketLow(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        uint64_t shift = bucket / HALF - 1;
+        return (bucket - shift * HALF) << shift;
+    }
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKETS, 0);
+
+        double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+
+        // Value at quantile q (0..1): midpoint of its bucket, within [min, max]
+        uint64_t percentile(double q) const {
+            if (count == 0) return 0;
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BUCKETS; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    uint64_t low = bucketLow(i);
+                    uint64_t mid = low + (bucketLow(i + 1) - low) / 2;
+                    return std::min(max, std::max(min, mid));
+                }
+            }
+            return max;
+        }
+
+        // Values <= bound (whole buckets only, so at most one bucket low)
+        uint64_t countAtMost(uint64_t bound) const {
+            uint64_t total = 0;
+            for (size_t i = 0; i < BUCKETS && bucketLow(i + 1) - 1 <= bound; ++i) total += buckets[i];
+            return total;
+        }
+    };
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> minValue;
+    std::atomic<uint64_t> maxValue;
+
+    // Single writer: a plain load and store, no locked read-modify-write
+    static void bump(std::atomic<uint64_t>& cell, uint64_t by) {
+        cell.store(cell.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+public:
+    LatencyHistogram() : total(0), sum(0), minValue(std::numeric_limits<uint64_t>::max()), maxValue(0) {
+        for (std::atomic<uint64_t>& c : counts) c.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value) {
+        bump(counts[bucketFor(value)], 1);
+        bump(total, 1);
+        bump(sum, value);
+        if (value < minValue.load(std::memory_order_relaxed)) minValue.store(value, std::memory_order_relaxed);
+        if (value > maxValue.load(std::memory_order_relaxed)) maxValue.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount() const { return total.load(std::memory_order_relaxed); }
+
+    // Add this histogram into a snapshot (several shards merge into one)
+    void addTo(Snapshot* out) const {
+        for (size_t i = 0; i < BUCKETS; ++i) out->buckets[i] += counts[i].load(std::memory_order_relaxed);
+        out->count += total.load(std::memory_order_relaxed);
+        out->sum += sum.load(std::memory_order_relaxed);
+        out->min = std::min(out->min, minValue.load(std::memory_order_relaxed));
+        out->max = std::max(out->max, maxValue.load(std::memory_order_relaxed));
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        addTo(&s);
+        return s;
+    }
+};
+
+// ==================== METRIC NAMES ====================
+
+enum class Metric : int {
+    HTTP_PARSE,           // request line, headers and query parameters
+    HTTP_DISPATCH,        // path -> handler lookup
+    HTTP_HANDLER,         // handler, including everything below
+    ROUTE_CACHE_LOOKUP,
+    ROUTE_SEARCH,         // cache miss: lock, search and route description
+    GRAPH_SEARCH,         // the shortest-path search alone
+    SETTLED_NODES,        // vertices settled per graph search (a count)
+    ROUTE_SERIALIZE,      // RouteResult -> JSON
+    GEOCODE_REQUEST,      // one Nominatim request, on the geocoder thread
+    COUNT
+};
+
+enum class Counter : int {
+    HTTP_REQUESTS,
+    HTTP_ERRORS,          // 4xx and 5xx responses
+    COUNT
+};
+
+struct MetricInfo {
+    const char* name;     // JSON key; Prometheus name is traffic_<name>[_seconds]
+    const char* help;
+    bool isLatency;       // nanoseconds (exported as seconds) or a plain count
+};
+
+inline const MetricInfo& metricInfo(Metric metric) {
+    static const MetricInfo info[] = {
+        {"http_parse", "HTTP request parse time", true},
+        {"http_dispatch", "Route table lookup time", true},
+        {"http_handler", "Request handler time", true},
+        {"route_cache_lookup", "Route cache lookup time", true},
+        {"route_search", "Route computation time on a cache miss", true},
+        {"graph_search", "Shortest-path search time", true},
+        {"settled_nodes", "Vertices settled per shortest-path search", false},
+        {"route_serialize", "Route JSON serialization time", true},
+        {"geocode_request", "Nominatim request time", true},
+    };
+    return info[static_cast<int>(metric)];
+}
+
+inline const MetricInfo& counterInfo(Counter counter) {
+    static const MetricInfo info[] = {
+        {"http_requests", "HTTP requests answered", false},
+        {"http_errors", "HTTP requests answered with 4xx or 5xx", false},
+    };
+    return info[static_cast<int>(counter)];
+}
+
+// ==================== METRICS REGISTRY ====================
+
+class Metrics {
+private:
+    static constexpr int NUM_METRICS = static_cast<int>(Metric::COUNT);
+    static constexpr int NUM_COUNTERS = static_cast<int>(Counter::COUNT);
+
+    // Written by one thread at a time
+    struct Shard {
+        LatencyHistogram histograms[NUM_METRICS];
+        std::atomic<uint64_t> counters[NUM_COUNTERS];
+
+        Shard() {
+            for (std::atomic<uint64_t>& c : counters) c.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    // All shards ever made (never freed, so totals survive their threads);
+    // a finished thread's shard goes to the free list for the next thread,
+    // which keeps thread-per-connection servers from growing the list
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Shard>> shards;
+        std::vector<Shard*> freeShards;
+    };
+
+    static Registry& registry() {
+        static Registry* r = new Registry();   // outlives thread_local leases at exit
+        return *r;
+    }
+
+    struct Lease {
+        Shard* shard;
+
+        Lease() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (!r.freeShards.empty()) {
+                shard = r.freeShards.back();
+                r.freeShards.pop_back();
+            } else {
+                r.shards.push_back(std::unique_ptr<Shard>(new Shard()));
+                shard = r.shards.back().get();
+            }
+        }
+
+        ~Lease() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.freeShards.push_back(shard);
+        }
+    };
+
+    static Shard& local() {
+        thread_local Lease lease;
+        return *lease.shard;
+    }
+
+public:
+    // %.9g: valid in both JSON and the Prometheus text format
+    static void appendNumber(std::string& out, double value) {
+        char buffer[32];
+        int n = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out.append(buffer, n);
+    }
+
+    static void record(Metric metric, uint64_t value) {
+        local().histograms[static_cast<int>(metric)].record(value);
+    }
+
+    static void increment(Counter counter, uint64_t by = 1) {
+        std::atomic<uint64_t>& cell = local().counters[static_cast<int>(counter)];
+        cell.store(cell.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    // Records the time from construction to destruction (or to stop())
+    class Timer {
+    private:
+        Metric metric;
+        std::chrono::steady_clock::time_point start;
+        bool running;
+
+    public:
+        explicit Timer(Metric m) : metric(m), start(std::chrono::steady_clock::now()), running(true) {}
+
+        ~Timer() { stop(); }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        // Elapsed nanoseconds; recorded on the first call only
+        uint64_t stop() {
+            uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            if (running) Metrics::record(metric, ns);
+            running = false;
+            return ns;
+        }
+    };
+
+    // Summed over every thread
+    static LatencyHistogram::Snapshot snapshot(Metric metric) {
+        LatencyHistogram::Snapshot s;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const std::unique_ptr<Shard>& shard : r.shards) {
+            shard->histograms[static_cast<int>(metric)].addTo(&s);
+        }
+        return s;
+    }
+
+    static uint64_t total(Counter counter) {
+        uint64_t sum = 0;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const std::unique_ptr<Shard>& shard : r.shards) {
+            sum += shard->counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // {"counters": {...}, "histograms": {"http_parse": {"count": .., "p50": ..}, ...}};
+    // latencies in microseconds
+    static void appendJson(std::string& out) {
+        out += "\"counters\": {";
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            if (c > 0) out += ",";
+            out += "\"";
+            out += counterInfo(static_cast<Counter>(c)).name;
+            out += "\": ";
+            out += std::to_string(total(static_cast<Counter>(c)));
+        }
+        out += "},\"histograms\": {";
+        for (int m = 0; m < NUM_METRICS; ++m) {
+            const MetricInfo& info = metricInfo(static_cast<Metric>(m));
+            LatencyHistogram::Snapshot s = snapshot(static_cast<Metric>(m));
+            double scale = info.isLatency ? 1e-3 : 1.0;
+            if (m > 0) out += ",";
+            out += "\"";
+            out += info.name;
+            out += "\": {\"unit\": \"";
+            out += info.isLatency ? "us" : "count";
+            out += "\",\"count\": " + std::to_string(s.count);
+            out += ",\"mean\": ";
+            appendNumber(out, s.mean() * scale);
+            static const std::pair<const char*, double> quantiles[] = {
+                {"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}};
+            for (const auto& q : quantiles) {
+                out += ",\"";
+                out += q.first;
+                out += "\": ";
+                appendNumber(out, s.percentile(q.second) * scale);
+            }
+            out += ",\"max\": ";
+            appendNumber(out, s.max * scale);
+            out += "}";
+        }
+        out += "}";
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    static void appendPrometheus(std::string& out) {
+        for (int c = 0; c < NUM_COUNTERS; ++c) {
+            const MetricInfo& info = counterInfo(static_cast<Counter>(c));
+            std::string name = std::string("traffic_") + info.name + "_total";
+            out += "# HELP " + name + " " + info.help + "\n# TYPE " + name + " counter\n";
+            out += name + " " + std::to_string(total(static_cast<Counter>(c))) + "\n";
+        }
+
+        // 1 us .. 10 s in 1-2.5-5 steps for latencies, powers of ten for counts
+        static const double latencyBounds[] = {
+            1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 2.5e-3, 5e-3,
+            1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+        static const double countBounds[] = {10, 100, 1000, 1e4, 1e5, 1e6, 1e7};
+
+        for (int m = 0; m < NUM_METRICS; ++m) {
+            const MetricInfo& info = metricInfo(static_cast<Metric>(m));
+            LatencyHistogram::Snapshot s = snapshot(static_cast<Metric>(m));
+            std::string name = std::string("traffic_") + info.name + (info.isLatency ? "_seconds" : "");
+            double scale = info.isLatency ? 1e-9 : 1.0;
+            out += "# HELP " + name + " " + info.help + "\n# TYPE " + name + " histogram\n";
+
+            const double* bounds = info.isLatency ? latencyBounds : countBounds;
+            size_t numBounds = info.isLatency ? sizeof(latencyBounds) / sizeof(double)
+                                              : sizeof(countBounds) / sizeof(double);
+            for (size_t b = 0; b < numBounds; ++b) {
+                out += name + "_bucket{le=\"";
+                appendNumber(out, bounds[b]);
+                out += "\"} " + std::to_string(s.countAtMost(static_cast<uint64_t>(bounds[b] / scale + 0.5))) + "\n";
+            }
+            out += name + "_bucket{le=\"+Inf\"} " + std::to_string(s.count) + "\n";
+            out += name + "_sum ";
+            appendNumber(out, s.sum * scale);
+            out += "\n" + name + "_count " + std::to_string(s.count) + "\n";
+        }
+    }
+};
+
+#endif // METRICS_H
@@ -13,6 +13,7 @@
 #include <stdexcept>
 #include <functional>
 #include <unordered_map>
+#include <algorithm>
 
 template <typename T, typename Priority = double>
 class MinHeap {
@@ -237,4 +238,122 @@ public:
     }
 };
 
+/**
+ * Indexed 4-ary Min-Heap
+ *
+ * Elements are dense integer IDs in [0, capacity), so the position of each
+ * element is kept in a flat array instead of a hash map.
+ * Time Complexity: O(log n) for push/decrease-key/extract, O(1) contains
+ * A 4-ary layout halves the tree height and keeps siblings in one cache line.
+ */
+template <typename Priority = double>
+class IndexedMinHeap {
+private:
+    static constexpr size_t ARITY = 4;
+    static constexpr int NOT_IN_HEAP = -1;
+
+    struct HeapNode {
+        Priority priority;
+        int id;
+    };
+
+    std::vector<HeapNode> heap;
+    std::vector<int> position; // id -> index in heap, or NOT_IN_HEAP
+
+    void siftUp(size_t i) {
+        HeapNode node = heap[i];
+        while (i > 0) {
+            size_t p = (i - 1) / ARITY;
+            if (!(node.priority < heap[p].priority)) break;
+            heap[i] = heap[p];
+            position[heap[i].id] = static_cast<int>(i);
+            i = p;
+        }
+        heap[i] = node;
+        position[node.id] = static_cast<int>(i);
+    }
+
+    void siftDown(size_t i) {
+        HeapNode node = heap[i];
+        size_t n = heap.size();
+        while (true) {
+            size_t first = ARITY * i + 1;
+            if (first >= n) break;
+
+            size_t last = std::min(first + ARITY, n);
+            size_t best = first;
+            for (size_t c = first + 1; c < last; ++c) {
+                if (heap[c].priority < heap[best].priority) best = c;
+            }
+            if (!(heap[best].priority < node.priority)) break;
+
+            heap[i] = heap[best];
+            position[heap[i].id] = static_cast<int>(i);
+            i = best;
+        }
+        heap[i] = node;
+        position[node.id] = static_cast<int>(i);
+    }
+
+public:
+    explicit IndexedMinHeap(size_t capacity = 0) : position(capacity, NOT_IN_HEAP) {}
+
+    // Allow IDs in [0, capacity); never shrinks
+    void reserve(size_t capacity) {
+        if (position.size() < capacity) {
+            position.resize(capacity, NOT_IN_HEAP);
+        }
+    }
+
+    size_t capacity() const { return position.size(); }
+
+    // Insert, or lower the priority if already queued - O(log n)
+    void push(int id, Priority priority) {
+        int index = position[id];
+        if (index == NOT_IN_HEAP) {
+            heap.push_back({priority, id});
+            siftUp(heap.size() - 1);
+        } else if (priority < heap[index].priority) {
+            heap[index].priority = priority;
+            siftUp(static_cast<size_t>(index));
+        }
+    }
+
+    // Extract minimum element - O(log n)
+    int extractMin() {
+        if (heap.empty()) {
+            throw std::runtime_error("Heap is empty");
+        }
+
+        int minId = heap[0].id;
+        position[minId] = NOT_IN_HEAP;
+
+        HeapNode last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return minId;
+    }
+
+    int getMin() const { return heap[0].id; }
+    Priority getMinPriority() const { return heap[0].priority; }
+
+    bool contains(int id) const {
+        return static_cast<size_t>(id) < position.size() && position[id] != NOT_IN_HEAP;
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+
+    // Remove all queued elements - O(size), independent of capacity
+    void clear() {
+        for (const HeapNode& node : heap) {
+            position[node.id] = NOT_IN_HEAP;
+        }
+        heap.clear();
+    }
+};
+
 #endif // MINHEAP_H
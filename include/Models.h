@@ -7,13 +7,19 @@
 #define MODELS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cmath>
+#include <cstdio>
+#include "StringTable.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// Fastest speed limit of any generated road (inter-city highways), km/h
+const double MAX_ROAD_SPEED_KMH = 120.0;
+
 // Traffic level enumeration
 enum class TrafficLevel {
     LOW = 1,      // Green - Free flowing
@@ -44,6 +50,45 @@ inline std::string trafficLevelToString(TrafficLevel level) {
     }
 }
 
+// Append numbers in the std::to_string format without a temporary string
+inline void appendJsonNumber(std::string& out, long long value) {
+    char buffer[24];
+    out.append(buffer, snprintf(buffer, sizeof(buffer), "%lld", value));
+}
+
+inline void appendJsonNumber(std::string& out, double value) {
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%f", value);
+    if (length >= static_cast<int>(sizeof(buffer))) {
+        out += std::to_string(value);   // huge magnitudes only
+        return;
+    }
+    out.append(buffer, length);
+}
+
+// Append text escaped for use inside a JSON string literal (the quotes are the caller's)
+inline void appendJsonString(std::string& out, std::string_view text) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+        out.append(text.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char buffer[8];
+                out.append(buffer, snprintf(buffer, sizeof(buffer), "\\u%04x", c));
+            }
+        }
+    }
+    out.append(text.data() + start, text.size() - start);
+}
+
 // Convert traffic level to color
 inline std::string trafficLevelToColor(TrafficLevel level) {
     switch (level) {
@@ -55,6 +100,28 @@ inline std::string trafficLevelToColor(TrafficLevel level) {
     }
 }
 
+// Junction JSON object, shared by Junction and the compact RouteStop
+inline void appendJunctionJson(std::string& out, int id, std::string_view name, double latitude,
+                               double longitude, std::string_view city, std::string_view area,
+                               bool hasTrafficSignal, bool geocoded) {
+    out += "{\"id\":";
+    appendJsonNumber(out, static_cast<long long>(id));
+    out += ",\"name\":\"";
+    appendJsonString(out, name);
+    out += "\",\"displayName\":\"";
+    appendJsonString(out, name);
+    out += "\",\"latitude\":";
+    appendJsonNumber(out, latitude);
+    out += ",\"longitude\":";
+    appendJsonNumber(out, longitude);
+    out += ",\"city\":\"";
+    appendJsonString(out, city);
+    out += "\",\"area\":\"";
+    appendJsonString(out, area);
+    out += hasTrafficSignal ? "\",\"hasTrafficSignal\":true" : "\",\"hasTrafficSignal\":false";
+    out += geocoded ? ",\"source\":\"nominatim\"}" : ",\"source\":\"osm\"}";
+}
+
 // Junction (Intersection) data structure
 struct Junction {
     int id;
@@ -64,14 +131,15 @@ struct Junction {
     std::string city;
     std::string area;
     bool hasTrafficSignal;
+    bool geocoded;   // added from a Nominatim answer, not the loaded data
     std::vector<int> connectedJunctions;
 
-    Junction() : id(0), latitude(0), longitude(0), hasTrafficSignal(false) {}
+    Junction() : id(0), latitude(0), longitude(0), hasTrafficSignal(false), geocoded(false) {}
 
     Junction(int _id, const std::string& _name, double _lat, double _lng,
              const std::string& _city = "", const std::string& _area = "")
         : id(_id), name(_name), latitude(_lat), longitude(_lng),
-          city(_city), area(_area), hasTrafficSignal(true) {}
+          city(_city), area(_area), hasTrafficSignal(true), geocoded(false) {}
 
     // Calculate Haversine distance to another junction (in km)
     double distanceTo(const Junction& other) const {
@@ -88,19 +156,30 @@ struct Junction {
         return R * c;
     }
 
+    // Append the JSON object to out (streaming serializers reuse one buffer)
+    void appendJson(std::string& out) const {
+        appendJunctionJson(out, id, name, latitude, longitude, city, area, hasTrafficSignal, geocoded);
+    }
+
     // Convert to JSON string
     std::string toJson() const {
-        std::string json = "{";
-        json += "\"id\":" + std::to_string(id) + ",";
-        json += "\"name\":\"" + name + "\",";
-        json += "\"displayName\":\"" + name + "\",";
-        json += "\"latitude\":" + std::to_string(latitude) + ",";
-        json += "\"longitude\":" + std::to_string(longitude) + ",";
-        json += "\"city\":\"" + city + "\",";
-        json += "\"area\":\"" + area + "\",";
-        json += "\"hasTrafficSignal\":" + std::string(hasTrafficSignal ? "true" : "false") + ",";
-        json += "\"source\":\"" + std::string(id >= 10000 ? "nominatim" : "osm") + "\"";
-        json += "}";
+        std::string json;
+        appendJson(json);
+        return json;
+    }
+};
+
+// Junction returned by a spatial query, with its distance from the query point
+struct NearbyJunction {
+    Junction junction;
+    double distanceKm;
+
+    NearbyJunction() : distanceKm(0) {}
+
+    std::string toJson() const {
+        std::string json = junction.toJson();
+        json.pop_back();
+        json += ",\"distanceKm\":" + std::to_string(distanceKm) + "}";
         return json;
     }
 };
@@ -141,104 +220,158 @@ struct Road {
         trafficLevel = level;
     }
 
+    // Append the JSON object to out (streaming serializers reuse one buffer)
+    void appendJson(std::string& out) const {
+        out += "{\"id\":";
+        appendJsonNumber(out, static_cast<long long>(id));
+        out += ",\"name\":\"";
+        appendJsonString(out, name);
+        out += "\",\"source\":";
+        appendJsonNumber(out, static_cast<long long>(sourceJunction));
+        out += ",\"destination\":";
+        appendJsonNumber(out, static_cast<long long>(destJunction));
+        out += ",\"distance\":";
+        appendJsonNumber(out, distance);
+        out += ",\"speedLimit\":";
+        appendJsonNumber(out, speedLimit);
+        out += ",\"baseTime\":";
+        appendJsonNumber(out, baseTime);
+        out += ",\"actualTime\":";
+        appendJsonNumber(out, getActualTime());
+        out += ",\"trafficLevel\":\"";
+        out += trafficLevelToString(trafficLevel);
+        out += "\",\"trafficMultiplier\":";
+        appendJsonNumber(out, getTrafficMultiplier(trafficLevel));
+        out += isTwoWay ? ",\"isTwoWay\":true" : ",\"isTwoWay\":false";
+        out += ",\"roadType\":\"";
+        appendJsonString(out, roadType);
+        out += "\"}";
+    }
+
     // Convert to JSON string
     std::string toJson() const {
-        std::string json = "{";
-        json += "\"id\":" + std::to_string(id) + ",";
-        json += "\"name\":\"" + name + "\",";
-        json += "\"source\":" + std::to_string(sourceJunction) + ",";
-        json += "\"destination\":" + std::to_string(destJunction) + ",";
-        json += "\"distance\":" + std::to_string(distance) + ",";
-        json += "\"speedLimit\":" + std::to_string(speedLimit) + ",";
-        json += "\"baseTime\":" + std::to_string(baseTime) + ",";
-        json += "\"actualTime\":" + std::to_string(getActualTime()) + ",";
-        json += "\"trafficLevel\":\"" + trafficLevelToString(trafficLevel) + "\",";
-        json += "\"trafficMultiplier\":" + std::to_string(getTrafficMultiplier(trafficLevel)) + ",";
-        json += "\"isTwoWay\":" + std::string(isTwoWay ? "true" : "false") + ",";
-        json += "\"roadType\":\"" + roadType + "\"";
-        json += "}";
+        std::string json;
+        appendJson(json);
         return json;
     }
 };
 
+// Junction on a route: the fields the route JSON shows, with names as
+// RouteResult::strings IDs (no string copies, no connectedJunctions)
+struct RouteStop {
+    int id;
+    uint32_t name;
+    uint32_t city;
+    uint32_t area;
+    double latitude;
+    double longitude;
+    bool hasTrafficSignal;
+    bool geocoded;
+};
+
 // Traffic segment structure for route visualization
 struct TrafficSegment {
     int fromJunctionId;
     int toJunctionId;
-    std::string roadName;
+    uint32_t roadName;   // RouteResult::strings ID
     double distance;
     double time;
     TrafficLevel trafficLevel;
-    std::string color;
-
-    TrafficSegment() : fromJunctionId(0), toJunctionId(0), distance(0), 
-                       time(0), trafficLevel(TrafficLevel::NORMAL) {
-        color = trafficLevelToColor(trafficLevel);
-    }
 
-    TrafficSegment(int from, int to, const std::string& name, double dist, 
-                   double t, TrafficLevel level)
-        : fromJunctionId(from), toJunctionId(to), roadName(name), 
-          distance(dist), time(t), trafficLevel(level) {
-        color = trafficLevelToColor(level);
-    }
-
-    std::string toJson() const {
-        std::string json = "{";
-        json += "\"from\":" + std::to_string(fromJunctionId) + ",";
-        json += "\"to\":" + std::to_string(toJunctionId) + ",";
-        json += "\"roadName\":\"" + roadName + "\",";
-        json += "\"distance\":" + std::to_string(distance) + ",";
-        json += "\"time\":" + std::to_string(time) + ",";
-        json += "\"trafficLevel\":\"" + trafficLevelToString(trafficLevel) + "\",";
-        json += "\"color\":\"" + color + "\"";
-        json += "}";
-        return json;
+    void appendJson(std::string& out, const StringTable& strings) const {
+        out += "{\"from\":";
+        appendJsonNumber(out, static_cast<long long>(fromJunctionId));
+        out += ",\"to\":";
+        appendJsonNumber(out, static_cast<long long>(toJunctionId));
+        out += ",\"roadName\":\"";
+        appendJsonString(out, strings.get(roadName));
+        out += "\",\"distance\":";
+        appendJsonNumber(out, distance);
+        out += ",\"time\":";
+        appendJsonNumber(out, time);
+        out += ",\"trafficLevel\":\"";
+        out += trafficLevelToString(trafficLevel);
+        out += "\",\"color\":\"";
+        out += trafficLevelToColor(trafficLevel);
+        out += "\"}";
     }
 };
 
-// Route result structure
+/**
+ * Route result structure
+ * Compact: junctions are RouteStops and every name (junction, city, area,
+ * road) is interned once per route in strings, so a route is a handful of
+ * flat arrays however long it is, and copying one into or out of the
+ * route cache is a few memcpys. Text is resolved when serialized.
+ */
 struct RouteResult {
-    std::vector<Junction> junctions;
-    std::vector<Road> roads;
+    std::vector<RouteStop> stops;
     std::vector<TrafficSegment> trafficSegments;
+    StringTable strings;
     double totalDistance;
     double totalTime;
     bool found;
+    std::string algorithm;  // search strategy that produced the route
+    int settledNodes;       // vertices settled by the search
+    std::vector<RouteResult> alternatives;   // ?alternatives=N: other good routes, best first
+
+    RouteResult() : totalDistance(0), totalTime(0), found(false),
+                    algorithm("dijkstra"), settledNodes(0) {}
+
+    std::string_view getString(uint32_t id) const { return strings.get(id); }
+
+    void appendJson(std::string& out) const {
+        out += "{\"found\":";
+        out += found ? "true" : "false";
+        out += ",\"totalDistance\":";
+        appendJsonNumber(out, totalDistance);
+        out += ",\"totalTime\":";
+        appendJsonNumber(out, totalTime);
+        out += ",\"algorithm\":\"";
+        out += algorithm;
+        out += "\",\"settledNodes\":";
+        appendJsonNumber(out, static_cast<long long>(settledNodes));
 
-    RouteResult() : totalDistance(0), totalTime(0), found(false) {}
-
-    std::string toJson() const {
-        std::string json = "{";
-        json += "\"found\":" + std::string(found ? "true" : "false") + ",";
-        json += "\"totalDistance\":" + std::to_string(totalDistance) + ",";
-        json += "\"totalTime\":" + std::to_string(totalTime) + ",";
-        
         // Complete junction details
-        json += "\"junctions\":[";
-        for (size_t i = 0; i < junctions.size(); ++i) {
-            json += junctions[i].toJson();
-            if (i < junctions.size() - 1) json += ",";
+        out += ",\"junctions\":[";
+        for (size_t i = 0; i < stops.size(); ++i) {
+            const RouteStop& stop = stops[i];
+            if (i > 0) out += ',';
+            appendJunctionJson(out, stop.id, strings.get(stop.name), stop.latitude, stop.longitude,
+                               strings.get(stop.city), strings.get(stop.area), stop.hasTrafficSignal,
+                               stop.geocoded);
         }
-        json += "],";
-        
+
         // Traffic segments for visualization
-        json += "\"trafficSegments\":[";
+        out += "],\"trafficSegments\":[";
         for (size_t i = 0; i < trafficSegments.size(); ++i) {
-            json += trafficSegments[i].toJson();
-            if (i < trafficSegments.size() - 1) json += ",";
+            if (i > 0) out += ',';
+            trafficSegments[i].appendJson(out, strings);
         }
-        json += "],";
-        
+
         // Path IDs (for backward compatibility)
-        json += "\"path\":[";
-        for (size_t i = 0; i < junctions.size(); ++i) {
-            json += std::to_string(junctions[i].id);
-            if (i < junctions.size() - 1) json += ",";
+        out += "],\"path\":[";
+        for (size_t i = 0; i < stops.size(); ++i) {
+            if (i > 0) out += ',';
+            appendJsonNumber(out, static_cast<long long>(stops[i].id));
         }
-        json += "]";
-        
-        json += "}";
+        out += ']';
+
+        if (!alternatives.empty()) {
+            out += ",\"alternatives\":[";
+            for (size_t i = 0; i < alternatives.size(); ++i) {
+                if (i > 0) out += ',';
+                alternatives[i].appendJson(out);
+            }
+            out += ']';
+        }
+        out += '}';
+    }
+
+    std::string toJson() const {
+        std::string json;
+        json.reserve(256 + stops.size() * 320);
+        appendJson(json);
         return json;
     }
 };
@@ -10,89 +10,94 @@
 #define OSMLOADER_H
 
 #include <iostream>
-#include <fstream>
+#include <iomanip>
 #include <sstream>
 #include <chrono>
 #include <string>
 #include <vector>
 #include <map>
+#include <thread>
+#include <atomic>
 #include "TrafficManager.h"
+#include "GeoGrid.h"
+#include "JunctionReader.h"
 
 class OSMLoader {
 private:
     TrafficManager& trafficManager;
     
-    // Helper functions (keep existing ones)
-    std::string extractValue(const std::string& json, size_t start, size_t end) {
-        std::string value = json.substr(start, end - start);
-        if (!value.empty() && value[0] == '"') {
-            value = value.substr(1);
-        }
-        if (!value.empty() && value[value.length()-1] == '"') {
-            value = value.substr(0, value.length()-1);
-        }
-        return value;
-    }
+    // Junctions per parallel spatial-join job
+    static constexpr size_t JOIN_CHUNK_SIZE = 256;
+    // Grid cell size for the inter-city closest-pair search
+    static constexpr double HIGHWAY_GRID_KM = 5.0;
     
-    int extractInt(const std::string& json, const std::string& key) {
-        std::string searchKey = "\"" + key + "\":";
-        size_t pos = json.find(searchKey);
-        if (pos == std::string::npos) return 0;
-        
-        size_t start = pos + searchKey.length();
-        while (start < json.length() && (json[start] == ' ' || json[start] == '\t')) start++;
-        
-        size_t end = json.find_first_of(",}", start);
-        if (end == std::string::npos) return 0;
-        
-        try {
-            return std::stoi(json.substr(start, end - start));
-        } catch (...) {
-            return 0;
-        }
-    }
+    // Intra-city road found by the spatial join (indices into the city list)
+    struct CandidateRoad {
+        uint32_t i;
+        uint32_t j;
+        double distance;
+    };
     
-    double extractDouble(const std::string& json, const std::string& key) {
-        std::string searchKey = "\"" + key + "\":";
-        size_t pos = json.find(searchKey);
-        if (pos == std::string::npos) return 0.0;
-        
-        size_t start = pos + searchKey.length();
-        while (start < json.length() && (json[start] == ' ' || json[start] == '\t')) start++;
-        
-        size_t end = json.find_first_of(",}", start);
-        if (end == std::string::npos) return 0.0;
-        
-        try {
-            return std::stod(json.substr(start, end - start));
-        } catch (...) {
-            return 0.0;
+    /**
+     * Closest junction pair between two cities
+     * Grid cells of both cities are visited in order of their bounding-box
+     * distance lower bound, stopping once no remaining cell pair can beat the
+     * best pair. Ties resolve to the smallest (i, j), exactly like scanning all
+     * pairs in order with a strict '<'.
+     * @return number of junction pairs whose distance was computed
+     */
+    uint64_t closestPair(const std::vector<Junction>& junctions1,
+                         const std::vector<Junction>& junctions2,
+                         double* minDistance, size_t* bestI, size_t* bestJ) {
+        std::vector<GeoPoint> points1, points2;
+        points1.reserve(junctions1.size());
+        points2.reserve(junctions2.size());
+        for (const auto& j : junctions1) points1.push_back(GeoPoint(j.latitude, j.longitude));
+        for (const auto& j : junctions2) points2.push_back(GeoPoint(j.latitude, j.longitude));
+        
+        GeoGrid grid1, grid2;
+        grid1.build(points1, HIGHWAY_GRID_KM);
+        grid2.build(points2, HIGHWAY_GRID_KM);
+        const auto& cells1 = grid1.getCells();
+        const auto& cells2 = grid2.getCells();
+        
+        struct CellPair {
+            double lowerBound;
+            uint32_t a;
+            uint32_t b;
+            bool operator<(const CellPair& other) const { return lowerBound < other.lowerBound; }
+        };
+        std::vector<CellPair> cellPairs;
+        cellPairs.reserve(cells1.size() * cells2.size());
+        for (uint32_t a = 0; a < cells1.size(); ++a) {
+            for (uint32_t b = 0; b < cells2.size(); ++b) {
+                cellPairs.push_back({GeoGrid::lowerBoundKm(cells1[a], cells2[b]), a, b});
+            }
         }
-    }
-    
-    std::string extractString(const std::string& json, const std::string& key) {
-        std::string searchKey = "\"" + key + "\":";
-        size_t pos = json.find(searchKey);
-        if (pos == std::string::npos) return "";
-        
-        size_t start = pos + searchKey.length();
-        while (start < json.length() && (json[start] == ' ' || json[start] == '\t' || json[start] == '"')) start++;
-        
-        size_t end = json.find("\"", start);
-        if (end == std::string::npos) return "";
-        
-        return json.substr(start, end - start);
-    }
-    
-    bool extractBool(const std::string& json, const std::string& key) {
-        std::string searchKey = "\"" + key + "\":";
-        size_t pos = json.find(searchKey);
-        if (pos == std::string::npos) return false;
-        
-        size_t start = pos + searchKey.length();
-        while (start < json.length() && (json[start] == ' ' || json[start] == '\t')) start++;
+        std::sort(cellPairs.begin(), cellPairs.end());
         
-        return json.substr(start, 4) == "true";
+        uint64_t checked = 0;
+        for (const CellPair& pair : cellPairs) {
+            if (pair.lowerBound > *minDistance) break;
+            
+            const GeoGrid::Cell& cell1 = cells1[pair.a];
+            const GeoGrid::Cell& cell2 = cells2[pair.b];
+            for (uint32_t k = cell1.begin; k < cell1.end; ++k) {
+                size_t i = grid1.getOrder()[k];
+                for (uint32_t l = cell2.begin; l < cell2.end; ++l) {
+                    size_t j = grid2.getOrder()[l];
+                    double dist = greatCircleKm(points1[i], points2[j]);
+                    checked++;
+                    if (dist < *minDistance ||
+                        (dist == *minDistance && (i < *bestI || (i == *bestI && j < *bestJ)))) {
+                        *minDistance = dist;
+                        *bestI = i;
+                        *bestJ = j;
+                    }
+                }
+            }
+        }
+        return checked;
     }
 
 public:
@@ -108,68 +113,17 @@ public:
         std::cout << "📡 Source: OpenStreetMap (Overpass API)\n";
         std::cout << "💾 Storage: B-Tree + Hash Table (RAM)\n\n";
         
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "❌ ERROR: Cannot open file!\n";
-            std::cerr << "   File path: " << filename << "\n";
-            return false;
-        }
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        file.close();
-        
         std::cout << "⏳ Loading junctions into memory...\n\n";
         
-        int loadedCount = 0;
-        int errorCount = 0;
-        
-        size_t junctionsPos = content.find("\"junctions\"");
-        if (junctionsPos == std::string::npos) {
-            std::cerr << "❌ ERROR: 'junctions' array not found in JSON!\n";
-            return false;
-        }
-        
-        size_t arrayStart = content.find("[", junctionsPos);
-        if (arrayStart == std::string::npos) {
-            std::cerr << "❌ ERROR: Invalid JSON format!\n";
-            return false;
-        }
-        
-        size_t pos = arrayStart + 1;
-        while (pos < content.length()) {
-            size_t objStart = content.find("{", pos);
-            if (objStart == std::string::npos) break;
-            
-            size_t objEnd = content.find("}", objStart);
-            if (objEnd == std::string::npos) break;
-            
-            std::string junctionStr = content.substr(objStart, objEnd - objStart + 1);
-            
-            try {
-                Junction j;
-                j.id = extractInt(junctionStr, "id");
-                j.name = extractString(junctionStr, "name");
-                j.latitude = extractDouble(junctionStr, "latitude");
-                j.longitude = extractDouble(junctionStr, "longitude");
-                j.city = extractString(junctionStr, "city");
-                j.area = extractString(junctionStr, "area");
-                j.hasTrafficSignal = extractBool(junctionStr, "hasTrafficSignal");
-                
-                if (j.id > 0 && !j.name.empty() && j.latitude != 0.0) {
-                    trafficManager.addJunction(j);
-                    loadedCount++;
-                    
-                    if (loadedCount % 1000 == 0) {
-                        std::cout << "   📍 Loaded " << loadedCount << " junctions...\n";
-                    }
-                }
-            } catch (...) {
-                errorCount++;
-            }
-            
-            pos = objEnd + 1;
+        // Parsed chunk by chunk and added in growing batches, so the file is
+        // never held in memory as a whole
+        JunctionJsonReader::Stats stats;
+        bool ok = trafficManager.loadJunctionsFromJson(filename, &stats);
+        size_t loadedCount = stats.junctions;
+        if (!ok) {
+            std::cerr << "❌ ERROR: Cannot load junctions!\n";
+            std::cerr << "   File path: " << filename << "\n";
+            if (loadedCount == 0) return false;
         }
         
         auto endTime = std::chrono::high_resolution_clock::now();
@@ -179,8 +133,12 @@ public:
         std::cout << "║   LOADING COMPLETE!                   ║\n";
         std::cout << "╚════════════════════════════════════════╝\n\n";
         std::cout << "✅ Junctions Loaded: " << loadedCount << "\n";
-        std::cout << "⚠️  Errors: " << errorCount << "\n";
+        std::cout << "⚠️  Skipped: " << stats.skipped << "\n";
         std::cout << "⏱️  Load Time: " << duration.count() << " ms\n";
+        std::ostringstream parsed;   // keeps the fixed precision off std::cout
+        parsed << std::fixed << std::setprecision(1) << (stats.bytes / (1024.0 * 1024.0))
+               << " MB in " << (stats.parseSeconds * 1000) << " ms (" << stats.megabytesPerSecond() << " MB/s)";
+        std::cout << "📖 Parsed: " << parsed.str() << "\n";
         std::cout << "💾 B-Tree Nodes: ~" << (loadedCount / 10) << "\n";
         std::cout << "🔍 Search Complexity: O(log n)\n";
         std::cout << "⚡ Average Search Time: <1ms\n\n";
@@ -197,6 +155,7 @@ public:
         std::cout << "📏 Within cities: " << maxDistanceKm << " km\n";
         std::cout << "🏙️  Between cities: Major highways\n\n";
         
+        auto startTime = std::chrono::high_resolution_clock::now();
         auto junctions = trafficManager.getAllJunctions();
         int roadId = 1;
         int intraRoads = 0;  // Within city
@@ -215,51 +174,143 @@ public:
         std::cout << "\n";
         
         // PHASE 1: INTRA-CITY ROADS (within same city)
+        // Uniform-grid spatial join: only junctions in adjacent cells are
+        // compared. Cities are split into chunks that run on all cores, and
+        // roads are then added in the original (city, i, j) order so road
+        // IDs and the edge set match the all-pairs scan exactly.
         std::cout << "⏳ Phase 1: Generating intra-city roads...\n";
         
-        for (auto& [city, cityJunctions] : citiesMap) {
-            std::cout << "   🏙️ Processing " << city << "...\n";
-            
-            for (size_t i = 0; i < cityJunctions.size(); ++i) {
-                for (size_t j = i + 1; j < cityJunctions.size(); ++j) {
-                    double distance = cityJunctions[i].distanceTo(cityJunctions[j]);
+        struct JoinJob {
+            const std::vector<Junction>* junctions;
+            const GeoGrid* grid;
+            const std::vector<GeoPoint>* points;
+            size_t begin, end;
+            std::vector<CandidateRoad> roads;
+            uint64_t checkedPairs;
+        };
+        
+        std::vector<std::vector<GeoPoint>> cityPoints;
+        cityPoints.reserve(citiesMap.size());  // jobs keep pointers into it
+        std::vector<GeoGrid> cityGrids(citiesMap.size());
+        std::vector<JoinJob> jobs;
+        uint64_t allPairs = 0;
+        
+        if (maxDistanceKm > 0) {
+            size_t c = 0;
+            for (auto& [city, cityJunctions] : citiesMap) {
+                std::vector<GeoPoint> points;
+                points.reserve(cityJunctions.size());
+                for (const auto& j : cityJunctions) {
+                    points.push_back(GeoPoint(j.latitude, j.longitude));
+                }
+                cityPoints.push_back(std::move(points));
+                cityGrids[c].build(cityPoints.back(), maxDistanceKm);
+                allPairs += static_cast<uint64_t>(cityJunctions.size()) * 
+                            (cityJunctions.size() - 1) / 2;
+                
+                for (size_t begin = 0; begin < cityJunctions.size(); begin += JOIN_CHUNK_SIZE) {
+                    JoinJob job;
+                    job.junctions = &cityJunctions;
+                    job.grid = &cityGrids[c];
+                    job.points = &cityPoints.back();
+                    job.begin = begin;
+                    job.end = std::min(begin + JOIN_CHUNK_SIZE, cityJunctions.size());
+                    job.checkedPairs = 0;
+                    jobs.push_back(std::move(job));
+                }
+                ++c;
+            }
+        }
+        
+        std::atomic<size_t> nextJob(0);
+        auto joinWorker = [&]() {
+            size_t index;
+            std::vector<uint32_t> neighbours;
+            while ((index = nextJob++) < jobs.size()) {
+                JoinJob& job = jobs[index];
+                const std::vector<GeoPoint>& points = *job.points;
+                for (size_t i = job.begin; i < job.end; ++i) {
+                    neighbours.clear();
+                    job.grid->forEachNear(points[i], [&](uint32_t j) {
+                        if (j > i) neighbours.push_back(j);
+                    });
+                    std::sort(neighbours.begin(), neighbours.end());
+                    job.checkedPairs += neighbours.size();
                     
-                    if (distance < maxDistanceKm) {
-                        double speedLimit = 40.0;
-                        
-                        std::string areaLower = cityJunctions[i].area;
-                        std::transform(areaLower.begin(), areaLower.end(), 
-                                     areaLower.begin(), ::tolower);
-                        
-                        if (areaLower.find("highway") != std::string::npos ||
-                            areaLower.find("motorway") != std::string::npos) {
-                            speedLimit = 100.0;
-                        } else if (areaLower.find("main") != std::string::npos ||
-                                 areaLower.find("road") != std::string::npos) {
-                            speedLimit = 60.0;
+                    for (uint32_t j : neighbours) {
+                        double distance = greatCircleKm(points[i], points[j]);
+                        if (distance < maxDistanceKm) {
+                            job.roads.push_back({static_cast<uint32_t>(i), j, distance});
                         }
-                        
-                        Road road(roadId++, 
-                                 cityJunctions[i].name + " to " + cityJunctions[j].name,
-                                 cityJunctions[i].id,
-                                 cityJunctions[j].id,
-                                 distance,
-                                 speedLimit);
-                        road.isTwoWay = true;
-                        
-                        trafficManager.addRoad(road);
-                        intraRoads++;
                     }
                 }
+            }
+        };
+        
+        size_t numThreads = std::max<size_t>(1, std::min<size_t>(
+            std::thread::hardware_concurrency(), jobs.size()));
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < numThreads; ++t) {
+            workers.emplace_back(joinWorker);
+        }
+        joinWorker();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        
+        uint64_t checkedPairs = 0;
+        for (const JoinJob& job : jobs) {
+            checkedPairs += job.checkedPairs;
+        }
+        
+        size_t jobIndex = 0;
+        for (auto& [city, cityJunctions] : citiesMap) {
+            std::cout << "   🏙️ Processing " << city << "...\n";
+            int cityRoads = 0;
+            
+            // Speed limit depends only on the first junction's area
+            std::vector<double> speedLimits(cityJunctions.size(), 40.0);
+            for (size_t i = 0; i < cityJunctions.size(); ++i) {
+                std::string areaLower = cityJunctions[i].area;
+                std::transform(areaLower.begin(), areaLower.end(), 
+                             areaLower.begin(), ::tolower);
                 
-                // Progress indicator
-                if (i % 100 == 0 && i > 0) {
-                    std::cout << "      Progress: " << i << "/" << cityJunctions.size() << "\n";
+                if (areaLower.find("highway") != std::string::npos ||
+                    areaLower.find("motorway") != std::string::npos) {
+                    speedLimits[i] = 100.0;
+                } else if (areaLower.find("main") != std::string::npos ||
+                         areaLower.find("road") != std::string::npos) {
+                    speedLimits[i] = 60.0;
+                }
+            }
+            
+            while (jobIndex < jobs.size() && jobs[jobIndex].junctions == &cityJunctions) {
+                for (const CandidateRoad& candidate : jobs[jobIndex].roads) {
+                    const Junction& from = cityJunctions[candidate.i];
+                    const Junction& to = cityJunctions[candidate.j];
+                    
+                    Road road(roadId++, 
+                             from.name + " to " + to.name,
+                             from.id,
+                             to.id,
+                             candidate.distance,
+                             speedLimits[candidate.i]);
+                    road.isTwoWay = true;
+                    
+                    trafficManager.addRoad(road);
+                    intraRoads++;
+                    cityRoads++;
                 }
+                std::vector<CandidateRoad>().swap(jobs[jobIndex].roads);
+                ++jobIndex;
             }
+            std::cout << "      Roads: " << cityRoads << "\n";
         }
         
-        std::cout << "   ✅ Intra-city roads: " << intraRoads << "\n\n";
+        std::cout << "   ✅ Intra-city roads: " << intraRoads << "\n";
+        std::cout << "   🔍 Spatial join: " << checkedPairs << " of " << allPairs
+                  << " candidate pairs checked, " << (allPairs - checkedPairs)
+                  << " pruned by the grid\n\n";
         
         // PHASE 2: INTER-CITY HIGHWAYS (between different cities)
         std::cout << "⏳ Phase 2: Generating inter-city highways...\n";
@@ -276,6 +327,9 @@ public:
             {"Faisalabad", "Multan"}
         };
         
+        uint64_t highwayPairs = 0;
+        uint64_t highwayChecked = 0;
+        
         for (const auto& [city1, city2] : cityPairs) {
             if (citiesMap.find(city1) == citiesMap.end() || 
                 citiesMap.find(city2) == citiesMap.end()) {
@@ -285,20 +339,12 @@ public:
             // Find closest junctions between cities
             const auto& junctions1 = citiesMap[city1];
             const auto& junctions2 = citiesMap[city2];
+            highwayPairs += static_cast<uint64_t>(junctions1.size()) * junctions2.size();
             
             double minDistance = 999999.0;
             size_t bestI = 0, bestJ = 0;
-            
-            for (size_t i = 0; i < junctions1.size(); ++i) {
-                for (size_t j = 0; j < junctions2.size(); ++j) {
-                    double dist = junctions1[i].distanceTo(junctions2[j]);
-                    if (dist < minDistance) {
-                        minDistance = dist;
-                        bestI = i;
-                        bestJ = j;
-                    }
-                }
-            }
+            highwayChecked += closestPair(junctions1, junctions2,
+                                          &minDistance, &bestI, &bestJ);
             
             // Create highway connection
             Road highway(roadId++,
@@ -306,7 +352,7 @@ public:
                         junctions1[bestI].id,
                         junctions2[bestJ].id,
                         minDistance,
-                        120.0);  // Highway speed
+                        MAX_ROAD_SPEED_KMH);  // Highway speed
             highway.isTwoWay = true;
             
             trafficManager.addRoad(highway);
@@ -316,6 +362,9 @@ public:
                       << " (" << minDistance << " km)\n";
         }
         
+        std::cout << "   🔍 Closest-pair search: " << highwayChecked << " of " << highwayPairs
+                  << " junction pairs checked, " << (highwayPairs - highwayChecked)
+                  << " pruned\n";
         std::cout << "\n   ✅ Inter-city highways: " << interRoads << "\n\n";
         
         std::cout << "╔════════════════════════════════════════╗\n";
@@ -324,7 +373,11 @@ public:
         std::cout << "   Total Roads: " << (intraRoads + interRoads) << "\n";
         std::cout << "   • Intra-city: " << intraRoads << "\n";
         std::cout << "   • Inter-city: " << interRoads << "\n";
-        std::cout << "   Graph Edges: " << ((intraRoads + interRoads) * 2) << "\n\n";
+        std::cout << "   Graph Edges: " << ((intraRoads + interRoads) * 2) << "\n";
+        
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        std::cout << "   ⏱️  Generation Time: " << duration.count() << " ms\n\n";
     }
     
     void printStats() {
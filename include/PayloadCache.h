@@ -0,0 +1,151 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Versioned Payload Cache Implementation
+ *
+ * Read-mostly responses (the full junction and road lists, metrics) are
+ * serialized and compressed once per data version instead of once per
+ * request. Each payload carries the version it was built from; a request
+ * that sees a newer version rebuilds it, everyone else shares the cached
+ * copy (identity, gzip and deflate bodies plus the ETag).
+ * Time Complexity: O(1) per hit, one serialization + compression per version
+ */
+
+#ifndef PAYLOADCACHE_H
+#define PAYLOADCACHE_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <cstdio>
+#include "HttpParser.h"
+#include "Deflate.h"
+
+// ==================== HTTP CACHING HELPERS ====================
+
+// Does an Accept-Encoding header allow coding (listed, or "*", without q=0)?
+inline bool acceptsEncoding(std::string_view header, std::string_view coding) {
+    while (!header.empty()) {
+        size_t comma = header.find(',');
+        std::string_view item = header.substr(0, comma);
+        header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view name = trimHttpWhitespace(item.substr(0, semicolon));
+        if (!equalsIgnoreCase(name, coding) && name != "*") continue;
+        if (semicolon == std::string_view::npos) return true;
+
+        std::string_view q = trimHttpWhitespace(item.substr(semicolon + 1));
+        if (q.size() < 2 || (q[0] != 'q' && q[0] != 'Q') || q[1] != '=') return true;
+        for (char c : q.substr(2)) {
+            if (c != '0' && c != '.') return true;   // any non-zero weight
+        }
+        return false;
+    }
+    return false;
+}
+
+// Does If-None-Match list etag ("*", or any entry under weak comparison)?
+inline bool etagMatches(std::string_view header, std::string_view etag) {
+    while (!header.empty()) {
+        size_t comma = header.find(',');
+        std::string_view tag = trimHttpWhitespace(header.substr(0, comma));
+        header = comma == std::string_view::npos ? std::string_view() : header.substr(comma + 1);
+
+        if (tag == "*") return true;
+        if (tag.size() > 2 && tag[0] == 'W' && tag[1] == '/') tag.remove_prefix(2);
+        if (tag == etag) return true;
+    }
+    return false;
+}
+
+// ==================== PAYLOAD CACHE ====================
+
+class PayloadCache {
+public:
+    static constexpr size_t MIN_COMPRESS_BYTES = 1024;   // smaller bodies go out as they are
+
+    struct Payload {
+        uint64_t version;
+        std::string tag;        // ETag value without quotes, e.g. junctions-65f2a1c0-7
+        std::string identity;
+        std::string gzip;       // empty below MIN_COMPRESS_BYTES
+        std::string deflate;
+    };
+    typedef std::shared_ptr<const Payload> Ptr;
+
+    struct Stats {
+        size_t entries;
+        uint64_t hits;
+        uint64_t builds;
+        uint64_t notModified;
+    };
+
+private:
+    struct Slot {
+        std::mutex mutex;   // held while (re)building, so one request builds for all
+        Ptr payload;
+    };
+
+    std::mutex slotsMutex;
+    std::map<std::string, std::unique_ptr<Slot>> slots;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> builds;
+    std::atomic<uint64_t> notModified;
+    std::string epoch;   // start time: tags from an earlier run never match
+
+    Slot& slotFor(const std::string& name) {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        std::unique_ptr<Slot>& slot = slots[name];
+        if (!slot) slot.reset(new Slot());
+        return *slot;
+    }
+
+public:
+    PayloadCache() : hits(0), builds(0), notModified(0) {
+        char buffer[20];
+        snprintf(buffer, sizeof(buffer), "%llx", static_cast<unsigned long long>(std::time(nullptr)));
+        epoch = buffer;
+    }
+
+    /**
+     * The payload called name for data at version. build() returns the
+     * identity body and runs only when the cached copy is older; read
+     * the version before the data, so a payload is never newer than its tag.
+     */
+    template <typename Build>
+    Ptr get(const std::string& name, uint64_t version, Build build) {
+        Slot& slot = slotFor(name);
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.payload && slot.payload->version >= version) {
+            hits++;
+            return slot.payload;
+        }
+
+        std::shared_ptr<Payload> payload = std::make_shared<Payload>();
+        payload->version = version;
+        payload->tag = name + "-" + epoch + "-" + std::to_string(version);
+        payload->identity = build();
+        if (payload->identity.size() >= MIN_COMPRESS_BYTES) {
+            std::string raw = deflateRaw(payload->identity);   // one LZ77 pass, two framings
+            payload->gzip = gzipWrap(raw, payload->identity);
+            payload->deflate = zlibWrap(raw, payload->identity);
+        }
+        slot.payload = payload;
+        builds++;
+        return slot.payload;
+    }
+
+    void noteNotModified() { notModified++; }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(slotsMutex);
+        return {slots.size(), hits, builds, notModified};
+    }
+};
+
+#endif // PAYLOADCACHE_H
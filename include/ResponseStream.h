@@ -0,0 +1,89 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Streaming Response Implementation
+ *
+ * Lets a handler send a large body while it is still being produced:
+ * the handler appends JSON to one reusable buffer, and every CHUNK_BYTES
+ * the buffer goes out as an HTTP/1.1 chunk (or raw, for HTTP/1.0
+ * clients, whose connection then ends the body). Peak memory is one
+ * chunk instead of the whole body, and the first bytes leave early.
+ */
+
+#ifndef RESPONSESTREAM_H
+#define RESPONSESTREAM_H
+
+#include <string>
+#include <cstdio>
+
+// Where a streamed response goes (a socket, or the event loop's output queue)
+class ResponseSink {
+public:
+    virtual ~ResponseSink() {}
+
+    // Send the next part of the response; may block while the client is
+    // far behind. false once the client is gone.
+    virtual bool write(std::string data) = 0;
+};
+
+class StreamingResponse {
+public:
+    static constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+private:
+    ResponseSink& sink;
+    std::string pending;    // unsent bytes: the head until the first flush, then body
+    size_t bodyStart;       // where body bytes begin in pending
+    bool chunked;
+    bool failed;
+
+    // Frame pending[bodyStart..] as a chunk and hand everything to the sink
+    std::string takePending() {
+        std::string data;
+        size_t bodyLength = pending.size() - bodyStart;
+        if (!chunked || bodyLength == 0) {
+            data.swap(pending);
+        } else {
+            char size[24];
+            int sizeLength = snprintf(size, sizeof(size), "%zx\r\n", bodyLength);
+            data.reserve(pending.size() + sizeLength + 2);
+            data.append(pending, 0, bodyStart);
+            data.append(size, sizeLength);
+            data.append(pending, bodyStart, std::string::npos);
+            data += "\r\n";
+        }
+        pending.clear();
+        pending.reserve(CHUNK_BYTES + CHUNK_BYTES / 4);
+        bodyStart = 0;
+        return data;
+    }
+
+public:
+    // head: status line and headers, ending with the blank line
+    StreamingResponse(ResponseSink& out, const std::string& head, bool useChunks)
+        : sink(out), pending(head), bodyStart(head.size()), chunked(useChunks), failed(false) {
+        pending.reserve(head.size() + CHUNK_BYTES + CHUNK_BYTES / 4);
+    }
+
+    // Body buffer to append to; call flushIfFull() after each record
+    std::string& body() { return pending; }
+
+    // Send a chunk once enough body is buffered; false once the client is gone
+    bool flushIfFull() {
+        if (failed) return false;
+        if (pending.size() - bodyStart >= CHUNK_BYTES && !sink.write(takePending())) {
+            failed = true;
+        }
+        return !failed;
+    }
+
+    // Everything not yet sent, including the terminating chunk
+    std::string finish() {
+        std::string rest = takePending();
+        if (chunked) rest += "0\r\n\r\n";
+        return rest;
+    }
+
+    bool clientGone() const { return failed; }
+};
+
+#endif // RESPONSESTREAM_H
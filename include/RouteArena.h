@@ -0,0 +1,138 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Route Arena Implementation
+ *
+ * Per-thread monotonic arena for the transient data of one route request
+ * (edge chains, candidate paths): allocation is a pointer bump in a
+ * retained block, nothing is freed individually, and the whole arena is
+ * reset when the outermost Scope ends. Requests that outgrow the block
+ * spill to the heap once, and the block then grows to that high-water
+ * mark (up to MAX_BLOCK_BYTES), so steady-state requests never touch the heap.
+ * Counters record every arena allocation and every heap spill.
+ */
+
+#ifndef ROUTEARENA_H
+#define ROUTEARENA_H
+
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+class RouteArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t INITIAL_BLOCK_BYTES = 64 * 1024;
+    static constexpr size_t MAX_BLOCK_BYTES = 4 * 1024 * 1024;
+
+    struct Stats {
+        uint64_t allocations;       // served by the arena
+        uint64_t bytes;
+        uint64_t heapAllocations;   // blocks the arena took from the heap
+    };
+
+    // Opens a request on the calling thread's arena; nested scopes share
+    // it and only the outermost one resets it
+    class Scope {
+    private:
+        RouteArena& arena;
+        Stats start;
+
+    public:
+        Scope() : arena(RouteArena::forThread()), start(arena.stats) {
+            arena.depth++;
+        }
+
+        ~Scope() {
+            if (--arena.depth == 0) arena.reset();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        std::pmr::memory_resource* resource() { return &arena; }
+
+        // Counts since this scope opened
+        Stats delta() const {
+            return Stats{arena.stats.allocations - start.allocations, arena.stats.bytes - start.bytes,
+                         arena.stats.heapAllocations - start.heapAllocations};
+        }
+    };
+
+    // Arena owned by the calling thread
+    static RouteArena& forThread() {
+        thread_local RouteArena arena;
+        return arena;
+    }
+
+    const Stats& getStats() const { return stats; }
+    size_t getBlockBytes() const { return blockBytes; }
+
+private:
+    // Heap behind the block; counts what the arena could not serve
+    class Upstream : public std::pmr::memory_resource {
+    public:
+        uint64_t allocations = 0;
+        size_t bytes = 0;   // since the last reset
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override {
+            allocations++;
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::unique_ptr<std::byte[]> block;
+    size_t blockBytes;
+    Upstream upstream;
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> pool;
+    Stats stats;
+    int depth;
+
+    RouteArena()
+        : block(new std::byte[INITIAL_BLOCK_BYTES]), blockBytes(INITIAL_BLOCK_BYTES),
+          stats{0, 0, 0}, depth(0) {
+        pool.reset(new std::pmr::monotonic_buffer_resource(block.get(), blockBytes, &upstream));
+    }
+
+    // Free everything; after a spill, retain a block big enough for it
+    void reset() {
+        pool->release();
+        if (upstream.bytes > 0 && blockBytes < MAX_BLOCK_BYTES) {
+            size_t wanted = std::min(MAX_BLOCK_BYTES, blockBytes + upstream.bytes);
+            pool.reset();
+            block.reset(new std::byte[wanted]);
+            blockBytes = wanted;
+            pool.reset(new std::pmr::monotonic_buffer_resource(block.get(), blockBytes, &upstream));
+        }
+        stats.heapAllocations = upstream.allocations;
+        upstream.bytes = 0;
+    }
+
+    void* do_allocate(size_t size, size_t alignment) override {
+        stats.allocations++;
+        stats.bytes += size;
+        void* p = pool->allocate(size, alignment);
+        stats.heapAllocations = upstream.allocations;
+        return p;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {
+        // Monotonic: reclaimed when the outermost Scope ends
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+#endif // ROUTEARENA_H
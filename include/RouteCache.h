@@ -0,0 +1,201 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Sharded Route Cache Implementation
+ *
+ * Concurrent LRU cache for computed routes. Keys pack (source, dest,
+ * alternatives, metric, algorithm) into one 64-bit integer; the key's
+ * hash picks one of NUM_SHARDS independently locked LRU lists, so
+ * lookups for different routes rarely contend. Every entry records the road segments its path
+ * uses, indexed per shard, so a traffic update evicts only the routes
+ * through the changed road instead of the whole cache.
+ * Time Complexity: O(1) get, O(path length) put and eviction
+ */
+
+#ifndef ROUTECACHE_H
+#define ROUTECACHE_H
+
+#include <list>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <cstdint>
+#include "Models.h"
+#include "Graph.h"
+
+class RouteCache {
+public:
+    static constexpr size_t NUM_SHARDS = 8;
+
+    struct ShardStats {
+        size_t entries;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;       // dropped for capacity
+        uint64_t invalidations;   // dropped by a road network change
+    };
+
+    static constexpr int MAX_ALTERNATIVES = 15;
+
+    // (source, dest, alternatives, useTime, algorithm) -> key, as
+    // 28 | 28 | 4 | 1 | 3 bits; false if an ID needs more than 28 bits
+    static bool makeKey(int source, int dest, bool useTime, RouteAlgorithm algorithm,
+                        int alternatives, uint64_t* key) {
+        const uint32_t limit = 1u << 28;
+        if (source < 0 || dest < 0 || static_cast<uint32_t>(source) >= limit ||
+            static_cast<uint32_t>(dest) >= limit || alternatives < 0 || alternatives > MAX_ALTERNATIVES) {
+            return false;
+        }
+        *key = (static_cast<uint64_t>(source) << 36) | (static_cast<uint64_t>(dest) << 8) |
+               (static_cast<uint64_t>(alternatives) << 4) | (static_cast<uint64_t>(useTime) << 3) |
+               static_cast<uint64_t>(algorithm);
+        return true;
+    }
+
+    static bool keyUsesTime(uint64_t key) { return (key >> 3) & 1; }
+
+    // Directed road segment between two junctions
+    static uint64_t segmentId(int from, int to) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) | static_cast<uint32_t>(to);
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        RouteResult route;
+        std::vector<uint64_t> segments;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> entries;   // front = most recent
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> byKey;
+        std::unordered_map<uint64_t, std::unordered_set<uint64_t>> bySegment;   // segment -> keys
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+
+        void erase(std::list<Entry>::iterator it) {
+            for (uint64_t segment : it->segments) {
+                auto users = bySegment.find(segment);
+                if (users == bySegment.end()) continue;
+                users->second.erase(it->key);
+                if (users->second.empty()) bySegment.erase(users);
+            }
+            byKey.erase(it->key);
+            entries.erase(it);
+        }
+    };
+
+    Shard shards[NUM_SHARDS];
+    size_t shardCapacity;
+
+    static size_t shardOf(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return static_cast<size_t>(key % NUM_SHARDS);
+    }
+
+public:
+    explicit RouteCache(size_t capacity = 100)
+        : shardCapacity(std::max<size_t>(1, (capacity + NUM_SHARDS - 1) / NUM_SHARDS)) {}
+
+    bool get(uint64_t key, RouteResult* result) {
+        Shard& shard = shards[shardOf(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.byKey.find(key);
+        if (it == shard.byKey.end()) {
+            shard.misses++;
+            return false;
+        }
+        shard.hits++;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        if (result) *result = it->second->route;
+        return true;
+    }
+
+    // segments: segmentId() of every hop on the route's path (and its alternatives')
+    void put(uint64_t key, const RouteResult& route, std::vector<uint64_t> segments) {
+        Shard& shard = shards[shardOf(key)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto existing = shard.byKey.find(key);
+        if (existing != shard.byKey.end()) shard.erase(existing->second);
+
+        while (shard.entries.size() >= shardCapacity) {
+            shard.erase(std::prev(shard.entries.end()));
+            shard.evictions++;
+        }
+
+        shard.entries.push_front(Entry{key, route, std::move(segments)});
+        auto it = shard.entries.begin();
+        shard.byKey[key] = it;
+        for (uint64_t segment : it->segments) shard.bySegment[segment].insert(key);
+    }
+
+    // Drop routes through any of segments; with alsoTimeRoutes, every
+    // time-optimized route too (a faster road can shorten routes elsewhere)
+    size_t invalidate(const std::vector<uint64_t>& segments, bool alsoTimeRoutes) {
+        size_t dropped = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            std::vector<uint64_t> keys;
+            for (uint64_t segment : segments) {
+                auto users = shard.bySegment.find(segment);
+                if (users != shard.bySegment.end()) keys.insert(keys.end(), users->second.begin(), users->second.end());
+            }
+            if (alsoTimeRoutes) {
+                for (const Entry& entry : shard.entries) {
+                    if (keyUsesTime(entry.key)) keys.push_back(entry.key);
+                }
+            }
+            for (uint64_t key : keys) {
+                auto it = shard.byKey.find(key);
+                if (it == shard.byKey.end()) continue;   // listed twice
+                shard.erase(it->second);
+                shard.invalidations++;
+                dropped++;
+            }
+        }
+        return dropped;
+    }
+
+    // Drop every route (the network itself changed); statistics are kept
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.invalidations += shard.entries.size();
+            shard.entries.clear();
+            shard.byKey.clear();
+            shard.bySegment.clear();
+        }
+    }
+
+    std::vector<ShardStats> getShardStats() const {
+        std::vector<ShardStats> result;
+        result.reserve(NUM_SHARDS);
+        for (const Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            result.push_back({shard.entries.size(), shard.hits, shard.misses,
+                              shard.evictions, shard.invalidations});
+        }
+        return result;
+    }
+
+    double getHitRate() const {
+        uint64_t hits = 0, misses = 0;
+        for (const ShardStats& stats : getShardStats()) {
+            hits += stats.hits;
+            misses += stats.misses;
+        }
+        uint64_t total = hits + misses;
+        return total > 0 ? static_cast<double>(hits) / total * 100.0 : 0.0;
+    }
+
+    size_t getCapacity() const { return shardCapacity * NUM_SHARDS; }
+};
+
+#endif // ROUTECACHE_H
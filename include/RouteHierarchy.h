@@ -0,0 +1,408 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Route Hierarchy (CH-lite) Implementation
+ *
+ * Two-level hierarchy for long-distance queries on the frozen graph.
+ * Junctions are grouped into cells (cities) and the endpoints of every
+ * road that crosses between cells (the inter-city highways) become
+ * portals, the top level of the hierarchy. Any path between two cells
+ * leaves the source cell through one of its portals and enters the target
+ * cell through one of its portals, so with exact shortest path trees
+ * rooted at every portal:
+ *
+ *   dist(s, t) = min over p in P(cell s), q in P(cell t) of
+ *                dist(s, p) + dist(p, q) + dist(q, t)
+ *
+ * Preprocessing: one forward and one backward Dijkstra per portal.
+ * Query: |P(s)| x |P(t)| lookups, then the path is unpacked from the
+ * stored trees. Queries inside one cell are left to the regular searches.
+ *
+ * Customization: the portal set (the hierarchy "order") is fixed once
+ * built. When one edge weight changes, only the trees that depend on it
+ * are repaired: a cheaper edge is propagated from its head, and a dearer
+ * tree edge re-settles just the subtree hanging below it.
+ *
+ * Network is the frozen CSRGraph (templated to keep this header standalone).
+ */
+
+#ifndef ROUTEHIERARCHY_H
+#define ROUTEHIERARCHY_H
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include "MinHeap.h"
+
+class RouteHierarchy {
+public:
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t MAX_PORTALS = 64;
+
+private:
+    // Shortest path tree rooted at one portal
+    struct Tree {
+        std::vector<double> costs;        // cost between root and vertex
+        std::vector<uint32_t> parentEdges; // forward: edge into v; backward: edge out of v
+    };
+
+    std::vector<int> cells;                      // dense vertex -> cell ID
+    std::vector<int> portals;                    // dense vertex of each portal
+    std::vector<std::vector<int>> cellPortals;   // cell ID -> indices into portals
+    std::vector<Tree> forwardTrees;              // dist(portal, v)
+    std::vector<Tree> backwardTrees;             // dist(v, portal)
+    bool useTime;
+    bool ready;
+
+    // Customization scratch space and counters
+    IndexedMinHeap<double> repairHeap;
+    std::vector<bool> inSubtree;
+    std::vector<int> subtree;
+    size_t customizations;        // edge updates applied
+    size_t repairedVertices;      // vertices whose tree cost was recomputed
+
+    // Continue Dijkstra from whatever is queued in repairHeap
+    template <typename Network>
+    void propagate(const Network& graph, Tree* tree, bool reverse) {
+        while (!repairHeap.empty()) {
+            int current = repairHeap.extractMin();
+            double currentCost = tree->costs[current];
+            repairedVertices++;
+
+            if (!reverse) {
+                for (uint32_t e = graph.edgeBegin(current); e < graph.edgeEnd(current); ++e) {
+                    int neighbor = graph.target(e);
+                    double newCost = currentCost + graph.cost(e, useTime);
+                    if (newCost < tree->costs[neighbor]) {
+                        tree->costs[neighbor] = newCost;
+                        tree->parentEdges[neighbor] = e;
+                        repairHeap.push(neighbor, newCost);
+                    }
+                }
+            } else {
+                for (uint32_t r = graph.reverseBegin(current); r < graph.reverseEnd(current); ++r) {
+                    uint32_t e = graph.reverseEdge(r);
+                    int neighbor = graph.reverseSource(r);
+                    double newCost = currentCost + graph.cost(e, useTime);
+                    if (newCost < tree->costs[neighbor]) {
+                        tree->costs[neighbor] = newCost;
+                        tree->parentEdges[neighbor] = e;
+                        repairHeap.push(neighbor, newCost);
+                    }
+                }
+            }
+        }
+    }
+
+    // Repair one tree after edge e (tail -> head) changed from oldCost
+    template <typename Network>
+    void repairTree(const Network& graph, Tree* tree, bool reverse,
+                    uint32_t e, double oldCost) {
+        const double INF = std::numeric_limits<double>::infinity();
+        int tail = graph.edgeSource(e);
+        int head = graph.target(e);
+        // In a backward tree the edge is walked head -> tail
+        int from = reverse ? head : tail;
+        int to = reverse ? tail : head;
+        double newCost = graph.cost(e, useTime);
+
+        if (newCost < oldCost) {
+            // Cheaper: only improvements can spread from 'to'
+            double candidate = tree->costs[from] + newCost;
+            if (candidate < tree->costs[to]) {
+                tree->costs[to] = candidate;
+                tree->parentEdges[to] = e;
+                repairHeap.push(to, candidate);
+                propagate(graph, tree, reverse);
+            }
+            return;
+        }
+
+        // Dearer: nothing changes unless e is in the tree
+        if (tree->parentEdges[to] != e) return;
+
+        // Collect the subtree below 'to' (children found via parent edges)
+        subtree.clear();
+        subtree.push_back(to);
+        inSubtree[to] = true;
+        for (size_t i = 0; i < subtree.size(); ++i) {
+            int v = subtree[i];
+            if (!reverse) {
+                for (uint32_t c = graph.edgeBegin(v); c < graph.edgeEnd(v); ++c) {
+                    int child = graph.target(c);
+                    if (tree->parentEdges[child] == c && !inSubtree[child]) {
+                        inSubtree[child] = true;
+                        subtree.push_back(child);
+                    }
+                }
+            } else {
+                for (uint32_t r = graph.reverseBegin(v); r < graph.reverseEnd(v); ++r) {
+                    int child = graph.reverseSource(r);
+                    if (tree->parentEdges[child] == graph.reverseEdge(r) && !inSubtree[child]) {
+                        inSubtree[child] = true;
+                        subtree.push_back(child);
+                    }
+                }
+            }
+        }
+
+        for (int v : subtree) {
+            tree->costs[v] = INF;
+            tree->parentEdges[v] = NO_EDGE;
+        }
+
+        // Seed each subtree vertex from its best neighbour outside the subtree
+        for (int v : subtree) {
+            if (!reverse) {
+                for (uint32_t r = graph.reverseBegin(v); r < graph.reverseEnd(v); ++r) {
+                    int u = graph.reverseSource(r);
+                    if (inSubtree[u] || tree->costs[u] == INF) continue;
+                    uint32_t in = graph.reverseEdge(r);
+                    double candidate = tree->costs[u] + graph.cost(in, useTime);
+                    if (candidate < tree->costs[v]) {
+                        tree->costs[v] = candidate;
+                        tree->parentEdges[v] = in;
+                    }
+                }
+            } else {
+                for (uint32_t out = graph.edgeBegin(v); out < graph.edgeEnd(v); ++out) {
+                    int u = graph.target(out);
+                    if (inSubtree[u] || tree->costs[u] == INF) continue;
+                    double candidate = tree->costs[u] + graph.cost(out, useTime);
+                    if (candidate < tree->costs[v]) {
+                        tree->costs[v] = candidate;
+                        tree->parentEdges[v] = out;
+                    }
+                }
+            }
+            if (tree->costs[v] < INF) repairHeap.push(v, tree->costs[v]);
+        }
+
+        for (int v : subtree) inSubtree[v] = false;
+        propagate(graph, tree, reverse);
+    }
+
+    template <typename Network>
+    static void growTree(const Network& graph, int root, bool useTime, bool reverse, Tree* tree) {
+        const double INF = std::numeric_limits<double>::infinity();
+        size_t n = static_cast<size_t>(graph.numVertices());
+        tree->costs.assign(n, INF);
+        tree->parentEdges.assign(n, NO_EDGE);
+
+        IndexedMinHeap<double> heap(n);
+        tree->costs[root] = 0;
+        heap.push(root, 0);
+
+        while (!heap.empty()) {
+            int current = heap.extractMin();
+            double currentCost = tree->costs[current];
+
+            if (!reverse) {
+                for (uint32_t e = graph.edgeBegin(current); e < graph.edgeEnd(current); ++e) {
+                    int neighbor = graph.target(e);
+                    double newCost = currentCost + graph.cost(e, useTime);
+                    if (newCost < tree->costs[neighbor]) {
+                        tree->costs[neighbor] = newCost;
+                        tree->parentEdges[neighbor] = e;
+                        heap.push(neighbor, newCost);
+                    }
+                }
+            } else {
+                for (uint32_t r = graph.reverseBegin(current); r < graph.reverseEnd(current); ++r) {
+                    uint32_t e = graph.reverseEdge(r);
+                    int neighbor = graph.reverseSource(r);
+                    double newCost = currentCost + graph.cost(e, useTime);
+                    if (newCost < tree->costs[neighbor]) {
+                        tree->costs[neighbor] = newCost;
+                        tree->parentEdges[neighbor] = e;
+                        heap.push(neighbor, newCost);
+                    }
+                }
+            }
+        }
+    }
+
+public:
+    RouteHierarchy() : useTime(false), ready(false),
+                       customizations(0), repairedVertices(0) {}
+
+    /**
+     * Build the hierarchy for one metric
+     * @param vertexCells cell ID per dense vertex (-1 = unknown)
+     * @return false if there are no portals or more than MAX_PORTALS
+     */
+    template <typename Network>
+    bool build(const Network& graph, const std::vector<int>& vertexCells, bool timeMetric) {
+        clear();
+        useTime = timeMetric;
+        cells = vertexCells;
+
+        std::vector<bool> isPortal(cells.size(), false);
+        int maxCell = -1;
+        for (int u = 0; u < graph.numVertices(); ++u) {
+            maxCell = std::max(maxCell, cells[u]);
+            for (uint32_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); ++e) {
+                int v = graph.target(e);
+                if (cells[u] != cells[v]) {
+                    isPortal[u] = true;
+                    isPortal[v] = true;
+                }
+            }
+        }
+
+        cellPortals.assign(maxCell + 1, std::vector<int>());
+        for (size_t v = 0; v < isPortal.size(); ++v) {
+            if (!isPortal[v]) continue;
+            if (cells[v] >= 0) {
+                cellPortals[cells[v]].push_back(static_cast<int>(portals.size()));
+            }
+            portals.push_back(static_cast<int>(v));
+        }
+
+        if (portals.empty() || portals.size() > MAX_PORTALS) {
+            clear();
+            return false;
+        }
+
+        // Trees are independent: grow them on all cores
+        forwardTrees.resize(portals.size());
+        backwardTrees.resize(portals.size());
+        std::atomic<size_t> nextJob(0);
+        size_t jobs = portals.size() * 2;
+        auto worker = [&]() {
+            size_t job;
+            while ((job = nextJob++) < jobs) {
+                size_t p = job / 2;
+                bool reverse = (job % 2) == 1;
+                growTree(graph, portals[p], useTime, reverse,
+                         reverse ? &backwardTrees[p] : &forwardTrees[p]);
+            }
+        };
+
+        size_t numThreads = std::max<size_t>(1, std::min<size_t>(
+            std::thread::hardware_concurrency(), jobs));
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < numThreads; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        repairHeap.reserve(cells.size());
+        inSubtree.assign(cells.size(), false);
+        ready = true;
+        return true;
+    }
+
+    /**
+     * Re-customize after the weight of edge e changed (weight already updated
+     * in the graph). Cost is proportional to the part of each tree that
+     * actually changes, not to the size of the network.
+     */
+    template <typename Network>
+    void updateEdge(const Network& graph, uint32_t e, double oldCost) {
+        if (!ready || graph.cost(e, useTime) == oldCost) return;
+        for (Tree& tree : forwardTrees) {
+            repairTree(graph, &tree, false, e, oldCost);
+        }
+        for (Tree& tree : backwardTrees) {
+            repairTree(graph, &tree, true, e, oldCost);
+        }
+        customizations++;
+    }
+
+    /**
+     * Answer s -> t (dense indices) through the portals
+     * @return false if the hierarchy cannot answer (same cell, unknown cell);
+     *         true with found == false if t is unreachable from s
+     */
+    template <typename Network, typename EdgeList>
+    bool query(const Network& graph, int s, int t, EdgeList* edges, bool* found) const {
+        if (!ready || static_cast<size_t>(s) >= cells.size() ||
+            static_cast<size_t>(t) >= cells.size()) {
+            return false;
+        }
+        int cs = cells[s], ct = cells[t];
+        if (cs < 0 || ct < 0 || cs == ct) return false;
+
+        const double INF = std::numeric_limits<double>::infinity();
+        double best = INF;
+        int bestP = -1, bestQ = -1;
+        for (int p : cellPortals[cs]) {
+            double toPortal = backwardTrees[p].costs[s];
+            if (toPortal == INF) continue;
+            for (int q : cellPortals[ct]) {
+                double total = toPortal + forwardTrees[p].costs[portals[q]] +
+                               forwardTrees[q].costs[t];
+                if (total < best) {
+                    best = total;
+                    bestP = p;
+                    bestQ = q;
+                }
+            }
+        }
+
+        edges->clear();
+        *found = (bestP >= 0);
+        if (!*found) return true;
+
+        // s -> p: follow the backward tree of p
+        int pv = portals[bestP], qv = portals[bestQ];
+        for (int v = s; v != pv; v = graph.target(backwardTrees[bestP].parentEdges[v])) {
+            edges->push_back(backwardTrees[bestP].parentEdges[v]);
+        }
+
+        // p -> q and q -> t: walk the forward trees back from their ends
+        size_t mark = edges->size();
+        for (int v = qv; v != pv; v = graph.edgeSource(forwardTrees[bestP].parentEdges[v])) {
+            edges->push_back(forwardTrees[bestP].parentEdges[v]);
+        }
+        std::reverse(edges->begin() + mark, edges->end());
+
+        mark = edges->size();
+        for (int v = t; v != qv; v = graph.edgeSource(forwardTrees[bestQ].parentEdges[v])) {
+            edges->push_back(forwardTrees[bestQ].parentEdges[v]);
+        }
+        std::reverse(edges->begin() + mark, edges->end());
+        return true;
+    }
+
+    bool isReady() const { return ready; }
+    bool isTimeMetric() const { return useTime; }
+    size_t getNumPortals() const { return portals.size(); }
+    size_t getCustomizations() const { return customizations; }
+    size_t getRepairedVertices() const { return repairedVertices; }
+
+    size_t memoryUsageBytes() const {
+        size_t bytes = cells.capacity() * sizeof(int) + portals.capacity() * sizeof(int);
+        for (const Tree& tree : forwardTrees) {
+            bytes += tree.costs.capacity() * sizeof(double) +
+                     tree.parentEdges.capacity() * sizeof(uint32_t);
+        }
+        for (const Tree& tree : backwardTrees) {
+            bytes += tree.costs.capacity() * sizeof(double) +
+                     tree.parentEdges.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+    void clear() {
+        cells.clear();
+        portals.clear();
+        cellPortals.clear();
+        forwardTrees.clear();
+        backwardTrees.clear();
+        repairHeap.clear();
+        inSubtree.clear();
+        subtree.clear();
+        customizations = 0;
+        repairedVertices = 0;
+        ready = false;
+    }
+};
+
+#endif // ROUTEHIERARCHY_H
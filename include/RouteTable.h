@@ -0,0 +1,108 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Route Table (Perfect Hash) Implementation
+ *
+ * Maps request paths to handlers. Exact paths are placed by a seeded
+ * FNV-1a hash into a power-of-two slot array; build() searches for a seed
+ * under which no two paths share a slot, so a lookup is one hash, one
+ * slot and one string compare. Prefix routes (e.g. "/api/junction/")
+ * are few and checked in order when no exact path matches.
+ * Time Complexity: O(|path|) lookup, independent of the number of routes
+ */
+
+#ifndef ROUTETABLE_H
+#define ROUTETABLE_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <cstdint>
+
+template <typename Handler>
+class RouteTable {
+private:
+    struct Slot {
+        std::string path;
+        Handler handler;
+        bool used;
+    };
+
+    std::vector<std::pair<std::string, Handler>> exactRoutes;
+    std::vector<std::pair<std::string, Handler>> prefixRoutes;
+    std::vector<Slot> slots;
+    uint64_t seed;
+    size_t mask;
+
+    static uint64_t hash(std::string_view key, uint64_t seed) {
+        uint64_t h = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+        for (char c : key) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    bool tryPlace(size_t size, uint64_t candidateSeed) {
+        std::vector<Slot> placed(size);
+        for (const auto& route : exactRoutes) {
+            Slot& slot = placed[hash(route.first, candidateSeed) & (size - 1)];
+            if (slot.used) return false;
+            slot.path = route.first;
+            slot.handler = route.second;
+            slot.used = true;
+        }
+        slots.swap(placed);
+        seed = candidateSeed;
+        mask = size - 1;
+        return true;
+    }
+
+public:
+    RouteTable() : seed(0), mask(0) {}
+
+    // Register an exact path (a later add of the same path wins)
+    void add(const std::string& path, Handler handler) {
+        for (auto& route : exactRoutes) {
+            if (route.first == path) {
+                route.second = handler;
+                return;
+            }
+        }
+        exactRoutes.push_back({path, handler});
+    }
+
+    // Register a handler for every path starting with prefix
+    void addPrefix(const std::string& prefix, Handler handler) {
+        prefixRoutes.push_back({prefix, handler});
+    }
+
+    // Find a collision-free seed; call once after all add()s
+    void build() {
+        size_t size = 1;
+        while (size < 2 * exactRoutes.size()) size <<= 1;
+        while (true) {
+            for (uint64_t candidate = 1; candidate <= 256; ++candidate) {
+                if (tryPlace(size, candidate)) return;
+            }
+            size <<= 1;   // too crowded: give the search more room
+        }
+    }
+
+    // Handler for path, or nullptr
+    const Handler* find(std::string_view path) const {
+        if (!slots.empty()) {
+            const Slot& slot = slots[hash(path, seed) & mask];
+            if (slot.used && slot.path == path) return &slot.handler;
+        }
+        for (const auto& route : prefixRoutes) {
+            if (path.compare(0, route.first.size(), route.first) == 0) return &route.second;
+        }
+        return nullptr;
+    }
+
+    size_t size() const { return exactRoutes.size() + prefixRoutes.size(); }
+    size_t getNumSlots() const { return slots.size(); }
+};
+
+#endif // ROUTETABLE_H
@@ -0,0 +1,82 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Route Search Workspace
+ *
+ * Reusable per-thread state for shortest path searches on the frozen graph:
+ * flat arrays indexed by dense vertex ID plus an indexed decrease-key heap.
+ * Entries are validated by a generation stamp, so starting a new query is
+ * O(1) and never clears or reallocates the arrays.
+ * Query cost depends on the vertices the search touches, not on V.
+ */
+
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include "MinHeap.h"
+
+class SearchWorkspace {
+private:
+    std::vector<uint32_t> stamps;       // generation that last wrote each slot
+    std::vector<double> costs;
+    std::vector<int64_t> previousEdges; // CSR edge used to reach the vertex, -1 for none
+    uint32_t generation;
+
+public:
+    IndexedMinHeap<double> heap;
+
+    SearchWorkspace() : generation(0) {}
+
+    // Workspace owned by the calling thread
+    static SearchWorkspace& forThread() {
+        thread_local SearchWorkspace workspace;
+        return workspace;
+    }
+
+    // Second workspace for the reverse half of bidirectional search
+    static SearchWorkspace& backwardForThread() {
+        thread_local SearchWorkspace workspace;
+        return workspace;
+    }
+
+    // Start a new query over a graph with numVertices vertices - O(1) amortized
+    void begin(int numVertices) {
+        size_t n = static_cast<size_t>(numVertices);
+        if (stamps.size() < n) {
+            stamps.resize(n, 0);
+            costs.resize(n);
+            previousEdges.resize(n);
+            heap.reserve(n);
+        }
+
+        heap.clear();
+        if (++generation == 0) {
+            // Stamp counter wrapped around: invalidate everything once
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    bool isReached(int v) const { return stamps[v] == generation; }
+
+    double getCost(int v) const {
+        return isReached(v) ? costs[v] : std::numeric_limits<double>::infinity();
+    }
+
+    int64_t getPreviousEdge(int v) const {
+        return isReached(v) ? previousEdges[v] : -1;
+    }
+
+    void setCost(int v, double cost, int64_t previousEdge) {
+        stamps[v] = generation;
+        costs[v] = cost;
+        previousEdges[v] = previousEdge;
+    }
+
+    size_t capacity() const { return stamps.size(); }
+};
+
+#endif // SEARCHWORKSPACE_H
@@ -0,0 +1,427 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Binary Network Snapshot Implementation
+ *
+ * The loaded road network (junctions, roads, strings, CSR edges and
+ * profiles) written as one versioned binary file, so later starts map it
+ * instead of parsing JSON and regenerating roads. The file is a header,
+ * a section table and 8-byte aligned sections of fixed-size records:
+ *
+ *   SnapshotHeader | SnapshotSection[sectionCount] | section data ...
+ *
+ * Sections are plain arrays in host byte order and are read straight out
+ * of the mapping. The header records the size and modification time of
+ * the source JSON and the road generation radius; a snapshot that does
+ * not match them, or comes from another format version or byte order, is
+ * rejected and the caller falls back to a full load. Every section also
+ * carries a checksum, so a damaged file is rejected rather than routed on.
+ * Time Complexity: O(file size) write and open (checksums), memcpy-speed reads
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Section tags; a new or changed section needs a new SNAPSHOT_VERSION
+enum SnapshotTag : uint32_t {
+    SNAP_STRINGS = 1,            // char blob shared by all string references
+    SNAP_STRING_OFFSETS,         // uint32 per string + 1
+    SNAP_JUNCTIONS,              // SnapshotJunction per junction (hash table order)
+    SNAP_CONNECTION_OFFSETS,     // uint32 per junction + 1, into SNAP_CONNECTIONS
+    SNAP_CONNECTIONS,            // int32 connected junction IDs
+    SNAP_NAME_INDEX,             // SnapshotNameEntry per junction name
+    SNAP_CITY_OFFSETS,           // uint32 per city + 1, into SNAP_CITY_MEMBERS
+    SNAP_CITY_NAMES,             // string ID per city
+    SNAP_CITY_MEMBERS,           // int32 junction IDs in city insertion order
+    SNAP_ROADS,                  // SnapshotRoad per road (hash table order)
+    SNAP_GRAPH_VERTICES,         // int32 junction ID per dense vertex
+    SNAP_GRAPH_OFFSETS,          // uint32 per vertex + 1
+    SNAP_GRAPH_TARGETS,          // int32 dense target per edge
+    SNAP_GRAPH_DISTANCES,        // double per edge
+    SNAP_GRAPH_BASE_TIMES,       // double per edge
+    SNAP_GRAPH_MULTIPLIERS,      // double per edge
+    SNAP_GRAPH_NAME_IDS,         // uint32 per edge, into SNAP_GRAPH_ROAD_NAMES
+    SNAP_GRAPH_PROFILE_IDS,      // uint16 per edge
+    SNAP_GRAPH_ROAD_NAMES,       // char blob of the graph's road name table
+    SNAP_GRAPH_ROAD_NAME_OFFSETS,
+    SNAP_GRAPH_REVERSE_OFFSETS,  // uint32 per vertex + 1
+    SNAP_GRAPH_REVERSE_EDGES,    // uint32 forward edge per incoming slot
+    SNAP_GRAPH_REVERSE_SOURCES,  // int32 dense source per incoming slot
+    SNAP_GRAPH_LOCATIONS,        // GeoPoint per vertex
+    SNAP_GRAPH_LOCATED,          // uint8 per vertex
+    SNAP_GRAPH_BOUNDS,           // double[3]: distance/km, time/km, min multiplier
+    SNAP_PROFILE_SLOTS,          // uint8 per profile slot
+};
+
+const uint32_t SNAPSHOT_VERSION = 1;
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// What a snapshot was built from; all fields must match to use it
+struct SnapshotSource {
+    uint64_t fileSize;
+    int64_t modifiedTime;     // seconds since the epoch
+    double buildParameter;    // road generation radius (km)
+
+    SnapshotSource() : fileSize(0), modifiedTime(0), buildParameter(0) {}
+
+    // Describe the source file at path; false if it does not exist
+    static bool describe(const std::string& path, double buildParameter, SnapshotSource* source) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return false;
+        source->fileSize = static_cast<uint64_t>(info.st_size);
+        source->modifiedTime = static_cast<int64_t>(info.st_mtime);
+        source->buildParameter = buildParameter;
+        return true;
+    }
+
+    bool operator==(const SnapshotSource& other) const {
+        return fileSize == other.fileSize && modifiedTime == other.modifiedTime &&
+               buildParameter == other.buildParameter;
+    }
+};
+
+struct SnapshotHeader {
+    char magic[8];            // "STROSNAP"
+    uint32_t version;
+    uint32_t byteOrder;       // SNAPSHOT_BYTE_ORDER as written
+    uint32_t sectionCount;
+    uint32_t reserved;
+    uint64_t fileSize;        // total snapshot size, catches truncated files
+    SnapshotSource source;
+};
+
+struct SnapshotSection {
+    uint32_t tag;
+    uint32_t elementSize;     // sizeof one record, checked on read
+    uint64_t offset;          // from the start of the file, 8-byte aligned
+    uint64_t size;            // bytes
+    uint64_t checksum;        // snapshotChecksum() of the bytes
+};
+
+// Fixed-size records; strings are IDs into SNAP_STRINGS
+struct SnapshotJunction {
+    int32_t id;
+    uint32_t name;
+    uint32_t city;
+    uint32_t area;
+    double latitude;
+    double longitude;
+    uint8_t hasTrafficSignal;
+    uint8_t geocoded;         // was padding, so older snapshots read as 0
+    uint8_t padding[6];
+};
+
+struct SnapshotRoad {
+    int32_t id;
+    uint32_t name;
+    uint32_t roadType;
+    int32_t sourceJunction;
+    int32_t destJunction;
+    int32_t trafficLevel;
+    double distance;
+    double speedLimit;
+    double baseTime;
+    uint8_t isTwoWay;
+    uint8_t padding[7];
+};
+
+struct SnapshotNameEntry {
+    uint32_t name;
+    int32_t junctionId;
+};
+
+// Fast 64-bit checksum (four multiply-xorshift lanes, ~10 GB/s) - not cryptographic
+inline uint64_t snapshotChecksum(const char* data, size_t size) {
+    const uint64_t K = 0xff51afd7ed558ccdULL;
+    uint64_t lanes[4] = {0x9e3779b97f4a7c15ULL ^ size, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            memcpy(&word, data + i + 8 * lane, 8);
+            lanes[lane] = (lanes[lane] ^ word) * K;
+            lanes[lane] ^= lanes[lane] >> 31;
+        }
+    }
+    uint64_t h = lanes[0] ^ (lanes[1] * 3) ^ (lanes[2] * 5) ^ (lanes[3] * 7);
+    for (; i < size; ++i) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * K;
+    }
+    h ^= h >> 33;
+    return h * K;
+}
+
+// ==================== MAPPED FILE ====================
+
+// Read-only memory mapping of a whole file (RAII)
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+
+public:
+#ifdef _WIN32
+    MappedFile() : bytes(nullptr), length(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {}
+#else
+    MappedFile() : bytes(nullptr), length(0), fd(-1) {}
+#endif
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            close();
+            return false;
+        }
+        bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!bytes) {
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close();
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close();
+            return false;
+        }
+        bytes = static_cast<const char*>(mapped);
+        length = static_cast<size_t>(info.st_size);
+        madvise(mapped, length, MADV_WILLNEED);   // the whole file is read once, in order
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping != NULL) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const { return bytes != nullptr; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+// ==================== SNAPSHOT WRITER ====================
+
+class SnapshotWriter {
+private:
+    struct Pending {
+        uint32_t tag;
+        uint32_t elementSize;
+        std::string bytes;
+    };
+    std::vector<Pending> sections;
+
+public:
+    void addBytes(SnapshotTag tag, const void* data, size_t size, uint32_t elementSize = 1) {
+        Pending section;
+        section.tag = tag;
+        section.elementSize = elementSize;
+        section.bytes.assign(static_cast<const char*>(data), size);
+        sections.push_back(std::move(section));
+    }
+
+    template <typename T>
+    void addArray(SnapshotTag tag, const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot records are copied bytewise");
+        addBytes(tag, values.data(), values.size() * sizeof(T), sizeof(T));
+    }
+
+    size_t getNumSections() const { return sections.size(); }
+
+    /**
+     * Write the snapshot to path. The file is written next to it and
+     * renamed into place, so a reader never maps a half-written snapshot.
+     * @return bytes written, 0 on failure
+     */
+    size_t writeFile(const std::string& path, const SnapshotSource& source) const {
+        auto align = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+
+        std::vector<SnapshotSection> table(sections.size());
+        uint64_t offset = align(sizeof(SnapshotHeader) + table.size() * sizeof(SnapshotSection));
+        for (size_t i = 0; i < sections.size(); ++i) {
+            table[i].tag = sections[i].tag;
+            table[i].elementSize = sections[i].elementSize;
+            table[i].offset = offset;
+            table[i].size = sections[i].bytes.size();
+            table[i].checksum = snapshotChecksum(sections[i].bytes.data(), sections[i].bytes.size());
+            offset = align(offset + table[i].size);
+        }
+
+        SnapshotHeader header = SnapshotHeader();
+        memcpy(header.magic, "STROSNAP", 8);
+        header.version = SNAPSHOT_VERSION;
+        header.byteOrder = SNAPSHOT_BYTE_ORDER;
+        header.sectionCount = static_cast<uint32_t>(table.size());
+        header.fileSize = offset;
+        header.source = source;
+
+        std::string temporary = path + ".tmp";
+        FILE* out = fopen(temporary.c_str(), "wb");
+        if (!out) return 0;
+
+        static const char zeros[8] = {0};
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  (table.empty() || fwrite(table.data(), sizeof(SnapshotSection), table.size(), out) == table.size());
+        uint64_t written = sizeof(header) + table.size() * sizeof(SnapshotSection);
+        for (size_t i = 0; ok && i < sections.size(); ++i) {
+            ok = fwrite(zeros, 1, table[i].offset - written, out) == table[i].offset - written &&
+                 fwrite(sections[i].bytes.data(), 1, table[i].size, out) == table[i].size;
+            written = table[i].offset + table[i].size;
+        }
+        ok = ok && fwrite(zeros, 1, offset - written, out) == offset - written;
+        ok = fclose(out) == 0 && ok;
+
+        if (ok) {
+            remove(path.c_str());   // rename() does not replace on Windows
+            ok = rename(temporary.c_str(), path.c_str()) == 0;
+        }
+        if (!ok) {
+            remove(temporary.c_str());
+            return 0;
+        }
+        return static_cast<size_t>(offset);
+    }
+};
+
+// ==================== SNAPSHOT READER ====================
+
+class SnapshotReader {
+private:
+    MappedFile file;
+    const SnapshotSection* table;
+    uint32_t sectionCount;
+
+    const SnapshotSection* findSection(SnapshotTag tag) const {
+        for (uint32_t i = 0; i < sectionCount; ++i) {
+            if (table[i].tag == tag) return &table[i];
+        }
+        return nullptr;
+    }
+
+public:
+    SnapshotReader() : table(nullptr), sectionCount(0) {}
+
+    /**
+     * Map path and validate it: magic, version, byte order, size, the
+     * section table bounds, the checksums and (when given) the expected
+     * source.
+     * @return false if missing, damaged or stale
+     */
+    bool open(const std::string& path, const SnapshotSource* expected = nullptr) {
+        table = nullptr;
+        sectionCount = 0;
+        if (!file.open(path)) return false;
+
+        if (file.size() < sizeof(SnapshotHeader)) return false;
+        SnapshotHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, "STROSNAP", 8) != 0 || header.version != SNAPSHOT_VERSION ||
+            header.byteOrder != SNAPSHOT_BYTE_ORDER || header.fileSize != file.size()) {
+            return false;
+        }
+        if (expected && !(header.source == *expected)) return false;
+
+        uint64_t tableEnd = sizeof(SnapshotHeader) + uint64_t(header.sectionCount) * sizeof(SnapshotSection);
+        if (tableEnd > file.size()) return false;
+        const SnapshotSection* sections = reinterpret_cast<const SnapshotSection*>(file.data() + sizeof(SnapshotHeader));
+        for (uint32_t i = 0; i < header.sectionCount; ++i) {
+            const SnapshotSection& s = sections[i];
+            if (s.offset % 8 != 0 || s.offset < tableEnd || s.offset > file.size() ||
+                s.size > file.size() - s.offset || s.elementSize == 0 || s.size % s.elementSize != 0 ||
+                snapshotChecksum(file.data() + s.offset, static_cast<size_t>(s.size)) != s.checksum) {
+                return false;
+            }
+        }
+
+        table = sections;
+        sectionCount = header.sectionCount;
+        return true;
+    }
+
+    void close() {
+        file.close();
+        table = nullptr;
+        sectionCount = 0;
+    }
+
+    size_t getFileSize() const { return file.size(); }
+
+    // Records of a section, pointing into the mapping (valid until close())
+    template <typename T>
+    bool view(SnapshotTag tag, const T** values, size_t* count) const {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot records are copied bytewise");
+        static_assert(alignof(T) <= 8, "sections are 8-byte aligned");
+        const SnapshotSection* section = findSection(tag);
+        if (!section || section->elementSize != sizeof(T)) return false;
+        *values = reinterpret_cast<const T*>(file.data() + section->offset);
+        *count = static_cast<size_t>(section->size / sizeof(T));
+        return true;
+    }
+
+    // Copy a section into values; expectedCount < 0 accepts any length
+    template <typename T>
+    bool read(SnapshotTag tag, std::vector<T>* values, long long expectedCount = -1) const {
+        const T* data;
+        size_t count;
+        if (!view(tag, &data, &count)) return false;
+        if (expectedCount >= 0 && count != static_cast<size_t>(expectedCount)) return false;
+        values->assign(data, data + count);
+        return true;
+    }
+};
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,143 @@
+/**
+ * Smart Traffic Route Optimizer
+ * String Table (Interning) Implementation
+ *
+ * Stores every distinct string once in a single contiguous buffer
+ * and hands out dense 32-bit IDs for it
+ * Time Complexity: O(length) for intern/lookup, O(1) for get
+ */
+
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <limits>
+
+class StringTable {
+private:
+    static constexpr uint32_t EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+    std::string data;               // All strings back to back
+    std::vector<uint32_t> offsets;  // String i = data[offsets[i], offsets[i+1])
+    std::vector<uint32_t> slots;    // Open-addressing index: string ID or EMPTY_SLOT
+
+    // djb2 hash (same function HashTable uses for string keys)
+    static size_t hashString(std::string_view str) {
+        size_t hash = 5381;
+        for (char c : str) {
+            hash = ((hash << 5) + hash) + static_cast<unsigned char>(c);
+        }
+        return hash;
+    }
+
+    // Find the slot holding str, or the empty slot where it would go
+    size_t findSlot(std::string_view str) const {
+        size_t mask = slots.size() - 1;
+        size_t i = hashString(str) & mask;
+        while (slots[i] != EMPTY_SLOT && get(slots[i]) != str) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    // Double the index when it becomes half full
+    void growIndex() {
+        std::vector<uint32_t> newSlots(slots.empty() ? 16 : slots.size() * 2, EMPTY_SLOT);
+        slots.swap(newSlots);
+        for (uint32_t id = 0; id < size(); ++id) {
+            slots[findSlot(get(id))] = id;
+        }
+    }
+
+public:
+    StringTable() : offsets(1, 0) {}
+
+    // Return the ID of str, adding it if not present - O(length)
+    uint32_t intern(std::string_view str) {
+        if ((size() + 1) * 2 > slots.size()) {
+            growIndex();
+        }
+
+        size_t slot = findSlot(str);
+        if (slots[slot] != EMPTY_SLOT) {
+            return slots[slot];
+        }
+
+        uint32_t id = static_cast<uint32_t>(size());
+        data.append(str.data(), str.size());
+        offsets.push_back(static_cast<uint32_t>(data.size()));
+        slots[slot] = id;
+        return id;
+    }
+
+    // Look up an existing string without adding it
+    bool find(std::string_view str, uint32_t* id = nullptr) const {
+        if (slots.empty()) return false;
+        size_t slot = findSlot(str);
+        if (slots[slot] == EMPTY_SLOT) return false;
+        if (id) *id = slots[slot];
+        return true;
+    }
+
+    // Get string by ID - O(1)
+    std::string_view get(uint32_t id) const {
+        return std::string_view(data.data() + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+
+    // Number of distinct strings
+    size_t size() const { return offsets.size() - 1; }
+
+    // Approximate heap usage in bytes
+    size_t memoryUsageBytes() const {
+        return data.capacity() + offsets.capacity() * sizeof(uint32_t) +
+               slots.capacity() * sizeof(uint32_t);
+    }
+
+    // Raw contents for snapshots: the buffer and size() + 1 offsets into it
+    const std::string& rawData() const { return data; }
+    const std::vector<uint32_t>& rawOffsets() const { return offsets; }
+
+    // Replace the contents with raw ones (see rawData); false if malformed
+    bool assign(const char* bytes, size_t length, const uint32_t* stringOffsets, size_t numOffsets) {
+        if (numOffsets == 0 || stringOffsets[0] != 0 || stringOffsets[numOffsets - 1] != length) return false;
+        for (size_t i = 1; i < numOffsets; ++i) {
+            if (stringOffsets[i] < stringOffsets[i - 1]) return false;
+        }
+        data.assign(bytes, length);
+        offsets.assign(stringOffsets, stringOffsets + numOffsets);
+
+        size_t capacity = 16;
+        while (capacity < (size() + 1) * 2) capacity *= 2;
+        slots.assign(capacity, EMPTY_SLOT);
+        for (uint32_t id = 0; id < size(); ++id) {
+            slots[findSlot(get(id))] = id;
+        }
+        return true;
+    }
+
+    // Room for count strings of totalBytes in all: interning that many
+    // grows neither the buffer nor the index
+    void reserve(size_t count, size_t totalBytes) {
+        data.reserve(totalBytes);
+        offsets.reserve(count + 1);
+        if ((count + 1) * 2 > slots.size()) {
+            size_t capacity = 16;
+            while (capacity < (count + 1) * 2) capacity *= 2;
+            slots.assign(capacity, EMPTY_SLOT);
+            for (uint32_t id = 0; id < size(); ++id) {
+                slots[findSlot(get(id))] = id;
+            }
+        }
+    }
+
+    void clear() {
+        data.clear();
+        offsets.assign(1, 0);
+        slots.clear();
+    }
+};
+
+#endif // STRINGTABLE_H
@@ -4,8 +4,8 @@
  * Data Flow:
  * 1. Load OSM data into B-Tree (1299 junctions)
  * 2. Search B-Tree first (O(log n) - FAST)
- * 3. If not found, query Nominatim API (OpenStreetMap)
- * 4. Cache Nominatim results in B-Tree for future
+ * 3. If not found, queue a Nominatim API lookup (OpenStreetMap, Geocoder.h)
+ * 4. Cache Nominatim results in B-Tree and on disk for future runs
  */
 
 #ifndef TRAFFICMANAGER_H
@@ -16,264 +16,232 @@
 #include <sstream>
 #include <iomanip>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <chrono>
 #include <algorithm>
-#include <windows.h>
-#include <winhttp.h>
+#include <iterator>
+#include <queue>
+#include <atomic>
+#include <future>
 #include "BTree.h"
+#include "BPlusTree.h"
 #include "HashTable.h"
+#include "FlatHashTable.h"
 #include "Graph.h"
-#include "LRUCache.h"
+#include "RouteArena.h"
+#include "Metrics.h"
+#include "KDTree.h"
+#include "CompactTrie.h"
+#include "TrigramIndex.h"
+#include "EditDistance.h"
+#include "RouteCache.h"
+#include "Snapshot.h"
+#include "JunctionReader.h"
 #include "Models.h"
 #include "SessionManager.h"
-
-#pragma comment(lib, "winhttp.lib")
-
-// Nominatim API Configuration (OpenStreetMap - FREE)
-const std::wstring NOMINATIM_HOST = L"nominatim.openstreetmap.org";
-const std::wstring USER_AGENT = L"TrafficOptimizer/1.0 (contact@example.com)";
+#include "Geocoder.h"
 
 class TrafficManager {
 private:
     // Primary data structures
-    BTree<std::string, int> junctionNameIndex;      // Name -> Junction ID
-    BTree<std::string, std::vector<int>> cityIndex; // City -> List of Junction IDs
-    BTree<std::string, Junction> nominatimCache;    // Nominatim search cache
-    HashTable<int, Junction> junctionTable;          // ID -> Junction (O(1) lookup)
-    HashTable<int, Road> roadTable;                  // Road ID -> Road
+    BPlusTree<std::string, int> junctionNameIndex;      // Name -> Junction ID
+    BPlusTree<std::string, std::vector<int>> cityIndex; // City -> List of Junction IDs
+    Geocoder geocoder;                               // Nominatim lookups + on-disk cache
+    FlatHashTable<int, Junction> junctionTable;      // ID -> Junction (O(1) lookup)
+    FlatHashTable<int, Road> roadTable;              // Road ID -> Road
     Graph roadNetwork;                               // Road network graph
-    LRUCache<std::string, RouteResult> routeCache;   // Cache for routes
+    KDTree spatialIndex;                             // Position -> nearest junctions
+    TrigramIndex fuzzyNameIndex;                     // Normalized name trigrams -> junctions
+    CompactTrie autocompleteIndex;                   // Name prefix -> top junctions
+    RouteCache routeCache;                           // (source, dest, mode) -> route
+    WorkerPool matrixPool;                           // Shared helpers for cost matrices
     
     // User management
-    BTree<std::string, User> userTree;
+    BPlusTree<std::string, User> userTree;
     HashTable<std::string, Session> sessionTable;
     SessionManager sessionManager;
 
-    // Thread safety
-    mutable std::mutex dataMutex;
-    mutable std::mutex cacheMutex;
-    mutable std::mutex nominatimMutex;
-    
-    int nextNominatimJunctionId;  // Start Nominatim IDs at 10000
-
-    // Generate cache key for route
-    std::string generateCacheKey(int source, int dest, bool useTime) const {
-        return std::to_string(source) + "_" + std::to_string(dest) + 
-               "_" + (useTime ? "time" : "dist");
+    // Thread safety: queries share dataMutex, updates hold it alone
+    typedef std::shared_lock<std::shared_mutex> ReadLock;
+    typedef std::unique_lock<std::shared_mutex> WriteLock;
+    mutable std::shared_mutex dataMutex;
+
+    std::atomic<uint64_t> geocodedJunctions;   // added from Nominatim answers
+
+    // Bumped on every change to what /api/junctions or /api/roads returns
+    std::atomic<uint64_t> junctionsVersion;
+    std::atomic<uint64_t> roadsVersion;
+
+    // Route searches and the arena use of their transient data
+    std::atomic<uint64_t> routeSearches;
+    std::atomic<uint64_t> routeArenaAllocations;
+    std::atomic<uint64_t> routeArenaBytes;
+    std::atomic<uint64_t> routeHeapAllocations;
+
+    void recordRouteSearch(const RouteArena::Scope& arena) {
+        RouteArena::Stats used = arena.delta();
+        routeSearches++;
+        routeArenaAllocations += used.allocations;
+        routeArenaBytes += used.bytes;
+        routeHeapAllocations += used.heapAllocations;
     }
 
-    // ==================== WINHTTP HELPER FUNCTIONS ====================
-
-    // Convert string to wstring
-    std::wstring stringToWString(const std::string& str) {
-        if (str.empty()) return std::wstring();
-        int size = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, NULL, 0);
-        std::wstring wstr(size, 0);
-        MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &wstr[0], size);
-        return wstr;
+    // One graph search, recording its time and settled vertices
+    template <typename Search>
+    static PathResult timedSearch(Search search) {
+        Metrics::Timer timer(Metric::GRAPH_SEARCH);
+        PathResult path = search();
+        timer.stop();
+        Metrics::record(Metric::SETTLED_NODES, static_cast<uint64_t>(path.settledNodes));
+        return path;
     }
 
-    // URL Encode
-    std::string urlEncode(const std::string& str) {
-        std::ostringstream escaped;
-        escaped.fill('0');
-        escaped << std::hex;
-
-        for (char c : str) {
-            if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-                escaped << c;
-            } else if (c == ' ') {
-                escaped << '+';
-            } else {
-                escaped << '%' << std::setw(2) << int((unsigned char)c);
-            }
-        }
-        return escaped.str();
-    }
+    static constexpr size_t FUZZY_RESULT_LIMIT = 10;
+    static constexpr size_t MATRIX_QUEUE_LIMIT = 64;   // queued matrix helpers before callers go alone
 
-    // Make HTTP Request using WinHTTP
-    std::string makeHttpRequest(const std::string& path) {
-        std::string response;
-        HINTERNET hSession = NULL;
-        HINTERNET hConnect = NULL;
-        HINTERNET hRequest = NULL;
-
-        try {
-            // Initialize WinHTTP
-            hSession = WinHttpOpen(USER_AGENT.c_str(),
-                                   WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-                                   WINHTTP_NO_PROXY_NAME,
-                                   WINHTTP_NO_PROXY_BYPASS, 0);
-            
-            if (!hSession) {
-                std::cerr << "❌ WinHTTP session failed" << std::endl;
-                return "";
-            }
-
-            // Connect to server
-            hConnect = WinHttpConnect(hSession, NOMINATIM_HOST.c_str(),
-                                      INTERNET_DEFAULT_HTTPS_PORT, 0);
-            
-            if (!hConnect) {
-                std::cerr << "❌ WinHTTP connect failed" << std::endl;
-                WinHttpCloseHandle(hSession);
-                return "";
+    // Junction details and traffic segments for a path; appends its hops
+    // to segments (caller holds dataMutex)
+    RouteResult describeRoute(const PathResult& pathResult, std::vector<uint64_t>* segments) const {
+        RouteResult result;
+        result.found = pathResult.found;
+        result.totalDistance = pathResult.totalDistance;
+        result.totalTime = pathResult.totalTime;
+        result.algorithm = routeAlgorithmToString(pathResult.algorithm);
+        result.settledNodes = pathResult.settledNodes;
+    
+        if (pathResult.found) {
+            // Junction details by reference: names go to the route's string table
+            size_t hops = pathResult.path.size();
+            result.stops.reserve(hops);
+            result.trafficSegments.reserve(hops - 1);
+            result.strings.reserve(3 * hops, 64 * hops);
+            for (int junctionId : pathResult.path) {
+                if (const Junction* junction = junctionTable.find(junctionId)) {
+                    result.stops.push_back(RouteStop{junction->id, result.strings.intern(junction->name),
+                                                     result.strings.intern(junction->city),
+                                                     result.strings.intern(junction->area),
+                                                     junction->latitude, junction->longitude,
+                                                     junction->hasTrafficSignal, junction->geocoded});
+                }
             }
-
-            // Create request
-            std::wstring wPath = stringToWString(path);
-            hRequest = WinHttpOpenRequest(hConnect, L"GET", wPath.c_str(),
-                                          NULL, WINHTTP_NO_REFERER,
-                                          WINHTTP_DEFAULT_ACCEPT_TYPES,
-                                          WINHTTP_FLAG_SECURE);
+        
+            // Build traffic segments for visualization
+            segments->reserve(segments->size() + hops - 1);
+            for (size_t i = 0; i < hops - 1; ++i) {
+                int fromId = pathResult.path[i];
+                int toId = pathResult.path[i + 1];
+                segments->push_back(RouteCache::segmentId(fromId, toId));
             
-            if (!hRequest) {
-                std::cerr << "❌ WinHTTP request failed" << std::endl;
-                WinHttpCloseHandle(hConnect);
-                WinHttpCloseHandle(hSession);
-                return "";
-            }
+                EdgeView edge;
+                if (roadNetwork.getEdge(fromId, toId, &edge)) {
+                    // Time-dependent routes carry their own hop times
+                    bool timed = i < pathResult.legTimes.size() && edge.baseTime > 0;
+                    double legTime = timed ? pathResult.legTimes[i] : edge.getActualTime();
+                    double multiplier = timed ? legTime / edge.baseTime : edge.trafficMultiplier;
 
-            // Send request
-            if (!WinHttpSendRequest(hRequest,
-                                    WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-                                    WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
-                std::cerr << "❌ WinHTTP send failed" << std::endl;
-                WinHttpCloseHandle(hRequest);
-                WinHttpCloseHandle(hConnect);
-                WinHttpCloseHandle(hSession);
-                return "";
-            }
-
-            // Receive response
-            if (!WinHttpReceiveResponse(hRequest, NULL)) {
-                std::cerr << "❌ WinHTTP receive failed" << std::endl;
-                WinHttpCloseHandle(hRequest);
-                WinHttpCloseHandle(hConnect);
-                WinHttpCloseHandle(hSession);
-                return "";
-            }
-
-            // Read data
-            DWORD dwSize = 0;
-            DWORD dwDownloaded = 0;
-            char* pszOutBuffer;
-
-            do {
-                dwSize = 0;
-                if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) {
-                    break;
-                }
-
-                pszOutBuffer = new char[dwSize + 1];
-                ZeroMemory(pszOutBuffer, dwSize + 1);
-
-                if (!WinHttpReadData(hRequest, (LPVOID)pszOutBuffer, dwSize, &dwDownloaded)) {
-                    delete[] pszOutBuffer;
-                    break;
+                    // Determine traffic level from multiplier
+                    TrafficLevel level = TrafficLevel::NORMAL;
+                    if (multiplier <= 0.8) {
+                        level = TrafficLevel::LOW;
+                    } else if (multiplier <= 1.0) {
+                        level = TrafficLevel::NORMAL;
+                    } else if (multiplier <= 1.5) {
+                        level = TrafficLevel::HEAVY;
+                    } else {
+                        level = TrafficLevel::SEVERE;
+                    }
+                
+                    result.trafficSegments.push_back(TrafficSegment{
+                        fromId, toId, result.strings.intern(edge.roadName), edge.distance, legTime, level});
                 }
-
-                response.append(pszOutBuffer, dwDownloaded);
-                delete[] pszOutBuffer;
-
-            } while (dwSize > 0);
-
-            // Cleanup
-            WinHttpCloseHandle(hRequest);
-            WinHttpCloseHandle(hConnect);
-            WinHttpCloseHandle(hSession);
-
-        } catch (...) {
-            if (hRequest) WinHttpCloseHandle(hRequest);
-            if (hConnect) WinHttpCloseHandle(hConnect);
-            if (hSession) WinHttpCloseHandle(hSession);
-            return "";
+            }
         }
-
-        return response;
+        return result;
     }
 
-    // Simple JSON Parser for Nominatim response
-    Junction* parseNominatimResponse(const std::string& jsonResponse, const std::string& searchQuery) {
-        if (jsonResponse.empty() || jsonResponse[0] != '[') {
-            return nullptr;
+    // Take the shared lock on a frozen network; the first query after an
+    // edit freezes it once, exclusively
+    void lockFrozen(ReadLock& lock) {
+        lock.lock();
+        while (!roadNetwork.isFrozen()) {
+            lock.unlock();
+            {
+                WriteLock writeLock(dataMutex);
+                roadNetwork.freeze();
+            }
+            lock.lock();
         }
+    }
 
-        // Find first result
-        size_t latPos = jsonResponse.find("\"lat\":");
-        size_t lonPos = jsonResponse.find("\"lon\":");
-        size_t namePos = jsonResponse.find("\"display_name\":");
-
-        if (latPos == std::string::npos || lonPos == std::string::npos) {
-            return nullptr;
+    // Attach junction records to spatial index hits (caller holds dataMutex)
+    std::vector<NearbyJunction> resolveNeighbors(const std::vector<KDTree::Neighbor>& neighbors) const {
+        std::vector<NearbyJunction> result;
+        result.reserve(neighbors.size());
+        for (const KDTree::Neighbor& n : neighbors) {
+            if (const Junction* junction = junctionTable.find(n.id)) {
+                NearbyJunction nearby;
+                nearby.junction = *junction;
+                nearby.distanceKm = n.distanceKm;
+                result.push_back(std::move(nearby));
+            }
         }
+        return result;
+    }
 
-        // Extract latitude
-        latPos += 7; // Skip "lat\":"
-        size_t latEnd = jsonResponse.find("\"", latPos);
-        std::string latStr = jsonResponse.substr(latPos, latEnd - latPos);
-        double lat = std::stod(latStr);
-
-        // Extract longitude
-        lonPos += 7; // Skip "lon\":"
-        size_t lonEnd = jsonResponse.find("\"", lonPos);
-        std::string lonStr = jsonResponse.substr(lonPos, lonEnd - lonPos);
-        double lon = std::stod(lonStr);
-
-        // Extract display name
-        std::string displayName = searchQuery; // Default to search query
-        if (namePos != std::string::npos) {
-            namePos += 16; // Skip "display_name\":"
-            size_t nameEnd = jsonResponse.find("\"", namePos);
-            displayName = jsonResponse.substr(namePos, nameEnd - namePos);
+    // Append to the junction's city list in place (caller holds the write lock)
+    void addToCity(const Junction& junction) {
+        std::vector<int>* cityJunctions = cityIndex.find(junction.city);
+        if (cityJunctions) {
+            cityJunctions->push_back(junction.id);
+        } else {
+            cityIndex.insert(junction.city, {junction.id});
         }
+    }
 
-        // Extract city from display name
-        std::string city = "Unknown";
-        std::string area = "Central";
-        
-        if (displayName.find("Lahore") != std::string::npos) city = "Lahore";
-        else if (displayName.find("Karachi") != std::string::npos) city = "Karachi";
-        else if (displayName.find("Islamabad") != std::string::npos) city = "Islamabad";
-        else if (displayName.find("Rawalpindi") != std::string::npos) city = "Rawalpindi";
-        else if (displayName.find("Faisalabad") != std::string::npos) city = "Faisalabad";
-        else if (displayName.find("Multan") != std::string::npos) city = "Multan";
+    // Index one junction everywhere it is looked up; caller holds the write lock
+    void insertJunction(const Junction& junction) {
+        junctionTable.insert(junction.id, junction);
+        junctionNameIndex.insert(junction.name, junction.id);
+        addToCity(junction);
         
-        // Try to extract area
-        std::vector<std::string> areas = {"Gulberg", "Defence", "Model Town", 
-                                         "Johar Town", "Garden Town", "Township",
-                                         "Anarkali", "Cantt", "Saddar", "PECHS"};
-        for (const auto& a : areas) {
-            if (displayName.find(a) != std::string::npos) {
-                area = a;
-                break;
-            }
-        }
-
-        Junction* newJunction = new Junction(
-            nextNominatimJunctionId++,
-            searchQuery, // Use search query as name
-            lat,
-            lon,
-            city,
-            area
-        );
+        roadNetwork.addVertex(junction.id, junction.latitude, junction.longitude);
+        spatialIndex.insert(junction.id, GeoPoint(junction.latitude, junction.longitude));
+        fuzzyNameIndex.add(junction.id, normalizeString(junction.name));
+        autocompleteIndex.insert(autocompleteKey(junction.name), junction.id);
+    }
 
-        return newJunction;
+    // Add a geocoded place unless it is already in (a cached answer is
+    // handed to every caller that asks for the same query). Its ID is
+    // above every other junction's: all other additions reserve theirs
+    // with the geocoder.
+    void addGeocodedJunction(const Junction& junction) {
+        WriteLock lock(dataMutex);
+        if (junctionTable.contains(junction.id)) return;
+        insertJunction(junction);
+        geocodedJunctions++;
+        junctionsVersion++;
     }
 
 
 public:
     TrafficManager(size_t cacheSize = 100) 
-        : routeCache(cacheSize), nextNominatimJunctionId(10000) {}
+        : routeCache(cacheSize),
+          matrixPool(std::max(1u, std::thread::hardware_concurrency()) - 1, MATRIX_QUEUE_LIMIT),
+          geocodedJunctions(0),
+          junctionsVersion(0), roadsVersion(0), routeSearches(0), routeArenaAllocations(0),
+          routeArenaBytes(0), routeHeapAllocations(0) {
+        roadNetwork.setMaxSpeed(MAX_ROAD_SPEED_KMH);
+    }
 
     // ==================== SMART SEARCH ====================
 
-    // In TrafficManager.h, update the smartSearch function:
-
-    std::vector<Junction> smartSearch(const std::string& query, const std::string& city = "") {
+    // Fuzzy search, then Nominatim. With pending, a Nominatim lookup that
+    // is not answered yet sets *pending instead of being waited for
+    std::vector<Junction> smartSearch(const std::string& query, const std::string& city = "",
+                                      bool* pending = nullptr) {
         std::vector<Junction> results;
+        if (pending) *pending = false;
     
         // Step 1: Try fuzzy search first (NEW - BETTER!)
         std::cout << "🔍 Step 1: Fuzzy searching B-Tree..." << std::endl;
@@ -300,13 +268,15 @@ public:
             actualCity = "";  // City already in query
         }
     
-        Junction* nominatimResult = searchNominatim(actualQuery, actualCity);
+        Junction place;
+        GeocodeStatus status = geocodePlace(actualQuery, actualCity, pending == nullptr, &place);
     
-        if (nominatimResult) {
-            addJunction(*nominatimResult);
-            results.push_back(*nominatimResult);
-            delete nominatimResult;
+        if (status == GeocodeStatus::FOUND) {
+            results.push_back(place);
             std::cout << "✅ Added from OpenStreetMap" << std::endl;
+        } else if (status == GeocodeStatus::PENDING) {
+            *pending = true;
+            std::cout << "⏳ Nominatim lookup queued" << std::endl;
         } else {
             std::cout << "❌ No results found" << std::endl;
         }
@@ -317,29 +287,86 @@ public:
     // ==================== Original Junction Management ====================
 
     void addJunction(const Junction& junction) {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        WriteLock lock(dataMutex);
+        insertJunction(junction);
+        geocoder.reserveIds(junction.id);
+        junctionsVersion++;
+    }
+
+    /**
+     * Add a batch of junctions under one write lock (file loading). The
+     * ID table is sized once. A batch of at least 1/8 of the junctions
+     * already loaded rebuilds the name index bottom-up from a sorted merge
+     * instead of inserting name by name, and folds into the spatial and
+     * autocomplete indices with one rebuild each. As with addJunction, a
+     * later junction with an existing name takes the name over.
+     */
+    void addJunctions(const std::vector<Junction>& junctions) {
+        if (junctions.empty()) return;
+        WriteLock lock(dataMutex);
+        geocoder.reserveIds(std::max_element(junctions.begin(), junctions.end(),
+                                             [](const Junction& a, const Junction& b) { return a.id < b.id; })->id);
         
-        junctionTable.insert(junction.id, junction);
-        junctionNameIndex.insert(junction.name, junction.id);
+        size_t existing = junctionTable.size();
+        junctionTable.reserve(existing + junctions.size());
+        if (junctions.size() * 8 < existing) {
+            for (const Junction& junction : junctions) insertJunction(junction);
+            junctionsVersion++;
+            return;
+        }
         
-        std::vector<int> cityJunctions;
-        if (cityIndex.search(junction.city, &cityJunctions)) {
-            cityJunctions.push_back(junction.id);
-            cityIndex.insert(junction.city, cityJunctions);
-        } else {
-            cityIndex.insert(junction.city, {junction.id});
+        std::vector<std::pair<std::string, int>> names, autocompleteKeys;
+        std::vector<std::pair<int, GeoPoint>> positions;
+        names.reserve(junctions.size());
+        autocompleteKeys.reserve(junctions.size());
+        positions.reserve(junctions.size());
+        for (const Junction& junction : junctions) {
+            junctionTable.insert(junction.id, junction);
+            names.push_back({junction.name, junction.id});
+            addToCity(junction);
+            roadNetwork.addVertex(junction.id, junction.latitude, junction.longitude);
+            positions.push_back({junction.id, GeoPoint(junction.latitude, junction.longitude)});
+            fuzzyNameIndex.add(junction.id, normalizeString(junction.name));
+            autocompleteKeys.push_back({autocompleteKey(junction.name), junction.id});
         }
+        spatialIndex.insertMany(positions);
+        autocompleteIndex.insertMany(autocompleteKeys);
         
-        roadNetwork.addVertex(junction.id);
+        // Sorted by name, the last of equal names wins; then merged with
+        // the current index (batch wins again) into one sorted run
+        std::stable_sort(names.begin(), names.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        size_t unique = 0;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (i + 1 < names.size() && names[i + 1].first == names[i].first) continue;
+            if (unique != i) names[unique] = std::move(names[i]);
+            unique++;
+        }
+        names.resize(unique);
+        
+        std::vector<std::pair<std::string, int>> current = junctionNameIndex.getAll();
+        std::vector<std::pair<std::string, int>> merged;
+        merged.reserve(current.size() + names.size());
+        size_t c = 0, n = 0;
+        while (c < current.size() || n < names.size()) {
+            if (n == names.size() || (c < current.size() && current[c].first < names[n].first)) {
+                merged.push_back(std::move(current[c++]));
+            } else {
+                if (c < current.size() && current[c].first == names[n].first) c++;
+                merged.push_back(std::move(names[n++]));
+            }
+        }
+        junctionNameIndex.bulkLoad(std::move(merged));
+        junctionsVersion++;
     }
 
     bool getJunction(int id, Junction* result) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         return junctionTable.search(id, result);
     }
 
     bool getJunctionByName(const std::string& name, Junction* result) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         int id;
         if (junctionNameIndex.search(name, &id)) {
             return junctionTable.search(id, result);
@@ -348,31 +375,117 @@ public:
     }
 
     std::vector<Junction> getAllJunctions() const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         std::vector<Junction> result;
-        for (const auto& pair : junctionTable.getAll()) {
-            result.push_back(pair.second);
-        }
+        result.reserve(junctionTable.size());
+        junctionTable.scan([&](const int&, const Junction& junction) {
+            result.push_back(junction);
+            return true;
+        });
         return result;
     }
 
     std::vector<Junction> getJunctionsByCity(const std::string& city) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         std::vector<Junction> result;
         std::vector<int> ids;
         if (cityIndex.search(city, &ids)) {
             for (int id : ids) {
-                Junction j;
-                if (junctionTable.search(id, &j)) {
-                    result.push_back(j);
+                if (const Junction* junction = junctionTable.find(id)) {
+                    result.push_back(*junction);
                 }
             }
         }
         return result;
     }
 
+    // ==================== Paged Listings ====================
+
+    /**
+     * IDs of the junctions in [offset, offset + limit) of the listing:
+     * insertion order, overall or within a city (via cityIndex).
+     * *total is the number of junctions the listing has in all.
+     */
+    std::vector<int> pageJunctionIds(const std::string& city, size_t offset, size_t limit,
+                                     size_t* total) const {
+        ReadLock lock(dataMutex);
+        std::vector<int> ids;
+        if (!city.empty()) {
+            std::vector<int> cityIds;
+            cityIndex.search(city, &cityIds);
+            *total = cityIds.size();
+            if (offset < cityIds.size()) {
+                ids.assign(cityIds.begin() + offset,
+                           cityIds.begin() + offset + std::min(limit, cityIds.size() - offset));
+            }
+            return ids;
+        }
+
+        *total = junctionTable.size();
+        if (limit == 0) return ids;
+        size_t position = 0;
+        junctionTable.scan([&](const int& id, const Junction&) {
+            if (position++ >= offset) ids.push_back(id);
+            return ids.size() < limit;
+        });
+        return ids;
+    }
+
+    // visit(junction) for each of the IDs, in one lock hold and without copies
+    template <typename Visit>
+    void visitJunctions(const int* ids, size_t count, Visit visit) const {
+        ReadLock lock(dataMutex);
+        for (size_t i = 0; i < count; ++i) {
+            if (const Junction* junction = junctionTable.find(ids[i])) visit(*junction);
+        }
+    }
+
+    // ==================== Autocomplete ====================
+
+    // Up to limit junctions whose name starts with prefix (shortest names first)
+    std::vector<Junction> autocompleteJunctions(const std::string& prefix, size_t limit = 10) const {
+        ReadLock lock(dataMutex);
+        std::vector<Junction> result;
+        for (int id : autocompleteIndex.complete(autocompleteKey(prefix), limit)) {
+            if (const Junction* junction = junctionTable.find(id)) {
+                result.push_back(*junction);
+            }
+        }
+        return result;
+    }
+
+    // Autocomplete key: lowercase, single spaces, trimmed
+    std::string autocompleteKey(const std::string& name) const {
+        std::string key;
+        key.reserve(name.size());
+        for (char c : name) {
+            if (c == ' ' || c == '\t') {
+                if (!key.empty() && key.back() != ' ') key += ' ';
+            } else {
+                key += static_cast<char>(::tolower(static_cast<unsigned char>(c)));
+            }
+        }
+        if (!key.empty() && key.back() == ' ') key.pop_back();
+        return key;
+    }
+
+    // ==================== Spatial Queries ====================
+
+    // k junctions closest to (lat, lng), nearest first
+    std::vector<NearbyJunction> findNearestJunctions(double lat, double lng, size_t k) const {
+        ReadLock lock(dataMutex);
+        return resolveNeighbors(spatialIndex.nearest(GeoPoint(lat, lng), k));
+    }
+
+    // All junctions within radiusKm of (lat, lng), nearest first
+    std::vector<NearbyJunction> findJunctionsWithinRadius(double lat, double lng,
+                                                          double radiusKm) const {
+        ReadLock lock(dataMutex);
+        return resolveNeighbors(spatialIndex.withinRadius(GeoPoint(lat, lng), radiusKm));
+    }
+
     std::vector<Junction> searchJunctions(const std::string& query) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         std::vector<Junction> result;
     
         std::string lowerQuery = query;
@@ -391,16 +504,17 @@ public:
         lowerQuery.erase(0, lowerQuery.find_first_not_of(" "));
         lowerQuery.erase(lowerQuery.find_last_not_of(" ") + 1);
     
-        for (const auto& pair : junctionTable.getAll()) {
-            std::string lowerName = pair.second.name;
+        junctionTable.scan([&](const int&, const Junction& junction) {
+            std::string lowerName = junction.name;
             std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
         
             // NEW: Check if EITHER query contains name OR name contains query
             if (lowerName.find(lowerQuery) != std::string::npos || 
                 lowerQuery.find(lowerName) != std::string::npos) {
-                result.push_back(pair.second);
+                result.push_back(junction);
             }
-        }
+            return true;
+        });
         return result;
     }
     
@@ -423,8 +537,8 @@ public:
         }
         
         // Remove common suffixes
-        std::vector<std::string> suffixes = {" chowk", " road", " lahore", " karachi", 
-                                             " islamabad", " pakistan", " junction"};
+        static const std::vector<std::string> suffixes = {" chowk", " road", " lahore", " karachi",
+                                                          " islamabad", " pakistan", " junction"};
         for (const auto& suffix : suffixes) {
             size_t pos = result.find(suffix);
             if (pos != std::string::npos) {
@@ -435,45 +549,115 @@ public:
         return result;
     }
     
-    // Fuzzy search with similarity threshold
-    std::vector<Junction> fuzzySearchJunctions(const std::string& query, double threshold = 0.6) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
-        std::vector<std::pair<Junction, double>> scoredResults;
+    // Similarity of two normalized names, with the partial match boosts.
+    // Exact when at least minSimilarity, otherwise some value below it.
+    double scoreNormalized(const std::string& normalizedQuery, const std::string& normalizedName,
+                           double minSimilarity = 0.0) const {
+        double boost = 0.0;
+
+        // Also check if query is a substring (partial match bonus)
+        if (normalizedName.find(normalizedQuery) != std::string::npos) {
+            boost = 0.8;  // Boost partial matches
+        }
+
+        // Check if name is a substring of query (reverse partial match)
+        if (normalizedQuery.find(normalizedName) != std::string::npos) {
+            boost = std::max(boost, 0.85);
+        }
+
+        // The edit distance only matters if it beats the boost
+        return std::max(boost, calculateSimilarity(normalizedQuery, normalizedName,
+                                                   std::max(minSimilarity, boost)));
+    }
+
+    /**
+     * Fuzzy search with similarity threshold
+     * Only names sharing a trigram with the query are considered. For the
+     * others the length difference and the q-gram lemma (each edit changes
+     * at most 3 of the max(n, m) + 2 padded trigrams) bound the edit
+     * distance from below, hence the similarity from above. Candidates are
+     * scored best bound first until the bound drops below the 10th best
+     * similarity found, which a bounded heap keeps.
+     */
+    std::vector<std::pair<Junction, double>> fuzzySearchScored(const std::string& query,
+                                                               double threshold = 0.6) const {
+        ReadLock lock(dataMutex);
         
         std::string normalizedQuery = normalizeString(query);
-        
-        for (const auto& pair : junctionTable.getAll()) {
-            std::string normalizedName = normalizeString(pair.second.name);
-            
-            // Calculate similarity
-            double similarity = calculateSimilarity(normalizedQuery, normalizedName);
-            
-            // Also check if query is a substring (partial match bonus)
-            if (normalizedName.find(normalizedQuery) != std::string::npos) {
-                similarity = std::max(similarity, 0.8);  // Boost partial matches
-            }
-            
-            // Check if name is a substring of query (reverse partial match)
-            if (normalizedQuery.find(normalizedName) != std::string::npos) {
-                similarity = std::max(similarity, 0.85);
+
+        // Best first: higher similarity, then lower ID. The heap top is the worst kept.
+        typedef std::pair<double, int> Scored;   // (similarity, junction ID)
+        auto better = [](const Scored& a, const Scored& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        };
+        std::priority_queue<Scored, std::vector<Scored>, decltype(better)> best(better);
+
+        // Lowest similarity that can still enter the top 10
+        auto minUseful = [&]() {
+            return best.size() < FUZZY_RESULT_LIMIT ? threshold : std::max(threshold, best.top().first);
+        };
+        auto offer = [&](int id, double similarity) {
+            if (similarity < threshold) return;
+            if (best.size() < FUZZY_RESULT_LIMIT) {
+                best.push({similarity, id});
+            } else if (better({similarity, id}, best.top())) {
+                best.pop();
+                best.push({similarity, id});
             }
-            
-            if (similarity >= threshold) {
-                scoredResults.push_back({pair.second, similarity});
+        };
+
+        if (normalizedQuery.size() < TrigramIndex::GRAM) {
+            // Too short to filter by trigrams: score every (pre-normalized) name
+            fuzzyNameIndex.forEachEntry([&](const TrigramIndex::Entry& entry) {
+                offer(entry.id, scoreNormalized(normalizedQuery, entry.text, minUseful()));
+            });
+        } else {
+            const size_t n = normalizedQuery.size();
+            std::vector<std::pair<double, const TrigramIndex::Entry*>> bounded;
+
+            fuzzyNameIndex.forEachCandidate(normalizedQuery,
+                [&](const TrigramIndex::Entry& entry, size_t shared) {
+                    const size_t m = entry.text.size();
+                    if (entry.text.find(normalizedQuery) != std::string::npos ||
+                        normalizedQuery.find(entry.text) != std::string::npos) {
+                        // Partial matches are boosted above any threshold in use: always score
+                        offer(entry.id, scoreNormalized(normalizedQuery, entry.text, minUseful()));
+                        return;
+                    }
+                    size_t longest = std::max(n, m);
+                    size_t grams = TrigramIndex::trigramCount(longest);
+                    size_t minEdits = std::max(n > m ? n - m : m - n,
+                        grams > shared ? (grams - shared + TrigramIndex::GRAM - 1) / TrigramIndex::GRAM : 0);
+                    double upperBound = 1.0 - static_cast<double>(minEdits) / longest;
+                    if (upperBound >= threshold) {
+                        bounded.push_back({upperBound, &entry});
+                    }
+                });
+
+            std::sort(bounded.begin(), bounded.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+            for (const auto& candidate : bounded) {
+                if (best.size() >= FUZZY_RESULT_LIMIT && candidate.first < best.top().first) break;
+                offer(candidate.second->id,
+                      calculateSimilarity(normalizedQuery, candidate.second->text, minUseful()));
             }
         }
-        
-        // Sort by similarity score (descending)
-        std::sort(scoredResults.begin(), scoredResults.end(),
-                  [](const auto& a, const auto& b) { return a.second > b.second; });
-        
+
         // Return top results
+        std::vector<std::pair<Junction, double>> result(best.size());
+        for (size_t i = best.size(); i-- > 0; best.pop()) {
+            junctionTable.search(best.top().second, &result[i].first);
+            result[i].second = best.top().first;
+        }
+        
+        return result;
+    }
+
+    std::vector<Junction> fuzzySearchJunctions(const std::string& query, double threshold = 0.6) const {
         std::vector<Junction> result;
-        for (const auto& scored : scoredResults) {
+        for (const auto& scored : fuzzySearchScored(query, threshold)) {
             result.push_back(scored.first);
-            if (result.size() >= 10) break;  // Limit to top 10
         }
-        
         return result;
     }
     
@@ -484,33 +668,21 @@ public:
         if (!exactResults.empty()) return exactResults;
         
         // Strategy 2: Fuzzy match (70% threshold)
-        auto fuzzyResults = fuzzySearchJunctions(query, 0.7);
-        if (!fuzzyResults.empty()) return fuzzyResults;
-        
         // Strategy 3: More lenient fuzzy match (50% threshold)
-        return fuzzySearchJunctions(query, 0.5);
+        // Results are ranked by similarity, so the 70% matches are a prefix of
+        // the 50% ones and both strategies share a single pass.
+        std::vector<Junction> strict, lenient;
+        for (const auto& scored : fuzzySearchScored(query, 0.5)) {
+            if (scored.second >= 0.7) strict.push_back(scored.first);
+            lenient.push_back(scored.first);
+        }
+        return strict.empty() ? lenient : strict;
     }
 
     // ==================== FUZZY SEARCH ====================
-    // Calculate Levenshtein distance (edit distance)
+    // Calculate Levenshtein distance (edit distance), see EditDistance.h
     int levenshteinDistance(const std::string& s1, const std::string& s2) const {
-        const size_t len1 = s1.size(), len2 = s2.size();
-        std::vector<std::vector<int>> d(len1 + 1, std::vector<int>(len2 + 1));
-    
-        for (size_t i = 0; i <= len1; ++i) d[i][0] = i;
-        for (size_t j = 0; j <= len2; ++j) d[0][j] = j;
-    
-        for (size_t i = 1; i <= len1; ++i) {
-            for (size_t j = 1; j <= len2; ++j) {
-                int cost = (s1[i-1] == s2[j-1]) ? 0 : 1;
-                d[i][j] = std::min({
-                    d[i-1][j] + 1,      // deletion
-                    d[i][j-1] + 1,      // insertion
-                    d[i-1][j-1] + cost  // substitution
-                });
-            }
-        }
-        return d[len1][len2];
+        return static_cast<int>(editDistance(s1, s2));
     }
 
     // Calculate similarity percentage (0.0 to 1.0)
@@ -523,6 +695,19 @@ public:
         return 1.0 - (static_cast<double>(distance) / maxLen);
     }
 
+    // Similarity if it is at least minSimilarity, otherwise 0.0. The edit
+    // distance stops early once it exceeds what minSimilarity allows.
+    double calculateSimilarity(const std::string& s1, const std::string& s2, double minSimilarity) const {
+        if (s1.empty() || s2.empty()) return 0.0;
+
+        size_t maxLen = std::max(s1.length(), s2.length());
+        size_t maxEdits = static_cast<size_t>((1.0 - minSimilarity) * maxLen + 1e-9);
+        size_t distance = boundedEditDistance(s1, s2, maxEdits);
+        if (distance > maxEdits) return 0.0;
+
+        return 1.0 - (static_cast<double>(distance) / maxLen);
+    }
+
     // Convert to lowercase
     std::string toLowerCase(const std::string& str) const {
         std::string result = str;
@@ -559,9 +744,10 @@ public:
     // ==================== Road Management ====================
 
     void addRoad(const Road& road) {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        WriteLock lock(dataMutex);
         
         roadTable.insert(road.id, road);
+        roadsVersion++;   // connectedJunctions is not in the junction JSON
         
         double trafficMult = getTrafficMultiplier(road.trafficLevel);
         if (road.isTwoWay) {
@@ -571,42 +757,69 @@ public:
             roadNetwork.addEdge(road.sourceJunction, road.destJunction,
                                road.distance, road.baseTime, road.name);
         }
+        routeCache.clear();   // a new road can shorten any cached route
         
-        Junction source, dest;
-        if (junctionTable.search(road.sourceJunction, &source)) {
-            source.connectedJunctions.push_back(road.destJunction);
-            junctionTable.insert(road.sourceJunction, source);
+        if (Junction* source = junctionTable.find(road.sourceJunction)) {
+            source->connectedJunctions.push_back(road.destJunction);
         }
-        if (road.isTwoWay && junctionTable.search(road.destJunction, &dest)) {
-            dest.connectedJunctions.push_back(road.sourceJunction);
-            junctionTable.insert(road.destJunction, dest);
+        if (road.isTwoWay) {
+            if (Junction* dest = junctionTable.find(road.destJunction)) {
+                dest->connectedJunctions.push_back(road.sourceJunction);
+            }
         }
     }
 
     bool getRoad(int id, Road* result) const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         return roadTable.search(id, result);
     }
 
     std::vector<Road> getAllRoads() const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         std::vector<Road> result;
-        for (const auto& pair : roadTable.getAll()) {
-            result.push_back(pair.second);
-        }
+        result.reserve(roadTable.size());
+        roadTable.scan([&](const int&, const Road& road) {
+            result.push_back(road);
+            return true;
+        });
         return result;
     }
 
+    // IDs of the roads in [offset, offset + limit) of the listing, in insertion order
+    std::vector<int> pageRoadIds(size_t offset, size_t limit, size_t* total) const {
+        ReadLock lock(dataMutex);
+        std::vector<int> ids;
+        *total = roadTable.size();
+        if (limit == 0) return ids;
+        size_t position = 0;
+        roadTable.scan([&](const int& id, const Road&) {
+            if (position++ >= offset) ids.push_back(id);
+            return ids.size() < limit;
+        });
+        return ids;
+    }
+
+    // visit(road) for each of the IDs, in one lock hold and without copies
+    template <typename Visit>
+    void visitRoads(const int* ids, size_t count, Visit visit) const {
+        ReadLock lock(dataMutex);
+        for (size_t i = 0; i < count; ++i) {
+            if (const Road* road = roadTable.find(ids[i])) visit(*road);
+        }
+    }
+
     bool updateTrafficLevel(int roadId, TrafficLevel level) {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        WriteLock lock(dataMutex);
         
-        Road road;
-        if (!roadTable.search(roadId, &road)) {
+        Road* stored = roadTable.find(roadId);
+        if (!stored) {
             return false;
         }
         
-        road.trafficLevel = level;
-        roadTable.insert(roadId, road);
+        double previous = getTrafficMultiplier(stored->trafficLevel);
+        stored->trafficLevel = level;
+        const Road& road = *stored;
+        roadsVersion++;
         
         double multiplier = getTrafficMultiplier(level);
         if (road.isTwoWay) {
@@ -617,7 +830,11 @@ public:
                                       road.destJunction, multiplier);
         }
         
-        invalidateCache();
+        // Routes through the road show its traffic; if it got faster, any
+        // time-optimized route may now have a better alternative through it
+        std::vector<uint64_t> segments = {RouteCache::segmentId(road.sourceJunction, road.destJunction)};
+        if (road.isTwoWay) segments.push_back(RouteCache::segmentId(road.destJunction, road.sourceJunction));
+        routeCache.invalidate(segments, multiplier < previous);
         return true;
     }
 
@@ -627,85 +844,106 @@ public:
 
     // ==================== FIXED Route Finding ====================
 
-    RouteResult findRoute(int sourceId, int destId, bool useTime = true) {
-        std::string cacheKey = generateCacheKey(sourceId, destId, useTime);
-    
-        {
-            std::lock_guard<std::mutex> lock(cacheMutex);
-            RouteResult cached;
-            if (routeCache.get(cacheKey, &cached)) {
-                return cached;
-            }
-        }
-    
-        PathResult pathResult;
-        {
-            std::lock_guard<std::mutex> lock(dataMutex);
-            pathResult = roadNetwork.dijkstra(sourceId, destId, useTime);
+    // With alternatives > 0, also up to that many alternative routes
+    // (plateau method, Dijkstra trees; algorithm is then not used)
+    RouteResult findRoute(int sourceId, int destId, bool useTime = true,
+                          RouteAlgorithm algorithm = RouteAlgorithm::HIERARCHY,
+                          int alternatives = 0) {
+        uint64_t cacheKey = 0;
+        bool cacheable = RouteCache::makeKey(sourceId, destId, useTime, algorithm, alternatives, &cacheKey);
+        RouteResult cached;
+        if (cacheable) {
+            Metrics::Timer lookup(Metric::ROUTE_CACHE_LOOKUP);
+            bool hit = routeCache.get(cacheKey, &cached);
+            lookup.stop();
+            if (hit) return cached;
         }
+        Metrics::Timer searchTimer(Metric::ROUTE_SEARCH);
     
+        // Searches share the lock; they only read the frozen graph
+        ReadLock lock(dataMutex, std::defer_lock);
+        lockFrozen(lock);
+
+        RouteArena::Scope arena;   // transient search data, released on return
         RouteResult result;
-        result.found = pathResult.found;
-        result.totalDistance = pathResult.totalDistance;
-        result.totalTime = pathResult.totalTime;
-    
-        if (pathResult.found) {
-            std::lock_guard<std::mutex> lock(dataMutex);
-        
-            // Populate complete junction details
-            for (int junctionId : pathResult.path) {
-                Junction j;
-                if (junctionTable.search(junctionId, &j)) {
-                    result.junctions.push_back(j);
-                }
-            }
-        
-            // Build traffic segments for visualization
-            for (size_t i = 0; i < pathResult.path.size() - 1; ++i) {
-                int fromId = pathResult.path[i];
-                int toId = pathResult.path[i + 1];
-            
-                const Edge* edge = roadNetwork.getEdge(fromId, toId);
-                if (edge) {
-                    // Determine traffic level from multiplier
-                    TrafficLevel level = TrafficLevel::NORMAL;
-                    if (edge->trafficMultiplier <= 0.8) {
-                        level = TrafficLevel::LOW;
-                    } else if (edge->trafficMultiplier <= 1.0) {
-                        level = TrafficLevel::NORMAL;
-                    } else if (edge->trafficMultiplier <= 1.5) {
-                        level = TrafficLevel::HEAVY;
-                    } else {
-                        level = TrafficLevel::SEVERE;
-                    }
-                
-                    TrafficSegment segment(
-                        fromId,
-                        toId,
-                        edge->roadName,
-                        edge->distance,
-                        edge->getActualTime(),
-                        level
-                    );
-                    result.trafficSegments.push_back(segment);
+        std::vector<uint64_t> segments;
+        if (alternatives > 0) {
+            Metrics::Timer graphTimer(Metric::GRAPH_SEARCH);
+            std::vector<PathResult> paths =
+                roadNetwork.findAlternativePaths(sourceId, destId, alternatives, useTime);
+            graphTimer.stop();
+            if (!paths.empty()) {
+                Metrics::record(Metric::SETTLED_NODES, static_cast<uint64_t>(paths[0].settledNodes));
+                result = describeRoute(paths[0], &segments);
+                for (size_t i = 1; i < paths.size(); ++i) {
+                    result.alternatives.push_back(describeRoute(paths[i], &segments));
                 }
             }
+        } else {
+            PathResult path = timedSearch([&]() { return roadNetwork.findPath(sourceId, destId, useTime, algorithm); });
+            result = describeRoute(path, &segments);
         }
     
-        {
-            std::lock_guard<std::mutex> lock(cacheMutex);
-            routeCache.put(cacheKey, result);
-        }
+        // Still under the data lock: an update cannot invalidate in between
+        if (cacheable) routeCache.put(cacheKey, result, std::move(segments));
+        recordRouteSearch(arena);
     
         return result;
     }
 
+    // Fastest route leaving at depart (minute of the week, Monday 00:00 = 0),
+    // following the roads' time-of-day profiles. Not cached: the key has
+    // no room for a departure time, and each one is a different route.
+    RouteResult findRouteDepartingAt(int sourceId, int destId, double depart) {
+        Metrics::Timer searchTimer(Metric::ROUTE_SEARCH);
+        ReadLock lock(dataMutex, std::defer_lock);
+        lockFrozen(lock);
+        RouteArena::Scope arena;
+        std::vector<uint64_t> segments;
+        PathResult path = timedSearch([&]() { return roadNetwork.timeDependentPath(sourceId, destId, depart); });
+        RouteResult result = describeRoute(path, &segments);
+        result.algorithm = "timedependent";
+        recordRouteSearch(arena);
+        return result;
+    }
+
+    // Travel time and distance for every source -> target pair, one bounded
+    // search per source; the requesting thread and matrixPool's fixed
+    // helpers share the rows, so concurrent requests never add threads
+    MatrixResult findRouteMatrix(const std::vector<int>& sources, const std::vector<int>& targets,
+                                 bool useTime = true) {
+        ReadLock lock(dataMutex, std::defer_lock);
+        lockFrozen(lock);
+        return roadNetwork.costMatrix(sources, targets, useTime, &matrixPool);
+    }
+
+    // Junctions reachable from sourceId within budget (minutes, or km when
+    // !useTime), cheapest first; hull gets their convex outline if given
+    int findReachable(int sourceId, double budget, bool useTime,
+                      std::vector<ReachableJunction>* result,
+                      std::vector<GeoPoint>* hull = nullptr) {
+        ReadLock lock(dataMutex, std::defer_lock);
+        lockFrozen(lock);
+        int settled = roadNetwork.reachableWithin(sourceId, budget, useTime, result);
+        if (hull) {
+            std::vector<GeoPoint> points;
+            points.reserve(result->size());
+            for (const ReachableJunction& reachable : *result) {
+                if (const Junction* junction = junctionTable.find(reachable.id)) {
+                    points.push_back(GeoPoint(junction->latitude, junction->longitude));
+                }
+            }
+            *hull = convexHull(std::move(points));
+        }
+        return settled;
+    }
+
     RouteResult findRouteByName(const std::string& sourceName, 
                                 const std::string& destName,
                                 bool useTime = true) {
         int sourceId, destId;
         {
-            std::lock_guard<std::mutex> lock(dataMutex);
+            ReadLock lock(dataMutex);
             if (!junctionNameIndex.search(sourceName, &sourceId) ||
                 !junctionNameIndex.search(destName, &destId)) {
                 return RouteResult();
@@ -787,89 +1025,454 @@ public:
     //     return findRoute(sourceId, destId, useTime);
     // }
 
+    // Freeze the road network into its compact CSR form.
+    // Call once after the network is generated (see OSMLoader::generateRoadNetwork).
+    void freezeRoadNetwork() {
+        WriteLock lock(dataMutex);
+        
+        auto startTime = std::chrono::high_resolution_clock::now();
+        size_t bytesBefore = roadNetwork.getMemoryUsage();
+        roadNetwork.freeze();
+        size_t bytesAfter = roadNetwork.getMemoryUsage();
+
+        // Loading is done: fold pending inserts into the search indices
+        spatialIndex.rebuild();
+        autocompleteIndex.rebuild();
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        
+        std::cout << "🧊 Road network frozen (CSR): " << roadNetwork.getNumVertices()
+                  << " vertices, " << roadNetwork.getNumEdges() << " edges, "
+                  << roadNetwork.compact().getNumRoadNames() << " road names\n";
+        std::cout << "   Memory: " << (bytesBefore / (1024 * 1024)) << " MB -> "
+                  << (bytesAfter / (1024 * 1024)) << " MB in " << duration.count() << " ms\n";
+        std::cout << "🔤 Autocomplete trie: " << autocompleteIndex.size() << " names, "
+                  << autocompleteIndex.getNumNodes() << " nodes ("
+                  << (autocompleteIndex.memoryUsageBytes() / 1024) << " KB)\n";
+    }
+
+    // Precompute the inter-city route hierarchy (portal trees per city).
+    // Optional; call after freezeRoadNetwork(). Traffic updates then only
+    // re-customize the affected time-metric trees (see RouteHierarchy);
+    // road edits drop it until the next freeze rebuilds it.
+    void prepareRouteHierarchy() {
+        {
+            WriteLock lock(dataMutex);
+
+            auto startTime = std::chrono::high_resolution_clock::now();
+            std::unordered_map<std::string, int> cityIds;
+            std::unordered_map<int, int> cellOf;
+            junctionTable.scan([&](const int& id, const Junction& junction) {
+                auto it = cityIds.emplace(junction.city, static_cast<int>(cityIds.size())).first;
+                cellOf[id] = it->second;
+                return true;
+            });
+
+            size_t portals = roadNetwork.buildHierarchy(cellOf);
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+
+            if (portals == 0) {
+                std::cout << "⚠️  Route hierarchy skipped: no usable inter-city portals\n";
+                return;
+            }
+            std::cout << "🏔️  Route hierarchy: " << portals << " portals across "
+                      << cityIds.size() << " cities, "
+                      << (roadNetwork.getHierarchyMemoryUsage() / (1024 * 1024)) << " MB in "
+                      << duration.count() << " ms\n";
+        }
+        invalidateCache();
+    }
+
+    // ==================== Traffic Profiles ====================
+
+    // Weekly rush-hour profiles by road class (speed limit): arterials
+    // carry the sharpest peaks, highways and local streets milder ones.
+    // Used by departure-time routing; live traffic levels still drive
+    // plain routes. Call after the road network is generated.
+    void applyDefaultTrafficProfiles() {
+        WriteLock lock(dataMutex);
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        uint16_t highway = roadNetwork.addTrafficProfile(TrafficProfileTable::commuterWeek(1.3, 1.4, 0.9));
+        uint16_t arterial = roadNetwork.addTrafficProfile(TrafficProfileTable::commuterWeek(1.8, 2.1, 0.8));
+        uint16_t local = roadNetwork.addTrafficProfile(TrafficProfileTable::commuterWeek(1.3, 1.5, 0.9));
+
+        size_t assigned = 0;
+        roadTable.scan([&](const int&, const Road& road) {
+            uint16_t profile = road.speedLimit >= 90 ? highway : road.speedLimit >= 55 ? arterial : local;
+            if (roadNetwork.setTrafficProfile(road.sourceJunction, road.destJunction, profile)) assigned++;
+            if (road.isTwoWay) roadNetwork.setTrafficProfile(road.destJunction, road.sourceJunction, profile);
+            return true;
+        });
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        std::cout << "🕒 Traffic profiles: " << roadNetwork.getNumTrafficProfiles() << " weekly profiles on "
+                  << assigned << " roads, " << (roadNetwork.getTrafficProfileMemoryUsage() / 1024)
+                  << " KB in " << duration.count() << " ms\n";
+    }
+
     void invalidateCache() {
-        std::lock_guard<std::mutex> lock(cacheMutex);
         routeCache.clear();
     }
 
     // ==================== Statistics ====================
 
     int getJunctionCount() const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         return junctionTable.size();
     }
 
     int getRoadCount() const {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         return roadTable.size();
     }
 
+    // Data versions for response caching (read before reading the data)
+    uint64_t getJunctionsVersion() const { return junctionsVersion; }
+    uint64_t getRoadsVersion() const { return roadsVersion; }
+
     double getCacheHitRate() const {
-        std::lock_guard<std::mutex> lock(cacheMutex);
         return routeCache.getHitRate();
     }
 
+    std::vector<RouteCache::ShardStats> getRouteCacheStats() const {
+        return routeCache.getShardStats();
+    }
+
+    struct RouteAllocationStats {
+        uint64_t searches;           // route requests that ran a search (cache misses)
+        uint64_t arenaAllocations;   // transient allocations served by the per-thread arena
+        uint64_t arenaBytes;
+        uint64_t heapAllocations;    // arena blocks that had to come from the heap
+    };
+
+    RouteAllocationStats getRouteAllocationStats() const {
+        return RouteAllocationStats{routeSearches, routeArenaAllocations, routeArenaBytes, routeHeapAllocations};
+    }
+
+    struct RouteHierarchyStats {
+        bool ready;                  // inter-city queries use the portal trees
+        size_t portals;
+        size_t customizations;       // traffic updates applied in place
+        uint64_t rebuilds;           // rebuilt by a freeze after a network edit
+        uint64_t rebuildFailures;    // lost after an edit: plain search only
+    };
+
+    RouteHierarchyStats getRouteHierarchyStats() const {
+        ReadLock lock(dataMutex);
+        const RouteHierarchy& hierarchy = roadNetwork.getHierarchy(true);
+        return RouteHierarchyStats{hierarchy.isReady(), hierarchy.getNumPortals(), roadNetwork.getHierarchyCustomizations(),
+                                   roadNetwork.getHierarchyRebuilds(), roadNetwork.getHierarchyRebuildFailures()};
+    }
+
+    struct IndexMetrics {
+        BPlusTree<std::string, int>::BPlusTreeMetrics nameIndex;
+        size_t cityCount;
+        FlatHashTableMetrics junctionTable;
+        FlatHashTableMetrics roadTable;
+    };
+
+    // Shape of the junction indices (walks the tree and both hash indices)
+    IndexMetrics getIndexMetrics() const {
+        ReadLock lock(dataMutex);
+        return IndexMetrics{junctionNameIndex.getMetrics(), cityIndex.size(), junctionTable.getMetrics(),
+                            roadTable.getMetrics()};
+    }
+
     void printStatistics() const {
         std::cout << "\n=== Traffic Manager Statistics ===\n";
         std::cout << "Junctions: " << getJunctionCount() << "\n";
-        std::cout << "  - OSM Junctions: " << (getJunctionCount() - (nextNominatimJunctionId - 10000)) << "\n";
-        std::cout << "  - Nominatim Results: " << (nextNominatimJunctionId - 10000) << "\n";
+        std::cout << "  - OSM Junctions: " << (getJunctionCount() - geocodedJunctions.load()) << "\n";
+        std::cout << "  - Nominatim Results: " << geocodedJunctions.load() << "\n";
         std::cout << "Roads: " << getRoadCount() << "\n";
         std::cout << "Graph Vertices: " << roadNetwork.getNumVertices() << "\n";
         std::cout << "Graph Edges: " << roadNetwork.getNumEdges() << "\n";
+        std::cout << "Graph Memory: " << (roadNetwork.getMemoryUsage() / 1024) << " KB"
+                  << (roadNetwork.isFrozen() ? " (CSR)" : " (adjacency list)") << "\n";
+        std::cout << "Name Index: " << junctionNameIndex.size() << " names (B+Tree, height "
+                  << junctionNameIndex.getHeight() << ", " << cityIndex.size() << " cities)\n";
+        std::cout << "Fuzzy Name Index: " << fuzzyNameIndex.size() << " names, "
+                  << fuzzyNameIndex.getNumTrigrams() << " trigrams ("
+                  << (fuzzyNameIndex.memoryUsageBytes() / 1024) << " KB)\n";
+        std::cout << "Autocomplete Trie: " << autocompleteIndex.size() << " names, "
+                  << autocompleteIndex.getNumNodes() << " nodes ("
+                  << (autocompleteIndex.memoryUsageBytes() / 1024) << " KB)\n";
+        std::cout << "Spatial Index: " << spatialIndex.size() << " junctions (k-d tree, "
+                  << (spatialIndex.memoryUsageBytes() / 1024) << " KB)\n";
+        if (roadNetwork.hasHierarchy(true)) {
+            const RouteHierarchy& hierarchy = roadNetwork.getHierarchy(true);
+            std::cout << "Route Hierarchy: " << hierarchy.getNumPortals() << " portals, "
+                      << roadNetwork.getHierarchyCustomizations() << " traffic updates customized ("
+                      << roadNetwork.getHierarchyRepairedVertices() << " tree vertices repaired), "
+                      << roadNetwork.getHierarchyRebuilds() << " rebuilds after edits\n";
+        } else if (roadNetwork.getHierarchyRebuildFailures() > 0) {
+            std::cout << "Route Hierarchy: lost after a network edit (plain search)\n";
+        }
         std::cout << "Cache Hit Rate: " << getCacheHitRate() << "%\n";
         std::cout << "==================================\n";
     }
 
     // ==================== Data Persistence ====================
 
-    bool loadJunctionsFromJson(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "Error: Cannot open file " << filename << "\n";
+    /**
+     * Write junctions, roads, the name and city indices and the frozen
+     * road network to a binary snapshot (see Snapshot.h). source
+     * describes the data it was built from, for loadSnapshot's check.
+     */
+    bool saveSnapshot(const std::string& path, const SnapshotSource& source) const {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        SnapshotWriter writer;
+        StringTable strings;
+        {
+            ReadLock lock(dataMutex);
+            if (!roadNetwork.isFrozen()) return false;
+
+            std::vector<SnapshotJunction> junctions;
+            std::vector<uint32_t> connectionOffsets(1, 0);
+            std::vector<int32_t> connections;
+            junctions.reserve(junctionTable.size());
+            junctionTable.scan([&](const int&, const Junction& junction) {
+                SnapshotJunction record;
+                memset(&record, 0, sizeof(record));
+                record.id = junction.id;
+                record.name = strings.intern(junction.name);
+                record.city = strings.intern(junction.city);
+                record.area = strings.intern(junction.area);
+                record.latitude = junction.latitude;
+                record.longitude = junction.longitude;
+                record.hasTrafficSignal = junction.hasTrafficSignal;
+                record.geocoded = junction.geocoded;
+                junctions.push_back(record);
+                connections.insert(connections.end(), junction.connectedJunctions.begin(),
+                                   junction.connectedJunctions.end());
+                connectionOffsets.push_back(static_cast<uint32_t>(connections.size()));
+                return true;
+            });
+
+            std::vector<SnapshotNameEntry> names;
+            junctionNameIndex.traverse([&](const std::string& name, const int& id) {
+                names.push_back({strings.intern(name), id});
+            });
+
+            std::vector<uint32_t> cityOffsets(1, 0), cityNames;
+            std::vector<int32_t> cityMembers;
+            cityIndex.traverse([&](const std::string& city, const std::vector<int>& ids) {
+                cityNames.push_back(strings.intern(city));
+                cityMembers.insert(cityMembers.end(), ids.begin(), ids.end());
+                cityOffsets.push_back(static_cast<uint32_t>(cityMembers.size()));
+            });
+
+            std::vector<SnapshotRoad> roads;
+            roads.reserve(roadTable.size());
+            roadTable.scan([&](const int&, const Road& road) {
+                SnapshotRoad record;
+                memset(&record, 0, sizeof(record));
+                record.id = road.id;
+                record.name = strings.intern(road.name);
+                record.roadType = strings.intern(road.roadType);
+                record.sourceJunction = road.sourceJunction;
+                record.destJunction = road.destJunction;
+                record.trafficLevel = static_cast<int32_t>(road.trafficLevel);
+                record.distance = road.distance;
+                record.speedLimit = road.speedLimit;
+                record.baseTime = road.baseTime;
+                record.isTwoWay = road.isTwoWay;
+                roads.push_back(record);
+                return true;
+            });
+
+            writer.addArray(SNAP_JUNCTIONS, junctions);
+            writer.addArray(SNAP_CONNECTION_OFFSETS, connectionOffsets);
+            writer.addArray(SNAP_CONNECTIONS, connections);
+            writer.addArray(SNAP_NAME_INDEX, names);
+            writer.addArray(SNAP_CITY_OFFSETS, cityOffsets);
+            writer.addArray(SNAP_CITY_NAMES, cityNames);
+            writer.addArray(SNAP_CITY_MEMBERS, cityMembers);
+            writer.addArray(SNAP_ROADS, roads);
+            roadNetwork.saveSnapshot(writer);
+        }
+        writer.addBytes(SNAP_STRINGS, strings.rawData().data(), strings.rawData().size());
+        writer.addArray(SNAP_STRING_OFFSETS, strings.rawOffsets());
+
+        size_t bytes = writer.writeFile(path, source);
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - startTime);
+        if (bytes == 0) {
+            std::cerr << "Error: Cannot write snapshot " << path << "\n";
             return false;
         }
+        std::cout << "💾 Snapshot written: " << path << " (" << (bytes / (1024 * 1024)) << " MB, "
+                  << writer.getNumSections() << " sections) in " << duration.count() << " ms\n";
+        return true;
+    }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string content = buffer.str();
-        
-        size_t pos = 0;
-        while ((pos = content.find("\"id\":", pos)) != std::string::npos) {
-            Junction j;
-            
-            pos += 5;
-            j.id = std::stoi(content.substr(pos, content.find(",", pos) - pos));
-            
-            pos = content.find("\"name\":", pos) + 8;
-            size_t nameEnd = content.find("\"", pos);
-            j.name = content.substr(pos, nameEnd - pos);
-            
-            pos = content.find("\"latitude\":", pos) + 11;
-            j.latitude = std::stod(content.substr(pos, content.find(",", pos) - pos));
-            
-            pos = content.find("\"longitude\":", pos) + 12;
-            j.longitude = std::stod(content.substr(pos, content.find(",", pos) - pos));
-            
-            pos = content.find("\"city\":", pos) + 8;
-            size_t cityEnd = content.find("\"", pos);
-            j.city = content.substr(pos, cityEnd - pos);
-            
-            pos = content.find("\"area\":", pos) + 8;
-            size_t areaEnd = content.find("\"", pos);
-            j.area = content.substr(pos, areaEnd - pos);
-            
-            addJunction(j);
+    /**
+     * Load a snapshot written by saveSnapshot into an empty manager,
+     * instead of parsing JSON and generating roads. The road network
+     * arrives frozen; the spatial, fuzzy and autocomplete indices are
+     * rebuilt from the junctions. Traffic profiles come with the network,
+     * the route hierarchy does not (call prepareRouteHierarchy()).
+     * @param expected  source the snapshot must have been built from
+     * @return false if the file is missing, stale or damaged (nothing is loaded)
+     */
+    bool loadSnapshot(const std::string& path, const SnapshotSource& expected) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        SnapshotReader reader;
+        if (!reader.open(path, &expected)) return false;
+
+        // Decode and check everything before touching the indices
+        const char* blob;
+        size_t blobLength;
+        const uint32_t* stringOffsets;
+        size_t numStringOffsets;
+        StringTable strings;
+        const SnapshotJunction* junctionRecords;
+        const SnapshotNameEntry* nameRecords;
+        const SnapshotRoad* roadRecords;
+        size_t numJunctions, numNames, numRoads;
+        std::vector<uint32_t> connectionOffsets, cityOffsets, cityNames;
+        std::vector<int32_t> connections, cityMembers;
+
+        bool ok = reader.view(SNAP_STRINGS, &blob, &blobLength) &&
+                  reader.view(SNAP_STRING_OFFSETS, &stringOffsets, &numStringOffsets) &&
+                  strings.assign(blob, blobLength, stringOffsets, numStringOffsets) &&
+                  reader.view(SNAP_JUNCTIONS, &junctionRecords, &numJunctions) &&
+                  reader.read(SNAP_CONNECTION_OFFSETS, &connectionOffsets, static_cast<long long>(numJunctions) + 1) &&
+                  reader.read(SNAP_CONNECTIONS, &connections, connectionOffsets.back()) &&
+                  reader.view(SNAP_NAME_INDEX, &nameRecords, &numNames) &&
+                  reader.read(SNAP_CITY_NAMES, &cityNames) &&
+                  reader.read(SNAP_CITY_OFFSETS, &cityOffsets, static_cast<long long>(cityNames.size()) + 1) &&
+                  reader.read(SNAP_CITY_MEMBERS, &cityMembers, cityOffsets.back()) &&
+                  reader.view(SNAP_ROADS, &roadRecords, &numRoads);
+
+        const uint32_t numStrings = static_cast<uint32_t>(strings.size());
+        for (size_t i = 0; ok && i < numJunctions; ++i) {
+            const SnapshotJunction& r = junctionRecords[i];
+            ok = r.name < numStrings && r.city < numStrings && r.area < numStrings &&
+                 connectionOffsets[i] <= connectionOffsets[i + 1];
         }
-        
+        for (size_t i = 0; ok && i < numNames; ++i) {   // sorted, for bulkLoad
+            ok = nameRecords[i].name < numStrings &&
+                 (i == 0 || strings.get(nameRecords[i - 1].name) < strings.get(nameRecords[i].name));
+        }
+        for (size_t i = 0; ok && i < cityNames.size(); ++i) {
+            ok = cityNames[i] < numStrings && cityOffsets[i] <= cityOffsets[i + 1] &&
+                 (i == 0 || strings.get(cityNames[i - 1]) < strings.get(cityNames[i]));
+        }
+        for (size_t i = 0; ok && i < numRoads; ++i) {
+            const SnapshotRoad& r = roadRecords[i];
+            ok = r.name < numStrings && r.roadType < numStrings &&
+                 r.trafficLevel >= static_cast<int32_t>(TrafficLevel::LOW) &&
+                 r.trafficLevel <= static_cast<int32_t>(TrafficLevel::SEVERE);
+        }
+        ok = ok && connectionOffsets[0] == 0 && cityOffsets[0] == 0;
+        if (!ok) {
+            std::cerr << "Error: Snapshot " << path << " is damaged\n";
+            return false;
+        }
+
+        WriteLock lock(dataMutex);
+        if (junctionTable.size() > 0 || roadTable.size() > 0) return false;
+        if (!roadNetwork.loadSnapshot(reader)) {
+            std::cerr << "Error: Snapshot " << path << " has a damaged road network\n";
+            return false;
+        }
+
+        std::vector<std::pair<int, GeoPoint>> positions;
+        positions.reserve(numJunctions);
+        junctionTable.reserve(numJunctions);
+        int lastId = 0;
+        roadTable.reserve(numRoads);
+        for (size_t i = 0; i < numJunctions; ++i) {
+            const SnapshotJunction& r = junctionRecords[i];
+            Junction junction(r.id, std::string(strings.get(r.name)), r.latitude, r.longitude,
+                              std::string(strings.get(r.city)), std::string(strings.get(r.area)));
+            junction.hasTrafficSignal = r.hasTrafficSignal != 0;
+            junction.geocoded = r.geocoded != 0;
+            junction.connectedJunctions.assign(connections.begin() + connectionOffsets[i],
+                                               connections.begin() + connectionOffsets[i + 1]);
+
+            positions.push_back({junction.id, GeoPoint(junction.latitude, junction.longitude)});
+            fuzzyNameIndex.add(junction.id, normalizeString(junction.name));
+            autocompleteIndex.insert(autocompleteKey(junction.name), junction.id);
+            junctionTable.insert(junction.id, junction);
+            if (!junction.geocoded) lastId = std::max(lastId, junction.id);
+        }
+        geocoder.reserveIds(lastId);
+        std::vector<std::pair<std::string, int>> names;
+        names.reserve(numNames);
+        for (size_t i = 0; i < numNames; ++i) {
+            names.push_back({std::string(strings.get(nameRecords[i].name)), nameRecords[i].junctionId});
+        }
+        junctionNameIndex.bulkLoad(std::move(names));
+        std::vector<std::pair<std::string, std::vector<int>>> cities;
+        cities.reserve(cityNames.size());
+        for (size_t i = 0; i < cityNames.size(); ++i) {
+            cities.push_back({std::string(strings.get(cityNames[i])),
+                              std::vector<int>(cityMembers.begin() + cityOffsets[i],
+                                               cityMembers.begin() + cityOffsets[i + 1])});
+        }
+        cityIndex.bulkLoad(std::move(cities));
+        for (size_t i = 0; i < numRoads; ++i) {
+            const SnapshotRoad& r = roadRecords[i];
+            Road road(r.id, std::string(strings.get(r.name)), r.sourceJunction, r.destJunction,
+                      r.distance, r.speedLimit);
+            road.baseTime = r.baseTime;
+            road.trafficLevel = static_cast<TrafficLevel>(r.trafficLevel);
+            road.isTwoWay = r.isTwoWay != 0;
+            road.roadType = std::string(strings.get(r.roadType));
+            roadTable.insert(road.id, road);
+        }
+
+        spatialIndex.build(positions);
+        autocompleteIndex.rebuild();
+        junctionsVersion++;
+        roadsVersion++;
+        routeCache.clear();
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - startTime);
+        std::cout << "⚡ Snapshot loaded: " << numJunctions << " junctions, " << numRoads << " roads, "
+                  << roadNetwork.getNumEdges() << " edges (" << (reader.getFileSize() / (1024 * 1024))
+                  << " MB) in " << duration.count() << " ms\n";
         return true;
     }
 
+
+    /**
+     * Junction file (object with a "junctions" array, or a bare array),
+     * streamed in chunks. Batches are handed to addJunctions as soon as
+     * they reach the number of junctions already loaded, so each one
+     * takes the bulk path and the rebuilds add up to O(n log n).
+     * Junctions read before a syntax error are kept.
+     */
+    bool loadJunctionsFromJson(const std::string& filename, JunctionJsonReader::Stats* stats = nullptr) {
+        std::vector<Junction> pending;
+        size_t loaded = 0;
+        std::string error;
+        bool ok = JunctionJsonReader::readFile(filename, [&](std::vector<Junction>& batch) {
+            std::move(batch.begin(), batch.end(), std::back_inserter(pending));
+            if (pending.size() >= loaded) {
+                addJunctions(pending);
+                loaded += pending.size();
+                pending.clear();
+            }
+        }, stats, &error);
+        addJunctions(pending);
+        
+        if (!ok) {
+            std::cerr << "Error: " << error << "\n";
+        }
+        return ok;
+    }
+
     // ==================== User & Session Management ====================
     
     bool registerUser(const std::string& username, const std::string& email,
                      const std::string& passwordHash) {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        WriteLock lock(dataMutex);
         
         User existing;
         if (userTree.search(username, &existing)) {
@@ -890,7 +1493,7 @@ public:
     bool authenticateUser(const std::string& username, 
                          const std::string& passwordHash,
                          User* user = nullptr) {
-        std::lock_guard<std::mutex> lock(dataMutex);
+        ReadLock lock(dataMutex);
         
         User u;
         if (!userTree.search(username, &u)) {
@@ -931,73 +1534,40 @@ public:
         return sessionManager.getActiveUsers();
     }
 
-public:
+    // ==================== GEOCODING ====================
 
-    Junction* searchNominatim(const std::string& query, const std::string& city = "") {
-        std::lock_guard<std::mutex> lock(nominatimMutex);
-    
-        // Check cache first
-        Junction cached;
-        std::string cacheKey = query + "_" + city;
-        if (nominatimCache.search(cacheKey, &cached)) {
-            std::cout << "✅ Found in Nominatim cache: " << cached.name << std::endl;
-            return new Junction(cached);
-        }
-
-        // Build SMART query
-        std::string searchQuery = query;
-    
-        // Remove common words that confuse Nominatim
-        std::vector<std::string> removeWords = {"lahore", "karachi", "islamabad", "pakistan"};
-        std::string lowerQuery = query;
-        std::transform(lowerQuery.begin(), lowerQuery.end(), lowerQuery.begin(), ::tolower);
-    
-        for (const auto& word : removeWords) {
-            size_t pos = lowerQuery.find(word);
-            if (pos != std::string::npos) {
-                searchQuery.erase(pos, word.length());
-            }
-        }
-    
-        // Trim spaces
-        searchQuery.erase(0, searchQuery.find_first_not_of(" "));
-        searchQuery.erase(searchQuery.find_last_not_of(" ") + 1);
-    
-        // Add city context
-        if (!city.empty()) {
-            searchQuery += " " + city;
-        }
-        searchQuery += " Pakistan";
-    
-        std::string encodedQuery = urlEncode(searchQuery);
-    
-        // Build URL path
-        std::string path = "/search?q=" + encodedQuery +
-                          "&format=json&limit=1&countrycodes=pk";
+    // Places found by earlier runs; new answers are appended to the same file
+    size_t loadGeocodeCache(const std::string& path) {
+        return geocoder.load(path);
+    }
 
-        std::cout << "🌍 Searching Nominatim for: " << searchQuery << std::endl;
-    
-        // Make request
-        std::string response = makeHttpRequest(path);
-        if (response.empty()) {
-            return nullptr;
+    /**
+     * Look a place up on Nominatim without holding any lock while it is
+     * asked. With wait, blocks until the answer is in; otherwise returns
+     * PENDING while the lookup is queued or in flight (asking again later
+     * joins the same lookup). A place that is found is added to the
+     * network and copied to *out.
+     */
+    GeocodeStatus geocodePlace(const std::string& query, const std::string& city, bool wait, Junction* out) {
+        std::shared_future<GeocodeResult> answer = geocoder.lookup(query, city);
+        if (!wait && answer.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return GeocodeStatus::PENDING;
         }
+        const GeocodeResult& result = answer.get();
+        if (!result.found) return GeocodeStatus::NOT_FOUND;
+        addGeocodedJunction(result.junction);
+        if (out) *out = result.junction;
+        return GeocodeStatus::FOUND;
+    }
 
-        // Parse response
-        Junction* newJunction = parseNominatimResponse(response, query);
-    
-        if (newJunction) {
-            nominatimCache.insert(cacheKey, *newJunction);
-            std::cout << "✅ Found via Nominatim: " << newJunction->name 
-                      << " at (" << newJunction->latitude << ", " << newJunction->longitude << ")" << std::endl;
-        }
-
-        // Rate limiting
-        std::this_thread::sleep_for(std::chrono::seconds(1));
-
-        return newJunction;
+    // How long a lookup queued now should take to be answered
+    std::chrono::milliseconds getGeocodeWait() const {
+        return geocoder.estimatedWait();
     }
 
+    Geocoder::Stats getGeocoderStats() const {
+        return geocoder.getStats();
+    }
 };
 
 #endif // TRAFFICMANAGER_H
@@ -0,0 +1,184 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Time-of-Day Traffic Profile Implementation
+ *
+ * Weekly congestion profiles for departure-time routing: 672 slots of
+ * 15 minutes (Monday 00:00 first), each a traffic multiplier quantized to
+ * one byte. Roads share profiles by ID, so the whole table is a few KB
+ * and every edge only stores a 16-bit profile ID.
+ * Travel through an edge is integrated slot by slot: the edge's free-flow
+ * time is used up at a rate of 1 / multiplier, so a trip that crosses
+ * into rush hour slows down part-way. Leaving later therefore never
+ * arrives earlier (FIFO), which keeps time-dependent Dijkstra exact.
+ * Time Complexity: O(1) per edge that stays in one slot, O(slots crossed) otherwise
+ */
+
+#ifndef TRAFFICPROFILE_H
+#define TRAFFICPROFILE_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+const int PAKISTAN_UTC_OFFSET_MINUTES = 5 * 60;   // PKT, no daylight saving
+
+// ==================== WEEK TIME ====================
+
+const int MINUTES_PER_WEEK = 7 * 24 * 60;
+
+// Minute of the week (Monday 00:00 = 0) of a Unix time, in a fixed UTC offset
+inline double minuteOfWeekFromUnix(int64_t seconds, int utcOffsetMinutes = PAKISTAN_UTC_OFFSET_MINUTES) {
+    int64_t minutes = seconds / 60 + utcOffsetMinutes;
+    int64_t sinceMonday = (minutes + 3 * 24 * 60) % MINUTES_PER_WEEK;   // 1970-01-01 was a Thursday
+    if (sinceMonday < 0) sinceMonday += MINUTES_PER_WEEK;
+    return static_cast<double>(sinceMonday) + static_cast<double>(seconds % 60) / 60.0;
+}
+
+// Minute of the week of a local calendar date and time (proleptic Gregorian)
+inline double minuteOfWeekFromCivil(int year, int month, int day, int hour, int minute) {
+    // Days since 1970-01-01 (H. Hinnant's days_from_civil)
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = era * 146097 + dayOfEra - 719468;
+
+    int64_t weekday = (days + 3) % 7;   // Monday = 0
+    if (weekday < 0) weekday += 7;
+    return static_cast<double>(weekday * 24 * 60 + hour * 60 + minute);
+}
+
+// ==================== PROFILE TABLE ====================
+
+class TrafficProfileTable {
+public:
+    typedef uint16_t ProfileId;
+
+    static constexpr int SLOT_MINUTES = 15;
+    static constexpr int SLOTS_PER_WEEK = MINUTES_PER_WEEK / SLOT_MINUTES;   // 672
+    static constexpr double MULTIPLIER_STEP = 1.0 / 32;   // byte 32 = 1.0, range 0.03 .. 7.97
+    static const ProfileId NONE = 0;                      // no profile: use the live multiplier
+
+private:
+    std::vector<uint8_t> slots;   // profile p occupies [(p - 1) * SLOTS_PER_WEEK, p * SLOTS_PER_WEEK)
+    std::unordered_map<std::string, ProfileId> byContent;   // deduplicates identical profiles
+
+    static uint8_t quantize(double multiplier) {
+        double q = std::round(multiplier / MULTIPLIER_STEP);
+        return static_cast<uint8_t>(std::min(255.0, std::max(1.0, q)));
+    }
+
+public:
+    /**
+     * Add a profile of SLOTS_PER_WEEK multipliers (shorter input repeats,
+     * e.g. 96 values for one day); identical profiles share one ID.
+     * @return its ID, NONE if the input is empty or the table is full
+     */
+    ProfileId add(const std::vector<double>& multipliers) {
+        if (multipliers.empty()) return NONE;
+        std::string packed(SLOTS_PER_WEEK, '\0');
+        for (int s = 0; s < SLOTS_PER_WEEK; ++s) {
+            packed[s] = static_cast<char>(quantize(multipliers[s % multipliers.size()]));
+        }
+
+        auto it = byContent.find(packed);
+        if (it != byContent.end()) return it->second;
+        if (size() >= 65535) return NONE;
+
+        slots.insert(slots.end(), packed.begin(), packed.end());
+        ProfileId id = static_cast<ProfileId>(size());
+        byContent.emplace(std::move(packed), id);
+        return id;
+    }
+
+    double multiplier(ProfileId profile, int slot) const {
+        return slots[(profile - 1) * SLOTS_PER_WEEK + slot] * MULTIPLIER_STEP;
+    }
+
+    /**
+     * Arrival time (minutes of the week, may run past MINUTES_PER_WEEK)
+     * after an edge with baseTime minutes of free-flow travel entered at
+     * depart. Each slot uses up (time spent / multiplier) of the base time.
+     */
+    double arrival(ProfileId profile, double baseTime, double depart) const {
+        const uint8_t* week = &slots[(profile - 1) * SLOTS_PER_WEEK];
+        double t = depart;
+        double remaining = baseTime;   // free-flow minutes still to travel
+        for (;;) {
+            double slotIndex = std::floor(t / SLOT_MINUTES);
+            double slotEnd = (slotIndex + 1) * SLOT_MINUTES;
+            int slot = static_cast<int>(std::fmod(slotIndex, SLOTS_PER_WEEK));
+            if (slot < 0) slot += SLOTS_PER_WEEK;
+            double m = week[slot] * MULTIPLIER_STEP;
+
+            if (t + remaining * m <= slotEnd) return t + remaining * m;
+            remaining -= (slotEnd - t) / m;
+            t = slotEnd;
+        }
+    }
+
+    size_t size() const { return slots.size() / SLOTS_PER_WEEK; }
+
+    size_t memoryUsageBytes() const { return slots.capacity(); }
+
+    void clear() {
+        slots.clear();
+        byContent.clear();
+    }
+
+    // Raw slots for snapshots, size() * SLOTS_PER_WEEK bytes
+    const std::vector<uint8_t>& rawSlots() const { return slots; }
+
+    // Replace the table with raw slots (see rawSlots); false if malformed
+    bool assign(const uint8_t* bytes, size_t length) {
+        if (length % SLOTS_PER_WEEK != 0 || length / SLOTS_PER_WEEK > 65535) return false;
+        if (std::find(bytes, bytes + length, 0) != bytes + length) return false;   // arrival() divides by it
+        clear();
+        slots.assign(bytes, bytes + length);
+        for (size_t p = 0; p < size(); ++p) {
+            std::string packed(reinterpret_cast<const char*>(&slots[p * SLOTS_PER_WEEK]), SLOTS_PER_WEEK);
+            byContent.emplace(std::move(packed), static_cast<ProfileId>(p + 1));
+        }
+        return true;
+    }
+
+    /**
+     * Commuter week: free-flowing nights, morning and evening peaks on
+     * working days (Monday to Saturday), the Friday prayer midday slowdown
+     * and a lighter Sunday. Peaks ramp over an hour on either side.
+     */
+    static std::vector<double> commuterWeek(double morningPeak, double eveningPeak, double night) {
+        auto ramp = [](double minute, double start, double end, double peak) {
+            const double rampMinutes = 60;
+            if (minute <= start - rampMinutes || minute >= end + rampMinutes) return 1.0;
+            if (minute < start) return 1.0 + (peak - 1.0) * (minute - start + rampMinutes) / rampMinutes;
+            if (minute > end) return 1.0 + (peak - 1.0) * (end + rampMinutes - minute) / rampMinutes;
+            return peak;
+        };
+
+        std::vector<double> week(SLOTS_PER_WEEK);
+        for (int s = 0; s < SLOTS_PER_WEEK; ++s) {
+            int day = s / (24 * 60 / SLOT_MINUTES);
+            double minute = (s % (24 * 60 / SLOT_MINUTES)) * SLOT_MINUTES + SLOT_MINUTES / 2.0;
+
+            double m = 1.0;
+            if (minute < 6 * 60 || minute >= 23 * 60) {
+                m = night;
+            } else if (day == 6) {   // Sunday
+                m = ramp(minute, 17 * 60, 20 * 60, 1.0 + (eveningPeak - 1.0) * 0.5);
+            } else {
+                m = std::max(ramp(minute, 8 * 60, 9 * 60 + 30, morningPeak),
+                             ramp(minute, 17 * 60, 19 * 60 + 30, eveningPeak));
+                if (day == 4) m = std::max(m, ramp(minute, 12 * 60 + 30, 14 * 60, morningPeak * 0.9));
+            }
+            week[s] = m;
+        }
+        return week;
+    }
+};
+
+#endif // TRAFFICPROFILE_H
@@ -0,0 +1,189 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Trigram Inverted Index Implementation
+ *
+ * Maps every 3-character window of a (pre-normalized) name to the names
+ * containing it. Names are padded with two sentinels on each side, so a
+ * name of length n has n + 2 trigrams and every edit operation changes at
+ * most 3 of them (q-gram lemma). A fuzzy query only visits names sharing
+ * at least one trigram and learns how many they share, which is enough to
+ * discard most of them before any edit distance is computed.
+ * Time Complexity: O(n) insert, O(sum of visited posting lists) per query
+ */
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+class TrigramIndex {
+public:
+    static const size_t GRAM = 3;
+
+    struct Entry {
+        int id;
+        std::string text;    // normalized name
+        bool alive;          // false once replaced by a later add() of the same id
+    };
+
+private:
+    struct Posting {
+        uint32_t entry;
+        uint32_t count;      // occurrences of the trigram in the entry
+    };
+
+    std::vector<Entry> entries;
+    std::unordered_map<uint32_t, std::vector<Posting>> postings;   // trigram -> entries
+    std::unordered_map<int, uint32_t> entryById;
+    std::vector<uint32_t> shortEntries;   // too short to contain an unpadded trigram
+
+    // Per-query scratch, one per thread so queries can run concurrently
+    struct Scratch {
+        std::vector<uint32_t> stamps;   // generation that last touched each entry
+        std::vector<uint32_t> shared;
+        std::vector<uint32_t> touched;
+        uint32_t generation = 0;
+    };
+
+    static Scratch& scratchForThread() {
+        thread_local Scratch scratch;
+        return scratch;
+    }
+
+    static uint32_t pack(unsigned char a, unsigned char b, unsigned char c) {
+        return (static_cast<uint32_t>(a) << 16) | (static_cast<uint32_t>(b) << 8) | c;
+    }
+
+    // Padded trigrams with multiplicity, sorted by key
+    static std::vector<std::pair<uint32_t, uint32_t>> trigrams(const std::string& text) {
+        std::vector<uint32_t> keys;
+        keys.reserve(text.size() + GRAM - 1);
+        auto at = [&text](size_t i) -> unsigned char {
+            // Position i in the padded string "\0\0" + text + "\0\0"
+            return (i < GRAM - 1 || i >= text.size() + GRAM - 1)
+                   ? 0 : static_cast<unsigned char>(text[i - (GRAM - 1)]);
+        };
+        for (size_t i = 0; i + GRAM <= text.size() + 2 * (GRAM - 1); ++i) {
+            keys.push_back(pack(at(i), at(i + 1), at(i + 2)));
+        }
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<std::pair<uint32_t, uint32_t>> counted;
+        for (uint32_t key : keys) {
+            if (!counted.empty() && counted.back().first == key) {
+                counted.back().second++;
+            } else {
+                counted.push_back({key, 1});
+            }
+        }
+        return counted;
+    }
+
+public:
+    TrigramIndex() {}
+
+    // Index (or re-index) the normalized text of id - O(length)
+    void add(int id, const std::string& text) {
+        auto existing = entryById.find(id);
+        if (existing != entryById.end()) {
+            entries[existing->second].alive = false;
+        }
+
+        uint32_t index = static_cast<uint32_t>(entries.size());
+        entries.push_back({id, text, true});
+        entryById[id] = index;
+
+        if (text.size() < GRAM) {
+            shortEntries.push_back(index);
+        }
+        for (const auto& gram : trigrams(text)) {
+            postings[gram.first].push_back({index, gram.second});
+        }
+    }
+
+    /**
+     * Visit every live entry sharing at least one trigram with query:
+     * visit(entry, sharedTrigrams), where sharedTrigrams counts common
+     * trigrams with multiplicity. Entries too short to hold an unpadded
+     * trigram are always visited (possibly with a count of 0).
+     */
+    template <typename Visit>
+    void forEachCandidate(const std::string& query, Visit visit) const {
+        Scratch& scratch = scratchForThread();
+        std::vector<uint32_t>& stamps = scratch.stamps;
+        std::vector<uint32_t>& shared = scratch.shared;
+        std::vector<uint32_t>& touched = scratch.touched;
+        if (stamps.size() < entries.size()) {
+            stamps.resize(entries.size(), 0);
+            shared.resize(entries.size(), 0);
+        }
+        if (++scratch.generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            scratch.generation = 1;
+        }
+        const uint32_t generation = scratch.generation;
+        touched.clear();
+
+        auto touch = [&](uint32_t entry, uint32_t count) {
+            if (stamps[entry] != generation) {
+                stamps[entry] = generation;
+                shared[entry] = 0;
+                touched.push_back(entry);
+            }
+            shared[entry] += count;
+        };
+
+        for (const auto& gram : trigrams(query)) {
+            auto it = postings.find(gram.first);
+            if (it == postings.end()) continue;
+            for (const Posting& posting : it->second) {
+                touch(posting.entry, std::min(gram.second, posting.count));
+            }
+        }
+        for (uint32_t entry : shortEntries) {
+            touch(entry, 0);
+        }
+
+        for (uint32_t entry : touched) {
+            if (entries[entry].alive) {
+                visit(entries[entry], shared[entry]);
+            }
+        }
+    }
+
+    // Visit every live entry (fallback for queries too short to filter)
+    template <typename Visit>
+    void forEachEntry(Visit visit) const {
+        for (const Entry& entry : entries) {
+            if (entry.alive) visit(entry);
+        }
+    }
+
+    // Trigrams of a text of the given length (with padding)
+    static size_t trigramCount(size_t length) { return length + GRAM - 1; }
+
+    size_t size() const { return entryById.size(); }
+    size_t getNumTrigrams() const { return postings.size(); }
+
+    size_t memoryUsageBytes() const {
+        size_t bytes = entries.capacity() * sizeof(Entry);
+        for (const Entry& entry : entries) bytes += entry.text.capacity();
+        for (const auto& list : postings) {
+            bytes += sizeof(list) + list.second.capacity() * sizeof(Posting);
+        }
+        return bytes;
+    }
+
+    void clear() {
+        entries.clear();
+        postings.clear();
+        entryById.clear();
+        shortEntries.clear();
+    }
+};
+
+#endif // TRIGRAMINDEX_H
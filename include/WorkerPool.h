@@ -0,0 +1,155 @@
+/**
+ * Smart Traffic Route Optimizer
+ * Worker Pool Implementation
+ *
+ * Fixed number of threads serving a bounded FIFO task queue. Submitting
+ * never blocks: when the queue is full the task is rejected so the caller
+ * can shed load (e.g. answer 503) instead of piling up threads.
+ * Tracks queue depth, high-water mark and time spent waiting in the queue.
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+class WorkerPool {
+public:
+    struct Stats {
+        size_t workers;
+        size_t capacity;
+        size_t queueDepth;       // tasks waiting right now
+        size_t maxQueueDepth;    // high-water mark since start
+        size_t busyWorkers;
+        uint64_t submitted;
+        uint64_t rejected;       // queue was full
+        uint64_t completed;
+        double avgQueueWaitMs;
+        double maxQueueWaitMs;
+    };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Task {
+        std::function<void()> run;
+        Clock::time_point queuedAt;
+    };
+
+    std::vector<std::thread> threads;
+    std::deque<Task> queue;
+    size_t capacity;
+    bool stopping;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+
+    // Guarded by mutex
+    size_t maxQueueDepth;
+    size_t busyWorkers;
+    uint64_t submitted;
+    uint64_t rejected;
+    uint64_t completed;
+    double totalWaitMs;
+    double maxWaitMs;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            available.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) return;   // stopping and drained
+
+            Task task = std::move(queue.front());
+            queue.pop_front();
+            double waitMs = std::chrono::duration<double, std::milli>(Clock::now() - task.queuedAt).count();
+            totalWaitMs += waitMs;
+            maxWaitMs = std::max(maxWaitMs, waitMs);
+            busyWorkers++;
+
+            lock.unlock();
+            task.run();
+            lock.lock();
+
+            busyWorkers--;
+            completed++;
+        }
+    }
+
+public:
+    WorkerPool(size_t workerCount, size_t maxQueued)
+        : capacity(std::max<size_t>(1, maxQueued)), stopping(false), maxQueueDepth(0),
+          busyWorkers(0), submitted(0), rejected(0), completed(0), totalWaitMs(0), maxWaitMs(0) {
+        workerCount = std::max<size_t>(1, workerCount);
+        threads.reserve(workerCount);
+        for (size_t i = 0; i < workerCount; ++i) {
+            threads.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    ~WorkerPool() { shutdown(); }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Queue a task; false (task dropped) if the queue is full or stopping
+    bool trySubmit(std::function<void()> run) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || queue.size() >= capacity) {
+                rejected++;
+                return false;
+            }
+            queue.push_back({std::move(run), Clock::now()});
+            submitted++;
+            maxQueueDepth = std::max(maxQueueDepth, queue.size());
+        }
+        available.notify_one();
+        return true;
+    }
+
+    // Worker threads started (fixed for the pool's lifetime)
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return threads.size();
+    }
+
+    // Finish queued tasks, then join all workers
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping && threads.empty()) return;
+            stopping = true;
+        }
+        available.notify_all();
+        for (std::thread& t : threads) {
+            if (t.joinable()) t.join();
+        }
+        threads.clear();
+    }
+
+    Stats getStats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats stats;
+        stats.workers = threads.size();
+        stats.capacity = capacity;
+        stats.queueDepth = queue.size();
+        stats.maxQueueDepth = maxQueueDepth;
+        stats.busyWorkers = busyWorkers;
+        stats.submitted = submitted;
+        stats.rejected = rejected;
+        stats.completed = completed;
+        stats.avgQueueWaitMs = completed + busyWorkers > 0 ? totalWaitMs / (completed + busyWorkers) : 0;
+        stats.maxQueueWaitMs = maxWaitMs;
+        return stats;
+    }
+};
+
+#endif // WORKERPOOL_H
@@ -54,10 +54,9 @@ using namespace std;
 
 // ============ GLOBAL OBJECTS ============
 TrafficManager trafficManager(100);
-SpatialIndex spatialIndex;           // ✅ NEW: Spatial search
 PerformanceMonitor perfMonitor;       // ✅ NEW: Performance tracking
-AutocompleteEngine autocomplete;      // ✅ NEW: Smart autocomplete
 StressTester stressTester;            // ✅ NEW: Load testing
+ServerConfig serverConfig;            // set from --workers / --threaded
 
 // ============ FUNCTION PROTOTYPES ============
 void setupWindowsConsole();
@@ -118,21 +117,6 @@ void initializeLahoreData() {
     trafficManager.addJunction(j5);
     trafficManager.addJunction(j6);
 
-    // ✅ NEW: Add to spatial index and autocomplete
-    spatialIndex.addJunction(j1);
-    spatialIndex.addJunction(j2);
-    spatialIndex.addJunction(j3);
-    spatialIndex.addJunction(j4);
-    spatialIndex.addJunction(j5);
-    spatialIndex.addJunction(j6);
-    
-    autocomplete.addJunction(j1);
-    autocomplete.addJunction(j2);
-    autocomplete.addJunction(j3);
-    autocomplete.addJunction(j4);
-    autocomplete.addJunction(j5);
-    autocomplete.addJunction(j6);
-
     // Add Roads
     Road r1(1, "Main Boulevard Gulberg", 1, 3, 2.5, 50); r1.isTwoWay = true;
     Road r2(2, "Ferozepur Road", 3, 5, 6.0, 60); r2.isTwoWay = true;
@@ -141,6 +125,8 @@ void initializeLahoreData() {
     trafficManager.addRoad(r1);
     trafficManager.addRoad(r2);
     trafficManager.addRoad(r3);
+    trafficManager.freezeRoadNetwork();
+    trafficManager.applyDefaultTrafficProfiles();
 
     std::cout << ICON_SUCCESS << " Loaded " << trafficManager.getJunctionCount() 
               << " junctions and " << trafficManager.getRoadCount() << " roads.\n";
@@ -155,23 +141,34 @@ void loadOSMData() {
     std::cout << "|       Real OpenStreetMap Data Integration               |\n";
     std::cout << "|_________________________________________________________|\n";
     
-    if (loader.loadJunctions("data/pakistan_osm_junctions.json")) {
-        loader.generateRoadNetwork(5.0);
-        loader.printStats();
+    const std::string dataFile = "data/pakistan_osm_junctions.json";
+    const std::string snapshotFile = "data/pakistan_osm_junctions.snap";
+    const double roadRadiusKm = 5.0;
+    
+    // A snapshot built from the same JSON and radius skips parsing and road generation
+    SnapshotSource source;
+    bool haveSource = SnapshotSource::describe(dataFile, roadRadiusKm, &source);
+    if (haveSource && trafficManager.loadSnapshot(snapshotFile, source)) {
+        trafficManager.prepareRouteHierarchy();
+        std::cout << ICON_SUCCESS << " Spatial Index & Autocomplete Ready!\n\n";
         
-        // ✅ NEW: Build spatial index and autocomplete from loaded data
-        std::cout << "\n" << ICON_LOADING << " Building advanced indices...\n";
-        auto junctions = trafficManager.getAllJunctions();
-        for (const auto& j : junctions) {
-            spatialIndex.addJunction(j);
-            autocomplete.addJunction(j);
-        }
+    } else if (loader.loadJunctions(dataFile)) {
+        loader.generateRoadNetwork(roadRadiusKm);
+        trafficManager.freezeRoadNetwork();
+        trafficManager.applyDefaultTrafficProfiles();
+        trafficManager.saveSnapshot(snapshotFile, source);
+        trafficManager.prepareRouteHierarchy();
+        loader.printStats();
         std::cout << ICON_SUCCESS << " Spatial Index & Autocomplete Ready!\n\n";
         
     } else {
         std::cout << "\n" << ICON_WARNING << " OSM file not found. Loading sample data...\n\n";
         initializeLahoreData();
     }
+
+    // Places geocoded by earlier runs; new Nominatim answers are appended
+    size_t geocoded = trafficManager.loadGeocodeCache("data/nominatim_cache.tsv");
+    if (geocoded > 0) std::cout << ICON_SUCCESS << " " << geocoded << " cached Nominatim places\n";
 }
 
 // ============ UI FUNCTIONS ============
@@ -206,7 +203,7 @@ void printMenu() {
     std::cout << "|______________________________________________________________|\n";
     std::cout << "| " << ICON_FIRE << " ADVANCED SHOWCASE FEATURES (NEW!)                      |\n";
     std::cout << "|  7. " << ICON_SPATIAL << " Spatial Search (Find junctions within radius)        |\n";
-    std::cout << "|  8. " << ICON_AUTO << " Smart Autocomplete (B-Tree prefix search)            |\n";
+    std::cout << "|  8. " << ICON_AUTO << " Smart Autocomplete (trie prefix search)              |\n";
     std::cout << "|  9. " << ICON_STATS << " Performance Dashboard (Live metrics)                 |\n";
     std::cout << "| 10. " << ICON_STRESS << " Stress Test (Simulate 1000 concurrent users)        |\n";
     std::cout << "| 11. " << ICON_SAVE << " Data Persistence (Save/Load to disk)                 |\n";
@@ -223,10 +220,10 @@ void showcaseSpatialSearch() {
     clearScreen();
     printBanner();
     std::cout << "_____________________________________________________________\n";
-    std::cout << "|        " << ICON_SPATIAL << " SPATIAL SEARCH DEMO (B-Tree Range Query)             |\n";
+    std::cout << "|        " << ICON_SPATIAL << " SPATIAL SEARCH DEMO (K-D Tree Radius Query)          |\n";
     std::cout << "|_____________________________________________________________|\n\n";
     
-    std::cout << "This feature uses B-Tree range queries for O(log n + m) search\n";
+    std::cout << "This feature uses k-d tree range queries for ~O(log n + m) search\n";
     std::cout << "where m = number of results.\n\n";
     
     double lat, lng, radius;
@@ -239,7 +236,12 @@ void showcaseSpatialSearch() {
     
     std::cout << "\n" << ICON_LOADING << " Searching...\n\n";
     
-    auto results = spatialIndex.findInRadius(lat, lng, radius);
+    auto start = std::chrono::high_resolution_clock::now();
+    auto results = trafficManager.findJunctionsWithinRadius(lat, lng, radius);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "🎯 SPATIAL QUERY: Found " << results.size()
+              << " junctions within " << radius << "km in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << "ms\n";
     
     if (results.empty()) {
         std::cout << ICON_ERROR << " No junctions found within " << radius << " km\n";
@@ -250,17 +252,16 @@ void showcaseSpatialSearch() {
         std::cout << "|_____|_______________________|_________________|_____________|\n";
         
         int count = 1;
-        for (const auto& j : results) {
-            // Calculate exact distance
-            double dist = spatialIndex.calculateDistance(lat, lng, j.latitude, j.longitude);
+        for (const auto& nearby : results) {
+            const Junction& j = nearby.junction;
             printf("│ %3d │ %-21s │ %-15s │ %7.2f km │\n", 
                    count++, j.name.substr(0, 21).c_str(), 
-                   j.area.substr(0, 15).c_str(), dist);
+                   j.area.substr(0, 15).c_str(), nearby.distanceKm);
         }
         std::cout << "|_____|_______________________|_________________|_____________|\n";
     }
     
-    std::cout << "\n" << ICON_INFO << " This demonstrates B-Tree's efficient range queries!\n";
+    std::cout << "\n" << ICON_INFO << " This demonstrates the k-d tree's efficient radius queries!\n";
     std::cout << "\nPress Enter to continue...";
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     std::cin.get();
@@ -270,10 +271,10 @@ void showcaseAutocomplete() {
     clearScreen();
     printBanner();
     std::cout << "_____________________________________________________________\n";
-    std::cout << "|       " << ICON_AUTO << " SMART AUTOCOMPLETE (B-Tree Prefix Search)           |\n";
+    std::cout << "|       " << ICON_AUTO << " SMART AUTOCOMPLETE (Trie Prefix Search)             |\n";
     std::cout << "|_____________________________________________________________|\n\n";
     
-    std::cout << "This feature uses B-Tree prefix search for fast autocomplete.\n";
+    std::cout << "This feature uses a compact trie with precomputed top results per prefix.\n";
     std::cout << "Try typing partial names like 'lib', 'mall', 'def'\n\n";
     
     std::string prefix;
@@ -281,7 +282,12 @@ void showcaseAutocomplete() {
     std::cin.ignore();
     std::getline(std::cin, prefix);
     
-    auto results = autocomplete.search(prefix, 10);
+    auto start = std::chrono::high_resolution_clock::now();
+    auto results = trafficManager.autocompleteJunctions(prefix, 10);
+    auto end = std::chrono::high_resolution_clock::now();
+    std::cout << "⚡ AUTOCOMPLETE: Found " << results.size()
+              << " matches for \"" << prefix << "\" in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
     
     if (results.empty()) {
         std::cout << "\n" << ICON_ERROR << " No matches found for \"" << prefix << "\"\n";
@@ -300,7 +306,7 @@ void showcaseAutocomplete() {
         std::cout << "|_____|___________________________________|__________________|\n";
     }
     
-    std::cout << "\n" << ICON_INFO << " Autocomplete is powered by B-Tree prefix matching!\n";
+    std::cout << "\n" << ICON_INFO << " Autocomplete is powered by trie prefix matching: O(|prefix| + k)!\n";
     std::cout << "\nPress Enter to continue...";
     std::cin.get();
 }
@@ -325,13 +331,13 @@ void showcasePerformanceStats() {
     perfMonitor.recordSearch("Dijkstra (Distance)", time2);
     
     start = std::chrono::high_resolution_clock::now();
-    spatialIndex.findInRadius(31.5204, 74.3587, 5.0);
+    trafficManager.findJunctionsWithinRadius(31.5204, 74.3587, 5.0);
     end = std::chrono::high_resolution_clock::now();
     double time3 = std::chrono::duration<double, std::milli>(end - start).count();
     perfMonitor.recordSearch("Spatial Search", time3);
     
     start = std::chrono::high_resolution_clock::now();
-    autocomplete.search("lib", 10);
+    trafficManager.autocompleteJunctions("lib", 10);
     end = std::chrono::high_resolution_clock::now();
     double time4 = std::chrono::duration<double, std::milli>(end - start).count();
     perfMonitor.recordSearch("Autocomplete", time4);
@@ -486,10 +492,10 @@ void findShortestRoute() {
         std::cout << "🗺️ Route Path:\n";
         std::cout << "_____________________________________________________________\n";
         
-        for (size_t i = 0; i < result.junctions.size(); ++i) {
-            std::cout << "│  " << (i + 1) << ". " << result.junctions[i].name;
-            std::cout << " (" << result.junctions[i].area << ")\n";
-            if (i < result.junctions.size() - 1) {
+        for (size_t i = 0; i < result.stops.size(); ++i) {
+            std::cout << "│  " << (i + 1) << ". " << result.getString(result.stops[i].name);
+            std::cout << " (" << result.getString(result.stops[i].area) << ")\n";
+            if (i < result.stops.size() - 1) {
                 std::cout << "│       ↓\n";
             }
         }
@@ -695,7 +701,7 @@ void showcaseStressTest() {
     std::cout << "  ├─ B-Tree:            " << btreeSuccess << "/" << (total/2) << " searches\n";
     std::cout << "  └─ Hash Table:        " << hashSuccess << "/" << (total/2) << " searches\n\n";
 
-    td::cout << "  💡 ANALYSIS:\n";
+    std::cout << "  💡 ANALYSIS:\n";
     if (queriesPerSec > 10000) {
         std::cout << "  ✅ EXCELLENT: System handles 10K+ queries/sec!\n";
     } else if (queriesPerSec > 5000) {
@@ -957,7 +963,7 @@ void startServer() {
     int port = 8080;
     std::cout << "Starting HTTP API Server on port " << port << "...\n\n";
     
-    HttpServer server(port, trafficManager);
+    HttpServer server(port, trafficManager, serverConfig);
     
     if (server.start()) {
         std::cout << "✅ Server started successfully!\n";
@@ -1033,7 +1039,30 @@ void runCLI() {
 
 int main(int argc, char* argv[]) {
     setupWindowsConsole();
+
+    // --server [--workers=N] [--threaded]
+    bool serverOnly = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--server") {
+            serverOnly = true;
+        } else if (arg == "--threaded") {
+            serverConfig.mode = ServerMode::THREAD_PER_CONNECTION;
+        } else if (arg.rfind("--workers=", 0) == 0) {
+            int workers = atoi(arg.c_str() + 10);
+            if (workers < 1) {
+                std::cout << ICON_ERROR << " Invalid worker count: " << arg << "\n";
+                return 1;
+            }
+            serverConfig.workerThreads = workers;
+        }
+    }
+
     loadOSMData();
-    runCLI();
+    if (serverOnly) {
+        startServer();
+    } else {
+        runCLI();
+    }
     return 0;
 }